@@ -34,6 +34,7 @@
 #include "DELA.h"
 #include "AbstractDelaLoad.h"
 #include "AbstractDelaPlugCallback.h"
+#include "Pipeline.h"
 
 struct AbstractDelaSpace {
 	t_persistent_dic_func_array func_array;
@@ -135,13 +136,30 @@ const AbstractDelaSpace * GetDelaSpaceForFileName(const char*name)
 
 /*******************************/
 
+static void release_INF_codes(void* INF)
+{
+	free_INF_codes((struct INF_codes*)INF);
+}
+
 const struct INF_codes* load_abstract_INF_file(const char* name,struct INF_free_info* p_inf_free_info)
 {
 	struct INF_codes* res = NULL;
 	const AbstractDelaSpace * pads = GetDelaSpaceForFileName(name) ;
 	if (pads == NULL)
 	{
-		res = load_INF_file(name);
+		if (IsPipelineActive())
+		{
+			/* The .inf file is parsed only once for all the tools of the pipeline */
+			res = (struct INF_codes*)get_pipeline_resource(name,PIPELINE_INF_CODES);
+			if (res == NULL)
+			{
+				res = load_INF_file(name);
+				keep_pipeline_resource(name,PIPELINE_INF_CODES,res,release_INF_codes);
+			}
+		}
+		else
+			res = load_INF_file(name);
+		/* free_abstract_INF only frees the structure if the pipeline does not keep it */
 		if (res != NULL)
 		{
 			p_inf_free_info->must_be_free = 1;
@@ -167,7 +185,10 @@ void free_abstract_INF(const struct INF_codes* INF,struct INF_free_info* p_inf_f
 		if (p_inf_free_info->must_be_free != 0)
 	{
 		if (p_inf_free_info->func_free_inf == NULL)
-			free_INF_codes((struct INF_codes*)INF);
+		{
+			if (!unuse_pipeline_resource(INF))
+				free_INF_codes((struct INF_codes*)INF);
+		}
 		else
 		{
 			t_fnc_free_abstract_INF fnc_free_abstract_INF = (t_fnc_free_abstract_INF)(p_inf_free_info->func_free_inf);
@@ -251,7 +251,7 @@ void Call_logger_fnc_after_calling_tool(mainFunc* fnc,int argc,char* const argv[
     struct List_LoggerInfo* tmp = p_logger_info_list;
 	while (tmp != NULL)
 	{
-        if ((tmp->lgi.func_array.fnc_after_af_remove) != NULL)
+        if ((tmp->lgi.func_array.fnc_after_calling_tool) != NULL)
             (*(tmp->lgi.func_array.fnc_after_calling_tool))(fnc,argc,argv,ret,tmp->lgi.privateLoggerPtr);
 		tmp = tmp->next;
 	}
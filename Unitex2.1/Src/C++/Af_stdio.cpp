@@ -40,6 +40,7 @@
 #include "Af_stdio.h"
 #include "MappedFileHelper.h"
 #include "ActivityLogger.h"
+#include "Pipeline.h"
 
 
 
@@ -878,3 +879,145 @@ int af_rename(const char * OldFilename, const char * NewFilename)
     Call_logger_fnc_after_af_rename(OldFilename, NewFilename, ret);
     return ret;
 }
+
+
+/*********************************************************************/
+/* pipeline of tools (see Pipeline.h)                                 */
+
+static const t_pipeline_func_array* p_pipeline_func_array=NULL;
+
+int AddPipelineSpace(const t_pipeline_func_array* func_array)
+{
+    if (p_pipeline_func_array != NULL)
+        return 0;
+    p_pipeline_func_array = func_array;
+    return 1;
+}
+
+int RemovePipelineSpace(const t_pipeline_func_array* func_array)
+{
+    if (p_pipeline_func_array != func_array)
+        return 0;
+    p_pipeline_func_array = NULL;
+    return 1;
+}
+
+UNITEX_FUNC int UNITEX_CALL BeginPipeline()
+{
+    if (p_pipeline_func_array == NULL)
+        return 0;
+    return (*(p_pipeline_func_array->fnc_begin_pipeline))();
+}
+
+UNITEX_FUNC int UNITEX_CALL EndPipeline()
+{
+    if (p_pipeline_func_array == NULL)
+        return 0;
+    return (*(p_pipeline_func_array->fnc_end_pipeline))();
+}
+
+UNITEX_FUNC int UNITEX_CALL IsPipelineActive()
+{
+    if (p_pipeline_func_array == NULL)
+        return 0;
+    return (*(p_pipeline_func_array->fnc_is_pipeline_active))();
+}
+
+UNITEX_FUNC void UNITEX_CALL SetPipelineMemoryLimit(long limit)
+{
+    if (p_pipeline_func_array != NULL)
+        (*(p_pipeline_func_array->fnc_set_pipeline_memory_limit))(limit);
+}
+
+void* get_pipeline_resource(const char* filename,PipelineResourceType type)
+{
+    if (p_pipeline_func_array == NULL)
+        return NULL;
+    return (*(p_pipeline_func_array->fnc_get_resource))(filename,type);
+}
+
+int keep_pipeline_resource(const char* filename,PipelineResourceType type,void* resource,release_pipeline_resource release)
+{
+    if (p_pipeline_func_array == NULL)
+        return 0;
+    return (*(p_pipeline_func_array->fnc_keep_resource))(filename,type,resource,release);
+}
+
+int share_pipeline_resource(const char* filename,PipelineResourceType type,void* resource,release_pipeline_resource release)
+{
+    if (p_pipeline_func_array == NULL)
+        return 0;
+    return (*(p_pipeline_func_array->fnc_share_resource))(filename,type,resource,release);
+}
+
+int unuse_pipeline_resource(const void* resource)
+{
+    if (p_pipeline_func_array == NULL)
+        return 0;
+    return (*(p_pipeline_func_array->fnc_unuse_resource))(resource);
+}
+
+int provide_pipeline_resource(const char* filename,PipelineResourceType type,void* resource)
+{
+    if (p_pipeline_func_array == NULL)
+        return 0;
+    return (*(p_pipeline_func_array->fnc_provide_resource))(filename,type,resource);
+}
+
+void withdraw_pipeline_resource(const void* resource)
+{
+    if (p_pipeline_func_array != NULL)
+        (*(p_pipeline_func_array->fnc_withdraw_resource))(resource);
+}
+
+void drop_pipeline_file(const char* filename)
+{
+    if (p_pipeline_func_array != NULL)
+        (*(p_pipeline_func_array->fnc_drop_file))(filename);
+}
+
+static void release_mapped_file(void* mapped_file)
+{
+    struct pipeline_mapped_file* m=(struct pipeline_mapped_file*)mapped_file;
+    af_release_mapfile_pointer(m->amf,m->buffer);
+    af_close_mapfile(m->amf);
+    free(m);
+}
+
+/**
+ * Maps the given file in memory, and returns NULL if it cannot be opened.
+ * In a pipeline, the mapping of a file that has already been mapped is
+ * shared by all the tools, as long as the file is not modified.
+ */
+struct pipeline_mapped_file* map_pipeline_file(const char* filename)
+{
+    struct pipeline_mapped_file* shared=(struct pipeline_mapped_file*)get_pipeline_resource(filename,PIPELINE_MAPPED_FILE);
+    if (shared != NULL)
+        return shared;
+    ABSTRACTMAPFILE* amf=af_open_mapfile(filename,MAPFILE_OPTION_READ,0);
+    if (amf == NULL)
+        return NULL;
+    struct pipeline_mapped_file* m=(struct pipeline_mapped_file*)malloc(sizeof(struct pipeline_mapped_file));
+    if (m == NULL) {
+        fatal_alloc_error("map_pipeline_file");
+    }
+    m->amf=amf;
+    m->size=af_get_mapfile_size(amf);
+    m->buffer=af_get_mapfile_pointer(amf);
+    keep_pipeline_resource(filename,PIPELINE_MAPPED_FILE,m,release_mapped_file);
+    return m;
+}
+
+/**
+ * Tells that a tool does not use anymore a mapping given by map_pipeline_file.
+ * A mapping that does not belong to the pipeline is closed. A shared one is
+ * closed if its file has been modified and no other tool uses it.
+ */
+void unmap_pipeline_file(struct pipeline_mapped_file* mapped_file)
+{
+    if (mapped_file == NULL)
+        return;
+    if (unuse_pipeline_resource(mapped_file))
+        return;
+    release_mapped_file(mapped_file);
+}
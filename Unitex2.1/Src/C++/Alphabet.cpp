@@ -21,6 +21,7 @@
 
 #include "Alphabet.h"
 #include "Error.h"
+#include "Pipeline.h"
 
 // 0x400 in final release, good for all langage 
 #define FIRST_SIZE_ARRAYCOLLECTION 0x400
@@ -77,6 +78,7 @@ return alphabet;
  */
 void free_alphabet(Alphabet* alphabet) {
 if (alphabet==NULL) return;
+if (unuse_pipeline_resource(alphabet)) return;
 /*
 for (int i=0;i<alphabet->higher_written;i++) {
   if (alphabet->t[i]!=NULL)
@@ -92,6 +94,11 @@ free(alphabet);
 }
 
 
+static void release_alphabet(void* alphabet) {
+free_alphabet((Alphabet*)alphabet);
+}
+
+
 /**
  * Adds a letter equivalence to the given alphabet. For instance,
  * if 'lower'="e" and 'upper'="E", "E" will now be considered as an
@@ -139,12 +146,17 @@ if (alphabet->korean_equivalent_syllable!=NULL) {
  * characters.
  */
 Alphabet* load_alphabet(const char* filename,int korean) {
+PipelineResourceType type=korean?PIPELINE_KOREAN_ALPHABET:PIPELINE_ALPHABET;
+Alphabet* alphabet=(Alphabet*)get_pipeline_resource(filename,type);
+if (alphabet!=NULL) {
+   return alphabet;
+}
 U_FILE* f;
 f=u_fopen_existing_unitex_text_format(filename,U_READ);
 if (f==NULL) {
    return NULL;
 }
-Alphabet* alphabet=new_alphabet(korean);
+alphabet=new_alphabet(korean);
 int c;
 unichar lower,upper;
 while ((c=u_fgetc(f))!=EOF) {
@@ -185,6 +197,7 @@ while ((c=u_fgetc(f))!=EOF) {
       }
 }
 u_fclose(f);
+keep_pipeline_resource(filename,type,alphabet,release_alphabet);
 return alphabet;
 }
 
@@ -585,9 +585,10 @@ struct dico_application_info* info=(struct dico_application_info*)malloc(sizeof(
 if (info==NULL) {
    fatal_alloc_error("init_dico_application");
 }
-info->map_text_cod=af_open_mapfile(text_cod,MAPFILE_OPTION_READ,0);
-info->text_cod_buf=(const int*)af_get_mapfile_pointer(info->map_text_cod);
-info->text_cod_size_nb_int=(int)(af_get_mapfile_size(info->map_text_cod)/sizeof(int));
+/* In a pipeline, the mapping of text.cod is shared with the Locate calls */
+info->map_text_cod=map_pipeline_file(text_cod);
+info->text_cod_buf=(info->map_text_cod!=NULL)?(const int*)info->map_text_cod->buffer:NULL;
+info->text_cod_size_nb_int=(info->map_text_cod!=NULL)?(int)(info->map_text_cod->size/sizeof(int)):0;
 info->tokens=tokens;
 info->dlf=dlf;
 info->dlc=dlc;
@@ -634,8 +635,7 @@ return info;
  */
 void free_dico_application(struct dico_application_info* info) {
 if (info==NULL) return;
-af_release_mapfile_pointer(info->map_text_cod,info->text_cod_buf);
-af_close_mapfile(info->map_text_cod);
+unmap_pipeline_file(info->map_text_cod);
 free_bit_array(info->part_of_a_word);
 free_bit_array(info->part_of_a_word2);
 free_bit_array(info->simple_word);
@@ -744,14 +744,13 @@ int merge_dic_locate_results(struct dico_application_info* info,char* concord_fi
  * Example: cinquante-deux could be represented by (1347,35,582,-1) */
 int token_tab_coumpounds[TOKENS_IN_A_COMPOUND];
 u_printf("Merging dic/locate result...\n");
-/* First, we load the match list */
-U_FILE* f=u_fopen_existing_versatile_encoding(info->mask_encoding_compatibility_input,concord_filename,U_READ);
-if (f==NULL) {
+/* First, we load the match list. In a pipeline, like the one opened by Dico,
+ * the matches that Locate has just saved are taken from memory */
+struct match_list* l;
+if (!load_concord_ind(concord_filename,info->mask_encoding_compatibility_input,&l,NULL)) {
    error("Cannot open %s\n",concord_filename);
    return 0;
 }
-struct match_list* l=load_match_list(f,NULL);
-u_fclose(f);
 while (l!=NULL) {
    if (l->output!=NULL && l->output[0]=='/') {
 	   /* If we have a tag sequence to be used at the time of
@@ -30,6 +30,7 @@
 #include "CompoundWordHashTable.h"
 #include "BitArray.h"
 #include "LocateMatches.h"
+#include "Pipeline.h"
 
 
 /**
@@ -90,7 +91,7 @@ struct word_struct_array {
  */
 struct dico_application_info {
    /* Info about the text files */
-   ABSTRACTMAPFILE* map_text_cod;
+   struct pipeline_mapped_file* map_text_cod;
    const int* text_cod_buf;
    int text_cod_size_nb_int;
    struct text_tokens* tokens;
@@ -19,12 +19,15 @@
  *
  */
 
+#include <string.h>
 #include "Symbol.h"
 #include "Symbol_op.h"
 #include "Fst2Automaton.h"
 #include "ElagStateSet.h"
 #include "Transitions.h"
 #include "AutIntersection.h"
+#include "HashTable.h"
+#include "Vector.h"
 
 
 /**
@@ -230,3 +233,141 @@ return res;
 
 
 
+/**
+ * The states of the intersection built by elag_text_intersection are
+ * tuples of ints: tuple[0] is the size of the tuple, tuple[1] is a state
+ * of the text automaton, and tuple[i+2] is a state of the grammar #i.
+ */
+static unsigned int hash_state_tuple(const int* tuple) {
+unsigned int h=0;
+for (int i=1;i<tuple[0];i++) {
+   h=h*31+(unsigned int)tuple[i];
+}
+return h;
+}
+
+
+static int state_tuples_equal(const int* a,const int* b) {
+return !memcmp(a,b,a[0]*sizeof(int));
+}
+
+
+/**
+ * Returns the state reached from the state #q of the grammar B with the
+ * text symbol s, or -1 if s cannot be read from q.
+ */
+static int get_grammar_destination(const SingleGraph B,int q,const symbol_t* s) {
+int destination=-1;
+for (Transition* t=B->states[q]->outgoing_transitions;t!=NULL;t=t->next) {
+   if (symbol_in_symbol(s,t->label)) {
+      if (destination!=-1) {
+         fatal_error("elag_text_intersection: non deterministic automaton\n");
+      }
+      destination=t->state_number;
+   }
+}
+if (destination==-1) {
+   destination=B->states[q]->default_state;
+}
+return destination;
+}
+
+
+/**
+ * Returns the state of 'res' that corresponds to the given tuple, creating
+ * it if needed. In that case, the tuple is kept in 'tuples' and in the hash
+ * table, and *tuple is replaced by a new buffer for the caller.
+ */
+static int get_tuple_state(SingleGraph res,struct hash_table* hash,vector_ptr* tuples,int** tuple,
+                           const SingleGraph text,const SingleGraph* grammars,int n_grammars) {
+int ret;
+struct any* value=get_value(hash,*tuple,HT_INSERT_IF_NEEDED,&ret);
+if (ret==HT_KEY_ALREADY_THERE) {
+   return value->_int;
+}
+int q=res->number_of_states;
+value->_int=q;
+SingleGraphState state=add_state(res);
+int final=is_final_state(text->states[(*tuple)[1]]);
+for (int i=0;final && i<n_grammars;i++) {
+   final=is_final_state(grammars[i]->states[(*tuple)[i+2]]);
+}
+if (final) {
+   set_final_state(state);
+}
+vector_ptr_add(tuples,*tuple);
+int size=(*tuple)[0];
+(*tuple)=(int*)malloc(size*sizeof(int));
+if (*tuple==NULL) {
+   fatal_alloc_error("get_tuple_state");
+}
+(*tuple)[0]=size;
+return q;
+}
+
+
+/**
+ * Returns the intersection of the given sentence automaton with all the given
+ * grammars at once. All automata are supposed to be deterministic. The states
+ * of the result are tuples made of one state of each automaton, and they are
+ * only built when they can be reached: a text transition is dropped as soon as
+ * one grammar cannot read it, so that no intermediate intersection is ever
+ * built. The result is not trimmed.
+ */
+SingleGraph elag_text_intersection(const SingleGraph text,const SingleGraph* grammars,int n_grammars) {
+int size=n_grammars+2;
+int* tuple=(int*)malloc(size*sizeof(int));
+if (tuple==NULL) {
+   fatal_alloc_error("elag_text_intersection");
+}
+tuple[0]=size;
+tuple[1]=get_initial_state(text);
+for (int i=0;i<n_grammars;i++) {
+   tuple[i+2]=get_initial_state(grammars[i]);
+}
+for (int i=1;i<size;i++) {
+   if (tuple[i]==-2) {
+      fatal_error("Non deterministic automaton in elag_text_intersection\n");
+   }
+   if (tuple[i]==-1) {
+      /* If there is no initial state in one automaton, then the intersection is empty */
+      free(tuple);
+      return new_SingleGraph(0,PTR_TAGS);
+   }
+}
+SingleGraph res=new_SingleGraph(text->number_of_states,PTR_TAGS);
+struct hash_table* hash=new_hash_table((HASH_FUNCTION)hash_state_tuple,(EQUAL_FUNCTION)state_tuples_equal,
+                                       free,NULL,NULL);
+/* tuples->tab[q] is the tuple of the state #q. The tuples are owned by the hash table */
+vector_ptr* tuples=new_vector_ptr(16);
+int initial=get_tuple_state(res,hash,tuples,&tuple,text,grammars,n_grammars);
+set_initial_state(res->states[initial]);
+/* States are explored in the order they are created */
+for (int q=0;q<tuples->nbelems;q++) {
+   int* current=(int*)(tuples->tab[q]);
+   for (Transition* t=text->states[current[1]]->outgoing_transitions;t!=NULL;t=t->next) {
+      tuple[1]=t->state_number;
+      int i;
+      for (i=0;i<n_grammars;i++) {
+         tuple[i+2]=get_grammar_destination(grammars[i],current[i+2],t->label);
+         if (tuple[i+2]==-1) {
+            /* The transition is rejected by the grammar #i */
+            break;
+         }
+      }
+      if (i!=n_grammars) {
+         continue;
+      }
+      int destination=get_tuple_state(res,hash,tuples,&tuple,text,grammars,n_grammars);
+      add_outgoing_transition(res->states[q],t->label,destination);
+   }
+}
+resize(res);
+free(tuple);
+free_vector_ptr(tuples);
+free_hash_table(hash);
+return res;
+}
+
+
+
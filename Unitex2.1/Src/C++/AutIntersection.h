@@ -33,5 +33,6 @@
 #define TEXT_GRAMMAR 1
 
 SingleGraph elag_intersection(language_t*,const SingleGraph,const SingleGraph,int type);
+SingleGraph elag_text_intersection(const SingleGraph text,const SingleGraph* grammars,int n_grammars);
 
 #endif
@@ -33,6 +33,7 @@
 #include "MF_Global.h"
 #include "MF_InflectTransd.h"
 #include "MF_LangMorpho.h"
+#include "MF_SU_morpho.h"
 #include "File.h"
 
 const char* usage_BuildKrMwuDic =
@@ -167,6 +168,7 @@ MultiFlex_ctx* multiFlex_ctx = (MultiFlex_ctx*)malloc(sizeof(MultiFlex_ctx));
 if (multiFlex_ctx==NULL) {
    fatal_alloc_error("main_BuildKrMwuDic");
 }
+multiFlex_ctx->SU_memo=NULL;
 strcpy(multiFlex_ctx->inflection_directory,inflection_dir);
 if (init_transducer_tree(multiFlex_ctx)) {
    fatal_error("init_transducer_tree error\n");
@@ -194,6 +196,7 @@ for (int count_free_fst2=0;count_free_fst2<multiFlex_ctx->n_fst2;count_free_fst2
     multiFlex_ctx->fst2[count_free_fst2]=NULL;
 }
 free_language_morpho(pL_MORPHO);
+SU_free_memo(multiFlex_ctx);
 free(multiFlex_ctx);
 free_OptVars(vars);
 u_printf("Done.\n");
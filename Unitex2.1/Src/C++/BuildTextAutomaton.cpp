@@ -826,6 +826,7 @@ while (trans!=NULL) {
 void build_sentence_automaton(const int* buffer,int length,const struct text_tokens* tokens,
                                const struct DELA_tree* DELA_tree,
                                const Alphabet* alph,U_FILE* out_tfst,U_FILE* out_tind,
+                               struct tfst_binary_writer* out_tfstb,
                                int sentence_number,
                                int we_must_clean,
                                struct normalization_tree* norm_tree,
@@ -834,6 +835,57 @@ void build_sentence_automaton(const int* buffer,int length,const struct text_tok
                                int current_global_position_in_chars,
                                language_t* language,Korean* korean,
                                struct hash_table* form_frequencies) {
+struct string_hash* tags;
+Tfst* tfst=compute_sentence_automaton(buffer,length,tokens,DELA_tree,alph,sentence_number,we_must_clean,
+                                      norm_tree,tag_list,current_global_position_in_tokens,
+                                      current_global_position_in_chars,language,korean,&tags);
+save_sentence_automaton(tfst,tags,out_tfst,out_tind,out_tfstb,form_frequencies);
+}
+
+
+/**
+ * Removes from the given tag list the tag sequences that start in the sentence
+ * that starts at the given token position, and returns them. These are
+ * the tag sequences that 'compute_sentence_automaton' would take from
+ * the list. This allows to build sentences on several threads.
+ */
+struct match_list* get_sentence_tag_list(struct match_list* *tag_list,int current_global_position_in_tokens,
+                                         int length) {
+struct match_list* result=NULL;
+struct match_list* last=NULL;
+while ((*tag_list)!=NULL && (*tag_list)->m.start_pos_in_token>=current_global_position_in_tokens
+       && (*tag_list)->m.start_pos_in_token<=current_global_position_in_tokens+length) {
+   if (result==NULL) {
+      result=(*tag_list);
+   } else {
+      last->next=(*tag_list);
+   }
+   last=(*tag_list);
+   (*tag_list)=(*tag_list)->next;
+   last->next=NULL;
+}
+return result;
+}
+
+
+/**
+ * This function builds the sentence automaton that correspond to the
+ * given token buffer, without saving it. The tags used by the automaton
+ * are stored in *used_tags, or NULL if the sentence automaton is empty.
+ * Note that buffer[length] is read by the normalization, so it must be
+ * a valid token number.
+ */
+Tfst* compute_sentence_automaton(const int* buffer,int length,const struct text_tokens* tokens,
+                               const struct DELA_tree* DELA_tree,
+                               const Alphabet* alph,
+                               int sentence_number,
+                               int we_must_clean,
+                               struct normalization_tree* norm_tree,
+                               struct match_list* *tag_list,
+                               int current_global_position_in_tokens,
+                               int current_global_position_in_chars,
+                               language_t* language,Korean* korean,
+                               struct string_hash* *used_tags) {
 /* We declare the graph that will represent the sentence as well as
  * a temporary string_hash 'tmp_tags' that will be used to store the tags of this
  * graph. We don't put tags directly in the main 'tags', because a tag can
@@ -960,7 +1012,8 @@ if (tfst->automaton->number_of_states==0) {
    free_vector_ptr(tfst->tags,(void (*)(void*))free_TfstTag);
    tfst->tags=new_vector_ptr(1);
    vector_ptr_add(tfst->tags,new_TfstTag(T_EPSILON));
-   save_current_sentence(tfst,out_tfst,out_tind,NULL,0,NULL);
+   free_string_hash(tags);
+   tags=NULL;
 } else {
    /* Case 2: the automaton is not empty */
 
@@ -977,12 +1030,28 @@ if (tfst->automaton->number_of_states==0) {
          trans=trans->next;
       }
    }
-   save_current_sentence(tfst,out_tfst,out_tind,tags->value,tags->size,form_frequencies);
 }
-close_text_automaton(tfst);
 free_string_hash(tmp_tags);
-free_string_hash(tags);
 free_Ustring(foo);
+(*used_tags)=tags;
+return tfst;
+}
+
+
+/**
+ * Saves the given sentence automaton computed by 'compute_sentence_automaton'
+ * into the given files, and then frees it as well as its tags.
+ */
+void save_sentence_automaton(Tfst* tfst,struct string_hash* tags,U_FILE* out_tfst,U_FILE* out_tind,
+                             struct tfst_binary_writer* out_tfstb,struct hash_table* form_frequencies) {
+if (tags==NULL) {
+   /* Case of an empty sentence automaton */
+   save_current_sentence(tfst,out_tfst,out_tind,out_tfstb,NULL,0,NULL);
+} else {
+   save_current_sentence(tfst,out_tfst,out_tind,out_tfstb,tags->value,tags->size,form_frequencies);
+}
+close_text_automaton(tfst);
+free_string_hash(tags);
 }
 
 
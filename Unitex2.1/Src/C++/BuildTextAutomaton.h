@@ -33,16 +33,27 @@
 #include "LanguageDefinition.h"
 #include "Korean.h"
 #include "HashTable.h"
+#include "Tfst.h"
 
 #define MAX_TOKENS_IN_SENTENCE 2000
 
 
 void build_sentence_automaton(const int*,int,const struct text_tokens*,
                               const struct DELA_tree*,
-                              const Alphabet*,U_FILE*,U_FILE*,int,int,
+                              const Alphabet*,U_FILE*,U_FILE*,struct tfst_binary_writer*,int,int,
                               struct normalization_tree*,
                               struct match_list**,int,int,
                               language_t*,Korean* korean,
                               struct hash_table* form_frequencies);
+Tfst* compute_sentence_automaton(const int*,int,const struct text_tokens*,
+                              const struct DELA_tree*,
+                              const Alphabet*,int,int,
+                              struct normalization_tree*,
+                              struct match_list**,int,int,
+                              language_t*,Korean* korean,
+                              struct string_hash**);
+void save_sentence_automaton(Tfst*,struct string_hash*,U_FILE*,U_FILE*,struct tfst_binary_writer*,
+                             struct hash_table* form_frequencies);
+struct match_list* get_sentence_tag_list(struct match_list**,int,int);
 
 #endif
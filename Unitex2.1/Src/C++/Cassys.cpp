@@ -33,6 +33,11 @@
 #include "Text_tokens.h"
 #include "Copyright.h"
 #include "DirHelper.h"
+#include "Pipeline.h"
+#include "VirtualFileSystem.h"
+#include "String_hash.h"
+#include "Ustring.h"
+#include "LocateMatches.h"
 
 
 #define CASSYS_DIRECTORY_EXTENSION "_csc"
@@ -52,6 +57,8 @@ const struct option_TS lopts_Cassys[] = {
 		{"transducer_file",required_argument_TS,NULL,'s'},
         {"transducer_dir",required_argument_TS,NULL,'r'},
         {"in_place", no_argument_TS,NULL,'i'},
+        {"in_memory", no_argument_TS,NULL,1},
+        {"labeled_files", no_argument_TS,NULL,2},
 		{"help", no_argument_TS,NULL,'h'}
 };
 
@@ -68,6 +75,12 @@ const char* usage_Cassys =
 		"-t TXT/--text=TXT the text file to be modified, with extension .snt\n"
 		"-i/--in_place mean uses the same csc/snt directories for each transducer\n"
 		"-d/--no_create_directory mean the all snt/csc directories already exist and don't need to be created\n"
+		"--in_memory: applies the cascade without writing the intermediate texts: the text is\n"
+		"      tokenized once, and the outputs of each transducer are directly added to the tokens.\n"
+		"      Locate is given the tokens of each stage from memory, and only the tokens around\n"
+		"      its matches are computed again for the next stage\n"
+		"--labeled_files: with --in_memory, also writes the labeled texts of each transducer in the\n"
+		"      csc directory, for debugging\n"
 		"  -g minus/--negation_operator=minus: uses minus as negation operator for Unitex 2.0 graphs\n"
 		"  -g tilde/--negation_operator=tilde: uses tilde as negation operator (default)\n"
 		"-h/--help display this help\n"
@@ -229,6 +242,8 @@ int main_Cassys(int argc,char* const argv[]) {
 	int mask_encoding_compatibility_input = DEFAULT_MASK_ENCODING_COMPATIBILITY_INPUT;
     int must_create_directory = 1;
     int in_place = 0;
+    int in_memory = 0;
+    int labeled_files = 0;
 
     struct transducer_name_and_mode_linked_list* transducer_name_and_mode_linked_list_arg=NULL;
 
@@ -334,6 +349,14 @@ int main_Cassys(int argc,char* const argv[]) {
             must_create_directory = 0;
 			break;
 		}
+        case 1: {
+            in_memory = 1;
+			break;
+		}
+        case 2: {
+            labeled_files = 1;
+			break;
+		}
 		default :{
 			fatal_error("Unknown option : %c\n",val);
 			break;
@@ -360,7 +383,11 @@ int main_Cassys(int argc,char* const argv[]) {
         transducer_name_and_mode_linked_list_arg = load_transducer_list_file(transducer_list_file_name);
     struct fifo *transducer_list=load_transducer_from_linked_list(transducer_name_and_mode_linked_list_arg,transducer_filename_prefix);
 
-	cascade(text_file_name, in_place, must_create_directory, transducer_list, alphabet_file_name,negation_operator,encoding_output,bom_output,mask_encoding_compatibility_input);
+	if (in_memory) {
+		cascade_in_memory(text_file_name, must_create_directory, labeled_files, transducer_list, alphabet_file_name,negation_operator,encoding_output,bom_output,mask_encoding_compatibility_input);
+	} else {
+		cascade(text_file_name, in_place, must_create_directory, transducer_list, alphabet_file_name,negation_operator,encoding_output,bom_output,mask_encoding_compatibility_input);
+	}
 	free_fifo(transducer_list);
     free_OptVars(vars);
     free_transducer_name_and_mode_linked_list(transducer_name_and_mode_linked_list_arg);
@@ -460,6 +487,523 @@ int cascade(const char* text, int in_place, int must_create_directory, fifo* tra
 }
 
 
+/**
+ * Token sequence of the text seen by Locate at a stage of the in-memory cascade.
+ * Since the text would be tokenized again by Tokenize between two stages, a
+ * sequence of separators gives one " " token, and consecutive letter tokens
+ * give one token. element[i] is the first element of the token list that is
+ * part of the i-th token, and first_index[i] is the index of this element in
+ * the text of the stage, so that a match from i to j replaces
+ * first_index[j+1]-first_index[i] elements. The stage is built once from the
+ * token list, and then only updated around the matches of each transducer.
+ */
+struct cassys_stage {
+	int size;
+	int capacity;
+	int *code;
+	cassys_tokens_list **element;
+	int *first_index;
+};
+
+
+static struct cassys_stage *new_cassys_stage() {
+	struct cassys_stage *stage = (struct cassys_stage*)malloc(sizeof(struct cassys_stage));
+	if (stage == NULL) {
+		fatal_alloc_error("new_cassys_stage");
+	}
+	stage->size = 0;
+	stage->capacity = 1024;
+	stage->code = (int*)malloc(sizeof(int)*stage->capacity);
+	stage->element = (cassys_tokens_list**)malloc(sizeof(cassys_tokens_list*)*stage->capacity);
+	stage->first_index = (int*)malloc(sizeof(int)*(stage->capacity+1));
+	if (stage->code == NULL || stage->element == NULL || stage->first_index == NULL) {
+		fatal_alloc_error("new_cassys_stage");
+	}
+	return stage;
+}
+
+
+static void free_cassys_stage(struct cassys_stage *stage) {
+	if (stage == NULL) return;
+	free(stage->code);
+	free(stage->element);
+	free(stage->first_index);
+	free(stage);
+}
+
+
+static void add_stage_token(struct cassys_stage *stage, int code, cassys_tokens_list *element, int first_index) {
+	if (stage->size == stage->capacity) {
+		stage->capacity = stage->capacity*2;
+		stage->code = (int*)realloc(stage->code,sizeof(int)*stage->capacity);
+		stage->element = (cassys_tokens_list**)realloc(stage->element,sizeof(cassys_tokens_list*)*stage->capacity);
+		stage->first_index = (int*)realloc(stage->first_index,sizeof(int)*(stage->capacity+1));
+		if (stage->code == NULL || stage->element == NULL || stage->first_index == NULL) {
+			fatal_alloc_error("add_stage_token");
+		}
+	}
+	stage->code[stage->size] = code;
+	stage->element[stage->size] = element;
+	stage->first_index[stage->size] = first_index;
+	stage->size++;
+}
+
+
+/**
+ * Returns 1 if the token is made of the characters that Tokenize
+ * considers as separators.
+ */
+static int is_separator_token(const unichar *s) {
+	if (s[0] == '\0') return 0;
+	for (int i = 0; s[i] != '\0'; i++) {
+		if (s[i] != ' ' && s[i] != '\r' && s[i] != '\n') return 0;
+	}
+	return 1;
+}
+
+
+/**
+ * Returns 1 if the element is a tag like {S} or {aujourd'hui,.ADV} of the
+ * original text.
+ */
+static int is_original_tag(const cassys_tokens_list *element) {
+	if (element->transducer_id != 0 || element->token[0] != '{') return 0;
+	int length = u_strlen(element->token);
+	return length > 2 && element->token[length-1] == '}';
+}
+
+
+/**
+ * Reads in 'token' the stage token that begins at '*current' in the text after
+ * the transducer 'transducer_id', moves '*current' after it, and returns the
+ * number of elements of the token list that it contains.
+ * If 'protect_tags' is non null, the tags of the original text are protected
+ * as protect_special_characters would have done in the text file.
+ */
+static int read_stage_token(cassys_tokens_list **current, int transducer_id, int protect_tags,
+		const Alphabet *alphabet, Ustring *token) {
+	cassys_tokens_list *element = *current;
+	int n = 0;
+	if (is_separator_token(element->token)) {
+		u_strcpy(token," ");
+		do {
+			element = next_element(element,transducer_id);
+			n++;
+		} while (element != NULL && is_separator_token(element->token));
+	} else if (is_letter(element->token[0],alphabet)) {
+		empty(token);
+		do {
+			u_strcat(token,element->token);
+			element = next_element(element,transducer_id);
+			n++;
+		} while (element != NULL && is_letter(element->token[0],alphabet));
+	} else {
+		if (protect_tags && is_original_tag(element)) {
+			unichar *braced_string = u_strdup(element->token+1);
+			braced_string[u_strlen(braced_string)-1] = '\0';
+			unichar *protected_braced_string = protect_braced_string(braced_string);
+			u_sprintf(token,"{%S}",protected_braced_string);
+			free(protected_braced_string);
+			free(braced_string);
+		} else {
+			u_strcpy(token,element->token);
+		}
+		element = next_element(element,transducer_id);
+		n++;
+	}
+	*current = element;
+	return n;
+}
+
+
+/**
+ * Computes in 'stage' the tokens of the text after the transducer 'transducer_id'.
+ * The token numbers are given by 'tokens', in which new tokens are added.
+ */
+static void build_stage_tokens(cassys_tokens_list *list, int transducer_id, int protect_tags,
+		const Alphabet *alphabet, struct string_hash *tokens, struct cassys_stage *stage, Ustring *token) {
+	stage->size = 0;
+	int index = 0;
+	cassys_tokens_list *current = get_output(list,transducer_id);
+	while (current != NULL) {
+		cassys_tokens_list *first = current;
+		int first_index = index;
+		index = index + read_stage_token(&current,transducer_id,protect_tags,alphabet,token);
+		add_stage_token(stage,get_value_index(token->str,tokens),first,first_index);
+	}
+	stage->first_index[stage->size] = index;
+}
+
+
+/**
+ * Computes in 'next' the tokens of the text after the transducer 'transducer_id',
+ * which has been applied to 'stage' with the given matches. Only the tokens
+ * of the matches and the ones next to them are read again from the token list,
+ * since an output may be joined to its neighbours, like letters added to a word.
+ * The other tokens are copied. If 'protect_tags' is non null, the tags of the
+ * original text were not protected in 'stage', so they are read again too.
+ * Returns 0 if the token list cannot be followed from the copied tokens,
+ * which may happen with overlapping matches; 'next' must then be built with
+ * build_stage_tokens.
+ */
+static int update_stage_tokens(const struct cassys_stage *stage, const struct match_list *matches,
+		int transducer_id, int protect_tags, const Alphabet *alphabet, struct string_hash *tokens,
+		struct cassys_stage *next, Ustring *token) {
+	next->size = 0;
+	next->first_index[0] = 0;
+	if (stage->size == 0) {
+		return 1;
+	}
+	char *changed = (char*)calloc(stage->size,sizeof(char));
+	if (changed == NULL) {
+		fatal_alloc_error("update_stage_tokens");
+	}
+	for (const struct match_list *m = matches; m != NULL; m = m->next) {
+		int start = m->m.start_pos_in_token-1;
+		int end = m->m.end_pos_in_token+1;
+		if (end <= m->m.start_pos_in_token) {
+			// an output inserted before the token
+			end = m->m.start_pos_in_token+1;
+		}
+		if (start < 0) start = 0;
+		if (end >= stage->size) end = stage->size-1;
+		for (int i = start; i <= end; i++) {
+			changed[i] = 1;
+		}
+	}
+	if (protect_tags) {
+		for (int i = 0; i < stage->size; i++) {
+			if (is_original_tag(stage->element[i])) {
+				changed[i] = 1;
+			}
+		}
+	}
+	int index = 0;
+	int i = 0;
+	while (i < stage->size) {
+		if (!changed[i]) {
+			add_stage_token(next,stage->code[i],stage->element[i],index);
+			index = index + stage->first_index[i+1] - stage->first_index[i];
+			i++;
+			continue;
+		}
+		int j = i;
+		while (j < stage->size && changed[j]) {
+			j++;
+		}
+		// the element of an unchanged token is the same after the transducer
+		cassys_tokens_list *current = get_output(stage->element[i],transducer_id);
+		cassys_tokens_list *stop = (j < stage->size) ? stage->element[j] : NULL;
+		while (current != NULL && current != stop) {
+			cassys_tokens_list *first = current;
+			int first_index = index;
+			index = index + read_stage_token(&current,transducer_id,1,alphabet,token);
+			add_stage_token(next,get_value_index(token->str,tokens),first,first_index);
+		}
+		if (current != stop) {
+			free(changed);
+			return 0;
+		}
+		i = j;
+	}
+	next->first_index[next->size] = index;
+	free(changed);
+	return 1;
+}
+
+
+static void save_stage_tokens(const char *tokens_txt, const struct string_hash *tokens,
+		Encoding encoding_output, int bom_output) {
+	U_FILE *f = u_fopen_creating_versatile_encoding(encoding_output,bom_output,tokens_txt,U_WRITE);
+	if (f == NULL) {
+		fatal_error("Cannot create file %s\n",tokens_txt);
+	}
+	char number[16];
+	sprintf(number,"%010d",tokens->size);
+	u_fprintf(f,"%s\n",number);
+	for (int i = 0; i < tokens->size; i++) {
+		u_fprintf(f,"%S\n",tokens->value[i]);
+	}
+	u_fclose(f);
+}
+
+
+static void save_stage_text_cod(const char *text_cod, const struct cassys_stage *stage) {
+	U_FILE *f = u_fopen(BINARY,text_cod,U_WRITE);
+	if (f == NULL) {
+		fatal_error("Cannot create file %s\n",text_cod);
+	}
+	if (stage->size != 0 && fwrite(stage->code,sizeof(int),stage->size,f) != (size_t)stage->size) {
+		fatal_error("Cannot write file %s\n",text_cod);
+	}
+	u_fclose(f);
+}
+
+
+/**
+ * Adds to the token list the outputs of the matches found by the transducer
+ * 'transducer_id', like add_replaced_text, but the positions of the matches
+ * are directly given by the tokens of the stage.
+ */
+static void apply_stage_matches(const struct match_list *matches, const char *concord_ind, int transducer_id,
+		const Alphabet *alphabet, const struct cassys_stage *stage) {
+	for (const struct match_list *m = matches; m != NULL; m = m->next) {
+		int start = m->m.start_pos_in_token;
+		int end = m->m.end_pos_in_token;
+		if (start < 0 || start >= stage->size || end >= stage->size) {
+			fatal_error("Invalid match %d-%d in %s\n",start,end,concord_ind);
+		}
+
+		const unichar *output = (m->output != NULL) ? m->output : U_EMPTY;
+		struct list_ustring *new_sentence_lu = cassys_tokenize_word_by_word(output,alphabet);
+		cassys_tokens_list *new_sentence_ctl = new_list(new_sentence_lu,transducer_id);
+
+		int replaced_sentence_length = 0;
+		if (end >= start) {
+			replaced_sentence_length = stage->first_index[end+1] - stage->first_index[start];
+		}
+		add_output(stage->element[start],new_sentence_ctl,transducer_id,
+				replaced_sentence_length,length(new_sentence_lu)-1);
+
+		free_list_ustring(new_sentence_lu);
+	}
+}
+
+
+/**
+ * Puts back in the token list the new lines of the original text, which are
+ * " " tokens in text.cod, so that the labeled texts keep them.
+ */
+static void restore_new_lines(cassys_tokens_list *list, const char *enter_pos) {
+	U_FILE *f = u_fopen(BINARY,enter_pos,U_READ);
+	if (f == NULL) {
+		return;
+	}
+	int position;
+	int current_position = 0;
+	cassys_tokens_list *current = list;
+	while (fread(&position,sizeof(int),1,f) == 1) {
+		while (current != NULL && current_position < position) {
+			current = current->next_token;
+			current_position++;
+		}
+		if (current == NULL) {
+			break;
+		}
+		free(current->token);
+		current->token = u_strdup("\n");
+	}
+	u_fclose(f);
+}
+
+
+static void save_labeled_text(const char *labeled_text_name, cassys_tokens_list *list, int transducer_id,
+		Encoding encoding_output, int bom_output, int mask_encoding_compatibility_input) {
+	U_FILE *f = u_fopen_versatile_encoding(encoding_output,bom_output,mask_encoding_compatibility_input,labeled_text_name,U_WRITE);
+	if (f == NULL) {
+		fatal_error("Cannot create file %s\n",labeled_text_name);
+	}
+	for (cassys_tokens_list *current = get_output(list,transducer_id); current != NULL;
+			current = next_element(current,transducer_id)) {
+		u_fprintf(f,"%S",current->token);
+	}
+	u_fclose(f);
+}
+
+
+static void copy_stage_file(const char *dest, const char *src) {
+	if (fexists(src)) {
+		copy_file(dest,src);
+	} else if (fexists(dest)) {
+		af_remove(dest);
+	}
+}
+
+
+/**
+ * The cascade without intermediate texts. The text is tokenized once, and the
+ * outputs of the matches are directly added to the token list, so that only
+ * they are tokenized. The tokens and the text.cod of each stage are given to
+ * Locate from memory through the pipeline, and its matches are taken back
+ * from memory (see load_concord_ind) and freed in the pipeline as soon as
+ * they are applied, so that it keeps nothing from one stage to the next.
+ * After each transducer, the tokens of the stage are only read again around
+ * its matches. Locate still writes its concord.ind in a snt directory, kept
+ * in the RAM file space if it is available, and the labeled texts are only
+ * written if 'labeled_files' is non null.
+ */
+int cascade_in_memory(const char* text, int must_create_directory, int labeled_files, fifo* transducer_list,
+    const char *alphabet_name, const char*negation_operator,
+    Encoding encoding_output,int bom_output,int mask_encoding_compatibility_input) {
+
+	BeginPipeline();
+	launch_tokenize_in_Cassys(text,alphabet_name,NULL,encoding_output,bom_output,mask_encoding_compatibility_input);
+
+	Alphabet *alphabet = load_alphabet(alphabet_name);
+	if (alphabet == NULL) {
+		fatal_error("Cannot load alphabet file %s\n",alphabet_name);
+	}
+
+	struct snt_files *snt_text_files = new_snt_files(text);
+	struct text_tokens *tokens = NULL;
+	cassys_tokens_list *tokens_list = cassys_load_text(snt_text_files->tokens_txt, snt_text_files->text_cod,&tokens);
+	if (labeled_files) {
+		restore_new_lines(tokens_list,snt_text_files->enter_pos);
+	}
+
+	// the tokens of the text keep their numbers, the new ones are added after them
+	struct string_hash *stage_tokens = new_string_hash();
+	for (int i = 0; i < tokens->N; i++) {
+		get_value_index(tokens->token[i],stage_tokens);
+	}
+
+	char path[FILENAME_MAX];
+	get_path(text,path);
+	char canonical_name[FILENAME_MAX];
+	remove_path_and_extension(text,canonical_name);
+	char extension[FILENAME_MAX];
+	get_extension(text,extension);
+	char working_directory[FILENAME_MAX];
+	if (snprintf(working_directory,FILENAME_MAX,"%s%s%s%c",path,canonical_name,CASSYS_DIRECTORY_EXTENSION,PATH_SEPARATOR_CHAR) >= FILENAME_MAX) {
+		fatal_error("File name too long for the working directory of %s\n",text);
+	}
+
+	int in_ram = IsVirtualFileSpaceInstalled();
+	if (must_create_directory != 0 && (labeled_files || !in_ram)) {
+		make_directory(working_directory);
+	}
+
+	// the stage text itself is never written, Locate only needs its snt directory
+	char stage_text[FILENAME_MAX];
+	if (snprintf(stage_text,FILENAME_MAX,"%s%s%s%s",in_ram ? VIRTUAL_FILE_SPACE_PREFIX : "",working_directory,canonical_name,extension) >= FILENAME_MAX) {
+		fatal_error("File name too long for the stage text of %s\n",text);
+	}
+	struct snt_files *stage_files = new_snt_files(stage_text);
+	if (must_create_directory != 0 && !in_ram) {
+		make_directory(stage_files->path);
+	}
+	copy_stage_file(stage_files->dlf,snt_text_files->dlf);
+	copy_stage_file(stage_files->dlc,snt_text_files->dlc);
+	copy_stage_file(stage_files->err,snt_text_files->err);
+
+	// Locate takes the tokens and the text.cod of the stage from memory
+	struct text_tokens stage_text_tokens;
+	struct pipeline_mapped_file stage_text_cod;
+	stage_text_cod.amf = NULL;
+	int from_memory = provide_pipeline_resource(stage_files->tokens_txt,PIPELINE_TEXT_TOKENS,&stage_text_tokens)
+			&& provide_pipeline_resource(stage_files->text_cod,PIPELINE_MAPPED_FILE,&stage_text_cod);
+	unichar sentence_marker[4];
+	unichar stop_marker[7];
+	unichar space[2];
+	u_strcpy(sentence_marker,"{S}");
+	u_strcpy(stop_marker,"{STOP}");
+	u_strcpy(space," ");
+
+	fprintf(stdout,"Cascade begins\n");
+
+	struct cassys_stage *stage = new_cassys_stage();
+	struct cassys_stage *next_stage = new_cassys_stage();
+	Ustring *token = new_Ustring();
+	int saved_tokens = -1;
+	int transducer_number = 1;
+
+	// the first stage sees the text as it is, the next ones see it protected
+	build_stage_tokens(tokens_list,0,0,alphabet,stage_tokens,stage,token);
+
+	while(!is_empty(transducer_list)){
+		transducer *current_transducer = (transducer*)take_ptr(transducer_list);
+
+		if (from_memory) {
+			// the token array of the hash and the stage arrays may have been reallocated
+			stage_text_tokens.token = stage_tokens->value;
+			stage_text_tokens.N = stage_tokens->size;
+			stage_text_tokens.SENTENCE_MARKER = get_value_index(sentence_marker,stage_tokens,DONT_INSERT);
+			stage_text_tokens.STOP_MARKER = get_value_index(stop_marker,stage_tokens,DONT_INSERT);
+			stage_text_tokens.SPACE = get_value_index(space,stage_tokens,DONT_INSERT);
+			stage_text_cod.buffer = stage->code;
+			stage_text_cod.size = stage->size*sizeof(int);
+		} else {
+			if (stage_tokens->size != saved_tokens) {
+				save_stage_tokens(stage_files->tokens_txt,stage_tokens,encoding_output,bom_output);
+				saved_tokens = stage_tokens->size;
+			}
+			save_stage_text_cod(stage_files->text_cod,stage);
+		}
+
+		launch_locate_in_Cassys(stage_text, current_transducer, alphabet_name, negation_operator,encoding_output,bom_output,mask_encoding_compatibility_input);
+		struct match_list *matches = NULL;
+		if (!load_concord_ind(stage_files->concord_ind,mask_encoding_compatibility_input,&matches,NULL)) {
+			fatal_error("Cannot open file %s\n",stage_files->concord_ind);
+		}
+		apply_stage_matches(matches,stage_files->concord_ind,transducer_number,alphabet,stage);
+		// the matches Locate kept for this stage have been copied and applied
+		drop_pipeline_file(stage_files->concord_ind);
+
+		if (labeled_files) {
+			char labeled_text_name[FILENAME_MAX];
+			if (snprintf(labeled_text_name,FILENAME_MAX,"%s%s_%d%s",working_directory,canonical_name,transducer_number,extension) >= FILENAME_MAX) {
+				fatal_error("File name too long for the labeled text %d of %s\n",transducer_number,text);
+			}
+			save_labeled_text(labeled_text_name,tokens_list,transducer_number,encoding_output,bom_output,mask_encoding_compatibility_input);
+			struct snt_files *labeled_snt_files = new_snt_files(labeled_text_name);
+			if (must_create_directory != 0) {
+				make_directory(labeled_snt_files->path);
+			}
+			copy_file(labeled_snt_files->concord_ind,stage_files->concord_ind);
+			free_snt_files(labeled_snt_files);
+		}
+
+		if (!is_empty(transducer_list)) {
+			if (!update_stage_tokens(stage,matches,transducer_number,transducer_number == 1,alphabet,stage_tokens,next_stage,token)) {
+				build_stage_tokens(tokens_list,transducer_number,1,alphabet,stage_tokens,next_stage,token);
+			}
+			struct cassys_stage *previous_stage = stage;
+			stage = next_stage;
+			next_stage = previous_stage;
+		}
+		free_match_list(matches);
+
+		transducer_number++;
+
+		free(current_transducer -> transducer_file_name);
+		free(current_transducer);
+	}
+
+	withdraw_pipeline_resource(&stage_text_tokens);
+	withdraw_pipeline_resource(&stage_text_cod);
+	free_Ustring(token);
+	free_cassys_stage(stage);
+	free_cassys_stage(next_stage);
+	free_string_hash(stage_tokens);
+	if (in_ram) {
+		PurgeVirtualFiles(stage_files->path);
+	}
+	free_snt_files(stage_files);
+	free_snt_files(snt_text_files);
+	free_alphabet(alphabet);
+
+	construct_cascade_concord(tokens_list,text,transducer_number,encoding_output,bom_output,mask_encoding_compatibility_input);
+
+	struct snt_files *snt_files = new_snt_files(text);
+
+	char result_file_name[FILENAME_MAX];
+	char text_name_without_extension[FILENAME_MAX];
+	remove_extension(text,text_name_without_extension);
+	if (snprintf(result_file_name,FILENAME_MAX,"%s.csc",text_name_without_extension) >= FILENAME_MAX) {
+		fatal_error("File name too long for the result of %s\n",text);
+	}
+
+	copy_file(result_file_name,text);
+	launch_concord_in_Cassys(result_file_name,snt_files->concord_ind,alphabet_name,encoding_output,bom_output,mask_encoding_compatibility_input);
+
+	free_cassys_tokens_list(tokens_list);
+	free_snt_files(snt_files);
+	free_text_tokens(tokens);
+	EndPipeline();
+	return 0;
+}
+
+
 cassys_tokens_list *cassys_load_text(const char *tokens_text_name, const char *text_cod_name, struct text_tokens **tokens){
 
 	int mask_encoding_compatibility_input = DEFAULT_MASK_ENCODING_COMPATIBILITY_INPUT;
@@ -1022,7 +1566,7 @@ char *cassys_fgets(char *line, int n, U_FILE *u) {
 
 
 
-int make_directory(char *path){
+int make_directory(const char *path){
 	return mkDirPortable(path);
 }
 
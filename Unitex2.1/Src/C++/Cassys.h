@@ -149,6 +149,16 @@ struct fifo *load_transducer(const char *file_list_transducer_name);
  */
 int cascade(const char* text, int in_place, int must_create_directory, fifo* transducer_list, const char*negation_operator,const char *alphabet,Encoding encoding_output,int bom_output,int mask_encoding_compatibility_input);
 
+/**
+ * \brief function which makes the cascade without writing the intermediate texts
+ *
+ * The text is tokenized once and the outputs of each transducer are added to the
+ * token list. The labeled texts are only written if labeled_files is non null.
+ *
+ * return 0 if correct
+ */
+int cascade_in_memory(const char* text, int must_create_directory, int labeled_files, fifo* transducer_list, const char *alphabet,const char*negation_operator,Encoding encoding_output,int bom_output,int mask_encoding_compatibility_input);
+
 
 /**
  * \brief Calls the 'locate' program
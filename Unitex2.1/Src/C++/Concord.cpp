@@ -38,6 +38,7 @@
 #include "ProgramInvoker.h"
 #include "Concord.h"
 #include "Concord.h"
+#include "logger/SyncLogger.h"
 
 
 
@@ -80,6 +81,7 @@ const char* usage_Concord =
         "  -d DIR/--directory=DIR: does not work in the same directory than <concord> but in DIR\n"
         "  -a ALPH/--alphabet=ALPH : the char order file used for sorting\n"
         "  -T/--thai: option to use for Thai concordances\n"
+        "  --threads=N: sorts the concordance on N threads (default=1, 0=one per processor)\n"
         "  -h/--help: this help\n"
         "\n"
         "Extracts the matches stored in <concord>, and stores them into a UTF-8\n"
@@ -187,6 +189,7 @@ const struct option_TS lopts_Concord[]= {
       {"help",no_argument_TS,NULL,'h'},
       {"input_encoding",required_argument_TS,NULL,'k'},
       {"output_encoding",required_argument_TS,NULL,'q'},
+      {"threads",required_argument_TS,NULL,7},
       {NULL,no_argument_TS,NULL,0}
 };
 
@@ -247,6 +250,10 @@ while (EOF!=(val=getopt_long_TS(argc,argv,optstring_Concord,lopts_Concord,&index
    case 4: options->sort_mode=CENTER_RIGHT; break;
    case 5: options->sort_mode=RIGHT_LEFT; break;
    case 6: options->sort_mode=RIGHT_CENTER; break;
+   case 7: if (1!=sscanf(vars->optarg,"%d%c",&(options->n_threads),&foo) || options->n_threads<0) {
+                fatal_error("Invalid number of threads: %s\n",vars->optarg);
+             }
+             break;
    case 'H': options->result_mode=HTML_; break;
    case 't': options->result_mode=TEXT_; break;
    case 'g': options->result_mode=GLOSSANET_;
@@ -322,8 +329,16 @@ if (options->fontname==NULL || options->fontsize<=0) {
       fatal_error("The specified output mode is an HTML file: you must specify font parameters\n");
    }
 }
-U_FILE* concor=u_fopen_existing_versatile_encoding(mask_encoding_compatibility_input,argv[vars->optind],U_READ);
-if (concor==NULL) {
+if (options->n_threads<=0) {
+   options->n_threads=(int)SyncGetNumberOfProcessors();
+}
+if (options->n_threads>1 && !IsSeveralThreadsPossible()) {
+   options->n_threads=1;
+}
+u_printf("Loading concordance index...\n");
+/* In a pipeline, the matches that Locate has just saved are taken from memory */
+struct match_list* matches;
+if (!load_concord_ind(argv[vars->optind],mask_encoding_compatibility_input,&matches,NULL)) {
    error("Cannot open concordance index file %s\n",argv[vars->optind]);
    return 1;
 }
@@ -333,18 +348,18 @@ if (options->working_directory[0]=='\0') {
 }
 /* We compute the name of the files associated to the text */
 struct snt_files* snt_files=new_snt_files_from_path(options->working_directory);
-ABSTRACTMAPFILE* text=af_open_mapfile(snt_files->text_cod,MAPFILE_OPTION_READ,0);
+struct pipeline_mapped_file* text=map_pipeline_file(snt_files->text_cod);
 if (text==NULL) {
 	error("Cannot open file %s\n",snt_files->text_cod);
-	u_fclose(concor);
+	free_match_list(matches);
 	free_snt_files(snt_files);
 	return 1;
 }
 struct text_tokens* tok=load_text_tokens(snt_files->tokens_txt,mask_encoding_compatibility_input);
 if (tok==NULL) {
 	error("Cannot load text token file %s\n",snt_files->tokens_txt);
-	u_fclose(concor);
-	af_close_mapfile(text);
+	free_match_list(matches);
+	unmap_pipeline_file(text);
 	free_snt_files(snt_files);
 	return 1;
 }
@@ -377,12 +392,15 @@ if (options->result_mode==INDEX_ || options->result_mode==UIMA_ ||
    options->sort_mode=TEXT_ORDER;
 }
 
+/* If Tokenize has built the text.ofs index, we use it */
+struct text_offsets* offsets=load_text_offsets(snt_files->text_ofs,(int)(text->size/sizeof(int)),
+                                               tok->SENTENCE_MARKER);
 /* Once we have setted all the parameters, we call the function that
  * will actually create the concordance. */
-create_concordance(encoding_output,bom_output,concor,text,tok,n_enter_char,enter_pos,options);
+create_concordance(encoding_output,bom_output,matches,text,offsets,tok,n_enter_char,enter_pos,options);
+free_text_offsets(offsets);
 free(enter_pos);
-u_fclose(concor);
-af_close_mapfile(text);
+unmap_pipeline_file(text);
 free_snt_files(snt_files);
 free_text_tokens(tok);
 free_conc_opt(options);
@@ -27,18 +27,37 @@
 #include "StringParsing.h"
 #include "Thai.h"
 #include "NewLineShifts.h"
+#include "AbstractCallbackFuncModifier.h"
 
-int create_raw_text_concordance(U_FILE*,U_FILE*,ABSTRACTMAPFILE*,struct text_tokens*,int,int,
+
+/* Over this size in bytes, the raw concordance is not kept in memory anymore,
+ * but saved to a temporary file that is sorted by SortTxt */
+#define MAX_RAW_CONCORDANCE_MEMORY (256*1024*1024)
+
+/**
+ * This structure holds the lines of the raw concordance, before they are sorted
+ * and turned into the final concordance. 'temp_file' is not NULL when there
+ * were too many lines to keep them in memory.
+ */
+struct raw_concordance {
+   unichar** lines;
+   int n_lines;
+   int capacity;
+   size_t size;
+   const char* temp_file_name;
+   U_FILE* temp_file;
+};
+
+int create_raw_text_concordance(U_FILE*,struct raw_concordance*,struct match_list*,const struct pipeline_mapped_file*,struct text_offsets*,struct text_tokens*,int,int,
                                 int*,int*,int,int,struct conc_opt*);
 void compute_token_length(int*,struct text_tokens*);
 
-void create_modified_text_file(Encoding,int,U_FILE*,ABSTRACTMAPFILE*,struct text_tokens*,char*,int,int*);
+void create_modified_text_file(Encoding,int,struct match_list*,const struct pipeline_mapped_file*,struct text_tokens*,char*,int,int*);
 void write_HTML_header(U_FILE*,int,struct conc_opt*);
 void write_HTML_end(U_FILE*);
 void reverse_initial_vowels_thai(unichar*);
 
 struct buffer_mapped {
-    ABSTRACTMAPFILE* amf;
     const int*int_buffer_;
     size_t nb_item;
     size_t pos_next_read;
@@ -62,11 +81,103 @@ static size_t buf_map_int_pseudo_read(struct buffer_mapped* buffer,size_t size_r
     return size_requested;
 }
 
+static struct raw_concordance* new_raw_concordance(const char* temp_file_name) {
+struct raw_concordance* raw=(struct raw_concordance*)malloc(sizeof(struct raw_concordance));
+if (raw==NULL) {
+   fatal_alloc_error("new_raw_concordance");
+}
+raw->capacity=1024;
+raw->lines=(unichar**)malloc(raw->capacity*sizeof(unichar*));
+if (raw->lines==NULL) {
+   fatal_alloc_error("new_raw_concordance");
+}
+raw->n_lines=0;
+raw->size=0;
+raw->temp_file_name=temp_file_name;
+raw->temp_file=NULL;
+return raw;
+}
+
+
+static void free_raw_concordance(struct raw_concordance* raw) {
+for (int i=0;i<raw->n_lines;i++) {
+   free(raw->lines[i]);
+}
+free(raw->lines);
+if (raw->temp_file!=NULL) {
+   u_fclose(raw->temp_file);
+}
+free(raw);
+}
+
+
+/**
+ * Adds a line to the raw concordance. If the memory limit is reached, all the lines
+ * are moved to the temporary file, and the next ones will be written to it.
+ */
+static void add_raw_concordance_line(struct raw_concordance* raw,const unichar* line) {
+if (raw->temp_file!=NULL) {
+   u_fprintf(raw->temp_file,"%S\n",line);
+   return;
+}
+if (raw->n_lines==raw->capacity) {
+   raw->capacity=raw->capacity*2;
+   raw->lines=(unichar**)realloc(raw->lines,raw->capacity*sizeof(unichar*));
+   if (raw->lines==NULL) {
+      fatal_alloc_error("add_raw_concordance_line");
+   }
+}
+raw->lines[raw->n_lines]=u_strdup(line);
+raw->size=raw->size+sizeof(unichar*)+(u_strlen(line)+1)*sizeof(unichar);
+raw->n_lines++;
+if (raw->size>MAX_RAW_CONCORDANCE_MEMORY) {
+   raw->temp_file=u_fopen(UTF16_LE,raw->temp_file_name,U_WRITE);
+   if (raw->temp_file==NULL) {
+      fatal_error("Cannot write %s\n",raw->temp_file_name);
+   }
+   for (int i=0;i<raw->n_lines;i++) {
+      u_fprintf(raw->temp_file,"%S\n",raw->lines[i]);
+      free(raw->lines[i]);
+   }
+   raw->n_lines=0;
+   raw->size=0;
+}
+}
+
+
+/**
+ * Returns the next line of the raw concordance, or NULL if there is no more.
+ * If the lines are in a file, they are read into '*buffer', that is enlarged
+ * when a line does not fit in its '*size' characters.
+ */
+static const unichar* next_raw_concordance_line(struct raw_concordance* raw,U_FILE* f,int* current,
+                                                unichar** buffer,int* size) {
+if (f==NULL) {
+   if (*current==raw->n_lines) return NULL;
+   return raw->lines[(*current)++];
+}
+int c;
+int i=0;
+while ((c=u_fgetc(f))!=EOF && c!='\n') {
+   if (i==(*size)-1) {
+      (*size)=(*size)*2;
+      (*buffer)=(unichar*)realloc(*buffer,sizeof(unichar)*(*size));
+      if ((*buffer)==NULL) {
+         fatal_alloc_error("next_raw_concordance_line");
+      }
+   }
+   (*buffer)[i++]=(unichar)c;
+}
+if (c==EOF && i==0) return NULL;
+(*buffer)[i]='\0';
+return *buffer;
+}
+
+
 /**
- * This function builds a concordance from a 'concord.ind' file
- * described by the 'concordance' parameter. 'text' is supposed to
- * represent the 'text.cod' file from which the concordance index was
- * computed. 'tokens' represents the associated 'tokens.txt'
+ * This function builds a concordance from the matches of a 'concord.ind'
+ * file, which are freed. 'text' is supposed to represent the mapped
+ * 'text.cod' file from which the concordance index was computed. 'tokens' represents the associated 'tokens.txt'
  * file. 'option.sort_mode' is an integer that represents the sort mode to be
  * used for creating the concordance. This parameter will be ignored
  * if the function must modify the text instead of building a
@@ -91,7 +202,8 @@ static size_t buf_map_int_pseudo_read(struct buffer_mapped* buffer,size_t size_r
  * 'enter_pos' is an array that contains the positions of these new
  * lines. If 'option.thai_mode' is set to a non zero value, it indicates that
  * the concordance is a Thai one. This information is used to compute
- * correctly the context sizes.
+ * correctly the context sizes. 'offsets' is the text.ofs index of the text, or
+ * NULL if there is none.
  *
  *
  * Modifications made by Patrick Watrin (pwatrin@gmail.com) allow to
@@ -112,7 +224,8 @@ static size_t buf_map_int_pseudo_read(struct buffer_mapped* buffer,size_t size_r
  * This segment
  * 2.5  9
  */
-void create_concordance(Encoding encoding_output,int bom_output,U_FILE* concordance,ABSTRACTMAPFILE* text,struct text_tokens* tokens,
+void create_concordance(Encoding encoding_output,int bom_output,struct match_list* matches,const struct pipeline_mapped_file* text,
+                        struct text_offsets* offsets,struct text_tokens* tokens,
                         int n_enter_char,int* enter_pos,struct conc_opt* option) {
 U_FILE* out;
 U_FILE* f;
@@ -129,7 +242,7 @@ compute_token_length(token_length,tokens);
 if (option->result_mode==MERGE_) {
 	/* If we have to produced a modified version of the original text, we
 	 * do it and return. */
-	create_modified_text_file(encoding_output,bom_output,concordance,text,tokens,option->output,n_enter_char,enter_pos);
+	create_modified_text_file(encoding_output,bom_output,matches,text,tokens,option->output,n_enter_char,enter_pos);
 	free(token_length);
 	return;
 }
@@ -162,42 +275,62 @@ else
 int N_MATCHES;
 
 /* If we are in the 'xalign' mode, we don't need to sort the results.
- * So, we don't need to store the results in a temporary file */
-if (option->result_mode==XALIGN_) f=u_fopen(UTF8,option->output,U_WRITE);
-else f=u_fopen(UTF16_LE,temp_file_name,U_WRITE);
-if (f==NULL) {
-	error("Cannot write %s\n",temp_file_name);
-	free(token_length);
-	return;
+ * So, we directly write them to the output */
+if (option->result_mode==XALIGN_) {
+   f=u_fopen(UTF8,option->output,U_WRITE);
+   if (f==NULL) {
+      error("Cannot write %s\n",option->output);
+      free_match_list(matches);
+      free(token_length);
+      return;
+   }
+   create_raw_text_concordance(f,NULL,matches,text,offsets,tokens,
+                               option->result_mode,n_enter_char,enter_pos,
+                               token_length,open_bracket,close_bracket,
+                               option);
+   u_fclose(f);
+   free(token_length);
+   return;
 }
-/* First, we create a raw text concordance.
+/* First, we create a raw text concordance. It is kept in memory, unless it
+ * is too big, in which case it is saved in the temporary file.
  * NOTE: columns may have been reordered according to the sort mode. See the
  * comments of the 'create_raw_text_concordance' function for more details. */
-N_MATCHES=create_raw_text_concordance(f,concordance,text,tokens,
+struct raw_concordance* raw=new_raw_concordance(temp_file_name);
+N_MATCHES=create_raw_text_concordance(NULL,raw,matches,text,offsets,tokens,
                                       option->result_mode,n_enter_char,enter_pos,
                                       token_length,open_bracket,close_bracket,
                                       option);
-u_fclose(f);
 free(token_length);
 
-if(option->result_mode==XALIGN_) return;
-
-/* If necessary, we sort it by invoking the main function of the SortTxt program */
-if (option->sort_mode!=TEXT_ORDER) {
-   // we dont use pseudo_main_SortTxt(encoding_output,bom_output,mask_encoding_compatibility_input,0,0,option->sort_alphabet,NULL,option->thai_mode,temp_file_name);
-   // because we work only on temp_file_name which is only internal temp file, so UTF16_LE
-   pseudo_main_SortTxt(UTF16_LE,1,ALL_ENCODING_BOM_POSSIBLE,0,0,option->sort_alphabet,NULL,option->thai_mode,temp_file_name);
+f=NULL;
+if (raw->temp_file==NULL) {
+   /* If necessary, we sort the lines in memory, the same way SortTxt would */
+   if (option->sort_mode!=TEXT_ORDER) {
+      raw->n_lines=sort_lines_in_memory(raw->lines,raw->n_lines,1,0,option->sort_alphabet,
+                                        ALL_ENCODING_BOM_POSSIBLE,option->thai_mode,
+                                        (unsigned int)option->n_threads);
+   }
+} else {
+   u_fclose(raw->temp_file);
+   raw->temp_file=NULL;
+   /* If necessary, we sort it by invoking the main function of the SortTxt program */
+   if (option->sort_mode!=TEXT_ORDER) {
+      // we dont use pseudo_main_SortTxt(encoding_output,bom_output,mask_encoding_compatibility_input,0,0,option->sort_alphabet,NULL,option->thai_mode,temp_file_name);
+      // because we work only on temp_file_name which is only internal temp file, so UTF16_LE
+      pseudo_main_SortTxt(UTF16_LE,1,ALL_ENCODING_BOM_POSSIBLE,0,0,option->sort_alphabet,NULL,option->thai_mode,temp_file_name);
+   }
+   f=u_fopen(UTF16_LE,temp_file_name,U_READ);
+   if (f==NULL) {
+      error("Cannot read %s\n",temp_file_name);
+      free_raw_concordance(raw);
+      return;
+   }
 }
 /* Now, we will take the sorted raw text concordance and we will:
  * 1) reorder the columns
  * 2) insert HTML info if needed
  */
-
-f=u_fopen(UTF16_LE,temp_file_name,U_READ);
-if (f==NULL) {
-	error("Cannot read %s\n",temp_file_name);
-	return;
-}
 if (option->result_mode==TEXT_ || option->result_mode==INDEX_
       || option->result_mode==XML_ || option->result_mode==XML_WITH_HEADER_
       || option->result_mode==UIMA_ || option->result_mode==AXIS_) {
@@ -211,7 +344,8 @@ else {
 }
 if (out==NULL) {
 	error("Cannot write %s\n",option->output);
-	u_fclose(f);
+	if (f!=NULL) u_fclose(f);
+	free_raw_concordance(raw);
 	return;
 }
 /* If we have an HTML or a GlossaNet/script concordance, we must write an HTML
@@ -233,65 +367,91 @@ if ((option->result_mode==XML_WITH_HEADER_)) {
 if ((option->result_mode==XML_)) {
   u_fprintf(out,"<concord>\n");
 }
-unichar* unichar_buffer=(unichar*)malloc(sizeof(unichar)*((3000*4) + 100));
+/* The columns of a line are copied in 5 buffers of 'column_size' characters,
+ * that are enlarged if a line is longer */
+int column_size=3000;
+unichar* unichar_buffer=(unichar*)malloc(sizeof(unichar)*(column_size*5));
 if (unichar_buffer==NULL) {
 	fatal_alloc_error("create_concordance");
 }
-unichar* A = unichar_buffer + (3000 * 0);
-unichar* B = unichar_buffer + (3000 * 1);
-unichar* C = unichar_buffer + (3000 * 2);
-unichar* href = unichar_buffer + (3000 * 3);
-unichar* indices = unichar_buffer + (3000 * 4);
+unichar* A = unichar_buffer + (column_size * 0);
+unichar* B = unichar_buffer + (column_size * 1);
+unichar* C = unichar_buffer + (column_size * 2);
+unichar* href = unichar_buffer + (column_size * 3);
+unichar* indices = unichar_buffer + (column_size * 4);
 unichar* left=NULL;
 unichar* middle=NULL;
 unichar* right=NULL;
+/* Buffer used to read the lines when they are in the temporary file. It is
+ * enlarged if a line is longer */
+int line_buffer_size=(MAX_CONTEXT_IN_UNITS+1)*8+400;
+unichar* line_buffer=NULL;
+if (f!=NULL) {
+   line_buffer=(unichar*)malloc(sizeof(unichar)*line_buffer_size);
+   if (line_buffer==NULL) {
+      fatal_alloc_error("create_concordance");
+   }
+}
+int current_line=0;
+const unichar* line;
+const unichar* p;
 int j;
-int c;
 /* Now we process each line of the sorted raw text concordance */
-while ((c=u_fgetc(f))!=EOF) {
+while ((line=next_raw_concordance_line(raw,f,&current_line,&line_buffer,&line_buffer_size))!=NULL) {
+	int line_length=u_strlen(line);
+	if (line_length>=column_size) {
+		column_size=line_length+1;
+		unichar_buffer=(unichar*)realloc(unichar_buffer,sizeof(unichar)*(column_size*5));
+		if (unichar_buffer==NULL) {
+			fatal_alloc_error("create_concordance");
+		}
+		A = unichar_buffer + (column_size * 0);
+		B = unichar_buffer + (column_size * 1);
+		C = unichar_buffer + (column_size * 2);
+		href = unichar_buffer + (column_size * 3);
+		indices = unichar_buffer + (column_size * 4);
+	}
+	p=line;
 	j=0;
 	/* We save the first column in A... */
-	while (c!=0x09) {
-		A[j++]=(unichar)c;
-		c=u_fgetc(f);
+	while (*p!='\t' && *p!='\0') {
+		A[j++]=*(p++);
 	}
 	A[j]='\0';
-	c=u_fgetc(f);
+	if (*p=='\t') p++;
 	j=0;
 	/* ...the second in B... */
-	while (c!=0x09) {
-		B[j++]=(unichar)c;
-		c=u_fgetc(f);
+	while (*p!='\t' && *p!='\0') {
+		B[j++]=*(p++);
 	}
 	B[j]='\0';
-	c=u_fgetc(f);
+	if (*p=='\t') p++;
 	j=0;
 	/* ...and the third in C */
-	while (c!='\n' && c!='\t') {
-		C[j++]=(unichar)c;
-		c=u_fgetc(f);
+	while (*p!='\t' && *p!='\0') {
+		C[j++]=*(p++);
 	}
 	C[j]='\0';
 	indices[0]='\0';
 	/* If there are indices to be read like "15 17 1", we read them */
-	if (c=='\t') {
-		c=u_fgetc(f);
+	if (*p=='\t') {
+		p++;
 		j=0;
-		while (c!='\t' && c!='\n') {
-			indices[j++]=(unichar)c;
-			c=u_fgetc(f);
+		while (*p!='\t' && *p!='\0') {
+			indices[j++]=*(p++);
 		}
 		indices[j]='\0';
 		/*------------begin GlossaNet-------------------*/
 		/* If we are in GlossaNet mode, we extract the url at the end of the line */
 		if (option->result_mode==GLOSSANET_) {
-			if (c!='\t') {
+			if (*p!='\t') {
 				error("ERROR in GlossaNet concordance: no URL found\n");
 				href[0]='\0';
 			} else {
+				p++;
 				j=0;
-				while ((c=u_fgetc(f))!='\n') {
-					href[j++]=(unichar)c;
+				while (*p!='\0') {
+					href[j++]=*(p++);
 				}
 				href[j]='\0';
 			}
@@ -312,15 +472,20 @@ while ((c=u_fgetc(f))!=EOF) {
 	 * printed, because in GlossaNet mode, duplicates must be removed. */
 	int can_print_line=1;
 	if (option->result_mode==GLOSSANET_) {
-		unichar line[4000];
-      u_sprintf(line,"%S\t%S\t%S",left,middle,right);
+		/* The 3 columns are not longer than the raw line */
+		unichar* glossa_line=(unichar*)malloc(sizeof(unichar)*(line_length+1));
+		if (glossa_line==NULL) {
+			fatal_alloc_error("create_concordance");
+		}
+      u_sprintf(glossa_line,"%S\t%S\t%S",left,middle,right);
 		/* We test if the line was already seen */
-		if (NO_VALUE_INDEX==get_value_index(line,glossa_hash,DONT_INSERT)) {
+		if (NO_VALUE_INDEX==get_value_index(glossa_line,glossa_hash,DONT_INSERT)) {
 			can_print_line=1;
-			get_value_index(line,glossa_hash);
+			get_value_index(glossa_line,glossa_hash);
 		} else {
 			can_print_line=0;
 		}
+		free(glossa_line);
 	}
 	/* If we can print the line */
 	if (can_print_line) {
@@ -412,10 +577,14 @@ if ((option->result_mode==HTML_) || (option->result_mode==GLOSSANET_)) write_HTM
 if ((option->result_mode==XML_) || (option->result_mode==XML_WITH_HEADER_)){
   u_fprintf(out,"</concord>\n");
 }
-u_fclose(f);
-af_remove(temp_file_name);
+if (f!=NULL) {
+   u_fclose(f);
+   af_remove(temp_file_name);
+   free(line_buffer);
+}
 u_fclose(out);
 free(unichar_buffer);
+free_raw_concordance(raw);
 if (option->result_mode==GLOSSANET_) {
 	free_string_hash(glossa_hash);
 }
@@ -770,7 +939,8 @@ while (s[i]!='\0') {
  * DEF^CBA^GHI^120 124 5
  *
  *
- * 'text' is the "text.cod" file. 'tokens' contains the text tokens.
+ * 'text' is the "text.cod" file. If 'offsets' is not NULL, it is used to get
+ * the position of each match without scanning the text. 'tokens' contains the text tokens.
  * 'option.left_context' and 'option.right_context' specify the lengthes of the
  * contexts to extract. 'expected_result' is used to know if the output is
  * a GlossaNet concordance. 'n_enter_char' is the number of new lines in the text,
@@ -778,6 +948,9 @@ while (s[i]!='\0') {
  * If 'option.thai_mode' is set to a non zero value, it indicates that the concordance
  * is a Thai one. This information is used to compute correctly the context sizes.
  *
+ * The lines are stored in 'raw', except in xalign mode where they are directly
+ * written to 'output'.
+ *
  * The function returns the number of matches actually written to the output file.
  *
  * For the xalign mode we produce a concord file with the following information :
@@ -786,14 +959,15 @@ while (s[i]!='\0') {
  *    - Column 2: shift in chars from the beginning of the sentence to the left side of the match
  *    - Column 3: shift in chars from the beginning of the sentence to the right side of the match
  */
-int create_raw_text_concordance(U_FILE* output,U_FILE* concordance,ABSTRACTMAPFILE* text,struct text_tokens* tokens,
+int create_raw_text_concordance(U_FILE* output,struct raw_concordance* raw,struct match_list* matches,
+                                const struct pipeline_mapped_file* text,
+                                struct text_offsets* offsets,struct text_tokens* tokens,
                                 int expected_result,
                                 int n_enter_char,int* enter_pos,
                                 int* token_length,int open_bracket,int close_bracket,
                                 struct conc_opt* option) {
-struct match_list* matches;
 struct match_list* matches_tmp;
-unichar* unichar_buffer=(unichar*)malloc(sizeof(unichar)*(MAX_CONTEXT_IN_UNITS+1)*4);
+unichar* unichar_buffer=(unichar*)malloc(sizeof(unichar)*((MAX_CONTEXT_IN_UNITS+1)*8+400));
 if (unichar_buffer==NULL) {
 	fatal_alloc_error("create_raw_text_concordance");
 }
@@ -801,6 +975,9 @@ unichar* left = unichar_buffer + ((MAX_CONTEXT_IN_UNITS+1) * 0);
 unichar* middle = unichar_buffer + ((MAX_CONTEXT_IN_UNITS+1) * 1);
 unichar* right = unichar_buffer + ((MAX_CONTEXT_IN_UNITS+1) * 2);
 unichar* href = unichar_buffer + ((MAX_CONTEXT_IN_UNITS+1) * 3);
+/* The line is built here before being stored */
+unichar* line = unichar_buffer + ((MAX_CONTEXT_IN_UNITS+1) * 4);
+int line_length;
 int number_of_matches=0;
 int is_a_good_match=1;
 int start_pos,end_pos;
@@ -811,17 +988,12 @@ struct buffer_mapped* buffer=(struct buffer_mapped*)malloc(sizeof(struct buffer_
 if (buffer==NULL) {
 	fatal_alloc_error("create_raw_text_concordance");
 }
-buffer->amf=(text);
-buffer->int_buffer_=(const int*)af_get_mapfile_pointer(buffer->amf);
-buffer->nb_item=af_get_mapfile_size(buffer->amf)/sizeof(int);
+buffer->int_buffer_=(const int*)text->buffer;
+buffer->nb_item=text->size/sizeof(int);
 buffer->skip=0;
 buffer->pos_next_read=0;
 buffer->size=0;
 
-u_printf("Loading concordance index...\n");
-/* Then we load the concordance index. NULL means that the kind of output
- * doesn't matter. */
-matches=load_match_list(concordance,NULL);
 /* Then we fill the buffer with the beginning of the text */
 //buffer->size=(int)fread(buffer->int_buffer,sizeof(int),buffer->MAXIMUM_BUFFER_SIZE,text);
 buffer->size=(int)buf_map_int_pseudo_read(buffer,buffer->nb_item);
@@ -852,7 +1024,24 @@ while (matches!=NULL) {
 	/* We update the position in characters so that we know how
 	 * many characters there are before buffer[start_pos]. We update
 	 * the sentence number in the same way. */
-	if (position_in_tokens>start_pos) {
+	if (offsets!=NULL) {
+	   /* If we have the text.ofs index, we get them directly */
+	   int n_markers;
+	   const int* text_cod=buffer->int_buffer_+buffer->skip;
+	   start_pos_char=get_text_offset(offsets,text_cod,token_length,start_pos,&n_markers);
+	   current_sentence=n_markers+1;
+	   position_from_eos=0;
+	   if (n_markers<offsets->n_sentences) {
+	      position_from_eos=start_pos_char-get_text_offset(offsets,text_cod,token_length,
+	                                                       get_sentence_start(offsets,n_markers),NULL);
+	   }
+	   if (expected_result==UIMA_ && tokens->SENTENCE_MARKER!=-1) {
+	      /* In UIMA mode, sentence markers are not counted */
+	      start_pos_char=start_pos_char-n_markers*token_length[tokens->SENTENCE_MARKER];
+	   }
+	   start_from_eos=position_from_eos;
+	}
+	else if (position_in_tokens>start_pos) {
 	   /* If we have to go backward, in the case a Locate made in "All matches mode" */
 	   for (int z=position_in_tokens-1; z>=start_pos; z--) {
          int token_size=0;
@@ -962,27 +1151,28 @@ while (matches!=NULL) {
 			}
 		}
 		/* We save the 3 parts of the concordance line according to the sort mode */
+		line_length=0;
 		switch(option->sort_mode) {
 			case TEXT_ORDER:
-			if(expected_result==XALIGN_) u_fprintf(output,"%S\t%S",positions_from_eos,middle);
-				else u_fprintf(output,"%S\t%S\t%S",left,middle,right);
+			if(expected_result==XALIGN_) line_length=u_sprintf(line,"%S\t%S",positions_from_eos,middle);
+				else line_length=u_sprintf(line,"%S\t%S\t%S",left,middle,right);
 				break;
-			case LEFT_CENTER:  u_fprintf(output,"%R\t%S\t%S",left,middle,right); break;
-			case LEFT_RIGHT:   u_fprintf(output,"%R\t%S\t%S",left,right,middle); break;
-			case CENTER_LEFT:  u_fprintf(output,"%S\t%R\t%S",middle,left,right); break;
-			case CENTER_RIGHT: u_fprintf(output,"%S\t%S\t%R",middle,right,left);	break;
-			case RIGHT_LEFT:   u_fprintf(output,"%S\t%R\t%S",right,left,middle); break;
-			case RIGHT_CENTER: u_fprintf(output,"%S\t%S\t%R",right,middle,left);	break;
+			case LEFT_CENTER:  line_length=u_sprintf(line,"%R\t%S\t%S",left,middle,right); break;
+			case LEFT_RIGHT:   line_length=u_sprintf(line,"%R\t%S\t%S",left,right,middle); break;
+			case CENTER_LEFT:  line_length=u_sprintf(line,"%S\t%R\t%S",middle,left,right); break;
+			case CENTER_RIGHT: line_length=u_sprintf(line,"%S\t%S\t%R",middle,right,left);	break;
+			case RIGHT_LEFT:   line_length=u_sprintf(line,"%S\t%R\t%S",right,left,middle); break;
+			case RIGHT_CENTER: line_length=u_sprintf(line,"%S\t%S\t%R",right,middle,left);	break;
 		}
 		/* And we add the position information */
-		if(expected_result!=XALIGN_) u_fprintf(output,"%S",positions);
+		if(expected_result!=XALIGN_) line_length+=u_sprintf(line+line_length,"%S",positions);
 		/* And the GlossaNet URL if needed */
 		if (expected_result==GLOSSANET_) {
-			u_fprintf(output,"\t%S",href);
+			line_length+=u_sprintf(line+line_length,"\t%S",href);
 		}
 
-		if(expected_result==XALIGN_) u_fprintf(output,"\n");
-		else u_fprintf(output,"\n");
+		if(expected_result==XALIGN_) u_fprintf(output,"%S\n",line);
+		else add_raw_concordance_line(raw,line);
 		/* We increase the number of matches actually written to the output */
 		number_of_matches++;
 	}
@@ -991,7 +1181,6 @@ while (matches!=NULL) {
 	matches=matches->next;
 	free_match_list_element(matches_tmp);
 }
-af_release_mapfile_pointer(buffer->amf,buffer->int_buffer_);
 free(unichar_buffer);
 free(buffer);
 return number_of_matches;
@@ -1042,7 +1231,7 @@ return pos_in_enter_pos;
  *
  * The function also makes sure that the last token #match_end has been loaded into the buffer.
  */
-int move_in_text_with_writing(int match_start,int match_end,ABSTRACTMAPFILE* /*text*/,struct text_tokens* tokens,
+int move_in_text_with_writing(int match_start,int match_end,const struct pipeline_mapped_file* /*text*/,struct text_tokens* tokens,
 								int current_global_position,U_FILE* output,
 								int n_enter_char,int* enter_pos,int pos_in_enter_pos,
 								struct buffer_mapped* buffer,int *pos_int_char) {
@@ -1087,7 +1276,7 @@ return pos_in_enter_pos;
  * This function saves all the text from the token n� 'current_global_position' to
  * the end.
  */
-int move_to_end_of_text_with_writing(ABSTRACTMAPFILE* /*text*/,struct text_tokens* tokens,
+int move_to_end_of_text_with_writing(const struct pipeline_mapped_file* /*text*/,struct text_tokens* tokens,
 									int current_global_position,U_FILE* output,
 									int n_enter_char,int* enter_pos,int pos_in_enter_pos,
 									struct buffer_mapped* buffer) {
@@ -1116,16 +1305,15 @@ return pos_in_enter_pos;
  * the longest is preferred. If 2 matches start and end at the same positions,
  * then the first one is arbitrarily preferred.
  */
-void create_modified_text_file(Encoding encoding_output,int bom_output,U_FILE* concordance,ABSTRACTMAPFILE* text,
+void create_modified_text_file(Encoding encoding_output,int bom_output,struct match_list* matches,
+                               const struct pipeline_mapped_file* text,
                                struct text_tokens* tokens,char* output_name,
                                int n_enter_char,int* enter_pos) {
 U_FILE* output=u_fopen_creating_versatile_encoding(encoding_output,bom_output,output_name,U_WRITE);
 if (output==NULL) {
-	u_fclose(concordance);
-	af_close_mapfile(text);
+	free_match_list(matches);
 	fatal_error("Cannot write file %s\n",output_name);
 }
-struct match_list* matches;
 struct match_list* matches_tmp;
 int current_global_position_in_token=0;
 int current_global_position_in_char=0;
@@ -1133,15 +1321,12 @@ int current_global_position_in_char=0;
 /* We allocate a buffer to read the tokens of the text */
 //struct buffer* buffer=new_buffer_for_file(INTEGER_BUFFER,text);
 struct buffer_mapped* buffer=(struct buffer_mapped*)malloc(sizeof(struct buffer_mapped));
-buffer->amf=(text);
-buffer->int_buffer_=(const int*)af_get_mapfile_pointer(buffer->amf);
-buffer->nb_item=af_get_mapfile_size(buffer->amf)/sizeof(int);
+buffer->int_buffer_=(const int*)text->buffer;
+buffer->nb_item=text->size/sizeof(int);
 buffer->skip=0;
 buffer->pos_next_read=0;
 buffer->size=0;
 
-/* We load the match list */
-matches=load_match_list(concordance,NULL);
 int pos_in_enter_pos=0;
 u_printf("Merging outputs with text...\n");
 while (matches!=NULL) {
@@ -1203,7 +1388,6 @@ while (matches!=NULL) {
  * last match. */
 move_to_end_of_text_with_writing(text,tokens,current_global_position_in_token,output,
 								n_enter_char,enter_pos,pos_in_enter_pos,buffer);
-af_release_mapfile_pointer(buffer->amf,buffer->int_buffer_);
 free(buffer);
 u_fclose(output);
 u_printf("Done.\n");
@@ -1232,6 +1416,7 @@ opt->output[0]='\0';
 opt->script=NULL;
 opt->sort_alphabet=NULL;
 opt->working_directory[0]='\0';
+opt->n_threads=1;
 return opt;
 }
 
@@ -23,6 +23,9 @@
 #define ConcordanceH
 
 #include "Text_tokens.h"
+#include "TextOffsets.h"
+#include "LocateMatches.h"
+#include "Pipeline.h"
 
 
 #define TEXT_ORDER 0
@@ -67,13 +70,14 @@ struct conc_opt {
   char* script;
   char* sort_alphabet;
   char working_directory[FILENAME_MAX];
+  int n_threads;
 };
 
 struct conc_opt* new_conc_opt();
 void free_conc_opt(struct conc_opt*);
 
-void create_concordance(Encoding encoding_output,int bom_output,U_FILE*,ABSTRACTMAPFILE*,struct text_tokens*,
-                        int,int*,struct conc_opt*);
+void create_concordance(Encoding encoding_output,int bom_output,struct match_list*,const struct pipeline_mapped_file*,struct text_offsets*,
+                        struct text_tokens*,int,int*,struct conc_opt*);
 
 
 #endif
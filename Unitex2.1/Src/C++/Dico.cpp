@@ -41,6 +41,7 @@
 #include "Dico.h"
 #include "SortTxt.h"
 #include "Compress.h"
+#include "Pipeline.h"
 
 /**
  * This enhanced version of Dico was rewritten by Alexis Neme,
@@ -325,11 +326,15 @@ if (!u_fempty(encoding_output,bom_output,snt_files->tags_err)) {
 af_remove(snt_files->morpho_dic);
 af_remove(snt_files->morpho_bin);
 af_remove(snt_files->morpho_inf);
+/* The alphabet and the morphological dictionaries will be shared
+ * with the Locate calls used to apply .fst2 dictionaries */
+BeginPipeline();
 Alphabet* alphabet=NULL;
 if (alph[0]!='\0') {
    /* We load the alphabet */
    alphabet=load_alphabet(alph,is_korean);
    if (alphabet==NULL) {
+      EndPipeline();
       error("Cannot open alphabet file %s\n",alph);
       return 1;
    }
@@ -338,6 +343,7 @@ if (alph[0]!='\0') {
 tokens=load_text_tokens(snt_files->tokens_txt,mask_encoding_compatibility_input);
 if (tokens==NULL) {
    free_alphabet(alphabet);
+   EndPipeline();
    error("Cannot open token file %s\n",snt_files->tokens_txt);
    return 1;
 }
@@ -346,6 +352,7 @@ text_cod=u_fopen(BINARY,snt_files->text_cod,U_READ);
 if (text_cod==NULL) {
    free_alphabet(alphabet);
    free_text_tokens(tokens);
+   EndPipeline();
    error("Cannot open coded text file %s\n",snt_files->text_cod);
    return 1;
 }
@@ -504,5 +511,6 @@ free_dico_application(info);
 free_snt_files(snt_files);
 if (morpho_dic!=NULL) free(morpho_dic);
 free_OptVars(vars);
+EndPipeline();
 return ret;
 }
@@ -37,6 +37,8 @@
 #ifndef _DIR_LOGGER_H
 #define _DIR_LOGGER_H
 
+#include <stddef.h>
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -49,6 +51,8 @@ int chDirPortable(const char* dirname);
 
 int rmDirPortable(const char* dirname);
 
+int getCurrentDirPortable(char* dirname,size_t size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -62,3 +62,11 @@ int rmDirPortable(const char* dirname)
 
     return rmdir(dirname);
 }
+
+/* Upon successful completion, 0 shall be returned. */
+int getCurrentDirPortable(char* dirname,size_t size)
+{
+    if (_getcwd(dirname,(int)size) == NULL)
+        return -1;
+    return 0;
+}
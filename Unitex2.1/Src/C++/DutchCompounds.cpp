@@ -22,6 +22,10 @@
 #include "DutchCompounds.h"
 #include "Error.h"
 #include "List_ustring.h"
+#include "HashTable.h"
+#include "Vector.h"
+#include "Ustring.h"
+#include "logger/SyncLogger.h"
 
 
 #define is_N 0
@@ -30,6 +34,17 @@
 #define is_ADV 3
 #define INVALID_LEFT_COMPONENT 4
 
+/**
+ * Above this number of analysed suffixes, the memo of a thread is emptied
+ * before the next word.
+ */
+#define MAX_DUTCH_MEMO_SIZE 200000
+
+/**
+ * Number of words read at once, per thread.
+ */
+#define WORDS_PER_THREAD 1024
+
 
 /**
  * This structure is used to englobe settings for the analysis of
@@ -58,39 +73,50 @@ struct dutch_infos {
 	 * compound word. */
 	char* valid_left_component;
 	char* valid_right_component;
+	/* The decompositions of the word suffixes already analysed */
+	struct hash_table* memo;
 };
 
 
+/**
+ * A decomposition of the end of a word. 'decomposition' is the list of the
+ * entries of its components, starting with the " +++ " mark that separates
+ * it from the previous component, 'components' is the concatenation of its
+ * left components, and 'inflected', 'lemma' and 'codes' come from the
+ * entry of its last component. The strings are allocated with the structure.
+ */
 struct word_decomposition {
    int n_parts;
-   unichar decomposition[4096];
-   unichar dela_line[4096];
+   unichar* decomposition;
+   unichar* components;
+   unichar* inflected;
+   unichar* lemma;
+   unichar* codes;
 };
 
 
-struct word_decomposition_list {
-   struct word_decomposition* element;
-   struct word_decomposition_list* next;
+/**
+ * A component found at the beginning of a word. The component is stored
+ * right after the structure.
+ */
+struct dutch_prefix {
+   int index;
+   int length;
+   unichar component[1];
 };
 
 
-void analyse_dutch_unknown_words(struct dutch_infos*);
-int analyse_dutch_word(const unichar* word,struct dutch_infos*);
-void explore_state_dutch(int offset,unichar* current_component,int pos_in_current_component,
-                   const unichar* word_to_analyze,int pos_in_word_to_analyze,const unichar* analysis,
-                   const unichar* output_dela_line,struct word_decomposition_list** L,
-                   int number_of_components,const struct dutch_infos* infos);
+void analyse_dutch_unknown_words(struct dutch_infos*,int);
+int analyse_dutch_word(const unichar* word,Ustring*,Ustring*,struct dutch_infos*);
+static void get_dutch_prefixes(int,unichar*,int,const unichar*,vector_ptr*,const struct dutch_infos*);
+static void get_dutch_decompositions(const unichar*,int,const vector_ptr*,vector_ptr*,struct dutch_infos*);
 void check_valid_right_component_dutch(char*,const struct INF_codes*);
 char check_valid_right_component_for_an_INF_line_dutch(const struct list_ustring*);
 char check_valid_right_component_for_one_INF_code_dutch(const unichar*);
 void check_valid_left_component_dutch(char*,const struct INF_codes*);
 char check_valid_left_component_for_an_INF_line_dutch(const struct list_ustring*);
 char check_valid_left_component_for_one_INF_code_dutch(const unichar*);
-
-struct word_decomposition* new_word_decomposition_dutch();
-void free_word_decomposition_dutch(struct word_decomposition*);
-struct word_decomposition_list* new_word_decomposition_list_dutch();
-void free_word_decomposition_list_dutch(struct word_decomposition_list*);
+static void free_word_decompositions_dutch(void*);
 
 
 /**
@@ -98,7 +124,8 @@ void free_word_decomposition_list_dutch(struct word_decomposition_list*);
  */
 void analyse_dutch_unknown_words(const Alphabet* alphabet,const unsigned char* bin,const struct INF_codes* inf,
 								U_FILE* unknown_word_list,U_FILE* output,U_FILE* info_output,
-								U_FILE* new_unknown_word_list,struct string_hash* forbidden_words) {
+								U_FILE* new_unknown_word_list,struct string_hash* forbidden_words,
+								int n_threads) {
 /* We create a structure that will contain all settings */
 struct dutch_infos infos;
 infos.alphabet=alphabet;
@@ -121,8 +148,9 @@ if (infos.valid_right_component==NULL) {
  * components of compounds words. */
 check_valid_left_component_dutch(infos.valid_left_component,inf);
 check_valid_right_component_dutch(infos.valid_right_component,inf);
+infos.memo=NULL;
 /* Now we are ready to analyse the given word list */
-analyse_dutch_unknown_words(&infos);
+analyse_dutch_unknown_words(&infos,n_threads);
 free(infos.valid_left_component);
 free(infos.valid_right_component);
 }
@@ -335,174 +363,236 @@ return res;
 
 
 
+/**
+ * A word read from the unknown word list, with the lines produced by its
+ * analysis.
+ */
+struct dutch_word_info {
+   unichar* word;
+   Ustring* result;
+   Ustring* info;
+   int decomposed;
+};
+
+
+/**
+ * The words first, first+step, ... that are before 'end' are analysed with
+ * the given infos, whose memo is private to the job.
+ */
+struct dutch_job {
+   struct dutch_infos infos;
+   struct dutch_word_info* words;
+   int first;
+   int end;
+   int step;
+};
+
+
+static void SYNC_CALLBACK_UNITEX analyse_dutch_words(void* privateDataPtr,unsigned int /*iNbThread*/) {
+struct dutch_job* job=(struct dutch_job*)privateDataPtr;
+for (int i=job->first;i<job->end;i+=job->step) {
+   struct dutch_word_info* w=&(job->words[i]);
+   w->decomposed=analyse_dutch_word(w->word,w->result,w->info,&(job->infos));
+}
+}
+
+
 /**
  * This function reads words from the unknown word file and tries to
  * analyse them. The unknown word file is supposed to contain one word
  * per line. If a word cannot be analyzed, we print it to the new
  * unknown word list file.
+ *
+ * The words are read by blocks, and the words of a block are shared
+ * between 'n_threads' threads, each one with its own memo. Then, the
+ * results are written in the order of the word file.
  */
-void analyse_dutch_unknown_words(struct dutch_infos* infos) {
+void analyse_dutch_unknown_words(struct dutch_infos* infos,int n_threads) {
 unichar line[10000];
 u_printf("Analysing Dutch unknown words...\n");
-int n=0;
-/* We read each line of the unknown word list and we try to analyze it */
-while (EOF!=u_fgets_limit2(line,10000,infos->unknown_word_list)) {
-  if (!analyse_dutch_word(line,infos)) {
-     /* If the analysis has failed, we store the word in the
-      * new unknown word file */
-     u_fprintf(infos->new_unknown_word_list,"%S\n",line);
-  } else {
-  		/* Otherwise, we increase the number of analyzed words */
-  		n++;
-  	}
+if (n_threads<1) {
+   n_threads=1;
+}
+int max_words=n_threads*WORDS_PER_THREAD;
+struct dutch_word_info* block=(struct dutch_word_info*)malloc(max_words*sizeof(struct dutch_word_info));
+struct dutch_job* jobs=(struct dutch_job*)malloc(n_threads*sizeof(struct dutch_job));
+void** job_ptrs=(void**)malloc(n_threads*sizeof(void*));
+if (block==NULL || jobs==NULL || job_ptrs==NULL) {
+   fatal_alloc_error("analyse_dutch_unknown_words");
 }
+for (int t=0;t<n_threads;t++) {
+   jobs[t].infos=*infos;
+   jobs[t].infos.memo=new_hash_table((HASH_FUNCTION)hash_unichar,(EQUAL_FUNCTION)u_equal,
+                                     (FREE_FUNCTION)free,free_word_decompositions_dutch,(KEYCOPY_FUNCTION)keycopy);
+   jobs[t].words=block;
+   jobs[t].first=t;
+   jobs[t].step=n_threads;
+   job_ptrs[t]=&(jobs[t]);
+}
+for (int i=0;i<max_words;i++) {
+   block[i].result=new_Ustring(256);
+   block[i].info=(infos->info_output!=NULL)?new_Ustring(256):NULL;
+}
+int n=0;
+int n_words;
+do {
+   /* We read a block of lines of the unknown word list */
+   for (n_words=0;n_words<max_words && EOF!=u_fgets_limit2(line,10000,infos->unknown_word_list);n_words++) {
+      block[n_words].word=u_strdup(line);
+   }
+   for (int t=0;t<n_threads;t++) {
+      jobs[t].end=n_words;
+   }
+   if (n_threads==1) {
+      analyse_dutch_words(job_ptrs[0],0);
+   } else {
+      SyncDoRunThreads(n_threads,analyse_dutch_words,job_ptrs);
+   }
+   for (int i=0;i<n_words;i++) {
+      if (!block[i].decomposed) {
+         /* If the analysis has failed, we store the word in the
+          * new unknown word file */
+         u_fprintf(infos->new_unknown_word_list,"%S\n",block[i].word);
+      } else {
+         /* Otherwise, we increase the number of analyzed words */
+         n++;
+         if (infos->info_output!=NULL) {
+            u_fprintf(infos->info_output,"%S",block[i].info->str);
+         }
+         u_fprintf(infos->output,"%S",block[i].result->str);
+      }
+      free(block[i].word);
+   }
+} while (n_words==max_words);
+for (int i=0;i<max_words;i++) {
+   free_Ustring(block[i].result);
+   free_Ustring(block[i].info);
+}
+for (int t=0;t<n_threads;t++) {
+   free_hash_table(jobs[t].infos.memo);
+}
+free(job_ptrs);
+free(jobs);
+free(block);
 u_printf("%d words decomposed as compound word%s\n",n,(n>1)?"s":"");
 }
 
 
 /**
  * This function tries to analyse an unknown Dutch word. If OK,
- * it returns 1 and print the dictionary entry to the output (and
- * information if an information file has been specified in 'infos');
- * returns 0 otherwise.
+ * it returns 1 and stores the dictionary entries in 'result' (and
+ * information in 'info' if it is not NULL); returns 0 otherwise.
  */
-int analyse_dutch_word(const unichar* word,struct dutch_infos* infos) {
-unichar decomposition[4096];
-unichar dela_line[4096];
-unichar correct_word[4096];
-decomposition[0]='\0';
-dela_line[0]='\0';
-correct_word[0]='\0';
-struct word_decomposition_list* l=NULL;
+int analyse_dutch_word(const unichar* word,Ustring* result,Ustring* info,struct dutch_infos* infos) {
+empty(result);
+if (info!=NULL) {
+	empty(info);
+}
+if (infos->memo->number_of_elements>MAX_DUTCH_MEMO_SIZE) {
+	clear_hash_table(infos->memo);
+}
+unichar current_component[4096];
+vector_ptr* prefixes=new_vector_ptr(8);
+get_dutch_prefixes(4,current_component,0,word,prefixes,infos);
+vector_ptr* l=new_vector_ptr(4);
 /* We look if there are decompositions for this word */
-explore_state_dutch(4,correct_word,0,word,0,decomposition,dela_line,&l,1,infos);
-if (l==NULL) {
+get_dutch_decompositions(word,1,prefixes,l,infos);
+free_vector_ptr(prefixes,free);
+if (l->nbelems==0) {
 	/* If there is no decomposition, we return */
+	free_vector_ptr(l);
 	return 0;
 }
 /* Otherwise, we will choose the one to keep */
-struct word_decomposition_list* tmp=l;
 int n=1000;
+int i;
 /* First, we count the minimal number of components, because
  * we want to give priority to analysis with smallest number
- * of components. By the way, we note if there is a minimal
- * analysis ending by a noun or an adjective. */
-while (tmp!=NULL) {
-	if (tmp->element->n_parts<=n) {
-		n=tmp->element->n_parts;
+ * of components. */
+for (i=0;i<l->nbelems;i++) {
+	struct word_decomposition* d=(struct word_decomposition*)l->tab[i];
+	if (d->n_parts<=n) {
+		n=d->n_parts;
 	}
-	tmp=tmp->next;
 }
-tmp=l;
-while (tmp!=NULL) {
-	if (n==tmp->element->n_parts) {
+/* The decompositions are printed in the reverse order of their discovery */
+for (i=l->nbelems-1;i>=0;i--) {
+	struct word_decomposition* d=(struct word_decomposition*)l->tab[i];
+	if (n==d->n_parts) {
 		/* We only consider the words that have shortest decompositions.
 		 * The test (tmp->element->n_parts==1) is used to
 		 * match simple words that would have been wrongly considered
 		 * as unknown words. */
-		if (infos->info_output!=NULL) {
-			u_fprintf(infos->info_output,"%S = %S\n",word,tmp->element->decomposition);
+		if (info!=NULL) {
+			u_strcatf(info,"%S = %S\n",word,d->decomposition);
 		}
-		u_fprintf(infos->output,"%S\n",tmp->element->dela_line);
+		/* The DELA line is made of the left components followed by the
+		 * inflected form and the lemma of the last one */
+		u_strcatf(result,"%S%S,%S%S%S\n",d->components,d->inflected,
+				d->components,d->lemma,d->codes);
 	}
-	tmp=tmp->next;
 }
-free_word_decomposition_list_dutch(l);
+free_vector_ptr(l,free);
 return 1;
 }
 
 
 /**
- * Allocates, initializes and returns a word decomposition structure.
+ * Allocates and returns a word decomposition structure. 'decomposition' is made
+ * of 'head' followed by 'tail_decomposition', and 'components' of the first
+ * 'length' characters of 'component' followed by 'tail_components'.
  */
-struct word_decomposition* new_word_decomposition_dutch() {
-struct word_decomposition* tmp;
-tmp=(struct word_decomposition*)malloc(sizeof(struct word_decomposition));
-if (tmp==NULL) {
-   fatal_alloc_error("new_word_decomposition_dutch");
-}
-tmp->n_parts=0;
-tmp->decomposition[0]='\0';
-tmp->dela_line[0]='\0';
-return tmp;
+static struct word_decomposition* new_word_decomposition_dutch(int n_parts,
+		const unichar* head,const unichar* tail_decomposition,
+		const unichar* component,int length,const unichar* tail_components,
+		const unichar* inflected,const unichar* lemma,const unichar* codes) {
+int head_length=u_strlen(head);
+int tail_length=u_strlen(tail_decomposition);
+int components_length=u_strlen(tail_components);
+int inflected_length=u_strlen(inflected);
+int lemma_length=u_strlen(lemma);
+int codes_length=u_strlen(codes);
+int total=(head_length+tail_length+1)+(length+components_length+1)
+         +(inflected_length+1)+(lemma_length+1)+(codes_length+1);
+struct word_decomposition* d=(struct word_decomposition*)malloc(sizeof(struct word_decomposition)
+                                                                +total*sizeof(unichar));
+if (d==NULL) {
+	fatal_alloc_error("new_word_decomposition_dutch");
+}
+d->n_parts=n_parts;
+d->decomposition=(unichar*)(d+1);
+memcpy(d->decomposition,head,head_length*sizeof(unichar));
+memcpy(d->decomposition+head_length,tail_decomposition,(tail_length+1)*sizeof(unichar));
+d->components=d->decomposition+head_length+tail_length+1;
+memcpy(d->components,component,length*sizeof(unichar));
+memcpy(d->components+length,tail_components,(components_length+1)*sizeof(unichar));
+d->inflected=d->components+length+components_length+1;
+memcpy(d->inflected,inflected,(inflected_length+1)*sizeof(unichar));
+d->lemma=d->inflected+inflected_length+1;
+memcpy(d->lemma,lemma,(lemma_length+1)*sizeof(unichar));
+d->codes=d->lemma+lemma_length+1;
+memcpy(d->codes,codes,(codes_length+1)*sizeof(unichar));
+return d;
 }
 
 
 /**
- * Frees a word decomposition structure.
+ * Frees a vector of word decompositions.
  */
-void free_word_decomposition_dutch(struct word_decomposition* t) {
-if (t==NULL) return;
-free(t);
+static void free_word_decompositions_dutch(void* ptr) {
+free_vector_ptr((vector_ptr*)ptr,free);
 }
 
 
 /**
- * Allocates, initializes and returns a word decomposition list structure.
+ * This function explores the dictionary in order to find, in one pass, all
+ * the components that start the given word and that are not forbidden words.
+ * A component is kept if it covers the whole word, or if it is a valid left
+ * one. The components are added to 'prefixes' in the order of the exploration,
+ * which is the order in which the decompositions were always found.
  */
-struct word_decomposition_list* new_word_decomposition_list_dutch() {
-struct word_decomposition_list* tmp;
-tmp=(struct word_decomposition_list*)malloc(sizeof(struct word_decomposition_list));
-if (tmp==NULL) {
-   fatal_alloc_error("new_word_decomposition_list_dutch");
-}
-tmp->element=NULL;
-tmp->next=NULL;
-return tmp;
-}
-
-
-/**
- * Frees a word decomposition list.
- */
-void free_word_decomposition_list_dutch(struct word_decomposition_list* l) {
-struct word_decomposition_list* tmp;
-while (l!=NULL) {
-	free_word_decomposition_dutch(l->element);
-	tmp=l->next;
-	free(l);
-	l=tmp;
-}
-}
-
-
-/**
- * This explores the dictionary in order decompose the given word into a valid sequence
- * of simple words. For instance, if we have the word "Sommervarmt", we will first
- * explore the dictionary and find that "sommer" is a valid left component that
- * corresponds to the dictionary entry "sommer,.N:msia". Then we will
- * look if the following word "varmt" is in the dictionary. It is
- * the case, with the entry "varmt,varm.A:nsio". As we are at the end of the word to
- * analyze and as "varmt" is a valid rightmost component, we will generate an entry
- * according to the following things:
- *
- * 'output_dela_line'="sommervarmt,sommervarm.A:nsio"
- * 'analysis'="sommer,.N:msia +++ varmt,varm.A:nsio"
- * 'number_of_components'=2
- *
- * Note that the initial "S" was put in lowercase, because the dictionary
- * contains "sommer" and not "Sommer". The lemma is obtained with
- * the lemma of the rightmost component (here "varm"), and the word inherits
- * from the grammatical information of its rightmost component.
- *
- * 'offset': offset of the current node in the binary array 'infos->bin'
- * 'current_component': string that represents the current simple word
- * 'pos_in_current_component': position in the string 'current_component'
- * 'word_to_analyze': the word to analyze
- * 'pos_in_word_to_analyze': position in the string 'word_to_analyze'
- * 'analysis': string that represents the analysis as a concatenation like
- *             "sommer,.N:msia +++ varmt,varm.A:nsio"
- * 'output_dela_line': string that contains the final DELA line. The lemma is
- *                     obtained by replacing the rightmost term of
- *                     the word to analyze by its lemma.
- * 'L': list of all analysis for the given word
- * 'number_of_components': number of components that compose the word.
- * 'infos': global settings.
- */
-void explore_state_dutch(int offset,unichar* current_component,int pos_in_current_component,
-                   const unichar* word_to_analyze,int pos_in_word_to_analyze,const unichar* analysis,
-                   const unichar* output_dela_line,struct word_decomposition_list** L,
-                   int number_of_components,const struct dutch_infos* infos) {
+static void get_dutch_prefixes(int offset,unichar* current_component,int pos_in_current_component,
+                               const unichar* word,vector_ptr* prefixes,const struct dutch_infos* infos) {
 int c;
 int index,t;
 c=infos->bin[offset]*256+infos->bin[offset+1];
@@ -513,155 +603,18 @@ if (!(c&32768)) {
 	/* We can set the end of our current component */
 	current_component[pos_in_current_component]='\0';
 	/* We do not consider forbidden words */
-   if (infos->forbidden_words==NULL || NO_VALUE_INDEX==get_value_index(current_component,infos->forbidden_words,DONT_INSERT)) {
-		/* We don't consider components with a length of 1 */
-		if (word_to_analyze[pos_in_word_to_analyze]=='\0') {
-			/* If we have explored the entire original word */
-   		/* And if we do not have forbidden word in last position */
-			struct list_ustring* l=infos->inf->codes[index];
-			/* We will look at all the INF codes of the last component in order
-			 * to produce analysis */
-			while (l!=NULL) {
-				unichar dec[2000];
-				u_strcpy(dec,analysis);
-				if (dec[0]!='\0') {
-					/* If we have already something in the analysis (i.e. if
-					 * we have not a simple word), we insert the concatenation
-					 * mark before the entry to come */
-					u_strcat(dec," +++ ");
-				}
-				unichar entry[2000];
-				/* We get the dictionary line that corresponds to the current INF code */
-				uncompress_entry(current_component,l->string,entry);
-				/* And we add it to the analysis */
-				u_strcat(dec,entry);
-				unichar new_dela_line[2000];
-				/* We copy the current output DELA line that contains
-				 * the concatenation of the previous components */
-				u_strcpy(new_dela_line,output_dela_line);
-				/* Then we tokenize the DELA line that corresponds the current INF
-				 * code in order to obtain its lemma and grammatical/inflectional
-				 * information */
-				struct dela_entry* tmp_entry=tokenize_DELAF_line(entry,1);
-				/* We concatenate the inflected form of the last component to
-				 * the output DELA line */
-				u_strcat(new_dela_line,tmp_entry->inflected);
-				/* We put the comma that separates the inflected form and the lemma */
-				u_strcat(new_dela_line,",");
-				/* And we build the lemma in the same way than the inflected form */
-				u_strcat(new_dela_line,output_dela_line);
-				u_strcat(new_dela_line,tmp_entry->lemma);
-				/* We put the dot that separates the the lemma and the grammatical/inflectional
-				 * information */
-				u_strcat(new_dela_line,".");
-				/* And finally we put the grammatical/inflectional information */
-				u_strcat(new_dela_line,tmp_entry->semantic_codes[0]);
-              int k;
-              for (k=1;k<tmp_entry->n_semantic_codes;k++) {
-                 u_strcat(new_dela_line,"+");
-                 u_strcat(new_dela_line,tmp_entry->semantic_codes[k]);
-              }
-              for (k=0;k<tmp_entry->n_inflectional_codes;k++) {
-                 u_strcat(new_dela_line,":");
-                 u_strcat(new_dela_line,tmp_entry->inflectional_codes[k]);
-              }
-				/*
-				 * Now we can build an analysis in the form of a word decomposition
-				 * structure, but only if the last component is a valid
-				 * right one or if it is a verb long enough, or if we find out
-				 * that the word to analyze was in fact a simple word
-				 * in the dictionary */
-				if (check_valid_right_component_for_one_INF_code_dutch(l->string)
-					|| number_of_components==1) {
-					/*
-					 * We set the number of components, the analysis, the actual
-					 * DELA line and information about
-					 */
-					struct word_decomposition* wd=new_word_decomposition_dutch();
-					wd->n_parts=number_of_components;
-					u_strcpy(wd->decomposition,dec);
-					u_strcpy(wd->dela_line,new_dela_line);
-					/* Then we add the decomposition word structure to the list that
-					 * contains all the analysis for the word to analyze */
-					struct word_decomposition_list* wdl=new_word_decomposition_list_dutch();
-					wdl->element=wd;
-					wdl->next=(*L);
-					(*L)=wdl;
-				}
-				/* We go on with the next INF code of the last component */
-				l=l->next;
-			}
-			/* If are at the end of the word to analyze, we have nothing more to do */
-			return;
-		} else {
-			/* If we are not at the end of the word to analyze, we must
-			 * 1) look if the current component is a valid left one
-			 * 2) explore the rest of the original word
-			 */
-			if (infos->valid_left_component[index]) {
-				/* If we have a valid component, we look first if we are
-				 * in the case of a word followed by a "s" */
-				if (word_to_analyze[pos_in_word_to_analyze]=='s') {
-               /* If we have such a word, we add it to the current analysis,
-					 * putting "+++ s +++*/
-					unichar dec[2000];
-					u_strcpy(dec,analysis);
-					if (dec[0]!='\0') {
-						u_strcat(dec," +++");
-					}
-					/* In order to print the component in the analysis, we arbitrary
-					 * take a valid left component among all those that are available
-					 * for the current component */
-					unichar sia_code[2000];
-					unichar entry[2000];
-					unichar line[2000];
-					get_first_valid_left_component_dutch(infos->inf->codes[index],sia_code);
-					uncompress_entry(current_component,sia_code,entry);
-					u_strcat(dec,entry);
-					u_strcpy(line,output_dela_line);
-					u_strcat(line,current_component);
-					/* As we have a double letter at the end of the word,
-					 * we must remove a character */
-					line[u_strlen(line)-1]='\0';
-					unichar temp[2000];
-					unichar dec_temp[2000];
-					u_strcpy(dec_temp,dec);
-               u_strcat(dec_temp," +++ s");
-					/* Then, we explore the dictionary in order to analyze the
-					 * next component. We start at the root of the dictionary
-					 * (offset=4) and we go back one position in the word to analyze.
-					 */
-					explore_state_dutch(4,temp,0,word_to_analyze,pos_in_word_to_analyze+1,
-						dec_temp,line,L,number_of_components+1,infos);
-				}
-				/* Now, we try to analyze the component normally */
-				unichar dec[2000];
-				unichar line[2000];
-				u_strcpy(dec,analysis);
-				if (dec[0]!='\0') {
-					/* We add the "+++" mark if the current component is not the first one */
-					u_strcat(dec," +++ ");
-				}
-				unichar sia_code[2000];
-				unichar entry[2000];
-				/* In order to print the component in the analysis, we arbitrary
-				 * take a valid left component among all those that are available
-				 * for the current component */
-				get_first_valid_left_component_dutch(infos->inf->codes[index],sia_code);
-				uncompress_entry(current_component,sia_code,entry);
-				u_strcat(dec,entry);
-				u_strcpy(line,output_dela_line);
-				u_strcat(line,current_component);
-				unichar temp[2000];
-				unichar dec_temp[2000];
-				u_strcpy(dec_temp,dec);
-				/* Then, we explore the dictionary in order to analyze the
-				 * next component. We start at the root of the dictionary
-				 * (offset=4). */
-				explore_state_dutch(4,temp,0,word_to_analyze,pos_in_word_to_analyze,
-					dec_temp,line,L,number_of_components+1,infos);
-			}
+	if ((word[pos_in_current_component]=='\0' || infos->valid_left_component[index])
+		&& (infos->forbidden_words==NULL
+			|| NO_VALUE_INDEX==get_value_index(current_component,infos->forbidden_words,DONT_INSERT))) {
+		struct dutch_prefix* p=(struct dutch_prefix*)malloc(sizeof(struct dutch_prefix)
+		                                                   +pos_in_current_component*sizeof(unichar));
+		if (p==NULL) {
+			fatal_alloc_error("get_dutch_prefixes");
 		}
+		memcpy(p->component,current_component,(pos_in_current_component+1)*sizeof(unichar));
+		p->index=index;
+		p->length=pos_in_current_component;
+		vector_ptr_add(prefixes,p);
 	}
 	/* Once we have finished to deal with the current final dictionary node,
 	 * we go on because we may match a longer word */
@@ -673,17 +626,161 @@ else {
 	c=c-32768;
 	t=offset+2;
 }
+if (word[pos_in_current_component]=='\0') {
+	/* If we are at the end of the word, we have nothing more to do */
+	return;
+}
 /* We examine each transition that goes out from the node */
 for (int i=0;i<c;i++) {
-	if (is_equal_or_uppercase((unichar)(infos->bin[t]*256+infos->bin[t+1]),word_to_analyze[pos_in_word_to_analyze],infos->alphabet)) {
+	unichar letter=(unichar)(infos->bin[t]*256+infos->bin[t+1]);
+	if (is_equal_or_uppercase(letter,word[pos_in_current_component],infos->alphabet)) {
 		/* If the transition's letter is case compatible with the current letter of the
 		 * word to analyze, we follow it */
 		index=infos->bin[t+2]*256*256+infos->bin[t+3]*256+infos->bin[t+4];
-		current_component[pos_in_current_component]=(unichar)(infos->bin[t]*256+infos->bin[t+1]);
-		explore_state_dutch(index,current_component,pos_in_current_component+1,word_to_analyze,pos_in_word_to_analyze+1,
-			analysis,output_dela_line,L,number_of_components,infos);
+		current_component[pos_in_current_component]=letter;
+		get_dutch_prefixes(index,current_component,pos_in_current_component+1,word,prefixes,infos);
 	}
 	/* We move the offset to the next transition */
 	t=t+5;
 }
 }
+
+
+/**
+ * This function returns the decompositions of the given word suffix, in the
+ * order in which they are found. Since many words share the same suffixes,
+ * they are kept in the memo of 'infos', but only for the suffixes that start
+ * with a component: most suffixes do not, and looking them up in the
+ * dictionary is cheaper than hashing them. A suffix without decomposition
+ * is stored with a NULL value, so that it only costs its key.
+ */
+static const vector_ptr* analyse_dutch_suffix(const unichar* suffix,struct dutch_infos* infos) {
+static const vector_ptr no_decomposition={0,NULL,0};
+unichar current_component[4096];
+vector_ptr* prefixes=new_vector_ptr(8);
+get_dutch_prefixes(4,current_component,0,suffix,prefixes,infos);
+if (prefixes->nbelems==0) {
+	free_vector_ptr(prefixes,free);
+	return &no_decomposition;
+}
+int ret;
+struct any* value=get_value(infos->memo,(void*)suffix,HT_INSERT_IF_NEEDED,&ret);
+if (ret==HT_KEY_ALREADY_THERE) {
+	free_vector_ptr(prefixes,free);
+	return (value->_ptr!=NULL)?(const vector_ptr*)value->_ptr:&no_decomposition;
+}
+value->_ptr=NULL;
+vector_ptr* res=new_vector_ptr(4);
+get_dutch_decompositions(suffix,0,prefixes,res,infos);
+free_vector_ptr(prefixes,free);
+if (res->nbelems==0) {
+	free_vector_ptr(res);
+	res=NULL;
+}
+value->_ptr=res;
+return (res!=NULL)?res:&no_decomposition;
+}
+
+
+/**
+ * This function decomposes the given word into valid sequences of simple words,
+ * and adds the decompositions to 'res' in the order in which they are found.
+ * For instance, if we have the word "Sommervarmt", we will first
+ * explore the dictionary and find that "sommer" is a valid left component that
+ * corresponds to the dictionary entry "sommer,.N:msia". Then we will
+ * look for the decompositions of the rest of the word, "varmt". It is
+ * in the dictionary, with the entry "varmt,varm.A:nsio". As "varmt" is a
+ * valid rightmost component, we get the decomposition:
+ *
+ * 'decomposition'="sommer,.N:msia +++ varmt,varm.A:nsio"
+ * 'components'="sommer", and the DELA line "sommervarmt,sommervarm.A:nsio"
+ * 'n_parts'=2
+ *
+ * Note that the initial "S" was put in lowercase, because the dictionary
+ * contains "sommer" and not "Sommer". The lemma is obtained with
+ * the lemma of the rightmost component (here "varm"), and the word inherits
+ * from the grammatical information of its rightmost component.
+ *
+ * 'prefixes' are the components that start the word, as given by
+ * get_dutch_prefixes. 'whole_word' is non null if 'word' is the word to
+ * analyze, and 0 if it is the end of it. In that case, the decompositions
+ * start with the " +++ " mark and the last component must be a valid right one.
+ */
+static void get_dutch_decompositions(const unichar* word,int whole_word,const vector_ptr* prefixes,
+                                     vector_ptr* res,struct dutch_infos* infos) {
+for (int i=0;i<prefixes->nbelems;i++) {
+	struct dutch_prefix* p=(struct dutch_prefix*)prefixes->tab[i];
+	if (word[p->length]=='\0') {
+		/* If we have explored the entire word, we will look at all the
+		 * INF codes of the last component in order to produce analysis */
+		for (struct list_ustring* l=infos->inf->codes[p->index];l!=NULL;l=l->next) {
+			/* We keep the analysis only if the last component is a valid
+			 * right one, or if we find out that the word to analyze was
+			 * in fact a simple word in the dictionary */
+			if (!whole_word && !check_valid_right_component_for_one_INF_code_dutch(l->string)) {
+				continue;
+			}
+			unichar entry[4096];
+			/* We get the dictionary line that corresponds to the current INF code */
+			uncompress_entry(p->component,l->string,entry);
+			/* Then we tokenize it in order to obtain its lemma and
+			 * grammatical/inflectional information */
+			struct dela_entry* tmp_entry=tokenize_DELAF_line(entry,1);
+			if (tmp_entry==NULL) {
+				/* If there was an error in the dictionary, we skip the entry */
+				continue;
+			}
+			unichar codes[4096];
+			u_strcpy(codes,".");
+			u_strcat(codes,tmp_entry->semantic_codes[0]);
+			int k;
+			for (k=1;k<tmp_entry->n_semantic_codes;k++) {
+				u_strcat(codes,"+");
+				u_strcat(codes,tmp_entry->semantic_codes[k]);
+			}
+			for (k=0;k<tmp_entry->n_inflectional_codes;k++) {
+				u_strcat(codes,":");
+				u_strcat(codes,tmp_entry->inflectional_codes[k]);
+			}
+			unichar head[4096];
+			u_strcpy(head,whole_word?"":" +++ ");
+			u_strcat(head,entry);
+			vector_ptr_add(res,new_word_decomposition_dutch(1,head,U_EMPTY,U_EMPTY,0,U_EMPTY,
+					tmp_entry->inflected,tmp_entry->lemma,codes));
+			free_dela_entry(tmp_entry);
+		}
+		continue;
+	}
+	/* Otherwise, the component is a valid left one. In order to print it
+	 * in the analysis, we arbitrary take a valid left component among
+	 * all those that are available for it */
+	unichar sia_code[4096];
+	unichar entry[4096];
+	unichar head[4096];
+	get_first_valid_left_component_dutch(infos->inf->codes[p->index],sia_code);
+	uncompress_entry(p->component,sia_code,entry);
+	if (word[p->length]=='s') {
+		/* We look first if we are in the case of a word followed by a "s".
+		 * If so, the "s" is put in the analysis and the last letter of the
+		 * component is removed from the DELA line */
+		u_strcpy(head,whole_word?"":" +++");
+		u_strcat(head,entry);
+		u_strcat(head," +++ s");
+		const vector_ptr* tails=analyse_dutch_suffix(word+p->length+1,infos);
+		for (int j=0;j<tails->nbelems;j++) {
+			struct word_decomposition* tail=(struct word_decomposition*)tails->tab[j];
+			vector_ptr_add(res,new_word_decomposition_dutch(tail->n_parts+1,head,tail->decomposition,
+					p->component,p->length-1,tail->components,tail->inflected,tail->lemma,tail->codes));
+		}
+	}
+	/* Now, we try to analyze the rest of the word normally */
+	u_strcpy(head,whole_word?"":" +++ ");
+	u_strcat(head,entry);
+	const vector_ptr* tails=analyse_dutch_suffix(word+p->length,infos);
+	for (int j=0;j<tails->nbelems;j++) {
+		struct word_decomposition* tail=(struct word_decomposition*)tails->tab[j];
+		vector_ptr_add(res,new_word_decomposition_dutch(tail->n_parts+1,head,tail->decomposition,
+				p->component,p->length,tail->components,tail->inflected,tail->lemma,tail->codes));
+	}
+}
+}
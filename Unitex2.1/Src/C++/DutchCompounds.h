@@ -28,7 +28,7 @@
 
 
 void analyse_dutch_unknown_words(const Alphabet*,const unsigned char*,const struct INF_codes*,U_FILE*,
-									U_FILE*,U_FILE*,U_FILE*,struct string_hash*);
+									U_FILE*,U_FILE*,U_FILE*,struct string_hash*,int);
 
 
 #endif
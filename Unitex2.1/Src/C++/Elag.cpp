@@ -51,6 +51,8 @@ const char* usage_Elag =
          "  -l LANG/--language=LANG: language definition file\n"
          "  -r RULES/--rules=RULES: compiled elag rules file\n"
          "  -o OUT/--output=OUT: resulting output .tfst file\n"
+         "  --threads=N: disambiguates N sentences at the same time (default=1).\n"
+         "               If N is 0, one thread is used per processor\n"
          "  -h/--help: this help\n"
          "\n"
          "Disambiguate the input text automaton <tfst> using the specified compiled elag rules.\n";
@@ -70,6 +72,7 @@ const struct option_TS lopts_Elag[]= {
       {"input_encoding",required_argument_TS,NULL,'k'},
       {"output_encoding",required_argument_TS,NULL,'q'},
       {"help",no_argument_TS,NULL,'h'},
+      {"threads",required_argument_TS,NULL,1},
       {NULL,no_argument_TS,NULL,0}
 };
 
@@ -88,6 +91,8 @@ char language[FILENAME_MAX]="";
 char rule_file[FILENAME_MAX]="";
 char output_tfst[FILENAME_MAX]="";
 char directory[FILENAME_MAX]="";
+int n_threads=1;
+char foo;
 struct OptVars* vars=new_OptVars();
 while (EOF!=(val=getopt_long_TS(argc,argv,optstring_Elag,lopts_Elag,&index,vars))) {
    switch(val) {
@@ -117,6 +122,10 @@ while (EOF!=(val=getopt_long_TS(argc,argv,optstring_Elag,lopts_Elag,&index,vars)
              decode_writing_encoding_parameter(&encoding_output,&bom_output,vars->optarg);
              break;
    case 'h': usage(); return 0;
+   case 1: if (1!=sscanf(vars->optarg,"%d%c",&n_threads,&foo) || n_threads<0) {
+                fatal_error("Invalid number of threads: %s\n",vars->optarg);
+             }
+             break;
    case ':': if (index==-1) fatal_error("Missing argument for option -%c\n",vars->optopt);
              else fatal_error("Missing argument for option --%s\n",lopts_Elag[index].name);
    case '?': if (index==-1) fatal_error("Invalid option -%c\n",vars->optopt);
@@ -153,7 +162,7 @@ if ((grammars=load_elag_grammars(rule_file,lang,directory)) == NULL) {
    fatal_error("Unable to load grammar %s", rule_file);
 }
 u_printf("Grammars are loaded.\n");
-remove_ambiguities(input_tfst,grammars,output_tfst,encoding_output,bom_output,lang);
+remove_ambiguities(input_tfst,grammars,output_tfst,encoding_output,bom_output,lang,n_threads);
 free_language_t(lang);
 free_vector_ptr(grammars,(release_f)free_Fst2Automaton_including_symbols);
 free_OptVars(vars);
@@ -43,18 +43,142 @@
 #include "Ustring.h"
 #include "TfstStats.h"
 #include "HashTable.h"
+#include "AbstractCallbackFuncModifier.h"
+#include "logger/SyncLogger.h"
 
 
 static void add_sentence_delimiters(Tfst* tfst,language_t*);
 static void remove_sentence_delimiters(Tfst* tfst,language_t*);
-vector_ptr* convert_elag_symbols_to_tfst_tags(Elag_Tfst_file_in*);
+vector_ptr* convert_elag_symbols_to_tfst_tags(Tfst*);
+
+static const unichar SENTENCE_DELIMITER[] = { '{', 'S', '}', 0 };
+
+/* Sentences are disambiguated by batches of ELAG_SENTENCES_PER_THREAD sentences
+ * per thread. Each batch is processed by the threads and then saved in sentence
+ * order */
+#define ELAG_SENTENCES_PER_THREAD 16
+
+
+/**
+ * A sentence of the batch. 'tfst' contains the sentence as it was loaded from the
+ * input text automaton. The other fields are set by 'disambiguate_sentence'.
+ */
+struct elag_sentence {
+   Tfst* tfst;
+
+   /* The tags of the disambiguated sentence automaton */
+   vector_ptr* new_tags;
+
+   /* 1 if the sentence automaton was empty */
+   int unloadable;
+   /* 1 if the sentence automaton was empty once delimited by {S} */
+   int empty;
+   /* 1 if the sentence was rejected by a grammar */
+   int rejected;
+
+   /* Ambiguity and length of the sentence before and after the disambiguation */
+   double before;
+   double after;
+   double length_before;
+   double length_after;
+};
+
+
+/**
+ * This structure describes the work of one thread: it disambiguates the sentences
+ * first, first+step, first+2*step, ... of the batch. The grammars and the language
+ * are shared with the other threads, since they are only read once the sentences
+ * have been loaded.
+ */
+struct elag_job {
+   const SingleGraph* grammars;
+   int n_grammars;
+   language_t* language;
+   struct elag_sentence* sentences;
+   int n_sentences;
+   int first;
+   int step;
+};
+
+
+/**
+ * Disambiguates the given sentence with the given grammars, and replaces its
+ * symbols by tfst tags.
+ */
+static void disambiguate_sentence(struct elag_sentence* s,const SingleGraph* grammars,int n_grammars,
+                                  language_t* language) {
+   Tfst* tfst=s->tfst;
+   double before, after;
+   s->unloadable=0;
+   s->empty=0;
+   s->rejected=0;
+   s->before=s->after=0.0;
+   s->length_before=s->length_after=0.0;
+   elag_determinize(language,tfst->automaton,free_symbol);
+   elag_minimize(tfst->automaton);
+   if (tfst->automaton->number_of_states<2) {
+      /* If the sentence is empty, we replace the sentence automaton
+       * by a 1-state automaton with no transition. */
+      free_SingleGraph(tfst->automaton,free_symbol);
+      tfst->automaton=new_SingleGraph(1,PTR_TAGS);
+      SingleGraphState initial_state=add_state(tfst->automaton);
+      set_initial_state(initial_state);
+      s->unloadable=1;
+   } else {
+      int min,max;
+      before=evaluate_ambiguity(tfst->automaton,&min,&max);
+      s->before=before;
+      s->length_before=((double) (min + max) / (double) 2);
+      add_sentence_delimiters(tfst,language);
+      if (tfst->automaton->number_of_states<2) {
+         s->empty=1;
+      } else if (n_grammars>0) {
+         /* The sentence is intersected with all the grammars at once */
+         SingleGraph temp=elag_text_intersection(tfst->automaton,grammars,n_grammars);
+         trim(temp,free_symbol);
+         free_SingleGraph(tfst->automaton,free_symbol);
+         tfst->automaton=temp;
+         if (tfst->automaton->number_of_states<2) {
+            /* If the sentence has been rejected by a grammar */
+            free_SingleGraph(tfst->automaton,free_symbol);
+            tfst->automaton=new_SingleGraph(1,PTR_TAGS);
+            SingleGraphState initial_state=add_state(tfst->automaton);
+            set_initial_state(initial_state);
+            s->rejected=1;
+         }
+      }
+      if (!s->rejected) {
+         elag_determinize(language,tfst->automaton,free_symbol);
+         trim(tfst->automaton,free_symbol);
+         elag_minimize(tfst->automaton);
+         remove_sentence_delimiters(tfst,language);
+         after = evaluate_ambiguity(tfst->automaton,&min,&max);
+         s->after=after;
+         s->length_after=((double) (min + max) / (double) 2);
+      }
+   }
+   s->new_tags=convert_elag_symbols_to_tfst_tags(tfst);
+}
+
+
+/**
+ * Disambiguates the sentences of the given job.
+ */
+static void SYNC_CALLBACK_UNITEX disambiguate_sentences(void* privateDataPtr,unsigned int /*iNbThread*/) {
+   struct elag_job* job=(struct elag_job*)privateDataPtr;
+   for (int i=job->first;i<job->n_sentences;i=i+job->step) {
+      disambiguate_sentence(&(job->sentences[i]),job->grammars,job->n_grammars,job->language);
+   }
+}
 
 
 /**
  * This function loads a .tfst text automaton, disambiguates it according to the given rules,
- * and saves the result in another text automaton.
+ * and saves the result in another text automaton. Sentences are disambiguated by 'n_threads'
+ * threads (one per processor if 'n_threads' is 0).
  */
-void remove_ambiguities(char* input_tfst,vector_ptr* gramms,char* output,Encoding encoding_output,int bom_output,language_t* language) {
+void remove_ambiguities(char* input_tfst,vector_ptr* gramms,char* output,Encoding encoding_output,int bom_output,
+                        language_t* language,int n_threads) {
    Elag_Tfst_file_in* input=load_tfst_file(input_tfst,language);
    if (input==NULL) {
       fatal_error("Unable to load text automaton'%s'\n",input_tfst);
@@ -74,12 +198,14 @@ void remove_ambiguities(char* input_tfst,vector_ptr* gramms,char* output,Encodin
    if (output_tind==NULL) {
       fatal_error("Cannot open %s\n",tind);
    }
+   char tfstb[FILENAME_MAX];
+   get_tfst_binary_name(output,tfstb);
+   struct tfst_binary_writer* output_tfstb=new_tfst_binary_writer(tfstb);
 
    time_t start_time = time(0);
    u_printf("\nProcessing ...\n");
    int n_rejected_sentences = 0;
    int nb_unloadable = 0;
-   double before, after;
    double total_before = 0.0, total_after = 0.0;
    double length_before = 0., length_after = 0.; // average text length in words
    Tfst* tfst=input->tfst;
@@ -88,74 +214,96 @@ void remove_ambiguities(char* input_tfst,vector_ptr* gramms,char* output,Encodin
    struct hash_table* form_frequencies=new_hash_table((HASH_FUNCTION)hash_unichar,(EQUAL_FUNCTION)u_equal,
            (FREE_FUNCTION)free,NULL,(KEYCOPY_FUNCTION)keycopy);
 
-   for (int current_sentence=1;current_sentence<=input->tfst->N;current_sentence++) {
-      load_tfst_sentence_automaton(input,current_sentence);
-      elag_determinize(language,tfst->automaton,free_symbol);
-      elag_minimize(tfst->automaton);
-      int is_rejected=0;
-      if (current_sentence % 100 == 0) {
-         u_printf("Sentence %d/%d...\r",current_sentence,input->tfst->N);
+   /* The sentence delimiter is added to the language now, so that the
+    * threads never have to modify it */
+   language_add_form(language,SENTENCE_DELIMITER);
+   if (n_threads<=0) {
+      n_threads=(int)SyncGetNumberOfProcessors();
+   }
+   if (n_threads>1 && !IsSeveralThreadsPossible()) {
+      n_threads=1;
+   }
+   int batch_size=n_threads*ELAG_SENTENCES_PER_THREAD;
+   struct elag_sentence* sentences=(struct elag_sentence*)malloc(batch_size*sizeof(struct elag_sentence));
+   struct elag_job* jobs=(struct elag_job*)malloc(n_threads*sizeof(struct elag_job));
+   void** job_ptrs=(void**)malloc(n_threads*sizeof(void*));
+   SingleGraph* grammars=(SingleGraph*)malloc((gramms->nbelems+1)*sizeof(SingleGraph));
+   if (sentences==NULL || jobs==NULL || job_ptrs==NULL || grammars==NULL) {
+      fatal_alloc_error("remove_ambiguities");
+   }
+   for (int j=0;j<gramms->nbelems;j++) {
+      grammars[j]=((Fst2Automaton*)(gramms->tab[j]))->automaton;
+   }
+   for (int i=0;i<batch_size;i++) {
+      sentences[i].tfst=new_Tfst(NULL,NULL,tfst->N);
+   }
+   for (int t=0;t<n_threads;t++) {
+      jobs[t].grammars=grammars;
+      jobs[t].n_grammars=gramms->nbelems;
+      jobs[t].language=language;
+      jobs[t].sentences=sentences;
+      jobs[t].first=t;
+      jobs[t].step=n_threads;
+      job_ptrs[t]=&(jobs[t]);
+   }
+
+   for (int first_sentence=1;first_sentence<=tfst->N;first_sentence=first_sentence+batch_size) {
+      /* We load a batch of sentences. This is done by the main thread, because
+       * loading symbols may add forms to the language */
+      int n=0;
+      for (int current_sentence=first_sentence;n<batch_size && current_sentence<=tfst->N;current_sentence++) {
+         load_tfst_sentence_automaton(input,current_sentence);
+         move_current_sentence(tfst,sentences[n++].tfst);
       }
-      u_printf("Sentence %d\n",current_sentence);
-      if (tfst->automaton->number_of_states<2) {
-         /* If the sentence is empty, we replace the sentence automaton
-          * by a 1-state automaton with no transition. */
-    	 error("Sentence %d is empty\n",current_sentence);
-         free_SingleGraph(tfst->automaton,free_symbol);
-         tfst->automaton=new_SingleGraph(1,PTR_TAGS);
-         SingleGraphState initial_state=add_state(tfst->automaton);
-         set_initial_state(initial_state);
-         nb_unloadable++;
+      for (int t=0;t<n_threads;t++) {
+         jobs[t].n_sentences=n;
+      }
+      if (n_threads>1) {
+         SyncDoRunThreads(n_threads,disambiguate_sentences,job_ptrs);
       } else {
-         int min,max;
-         before=evaluate_ambiguity(tfst->automaton,&min,&max);
-         total_before += before;
-         length_before = length_before + ((double) (min + max) / (double) 2);
-         add_sentence_delimiters(tfst,language);
-         if (tfst->automaton->number_of_states<2) {
-            error("Sentence %d is empty\n",current_sentence) ;
-         } else {
-            for (int j=0;j<gramms->nbelems;j++) {
-               Fst2Automaton* grammar=(Fst2Automaton*)(gramms->tab[j]);
-               SingleGraph temp=elag_intersection(language,tfst->automaton,grammar->automaton,TEXT_GRAMMAR);
-               trim(temp,free_symbol);
-               free_SingleGraph(tfst->automaton,free_symbol);
-               tfst->automaton=temp;
-               if (tfst->automaton->number_of_states<2) {
-                  /* If the sentence has been rejected by the grammar */
-                  error("Sentence %d rejected\n\n",current_sentence);
-                  j=gramms->nbelems; /* We don't go on intersecting with other grammars */
-                  n_rejected_sentences++;
-                  free_SingleGraph(tfst->automaton,free_symbol);
-                  tfst->automaton=new_SingleGraph(1,PTR_TAGS);
-                  SingleGraphState initial_state=add_state(tfst->automaton);
-                  set_initial_state(initial_state);
-                  is_rejected=1;
-                  break;
-               }
-            }
+         disambiguate_sentences(job_ptrs[0],0);
+      }
+      /* And we save them in sentence order */
+      for (int i=0;i<n;i++) {
+         struct elag_sentence* s=&(sentences[i]);
+         int current_sentence=s->tfst->current_sentence;
+         if (current_sentence % 100 == 0) {
+            u_printf("Sentence %d/%d...\r",current_sentence,tfst->N);
+         }
+         u_printf("Sentence %d\n",current_sentence);
+         if (s->unloadable) {
+            error("Sentence %d is empty\n",current_sentence);
+            nb_unloadable++;
          }
-         if (!is_rejected) {
-            elag_determinize(language,tfst->automaton,free_symbol);
-            trim(tfst->automaton,free_symbol);
-            elag_minimize(tfst->automaton);
-            remove_sentence_delimiters(tfst,language);
-            after = evaluate_ambiguity(tfst->automaton,&min,&max);
-            total_after += after;
-            length_after = length_after + ((double) (min + max) / (double) 2);
+         if (s->empty) {
+            error("Sentence %d is empty\n",current_sentence);
          }
+         if (s->rejected) {
+            error("Sentence %d rejected\n\n",current_sentence);
+            n_rejected_sentences++;
+         }
+         total_before += s->before;
+         total_after += s->after;
+         length_before = length_before + s->length_before;
+         length_after = length_after + s->length_after;
+         save_current_sentence(s->tfst,output_tfst,output_tind,output_tfstb,(unichar**)s->new_tags->tab,s->new_tags->nbelems,form_frequencies);
+         free_vector_ptr(s->new_tags,free);
+         free_current_sentence(s->tfst);
       }
-      vector_ptr* new_tags=convert_elag_symbols_to_tfst_tags(input);
-      save_current_sentence(input->tfst,output_tfst,output_tind,(unichar**)new_tags->tab,new_tags->nbelems,form_frequencies);
-      free_vector_ptr(new_tags,free);
-      free_SingleGraph(tfst->automaton,NULL);
-      tfst->automaton=NULL;
    }
+   for (int i=0;i<batch_size;i++) {
+      close_text_automaton(sentences[i].tfst);
+   }
+   free(job_ptrs);
+   free(jobs);
+   free(sentences);
+   free(grammars);
    u_printf("\n");
    int N=input->tfst->N;
    tfst_file_close_in(input);
    u_fclose(output_tfst);
    u_fclose(output_tind);
+   close_tfst_binary_writer(output_tfstb,output);
    time_t end_time = time(0);
    u_printf("\n*** Done. Result in '%s'\n",output);
    u_printf("\nElapsed time: %.0f s.\n", difftime(end_time,start_time));
@@ -254,6 +402,9 @@ void explode_tfst(char* input_tfst,char* output,Encoding encoding_output,int bom
    if (output_tind==NULL) {
       fatal_error("Cannot open %s\n",tind);
    }
+   char tfstb[FILENAME_MAX];
+   get_tfst_binary_name(output,tfstb);
+   struct tfst_binary_writer* output_tfstb=new_tfst_binary_writer(tfstb);
    u_printf("\nProcessing ...\n");
    Tfst* tfst=input->tfst;
 
@@ -264,14 +415,15 @@ void explode_tfst(char* input_tfst,char* output,Encoding encoding_output,int bom
       if (current_sentence % 100 == 0) {
          u_printf("Sentence %d/%d...\r",current_sentence,input->tfst->N);
       }
-      vector_ptr* new_tags=convert_elag_symbols_to_tfst_tags(input);
-      save_current_sentence(input->tfst,output_tfst,output_tind,(unichar**)new_tags->tab,new_tags->nbelems,
+      vector_ptr* new_tags=convert_elag_symbols_to_tfst_tags(input->tfst);
+      save_current_sentence(input->tfst,output_tfst,output_tind,output_tfstb,(unichar**)new_tags->tab,new_tags->nbelems,
 								 form_frequencies);
       free_vector_ptr(new_tags,free);
    }
    tfst_file_close_in(input);
    u_fclose(output_tfst);
    u_fclose(output_tind);
+   close_tfst_binary_writer(output_tfstb,output);
    free_symbol(unloadable);
    free_symbol(rejected);
 }
@@ -329,8 +481,7 @@ return grammars;
  * Adds {S} at the beginning and end of the sentence automaton.
  */
 static void add_sentence_delimiters(Tfst* tfst,language_t* language) {
-static const unichar S[] = { '{', 'S', '}', 0 };
-int idx=language_add_form(language,S);
+int idx=language_add_form(language,SENTENCE_DELIMITER);
 symbol_t* delimiter=new_symbol_PUNC(language,idx,-1);
 int pseudo_initial_state_index=tfst->automaton->number_of_states;
 SingleGraphState pseudo_initial_state=add_state(tfst->automaton);
@@ -452,11 +603,11 @@ return vector_ptr_add(tags,u_strdup(tag));
  * tfst tag strings like "@STD\n@{fait,faire.V:P3s:Kms}\n@2-2\n.\n"
  * We replace symbol_t* by integers that are indexes in the vector we return.
  */
-vector_ptr* convert_elag_symbols_to_tfst_tags(Elag_Tfst_file_in* input) {
+vector_ptr* convert_elag_symbols_to_tfst_tags(Tfst* tfst) {
 /* We change the tag type */
-input->tfst->automaton->tag_type=INT_TAGS;
+tfst->automaton->tag_type=INT_TAGS;
 vector_ptr* tags=new_vector_ptr(16);
-SingleGraph automaton=input->tfst->automaton;
+SingleGraph automaton=tfst->automaton;
 unichar tmp[4096];
 TfstTag* foo_tag=new_TfstTag(T_STD);
 Ustring* foo_content=new_Ustring(256);
@@ -470,7 +621,7 @@ for (int i=0;i<automaton->number_of_states;i++) {
       if (symbol->tfsttag_index==-1) {
          fatal_error("Internal error in convert_elag_symbols_to_tfst_tags: unexpected -1 tag index for this tag:\n%S\n",foo_content->str);
       }
-      TfstTag* original_tag=(TfstTag*)input->tfst->tags->tab[symbol->tfsttag_index];
+      TfstTag* original_tag=(TfstTag*)tfst->tags->tab[symbol->tfsttag_index];
       symbol_to_tfst_tag(symbol,original_tag,foo_tag,foo_content,tmp);
       t->tag_number=insert_tag(tags,tmp);
       t=t->next;
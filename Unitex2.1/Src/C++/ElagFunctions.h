@@ -31,7 +31,7 @@
 #include "Vector.h"
 #include "LanguageDefinition.h"
 
-void remove_ambiguities(char* input_tfst,vector_ptr* grammars,char* output_tfst,Encoding,int,language_t* language);
+void remove_ambiguities(char* input_tfst,vector_ptr* grammars,char* output_tfst,Encoding,int,language_t* language,int n_threads);
 void explode_tfst(char* input_tfst,char* output_tfst,Encoding,int,language_t* language,struct hash_table* form_frequencies);
 vector_ptr* load_elag_grammars(char* filename,language_t* language,char* directory);
 
@@ -213,9 +213,16 @@ if (capacity<=0) {
    capacity=1;
 }
 s->state_sets=(state_set**)malloc(sizeof(state_set*)*capacity);
-if (s->state_sets==NULL) {
+s->hash_code=(unsigned int*)malloc(sizeof(unsigned int)*capacity);
+s->hash_next=(int*)malloc(sizeof(int)*capacity);
+s->hash_first=(int*)malloc(sizeof(int)*capacity);
+if (s->state_sets==NULL || s->hash_code==NULL || s->hash_next==NULL || s->hash_first==NULL) {
    fatal_alloc_error("new_state_set_array");
 }
+for (int i=0;i<capacity;i++) {
+   s->hash_first[i]=-1;
+}
+s->hash_size=capacity;
 s->capacity=capacity;
 s->size=0;
 return s;
@@ -231,10 +238,25 @@ for (int i=0;i<s->size;i++) {
    free_state_set(s->state_sets[i]);
 }
 free(s->state_sets);
+free(s->hash_code);
+free(s->hash_next);
+free(s->hash_first);
 free(s);
 }
 
 
+/**
+ * Returns a hash code for the given state set.
+ */
+static unsigned int hash_state_set(state_set* s) {
+unsigned int h=s->size;
+for (state_id* id=s->state_list;id!=NULL;id=id->next) {
+   h=h*31+id->state_number;
+}
+return h;
+}
+
+
 /**
  * Adds a copy of the given state set to the given state set array.
  * The function returns the index of the state set.
@@ -244,12 +266,30 @@ if (ARRAY->size==ARRAY->capacity) {
    /* If necessary, we enlarge the array doubling its capacity */
    ARRAY->capacity=ARRAY->capacity*2;
    ARRAY->state_sets=(state_set**)realloc(ARRAY->state_sets,ARRAY->capacity*sizeof(state_set*));
-   if (ARRAY->state_sets==NULL) {
+   ARRAY->hash_code=(unsigned int*)realloc(ARRAY->hash_code,ARRAY->capacity*sizeof(unsigned int));
+   ARRAY->hash_next=(int*)realloc(ARRAY->hash_next,ARRAY->capacity*sizeof(int));
+   ARRAY->hash_first=(int*)realloc(ARRAY->hash_first,ARRAY->capacity*sizeof(int));
+   if (ARRAY->state_sets==NULL || ARRAY->hash_code==NULL || ARRAY->hash_next==NULL || ARRAY->hash_first==NULL) {
       fatal_alloc_error("state_set_array_add");
    }
+   /* And we rebuild the hash index */
+   ARRAY->hash_size=ARRAY->capacity;
+   for (int i=0;i<ARRAY->hash_size;i++) {
+      ARRAY->hash_first[i]=-1;
+   }
+   for (int i=0;i<ARRAY->size;i++) {
+      int h=ARRAY->hash_code[i]%ARRAY->hash_size;
+      ARRAY->hash_next[i]=ARRAY->hash_first[h];
+      ARRAY->hash_first[h]=i;
+   }
 }
-ARRAY->state_sets[ARRAY->size++]=clone_state_set(s);
-return ARRAY->size-1;
+int n=ARRAY->size++;
+ARRAY->state_sets[n]=clone_state_set(s);
+ARRAY->hash_code[n]=hash_state_set(s);
+int h=ARRAY->hash_code[n]%ARRAY->hash_size;
+ARRAY->hash_next[n]=ARRAY->hash_first[h];
+ARRAY->hash_first[h]=n;
+return n;
 }
 
 
@@ -258,8 +298,9 @@ return ARRAY->size-1;
  * state set array. It returns its index, or -1 if not found.
  */
 int state_set_array_lookup(state_set_array* ARRAY,state_set* s) {
-for (int i=0;i<ARRAY->size;i++) {
-   if (state_set_equals(ARRAY->state_sets[i],s)) {
+unsigned int code=hash_state_set(s);
+for (int i=ARRAY->hash_first[code%ARRAY->hash_size];i!=-1;i=ARRAY->hash_next[i]) {
+   if (ARRAY->hash_code[i]==code && state_set_equals(ARRAY->state_sets[i],s)) {
       return i;
    }
 }
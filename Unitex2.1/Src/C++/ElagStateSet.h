@@ -94,6 +94,15 @@ typedef struct {
    int size;
    /* The maximum size of the array */
    int capacity;
+   /* The state sets are also indexed by their hash codes, so that a lookup
+    * does not have to compare the given set with all the sets of the array.
+    * hash_first[h] is the index of the first set whose hash code modulo
+    * hash_size is h, or -1, and hash_next[i] is the index of the next set
+    * with the same h as the set #i */
+   unsigned int* hash_code;
+   int* hash_next;
+   int* hash_first;
+   int hash_size;
 } state_set_array;
 
 
@@ -31,6 +31,7 @@
 #include "Snt.h"
 #include "UnitexGetOpt.h"
 #include "Extract.h"
+#include "TextOffsets.h"
 
 
 const char* usage_Extract =
@@ -172,8 +173,12 @@ if (result==NULL) {
    free_text_tokens(tok);
    return 1;
 }
+/* If Tokenize has built the text.ofs index, we use it */
+struct text_offsets* offsets=load_text_offsets(snt_files->text_ofs,(int)(af_get_mapfile_size(text)/sizeof(int)),
+                                               tok->SENTENCE_MARKER);
 free_snt_files(snt_files);
-extract_units(extract_matching_units,text,tok,concord,result);
+extract_units(extract_matching_units,text,offsets,tok,concord,result);
+free_text_offsets(offsets);
 af_close_mapfile(text);
 u_fclose(concord);
 u_fclose(result);
@@ -37,16 +37,20 @@ struct extract_buf_mapped {
 
 void read_one_sentence(struct extract_buf_mapped*,struct text_tokens*,int*);
 struct match_list* is_a_match_in_the_sentence(struct match_list*,int*,int,int);
+static void extract_matching_units_with_offsets(const int*,struct text_offsets*,struct text_tokens*,
+                                                struct match_list*,U_FILE*);
 
 
 /**
  * This function takes a concordance index file and a .snt text file and it builds
  * an output file 'result' made of all sentences that contain an
  * occurrence. if 'extract_matching_units' is null, the function extracts
- * all sentences that do NOT contain any occurrence.
+ * all sentences that do NOT contain any occurrence. If 'offsets' is not NULL,
+ * the sentences that contain an occurrence are reached without reading the
+ * whole text.
  */
-void extract_units(char extract_matching_units,ABSTRACTMAPFILE* snt,struct text_tokens* tokens,
-                   U_FILE* concord,U_FILE* result) {
+void extract_units(char extract_matching_units,ABSTRACTMAPFILE* snt,struct text_offsets* offsets,
+                   struct text_tokens* tokens,U_FILE* concord,U_FILE* result) {
 int N_TOKENS_READ;
 OutputPolicy output_policy;
 int current_beginning,current_end,RESULT;
@@ -64,6 +68,12 @@ buffer->nb_item=af_get_mapfile_size(buffer->amf)/sizeof(int);
 buffer->pos=0;
 buffer->pos_read=0;
 
+if (offsets!=NULL && extract_matching_units) {
+   extract_matching_units_with_offsets(buffer->int_buffer_,offsets,tokens,l,result);
+   af_release_mapfile_pointer(buffer->amf,buffer->int_buffer_);
+   free(buffer);
+   return;
+}
 read_one_sentence(buffer,tokens,&N_TOKENS_READ);
 u_printf("Extracting %smatching units...\n",extract_matching_units?"":"un");
 while (buffer->pos < buffer->nb_item) {
@@ -91,6 +101,42 @@ free(buffer);
 }
 
 
+/**
+ * Prints all the sentences that contain the start of a match of 'l', using the
+ * text.ofs index to find them. 'l' is freed.
+ */
+static void extract_matching_units_with_offsets(const int* text,struct text_offsets* offsets,
+                                                struct text_tokens* tokens,struct match_list* l,
+                                                U_FILE* result) {
+int last_sentence=-1;
+struct match_list* tmp;
+u_printf("Extracting matching units...\n");
+while (l!=NULL && l->m.start_pos_in_token<offsets->n_tokens) {
+   int sentence=get_sentence_number(offsets,text,l->m.start_pos_in_token);
+   if (sentence<last_sentence) {
+      fatal_error("Error in the function extract_matching_units_with_offsets: unsorted concordance\n");
+   }
+   if (sentence!=last_sentence) {
+      int start=get_sentence_start(offsets,sentence);
+      int end=get_sentence_end(offsets,sentence);
+      if (end-start>=MAX_TOKENS_BY_SENTENCE) {
+         error("Sentence too long to be entirely displayed\n");
+         end=start+MAX_TOKENS_BY_SENTENCE;
+      }
+      for (int i=start;i<end;i++) {
+         u_fprintf(result,"%S",tokens->token[text[i]]);
+      }
+      u_fprintf(result,"\n");
+      last_sentence=sentence;
+   }
+   tmp=l;
+   l=l->next;
+   free_match_list_element(tmp);
+}
+free_match_list(l);
+}
+
+
 /**
  * This function reads a sentence in the text.
  * buffer->size will contain the length of the sentence, in the limit of MAX_TOKENS_BY_SENTENCE
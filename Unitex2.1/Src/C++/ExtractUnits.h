@@ -24,9 +24,10 @@
 
 #include <stdio.h>
 #include "Text_tokens.h"
+#include "TextOffsets.h"
 
 
-void extract_units(char,ABSTRACTMAPFILE*,struct text_tokens*,U_FILE*,U_FILE*);
+void extract_units(char,ABSTRACTMAPFILE*,struct text_offsets*,struct text_tokens*,U_FILE*,U_FILE*);
 
 
 #endif
@@ -19,6 +19,7 @@
  *
  */
 
+#include <limits.h>
 #include "FlattenFst2.h"
 #include "LocateConstants.h"
 #include "List_int.h"
@@ -41,10 +42,45 @@ void compute_dependencies_for_subgraph(Fst2*,int,struct list_int**);
 void print_dependencies(Fst2*,struct list_int**);
 int* check_for_graphs_to_keep(Fst2*,int,struct list_int**);
 int renumber_graphs_to_keep(Fst2*,int*);
-int flatten_graph(Fst2*,int,int,int,
-                  SingleGraph,
-                  int,int,int*,int*,int*);
-void remove_epsilon_transitions_in_flattened_graph(SingleGraph);
+
+#define HEIGHT_NOT_COMPUTED -1
+#define HEIGHT_IN_PROGRESS -2
+#define INFINITE_HEIGHT INT_MAX
+
+
+/**
+ * The flattened form of a graph, as it is copied for each call to this graph.
+ * Its final states are the exits of the graph. 'depth' is the depth of the
+ * calls it has been computed for, or -1 if it is the same for all depths.
+ */
+struct flattened_graph {
+   int depth;
+   SingleGraph graph;
+   int subgraph_call;
+   int subgraph_call_ignored;
+   struct flattened_graph* next;
+};
+
+
+/**
+ * The parameters of the flattening. flattened_graphs[n] is the list of the
+ * flattened forms of the graph n that have already been computed, and
+ * height[n] is the maximal length of its subgraph call chains.
+ */
+struct flatten_infos {
+   Fst2* grammar;
+   int max_depth;
+   int RTN;
+   int* new_graph_number;
+   int* height;
+   struct flattened_graph** flattened_graphs;
+};
+
+static void flatten_graph(struct flatten_infos*,int,int,SingleGraph,int*,int*);
+static struct flattened_graph* get_flattened_graph(struct flatten_infos*,int,int);
+static int copy_flattened_graph(SingleGraph,SingleGraph,int);
+static void clean_flattened_graph(SingleGraph);
+static int* compute_heights(Fst2*,struct list_int**);
 void save_graphs_to_keep(Fst2*,U_FILE*,int*);
 void save_graph_to_keep(int,Fst2*,U_FILE*,int*);
 void copy_tags_into_file(Fst2*,U_FILE*);
@@ -84,27 +120,55 @@ int n_graphs_to_keep=renumber_graphs_to_keep(origin,new_graph_number);
 #ifdef DEBUG
   print_dependencies(origin);
 #endif
+struct flatten_infos infos;
+infos.grammar=origin;
+infos.max_depth=depth;
+infos.RTN=RTN;
+infos.new_graph_number=new_graph_number;
+infos.height=compute_heights(origin,dependencies);
+infos.flattened_graphs=(struct flattened_graph**)malloc((1+origin->number_of_graphs)*sizeof(struct flattened_graph*));
+if (infos.flattened_graphs==NULL) {
+   fatal_alloc_error("flatten_fst2");
+}
 /* Now we can free liberation of the dependency structures */
 for (int i=1;i<=origin->number_of_graphs;i++) {
    free_list_int(dependencies[i]);
+   infos.flattened_graphs[i]=NULL;
 }
 free(dependencies);
 u_printf("Flattening...\n");
 /* We create the new main graph structure */
 SingleGraph new_fst2=new_SingleGraph();
-/* And we do the flattening job */
+/* And we do the flattening job, starting with graph number 1 (main graph) at depth 0 */
 int SUBGRAPH_CALL_IGNORED=0;
 int SUBGRAPH_CALL=0;
-int result=flatten_graph(origin,
-                           1, /* start with graph number 1 (main graph) */
-                           0, /* start with depth 0 */
-                           depth, /* maximal depth */
-                           new_fst2,
-                           0,
-                           RTN,
-                           &SUBGRAPH_CALL_IGNORED,
-                           &SUBGRAPH_CALL,
-                           new_graph_number);
+flatten_graph(&infos,1,0,new_fst2,&SUBGRAPH_CALL_IGNORED,&SUBGRAPH_CALL);
+set_initial_state(new_fst2->states[0]);
+int result;
+if (SUBGRAPH_CALL) {
+   /* If some subgraph calls remains, then we have an equivalent RTN */
+   result=EQUIVALENT_RTN;
+} else if (SUBGRAPH_CALL_IGNORED) {
+   /* If we have removed some subgraph calls, we have a FST that is
+    * just an approximation of the original grammar */
+   result=APPROXIMATIVE_FST;
+} else {
+   /* If there is no subgraph call and if no subgraph call was removed,
+    * then we have a FST that is strictly equivalent to the original
+    * grammar */
+   result=EQUIVALENT_FST;
+}
+/* The flattened subgraphs are not needed anymore */
+for (int i=1;i<=origin->number_of_graphs;i++) {
+   while (infos.flattened_graphs[i]!=NULL) {
+      struct flattened_graph* tmp=infos.flattened_graphs[i];
+      infos.flattened_graphs[i]=tmp->next;
+      free_SingleGraph(tmp->graph,NULL);
+      free(tmp);
+   }
+}
+free(infos.flattened_graphs);
+free(infos.height);
 /* Now, we clean the new main graph, i.e.we remove epsilon transitions
  * and unreachable states */
 u_printf("Cleaning graph...\n");
@@ -296,34 +360,75 @@ return N;
 
 
 /**
- * This function flattens the main graph:
- *  Builds an array of states that represents the flattened
- *  version of the main graph. The return value indicates if the result is
- *  an equivalent RTN, an equivalent FST or an FST approximation.
- * Recursive function: called by itself for subgraphs.
- * @param grammar the fst2 grammar to be flattened
+ * This function computes for each graph the maximal length of the subgraph
+ * call chains that start from it: 0 for a graph that calls no subgraph, 1
+ * for a graph that only calls such graphs, etc. The height of a recursive
+ * graph, or of a graph that calls a recursive one, is INFINITE_HEIGHT.
+ */
+static int compute_height(int n,int* height,struct list_int** dependencies) {
+if (height[n]==HEIGHT_IN_PROGRESS) {
+   /* If we are already computing this graph, then it is recursive */
+   return INFINITE_HEIGHT;
+}
+if (height[n]!=HEIGHT_NOT_COMPUTED) {
+   return height[n];
+}
+height[n]=HEIGHT_IN_PROGRESS;
+int h=0;
+for (struct list_int* l=dependencies[n];l!=NULL;l=l->next) {
+   int tmp=compute_height(l->n,height,dependencies);
+   if (tmp==INFINITE_HEIGHT) {
+      h=INFINITE_HEIGHT;
+      break;
+   }
+   if (tmp+1>h) {
+      h=tmp+1;
+   }
+}
+height[n]=h;
+return h;
+}
+
+
+static int* compute_heights(Fst2* grammar,struct list_int** dependencies) {
+int* height=(int*)malloc((1+grammar->number_of_graphs)*sizeof(int));
+if (height==NULL) {
+   fatal_alloc_error("compute_heights");
+}
+for (int i=1;i<=grammar->number_of_graphs;i++) {
+   height[i]=HEIGHT_NOT_COMPUTED;
+}
+for (int i=1;i<=grammar->number_of_graphs;i++) {
+   compute_height(i,height,dependencies);
+}
+return height;
+}
+
+
+/**
+ * This function flattens the graph 'n_graph' in the empty graph 'new_graph':
+ * the states of 'n_graph' are copied, and each subgraph call that must
+ * be flattened is replaced by an epsilon transition to a copy of the
+ * flattened subgraph, whose final states are linked to the destination
+ * state of the call by epsilon transitions. The final states of
+ * 'n_graph' stay final, and its initial state is the state 0. The flattened
+ * form of each subgraph is computed only once for a given depth, and it is
+ * minimized before being copied, so that the same states are not
+ * built again and again for all the calls to a same subgraph.
+ *
+ * @param infos the flattening parameters and the flattened subgraphs
  * @param n_graph number of actually treated graph
  * @param depth actual depth
- * @param max_depth maximal depth until which the grammar should be flattened
- * @param new_graph the main graph of the resulting grammar (only the main graph is flattened)
- * @param destination_state the state to which a subgraph (to be incorporated) leds
- *        for instance, if we call a transition like X --call to graph G--> Y,
- *        the state Y will be the destination state while flattening graph G
+ * @param new_graph the resulting graph
  * @param SUBGRAPH_CALL_IGNORED will be > 0 if there are subgraphs ignored (passed by)
  *  in the grammar, i.e. the grammar is a finite-state approximization
  * @param SUBGRAPH_CALL will be > 0 if there are still subgraphs in the grammar,
  *  i.e. the grammar is a RTN
- * @return int : - returns starting position for subgraphs;
- *               - type of resulting graph (RTN, FST, FST-approximation) for main graph
  */
-int flatten_graph(Fst2* grammar,int n_graph,
-                  int depth,int max_depth,
-                  SingleGraph new_main_graph,
-                  int destination_state,int RTN,
-                  int *SUBGRAPH_CALL_IGNORED,int *SUBGRAPH_CALL,
-                  int* new_graph_number) {
-/* The new states will be appended at the end of the old graph's state array */
-int initial_position_for_new_states=new_main_graph->number_of_states;
+static void flatten_graph(struct flatten_infos* infos,int n_graph,int depth,
+                          SingleGraph new_graph,
+                          int *SUBGRAPH_CALL_IGNORED,int *SUBGRAPH_CALL) {
+Fst2* grammar=infos->grammar;
 /* The following array contains the of transitions that correspond
  * to subgraph calls to be flattened. We arbitrary set its capacity to 2048 */
 int trans_to_flatten_capacity=2048;
@@ -336,26 +441,14 @@ int trans_to_flatten_size=0;
 int limit=grammar->initial_states[n_graph]+grammar->number_of_states_per_graphs[n_graph];
 for (int i=grammar->initial_states[n_graph];i<limit;i++) {
    Fst2State original_state = grammar->states[i];
-   SingleGraphState new_state=add_state(new_main_graph);
+   SingleGraphState new_state=add_state(new_graph);
    if (is_final_state(original_state)) {
-      /* If the original state is terminal */
-      if (depth==0) {
-         /* If we are in the main graph, at the first step, i.e. not inside a
-          * recursive call to the main graph, we say that the new state must
-          * be also terminal */
-         set_final_state(new_state);
-      }
-      else {
-         /* In a subgraph, we add an epsilon transition pointing to the
-          * destination state specified in parameter. By convention,
-          * epsilon has the tag number 0 */
-         add_outgoing_transition(new_state,0,destination_state);
-      }
+      set_final_state(new_state);
    }
    /* Now, we deal with the transitions */
    Transition* original_transitions=original_state->transitions;
    while (original_transitions!=NULL) {
-      if (!RTN && (original_transitions->tag_number<0) && depth>=max_depth) {
+      if (!infos->RTN && (original_transitions->tag_number<0) && depth>=infos->max_depth) {
          /* If we have a subgraph call while 1) we have overpassed the maximum
           * depth and 2) we must produce a strict FST, then we have to ignore it.
           * We just signal the fact by increasing a counter */
@@ -365,17 +458,14 @@ for (int i=grammar->initial_states[n_graph];i<limit;i++) {
          /* Otherwise, we deal with the transition. First of all, we compute the
           * number of its destination state in the new graph. The point is that
           * original_transitions->state_number is a global state number in the original
-          * fst2. So, we compute its relative number in the current graph,
-          * which is original_transitions->state_number-grammar->initial_states[n_graph],
-          * and we add to it the starting position of the current graph.
-          */
-         int destination_state_number=initial_position_for_new_states+original_transitions->state_number-grammar->initial_states[n_graph];
+          * fst2, so we compute its relative number in the current graph. */
+         int destination_state_number=original_transitions->state_number-grammar->initial_states[n_graph];
          add_outgoing_transition(new_state,original_transitions->tag_number,destination_state_number);
          /* We get a pointer on the transition we have just created */
          Transition* temp=new_state->outgoing_transitions;
          if ((temp->tag_number) < 0) {
             /* If the transition is a subgraph call */
-            if (depth<max_depth) {
+            if (depth<infos->max_depth) {
                /* And if we must flatten, we note it in order the modify it later */
                if (trans_to_flatten_size>=trans_to_flatten_capacity) {
                   /* We resize the array if needed */
@@ -395,7 +485,7 @@ for (int i=grammar->initial_states[n_graph];i<limit;i++) {
                 *
                 * would have been true and we would not be here. So, we just produce
                 * a call to the subgraph taking care of the graph renumerotation. */
-               temp->tag_number=-(new_graph_number[-(original_transitions->tag_number)]);
+               temp->tag_number=-(infos->new_graph_number[-(original_transitions->tag_number)]);
                (*SUBGRAPH_CALL)++;
             }
          }
@@ -404,53 +494,95 @@ for (int i=grammar->initial_states[n_graph];i<limit;i++) {
       original_transitions=original_transitions->next;
    }
 }
-if (depth==0) {
-   /* If we are in the main graph, at the first step, i.e. not inside a
-    * recursive call to the main graph, we say that its first state is initial */
-   set_initial_state(new_main_graph->states[0]);
-}
-/* Then, if there were some calls to subgraphs, we flatten them */
+/* Then, if there were some calls to subgraphs, we replace them by epsilon
+ * transitions to copies of the flattened subgraphs */
 for (int i=0;i<trans_to_flatten_size;i++) {
-   /* We flatten recursively the subgraph */
-   int starting_pos=flatten_graph(grammar,-(transitions_to_flatten[i]->tag_number),
-                                  depth+1,max_depth,
-                                  new_main_graph,
-                                  transitions_to_flatten[i]->state_number,RTN,
-                                  SUBGRAPH_CALL_IGNORED,SUBGRAPH_CALL,
-                                  new_graph_number);
-   /* And we replace the subgraph call by an epsilon transition to the initial state
-    * of the flattened subgraph */
-   transitions_to_flatten[i]->tag_number = 0;
-   transitions_to_flatten[i]->state_number = starting_pos;
+   struct flattened_graph* subgraph=get_flattened_graph(infos,-(transitions_to_flatten[i]->tag_number),depth+1);
+   if (subgraph->subgraph_call_ignored) (*SUBGRAPH_CALL_IGNORED)++;
+   if (subgraph->subgraph_call) (*SUBGRAPH_CALL)++;
+   transitions_to_flatten[i]->state_number=copy_flattened_graph(subgraph->graph,new_graph,transitions_to_flatten[i]->state_number);
+   transitions_to_flatten[i]->tag_number=0;
 }
 /* Clean up */
 free(transitions_to_flatten);
-/* And finally... */
-if (depth==0) {
-   /* If we are in the main graph, at the first step, i.e. not inside a
-    * recursive call to the main graph */
-   if (*SUBGRAPH_CALL) {
-      /* If some subgraph calls remains, then we have an equivalent RTN */
-      return EQUIVALENT_RTN;
+}
+
+
+/**
+ * Removes the epsilon transitions and the useless states of the given graph,
+ * whose initial state is the state 0, and then minimizes it.
+ */
+static void clean_flattened_graph(SingleGraph graph) {
+compute_reverse_transitions(graph);
+for (int h=0;h<graph->number_of_states;h++) {
+   if (is_final_state(graph->states[h])) {
+      /* We start the co_accessibility check from every final state */
+      check_co_accessibility(graph->states,h);
+   }
+}
+check_accessibility(graph->states,0);
+remove_epsilon_transitions(graph,1);
+remove_useless_states(graph,NULL);
+if (graph->number_of_states!=0) {
+   minimize(graph,0);
+}
+}
+
+
+/**
+ * Returns the flattened form of the graph 'n' when it is called at the given
+ * depth, computing it if needed. If all the subgraph calls of the graph can
+ * be flattened from this depth, its flattened form does not depend on the
+ * depth, and so it is shared by all the depths that are small enough.
+ */
+static struct flattened_graph* get_flattened_graph(struct flatten_infos* infos,int n,int depth) {
+int key=(infos->height[n]<=infos->max_depth-depth)?-1:depth;
+struct flattened_graph* f;
+for (f=infos->flattened_graphs[n];f!=NULL;f=f->next) {
+   if (f->depth==key) return f;
+}
+f=(struct flattened_graph*)malloc(sizeof(struct flattened_graph));
+if (f==NULL) {
+   fatal_alloc_error("get_flattened_graph");
+}
+f->depth=key;
+f->subgraph_call=0;
+f->subgraph_call_ignored=0;
+f->graph=new_SingleGraph();
+flatten_graph(infos,n,depth,f->graph,&(f->subgraph_call_ignored),&(f->subgraph_call));
+set_initial_state(f->graph->states[0]);
+clean_flattened_graph(f->graph);
+f->next=infos->flattened_graphs[n];
+infos->flattened_graphs[n]=f;
+return f;
+}
+
+
+/**
+ * Appends a copy of the flattened graph 'src' to 'dest', linking its final
+ * states to 'destination_state' with epsilon transitions, and returns the
+ * number of the state of 'dest' that corresponds to the initial state of
+ * 'src', which is its state 0 since 'src' has been minimized.
+ */
+static int copy_flattened_graph(SingleGraph src,SingleGraph dest,int destination_state) {
+int offset=dest->number_of_states;
+if (src->number_of_states==0) {
+   /* If the subgraph recognizes nothing, we return a dead end state that
+    * will be removed with the useless states */
+   add_state(dest);
+   return offset;
+}
+for (int i=0;i<src->number_of_states;i++) {
+   SingleGraphState new_state=add_state(dest);
+   for (Transition* t=src->states[i]->outgoing_transitions;t!=NULL;t=t->next) {
+      add_outgoing_transition(new_state,t->tag_number,offset+t->state_number);
+   }
+   if (is_final_state(src->states[i])) {
+      /* By convention, epsilon has the tag number 0 */
+      add_outgoing_transition(new_state,0,destination_state);
    }
-   else {
-      /* Otherwise, we test if we have removed some subgraph calls */
-      if (*SUBGRAPH_CALL_IGNORED) {
-         /* In that case, we  have a FST that is just an approximation of
-          * the original grammar */
-         return APPROXIMATIVE_FST;
-      }
-      else {
-         /* If there is no subgraph call and if no subgraph call was removed,
-          * then we have a FST that is strictly equivalent to the original
-          * grammar */
-         return EQUIVALENT_FST;
-      }
-  }
 }
-/* If we are in a subgraph, we return the number of the initial state of
- * the current graph that we have just flattened */
-return initial_position_for_new_states;
+return offset;
 }
 
 
@@ -97,6 +97,9 @@ const char* usage_Fst2Check =
          "  -t/--tfst_check: checks if the given .fst2 can be considered as a valid sentence\n"
          "                   automaton\n"
          "  -e/--no_empty_graph_warning: no warning will be emitted when a graph matches <E>\n"
+         "  -c/--cache_analysis: with -y, saves the graphs that match <E> and the tags that can\n"
+         "                       start each graph in a .fst2a file next to the .fst2, so that\n"
+         "                       Locate does not need to compute them again\n"
          "  -o OUT/--output=OUT: output file for error message\n"
          "  -a/--append: opens the message output file in append mode\n"
          "  -s/--statistics: displays statistics about the .fst2 file\n"
@@ -117,7 +120,8 @@ u_printf(usage_Fst2Check);
 
 int pseudo_main_Fst2Check(Encoding encoding_output,int bom_output,int mask_encoding_compatibility_input,
                           const char* fst2name,const char* output_name,int append,int display_statistics,
-                          int yes_or_no,int no_empty_graph_warning,int tfst_check) {
+                          int yes_or_no,int no_empty_graph_warning,int tfst_check,
+                          int cache_analysis) {
 ProgramInvoker* invoker=new_ProgramInvoker(main_Fst2Check,"main_Fst2Check");
 add_argument(invoker,fst2name);
 add_argument(invoker,yes_or_no?"-y":"-n");
@@ -156,12 +160,15 @@ if (no_empty_graph_warning) {
 if (tfst_check) {
    add_argument(invoker,"-t");
 }
+if (cache_analysis) {
+   add_argument(invoker,"-c");
+}
 int ret=invoke(invoker);
 free_ProgramInvoker(invoker);
 return ret;
 }
 
-const char* optstring_Fst2Check=":ynatesho:k:q:";
+const char* optstring_Fst2Check=":ynatescho:k:q:";
 const struct option_TS lopts_Fst2Check[]= {
       {"append",no_argument_TS,NULL,'a'},
       {"statistics",no_argument_TS,NULL,'s'},
@@ -169,6 +176,7 @@ const struct option_TS lopts_Fst2Check[]= {
       {"no_loop_check",no_argument_TS,NULL,'n'},
       {"tfst_check",no_argument_TS,NULL,'t'},
       {"no_empty_graph_warning",no_argument_TS,NULL,'e'},
+      {"cache_analysis",no_argument_TS,NULL,'c'},
       {"input_encoding",required_argument_TS,NULL,'k'},
       {"output_encoding",required_argument_TS,NULL,'q'},
       {"output",required_argument_TS,NULL,'o'},
@@ -186,7 +194,7 @@ if (argc==1) {
    return 0;
 }
 
-int check_recursion=0,tfst_check=0;
+int check_recursion=0,tfst_check=0,cache_analysis=0;
 int append_output=0;
 int display_statistics=0;
 char no_empty_graph_warning=0;
@@ -211,6 +219,7 @@ while (EOF!=(val=getopt_long_TS(argc,argv,optstring_Fst2Check,lopts_Fst2Check,&i
              no_empty_graph_warning=1;
              break;
    case 'e': no_empty_graph_warning=1; break;
+   case 'c': cache_analysis=1; break;
    case 'h': usage(); free_OptVars(vars); return 0;
    case ':': if (index==-1) fatal_error("Missing argument for option -%c\n",vars->optopt);
              else fatal_error("Missing argument for option --%s\n",lopts_Fst2Check[index].name);
@@ -264,7 +273,7 @@ if (display_statistics) {
 
 
 if (check_recursion) {
-   if (!OK_for_Locate_write_error(fst2_file_name,no_empty_graph_warning,ferr)) {
+   if (!OK_for_Locate_write_error(fst2_file_name,no_empty_graph_warning,ferr,cache_analysis)) {
       if (ferr != NULL) {
           u_fclose(ferr);
       }
@@ -43,6 +43,7 @@ extern const char* usage_Fst2Check;
 int main_Fst2Check(int argc,char* const argv[]);
 int pseudo_main_Fst2Check(Encoding encoding_output,int bom_output,int mask_encoding_compatibility_input,
                           const char* fst2name,const char* output_name,int append,int display_statistics,
-                          int yes_or_no,int no_empty_graph_warning,int tfst_check);
+                          int yes_or_no,int no_empty_graph_warning,int tfst_check,
+                          int cache_analysis=0);
 #endif
 
@@ -21,8 +21,7 @@
 
 #include "Fst2Check_lib.h"
 #include "Error.h"
-#include "BitMasks.h"
-#include "Transitions.h"
+#include "File.h"
 
 
 /* see http://en.wikipedia.org/wiki/Variable_Length_Array . MSVC did not support it 
@@ -31,536 +30,717 @@
 #define NO_C99_VARIABLE_LENGTH_ARRAY 1
 #endif
 
-int look_for_recursion(int,struct list_int*,Fst2*,int*,U_FILE*);
-
 
 #define NO_LEFT_RECURSION 1
 #define LEFT_RECURSION 0
 
-#define TMP_LOOP_MARK 8
-#define VISITED_MARK 16
-
-#define UNCONDITIONAL_E_MATCH 32
-#define CONDITIONAL_E_MATCH 64
-#define DOES_NOT_MATCH_E 128
-
-#define E_IS_MATCHED 1
-#define E_IS_NOT_MATCHED 2
-#define DOES_NOT_KNOW_IF_E_IS_MATCHED 3
-
 
 /**
- * To determine if a graph can match the empty word <E>, we must check if
- * there is an empty path from its initial state to a final state. However,
- * such a path can be made of calls to subgraphs that match <E>. So, we use
- * conditions to represents these dependencies. Conditions are associated to
- * each state in the form of a list of condition. Each list corresponds to a
- * path from this state to a final state. It contains the numbers of the subgraphs
- * that are in the path. For instance, if we have the following case:
- * 
- * state s --------.....-------> graph 45 -------......-------> graph 12 ----> FINAL STATE
- *            |
- *            |
- *            |----------.....--------> graph 27 --------.....------> FINAL STATE
+ * Returns 1 if the given tag can match the empty word <E>, that is to say
+ * if it is <E> or a $ mark (variable, context, morphological mode); 0 otherwise.
  *
- * the state s will have two conditions:
- * - condition 1: {45, 12}
- * - condition 2: {27}
+ * WARNING: <E> problem detection does not take contexts into account!
  */
-struct condition_list {
-  struct list_int* condition;
-  struct condition_list* next;
-};
-typedef struct condition_list* ConditionList;
+static int is_epsilon_tag(const Fst2Tag e) {
+if (!u_strcmp(e->input,"<E>")) return 1;
+/* If we have a variable mark */
+return (e->input[0]=='$' && e->input[1]!='\0');
+}
 
 
 /**
- * Frees all the memory associated to the given condition list.
+ * Returns the number of transitions of the given fst2, and sets '*checksum'
+ * to a hash of its initial states, final states and transitions.
  */
-void free_ConditionList(ConditionList l) {
-ConditionList tmp;
-while (l!=NULL) {
-   free_list_int(l->condition);
-   tmp=l;
-   l=l->next;
-   free(tmp);
+static int get_number_of_transitions(const Fst2* fst2,int* checksum) {
+int n=0;
+unsigned int h=2166136261u;
+for (int g=1;g<=fst2->number_of_graphs;g++) {
+   h=(h^(unsigned int)fst2->initial_states[g])*16777619u;
+}
+for (int i=0;i<fst2->number_of_states;i++) {
+   if (fst2->states[i]==NULL) continue;
+   h=(h^(unsigned int)is_final_state(fst2->states[i]))*16777619u;
+   for (Transition* t=fst2->states[i]->transitions;t!=NULL;t=t->next) {
+      h=(h^(unsigned int)t->tag_number)*16777619u;
+      h=(h^(unsigned int)t->state_number)*16777619u;
+      n++;
+   }
 }
+*checksum=(int)h;
+return n;
 }
 
 
 /**
- * Returns a copy of the given condition list.
+ * A graph in the compressed form used by the analysis: the successors
+ * of the node #i are succ[start[i]] ... succ[start[i+1]-1].
  */
-ConditionList clone_ConditionList(ConditionList l) {
-ConditionList tmp;
-if (l==NULL) return NULL;
-tmp=(ConditionList)malloc(sizeof(struct condition_list));
-if (tmp==NULL) {
-   fatal_alloc_error("clone_ConditionList");
-}
-tmp->condition=clone(l->condition);
-tmp->next=clone_ConditionList(l->next);
-return tmp;
-}
+struct adjacency {
+   int n;
+   int* start;
+   int* succ;
+};
 
 
-/**
- * Inserts the graph number 'n' in the given condition list.
- */
-void insert_graph_in_conditions(int n,ConditionList* l) {
-ConditionList tmp;
-if (*l==NULL) {
-   /* If the condition list is empty, we create one */
-   tmp=(ConditionList)malloc(sizeof(struct condition_list));
-   if (tmp==NULL) {
-      fatal_alloc_error("insert_graph_in_conditions");
-   }
-   tmp->next=NULL;
-   tmp->condition=new_list_int(n);
-   *l=tmp;
-   return;
+static struct adjacency* new_adjacency(int n,int n_edges) {
+struct adjacency* a=(struct adjacency*)malloc(sizeof(struct adjacency));
+if (a==NULL) {
+   fatal_alloc_error("new_adjacency");
 }
-/* Otherwise, we insert the graph number in all the conditions of the list */
-tmp=*l;
-while (tmp!=NULL) {
-   tmp->condition=sorted_insert(n,tmp->condition);
-   tmp=tmp->next;
+a->n=n;
+a->start=(int*)calloc(n+1,sizeof(int));
+a->succ=(int*)malloc(sizeof(int)*(n_edges>0?n_edges:1));
+if (a->start==NULL || a->succ==NULL) {
+   fatal_alloc_error("new_adjacency");
 }
+return a;
 }
 
 
-/**
- * Appends the condition list 'd' to the condition list 'c'.
- */
-void merge_condition_lists(ConditionList *c,ConditionList d) {
-ConditionList tmp;
-if (*c==NULL) {
-   *c=d;
-   return;
-}
-if ((*c)->next==NULL) {
-   (*c)->next=d;
-   return;
-}
-tmp=*c;
-while (tmp->next!=NULL) tmp=tmp->next;
-tmp->next=d;
+static void free_adjacency(struct adjacency* a) {
+if (a==NULL) return;
+free(a->start);
+free(a->succ);
+free(a);
 }
 
 
-
 /**
- * Takes a fst2 tag and puts its control byte to 1 if it can
- * match the empty word <E>.
- * 
- * WARNING: <E> problem detection does not take contexts into account!
+ * Computes the strongly connected components of the given graph with Tarjan's
+ * algorithm, without recursion since graphs may have a lot of states.
+ * scc[i] is set to the number of the component of the node #i. Components
+ * are numbered in the order in which they are completed, so that a node can
+ * only lead to components whose number is lower or equal to its own.
+ * Returns the number of components.
  */
-void check_epsilon_tag(Fst2Tag e) {
-if (!u_strcmp(e->input,"<E>")) e->control=1;
-else if (e->input[0]=='$' && e->input[1]!='\0') {
-   /* If we have a variable mark */
-   e->control=1;
+static int get_strongly_connected_components(const struct adjacency* a,int* scc) {
+int n=a->n;
+int* index=(int*)malloc(sizeof(int)*(n>0?n:1));
+int* lowlink=(int*)malloc(sizeof(int)*(n>0?n:1));
+int* stack=(int*)malloc(sizeof(int)*(n>0?n:1));
+int* call_stack=(int*)malloc(sizeof(int)*(n>0?n:1));
+int* next_edge=(int*)malloc(sizeof(int)*(n>0?n:1));
+if (index==NULL || lowlink==NULL || stack==NULL || call_stack==NULL || next_edge==NULL) {
+   fatal_alloc_error("get_strongly_connected_components");
+}
+for (int i=0;i<n;i++) {
+   index[i]=-1;
+   scc[i]=-1;
+}
+int counter=0,n_scc=0,stack_size=0;
+for (int root=0;root<n;root++) {
+   if (index[root]!=-1) continue;
+   int depth=0;
+   call_stack[0]=root;
+   index[root]=lowlink[root]=counter++;
+   next_edge[root]=a->start[root];
+   stack[stack_size++]=root;
+   while (depth>=0) {
+      int v=call_stack[depth];
+      if (next_edge[v]<a->start[v+1]) {
+         int w=a->succ[next_edge[v]++];
+         if (index[w]==-1) {
+            /* If w has not been visited yet, we go on with it */
+            index[w]=lowlink[w]=counter++;
+            next_edge[w]=a->start[w];
+            stack[stack_size++]=w;
+            call_stack[++depth]=w;
+         } else if (scc[w]==-1 && index[w]<lowlink[v]) {
+            /* If w is on the stack */
+            lowlink[v]=index[w];
+         }
+         continue;
+      }
+      /* All the successors of v have been explored */
+      if (lowlink[v]==index[v]) {
+         int w;
+         do {
+            w=stack[--stack_size];
+            scc[w]=n_scc;
+         } while (w!=v);
+         n_scc++;
+      }
+      depth--;
+      if (depth>=0 && lowlink[v]<lowlink[call_stack[depth]]) {
+         lowlink[call_stack[depth]]=lowlink[v];
+      }
+   }
 }
-else e->control=0;
+free(index);
+free(lowlink);
+free(stack);
+free(call_stack);
+free(next_edge);
+return n_scc;
 }
 
 
 /**
- * Prints the graph call sequence that leads to the graph #n.
+ * Returns 1 if the node #i of the given graph has a transition to itself; 0 otherwise.
  */
-void print_reversed_list(const struct list_int* l,int n,unichar**  graph_names,U_FILE* ferr) {
-if (l->n==n) {
-   error("ERROR: %S",graph_names[l->n]);
-   if (ferr != NULL)
-       u_fprintf(ferr,"ERROR: %S",graph_names[l->n]);
-   return;
+static int has_self_loop(const struct adjacency* a,int i) {
+for (int k=a->start[i];k<a->start[i+1];k++) {
+   if (a->succ[k]==i) return 1;
 }
-print_reversed_list(l->next,n,graph_names,ferr);
-error(" calls %S that",graph_names[l->n]);
-if (ferr != NULL)
-  u_fprintf(ferr," calls %S that",graph_names[l->n]);
+return 0;
 }
 
 
 /**
- * Returns 1 if we can match <E> from the current state, with or without
- * conditions; 0 otherwise.
+ * Sets nullable[i] to 1 for every graph #i that can match <E>. A state can reach
+ * a final state without consuming anything if it is final, or if it has an <E>
+ * transition to such a state, or a call to a graph matching <E> that leads
+ * to such a state. We propagate this property backward from the final states,
+ * so that each transition is considered at most twice: once when its destination
+ * state is found, and once when its graph is found to match <E>.
  */
-int graph_matches_E(int initial_state,int current_state,const Fst2State* states,Fst2Tag* tags,
-                      int current_graph,unichar** graph_names,
-                      ConditionList conditions_for_states[],
-                      ConditionList *graph_conditions) {
-Transition* l;
-Fst2State s;
-int ret_value=0;
-int ret;
-*graph_conditions=NULL;
-s=states[current_state];
-if (is_final_state(s)) {
-   /* If we are arrived in a final state, then the graph matches <E> */
-   set_bit_mask(&(s->control),UNCONDITIONAL_E_MATCH);
-   return 1;
+static void compute_nullable_graphs(const Fst2* fst2,const char* epsilon_tags,char* nullable) {
+int n_states=fst2->number_of_states;
+int n_graphs=fst2->number_of_graphs;
+/* incoming[d] contains pairs (origin state, 0 for <E> or called graph number) */
+int* in_start=(int*)calloc(n_states+1,sizeof(int));
+int* call_start=(int*)calloc(n_graphs+2,sizeof(int));
+char* reached=(char*)calloc(n_states>0?n_states:1,sizeof(char));
+int* graph_of_initial_state=(int*)malloc(sizeof(int)*(n_states>0?n_states:1));
+if (in_start==NULL || call_start==NULL || reached==NULL || graph_of_initial_state==NULL) {
+   fatal_alloc_error("compute_nullable_graphs");
 }
-if (is_bit_mask_set(s->control,TMP_LOOP_MARK)) {
-   /* If we have a loop, we do nothing, because they will be
-    * dealt with later. */
-   return 0;
+int i;
+for (i=0;i<n_states;i++) {
+   graph_of_initial_state[i]=0;
+}
+for (i=1;i<=n_graphs;i++) {
+   graph_of_initial_state[fst2->initial_states[i]]=i;
+}
+for (i=0;i<n_states;i++) {
+   if (fst2->states[i]==NULL) continue;
+   for (Transition* t=fst2->states[i]->transitions;t!=NULL;t=t->next) {
+      if (t->tag_number<0) {
+         in_start[t->state_number+1]++;
+         call_start[-(t->tag_number)+1]++;
+      } else if (epsilon_tags[t->tag_number]) {
+         in_start[t->state_number+1]++;
+      }
+   }
 }
-if (is_bit_mask_set(s->control,VISITED_MARK)) {
-   /* If we are in state that has already been visited */
-   if (is_bit_mask_set(s->control,UNCONDITIONAL_E_MATCH)) {
-      /* If this state can match <E> without conditions, then we have finished */
-      return 1;
+for (i=0;i<n_states;i++) {
+   in_start[i+1]=in_start[i+1]+in_start[i];
+}
+for (i=0;i<=n_graphs;i++) {
+   call_start[i+1]=call_start[i+1]+call_start[i];
+}
+int* incoming=(int*)malloc(sizeof(int)*(2*in_start[n_states]+1));
+int* calls=(int*)malloc(sizeof(int)*(2*call_start[n_graphs+1]+1));
+int* in_pos=(int*)malloc(sizeof(int)*(n_states+1));
+int* call_pos=(int*)malloc(sizeof(int)*(n_graphs+2));
+int* stack=(int*)malloc(sizeof(int)*(n_states>0?n_states:1));
+if (incoming==NULL || calls==NULL || in_pos==NULL || call_pos==NULL || stack==NULL) {
+   fatal_alloc_error("compute_nullable_graphs");
+}
+memcpy(in_pos,in_start,sizeof(int)*(n_states+1));
+memcpy(call_pos,call_start,sizeof(int)*(n_graphs+2));
+int stack_size=0;
+for (i=0;i<n_states;i++) {
+   if (fst2->states[i]==NULL) continue;
+   if (is_final_state(fst2->states[i])) {
+      reached[i]=1;
+      stack[stack_size++]=i;
    }
-   if (is_bit_mask_set(s->control,CONDITIONAL_E_MATCH)) {
-      /* If this state can match <E> with conditions, then we have finished, but
-       * we copy the necessary conditions in 'graph_conditions'. */
-      *graph_conditions=clone_ConditionList(conditions_for_states[current_state-initial_state]);
-      return 1;
+   for (Transition* t=fst2->states[i]->transitions;t!=NULL;t=t->next) {
+      int graph=(t->tag_number<0)?-(t->tag_number):0;
+      if (graph!=0 || epsilon_tags[t->tag_number]) {
+         int k=in_pos[t->state_number]++;
+         incoming[2*k]=i;
+         incoming[2*k+1]=graph;
+      }
+      if (graph!=0) {
+         int k=call_pos[graph]++;
+         calls[2*k]=i;
+         calls[2*k+1]=t->state_number;
+      }
    }
-   /* If the state has been visited and if it does not match <E>, then we return OK */
-   return 0;
 }
-set_bit_mask(&(s->control),VISITED_MARK);
-set_bit_mask(&(s->control),TMP_LOOP_MARK);
-l=s->transitions;
-/* We look all the outgoing transitions */
-while (l!=NULL) {
-   if (l->tag_number<0) {
-      /* If we have a subgraph, we test if it matches <E> */
-      *graph_conditions=NULL;
-      ret=graph_matches_E(initial_state,l->state_number,states,tags,current_graph,graph_names,conditions_for_states,graph_conditions);
-      if (ret==1) {
-         /* If the subgraph matches <E>, we say that the current state matches
-          * <E>, modulo the conditions to be verified */
-         set_bit_mask(&(s->control),CONDITIONAL_E_MATCH);
-         /* We insert the new condition in first position... */
-         insert_graph_in_conditions(-(l->tag_number),graph_conditions);
-         /* ...and we merge the new conditions with the existing ones for this state */
-         merge_condition_lists(&conditions_for_states[current_state-initial_state],*graph_conditions);
-         *graph_conditions=NULL;
+while (stack_size!=0) {
+   int d=stack[--stack_size];
+   for (int k=in_start[d];k<in_start[d+1];k++) {
+      int s=incoming[2*k];
+      int graph=incoming[2*k+1];
+      if (!reached[s] && (graph==0 || nullable[graph])) {
+         reached[s]=1;
+         stack[stack_size++]=s;
       }
-      ret_value=ret_value|ret;
-   }
-   else if (tags[l->tag_number]->control&1) {
-      /* If we have an <E> transition, we explore the rest of the graph from it */
-      *graph_conditions=NULL;
-      ret=graph_matches_E(initial_state,l->state_number,states,tags,current_graph,graph_names,conditions_for_states,graph_conditions);
-      if (ret==1) {
-         /* If we can match <E> from the <E>-transition's destination state, then
-          * we can match it from the current state. */
-         if (*graph_conditions==NULL) {
-            /* If there is no condition */
-            set_bit_mask(&(s->control),UNCONDITIONAL_E_MATCH);
-         }
-         else {
-            /* Otherwise, we add the condition to the existing ones */
-            set_bit_mask(&(s->control),CONDITIONAL_E_MATCH);
-            merge_condition_lists(&conditions_for_states[current_state-initial_state],*graph_conditions);
-            *graph_conditions=NULL;
+   }
+   int g=graph_of_initial_state[d];
+   if (g!=0) {
+      /* If d is the initial state of the graph g, then g matches <E>, and so
+       * we can cross all the calls to g that lead to a state already reached */
+      nullable[g]=1;
+      for (int k=call_start[g];k<call_start[g+1];k++) {
+         int s=calls[2*k];
+         if (!reached[s] && reached[calls[2*k+1]]) {
+            reached[s]=1;
+            stack[stack_size++]=s;
          }
       }
-      ret_value=ret_value|ret;
    }
-   l=l->next;
 }
-unset_bit_mask(&(s->control),TMP_LOOP_MARK);
-*graph_conditions=clone_ConditionList(conditions_for_states[current_state-initial_state]);
-return ret_value;
+free(in_start);
+free(call_start);
+free(reached);
+free(graph_of_initial_state);
+free(incoming);
+free(calls);
+free(in_pos);
+free(call_pos);
+free(stack);
 }
 
 
 /**
- * This function takes a condition, i.e. a list of graph numbers. Then, it
- * tests if all the corresponding graphs match <E>. In that case, it sets
- * '*matches_E' to E_IS_MATCHED.
+ * Returns in 'reachable' the graph whose nodes are the states of the fst2 and whose
+ * transitions are the ones that can be crossed without consuming anything:
+ * <E> transitions and calls to graphs that match <E>.
  */
-struct list_int* resolve_simple_condition(struct list_int* c,Fst2State* states,
-                                    int* initial_states,int *modification,
-                                    int *matches_E) {
-struct list_int* tmp;
-*matches_E=E_IS_MATCHED;
-if (c==NULL) return NULL;
-/* First, we try to solve the rest of the condition */
-tmp=resolve_simple_condition(c->next,states,initial_states,modification,matches_E);
-if ((*matches_E)==E_IS_NOT_MATCHED) {
-   /* If at least one element of the rest of the condition does not
-    * matches <E>, we can delete the current element (the rest has
-    * already been freed). */
-   free(c);
-   (*modification)++;
-   return NULL;
-}
-if ((*matches_E)==E_IS_MATCHED) {
-   /* If all the elements of the rest of the condition match <E> */
-   c->next=tmp;
-   if (is_bit_mask_set(states[initial_states[c->n]]->control,UNCONDITIONAL_E_MATCH)) {
-      /* If the current one also matches <E>, then we can return */
-      return c;
-   }
-   if (is_bit_mask_set(states[initial_states[c->n]]->control,CONDITIONAL_E_MATCH) && 
-       !is_bit_mask_set(states[initial_states[c->n]]->control,DOES_NOT_MATCH_E)) {
-      /* If we don't know if the current element matches <E> or not */
-      *matches_E=DOES_NOT_KNOW_IF_E_IS_MATCHED;
-      return c;
-   }
-   /* If the current element does not match <E>, we can free the rest of the condition */
-   free_list_int(c);
-   *matches_E=E_IS_NOT_MATCHED;
-   (*modification)++;
-   return NULL;
-}
-/* If we don't know if the rest of the condition match <E> */
-c->next=tmp;
-if (is_bit_mask_set(states[initial_states[c->n]]->control,UNCONDITIONAL_E_MATCH)) {
-   /* If the current element matches <E>, we still cannot decide */
-   *matches_E=DOES_NOT_KNOW_IF_E_IS_MATCHED;
-   return c;
-}
-if (is_bit_mask_set(states[initial_states[c->n]]->control,DOES_NOT_MATCH_E)) {
-   /* If the current element does not matches <E>, the condition is not verified */
-   free_list_int(c);
-   *matches_E=E_IS_NOT_MATCHED;
-   (*modification)++;
-   return NULL;
+static struct adjacency* get_epsilon_transitions(const Fst2* fst2,const char* epsilon_tags,
+                                                 const char* nullable) {
+int n_states=fst2->number_of_states;
+int n=0;
+int i;
+for (int pass=0;pass<2;pass++) {
+   struct adjacency* a=NULL;
+   if (pass==1) {
+      a=new_adjacency(n_states,n);
+   }
+   n=0;
+   for (i=0;i<n_states;i++) {
+      if (a!=NULL) a->start[i]=n;
+      if (fst2->states[i]==NULL) continue;
+      for (Transition* t=fst2->states[i]->transitions;t!=NULL;t=t->next) {
+         if ((t->tag_number<0 && nullable[-(t->tag_number)])
+             || (t->tag_number>=0 && epsilon_tags[t->tag_number])) {
+            if (a!=NULL) a->succ[n]=t->state_number;
+            n++;
+         }
+      }
+   }
+   if (a!=NULL) {
+      a->start[n_states]=n;
+      return a;
+   }
 }
-/* If we still don't know, we do nothing */
-*matches_E=DOES_NOT_KNOW_IF_E_IS_MATCHED;
-return c;
+return NULL;
 }
 
 
-/**
- * This function takes a condition list and checks if at least of the
- * conditions is verified, i.e. there is at least one path to match <E>.
- * It returns the modified condition list. If there is at least one modification,
- * then '*modification' is set to 1. See 'resolve_simple_condition' for
- * the values to be taken by '*matches_E'.
- */
-ConditionList resolve_condition_list(ConditionList l,Fst2State* states,
-                               int* initial_states,int *modification,int *matches_E,U_FILE*ferr) {
-ConditionList tmp;
-if (l==NULL) return NULL;
-if (l->condition==NULL) {
-   error("NULL internal error in resolve_condition_list\n");
-   if (ferr != NULL)
-     u_fprintf(ferr,"NULL internal error in resolve_condition_list\n");
-   return NULL;
-}
-l->condition=resolve_simple_condition(l->condition,states,initial_states,modification,matches_E);
-if (*matches_E==E_IS_MATCHED) {
-   /* If condition is verified, then the graph matches <E>, so we return */
-   return l;
-}
-if (l->condition==NULL) {
-   /* If we have removed the whole condition, we delete it and we
-    * clean the rest of the condition list. */
-   tmp=l->next;
-   free(l);
-   return resolve_condition_list(tmp,states,initial_states,modification,matches_E,ferr);
-}
-/* Otherwise, we clean the rest of the condition list. */
-l->next=resolve_condition_list(l->next,states,initial_states,modification,matches_E,ferr);
-return l;
+static int compare_ints(const void* a,const void* b) {
+return *(const int*)a-*(const int*)b;
 }
 
 
 /**
- * This function tries to resolve the conditions of the graph #n.
- * It returns 1 if at least one condition was resolved.
+ * Explores each graph from its initial state without consuming anything. The
+ * graphs that can be called this way are stored in 'left_calls', and the
+ * tags of the transitions that can be tried are stored in 'tags'; both are
+ * indexed by graph numbers.
  */
-int resolve_conditions_for_one_graph(int n,ConditionList* conditions,
-                                     Fst2State* states,int* initial_states,U_FILE*ferr) {
-int modification=0;
-int matches_E=DOES_NOT_KNOW_IF_E_IS_MATCHED;
-if (conditions[n]==NULL) {
-   error("NULL internal error in resolve_conditions_for_one_graph for graph %d\n",n);
-   if (ferr != NULL)
-     u_fprintf(ferr,"NULL internal error in resolve_conditions_for_one_graph for graph %d\n",n);
-   return modification;
-}
-conditions[n]=resolve_condition_list(conditions[n],states,initial_states,&modification,&matches_E,ferr);
-if (matches_E==E_IS_MATCHED) {
-   /* If at least one condition was verified */
-   set_bit_mask(&(states[initial_states[n]]->control),UNCONDITIONAL_E_MATCH);
-   /* We can free the conditions */
-   free_ConditionList(conditions[n]);
-   conditions[n]=NULL;
-   return 1;
-}
-if (conditions[n]==NULL) {
-   /* If the graph has no more condition, then we mark it as unable to match <E> */
-   set_bit_mask(&(states[initial_states[n]]->control),DOES_NOT_MATCH_E);
-   free_ConditionList(conditions[n]);
-   conditions[n]=NULL;
-   return 1;
+static void explore_graph_beginnings(const Fst2* fst2,const struct adjacency* epsilon,
+                                     struct adjacency** left_calls,struct adjacency** tags) {
+int n_graphs=fst2->number_of_graphs;
+int* graph_stamps=(int*)calloc(n_graphs+1,sizeof(int));
+int* tag_stamps=(int*)calloc(fst2->number_of_tags>0?fst2->number_of_tags:1,sizeof(int));
+int* state_stamps=(int*)calloc(fst2->number_of_states>0?fst2->number_of_states:1,sizeof(int));
+int* stack=(int*)malloc(sizeof(int)*(fst2->number_of_states>0?fst2->number_of_states:1));
+if (graph_stamps==NULL || tag_stamps==NULL || state_stamps==NULL || stack==NULL) {
+   fatal_alloc_error("explore_graph_beginnings");
+}
+int n_calls=0,n_tags=0;
+for (int pass=0;pass<2;pass++) {
+   struct adjacency* calls=NULL;
+   struct adjacency* t=NULL;
+   if (pass==1) {
+      calls=new_adjacency(n_graphs+1,n_calls);
+      t=new_adjacency(n_graphs+1,n_tags);
+      memset(graph_stamps,0,sizeof(int)*(n_graphs+1));
+      memset(tag_stamps,0,sizeof(int)*(fst2->number_of_tags>0?fst2->number_of_tags:1));
+      memset(state_stamps,0,sizeof(int)*(fst2->number_of_states>0?fst2->number_of_states:1));
+   }
+   n_calls=0;
+   n_tags=0;
+   for (int g=1;g<=n_graphs;g++) {
+      if (calls!=NULL) {
+         calls->start[g]=n_calls;
+         t->start[g]=n_tags;
+      }
+      int stack_size=0;
+      stack[stack_size++]=fst2->initial_states[g];
+      state_stamps[fst2->initial_states[g]]=g;
+      while (stack_size!=0) {
+         int s=stack[--stack_size];
+         if (fst2->states[s]==NULL) continue;
+         for (Transition* tr=fst2->states[s]->transitions;tr!=NULL;tr=tr->next) {
+            if (tr->tag_number<0) {
+               int callee=-(tr->tag_number);
+               if (graph_stamps[callee]!=g) {
+                  graph_stamps[callee]=g;
+                  if (calls!=NULL) calls->succ[n_calls]=callee;
+                  n_calls++;
+               }
+            } else if (tag_stamps[tr->tag_number]!=g) {
+               tag_stamps[tr->tag_number]=g;
+               if (t!=NULL) t->succ[n_tags]=tr->tag_number;
+               n_tags++;
+            }
+         }
+         for (int k=epsilon->start[s];k<epsilon->start[s+1];k++) {
+            int d=epsilon->succ[k];
+            if (state_stamps[d]!=g) {
+               state_stamps[d]=g;
+               stack[stack_size++]=d;
+            }
+         }
+      }
+   }
+   if (calls!=NULL) {
+      calls->start[0]=0;
+      t->start[0]=0;
+      calls->start[n_graphs+1]=n_calls;
+      t->start[n_graphs+1]=n_tags;
+      *left_calls=calls;
+      *tags=t;
+   }
 }
-return modification;
+free(graph_stamps);
+free(tag_stamps);
+free(state_stamps);
+free(stack);
 }
 
 
 /**
- * This function looks for each graph if it can resolve a condition.
- * 
- * It returns a non zero value if some conditions have been resolved, 
- * even just one; 0 otherwise.
+ * Computes the first tags of each graph, component by component of the graph
+ * of left calls. Since components are numbered so that a graph can only call
+ * graphs of lower or equal components, the first tags of the called graphs
+ * are already known when we deal with a component.
  */
-int resolve_conditions(ConditionList* conditions,int n_graphs,
-                       Fst2State* states,int* initial_states,U_FILE*ferr) {
-int modification=0;
-for (int i=1;i<n_graphs+1;i++) {
-   if (!is_bit_mask_set(states[initial_states[i]]->control,
-                        UNCONDITIONAL_E_MATCH|DOES_NOT_MATCH_E)) {
-      /* If we don't already know the status of the current graph */
-      if (!is_bit_mask_set(states[initial_states[i]]->control,CONDITIONAL_E_MATCH)) {
-         /* If there is no conditionnal match, then we say that it does
-          * not match <E> */
-         set_bit_mask(&(states[initial_states[i]]->control),DOES_NOT_MATCH_E);
-         modification++;
-      } else {
-         /* Otherwise, we try to solve the conditions of the graph */
-         modification=modification+resolve_conditions_for_one_graph(i,conditions,states,initial_states,ferr);
+static void compute_first_tags(const Fst2* fst2,const struct adjacency* left_calls,
+                               const struct adjacency* own_tags,const int* scc,int n_scc,
+                               struct fst2_analysis* analysis) {
+int n_graphs=fst2->number_of_graphs;
+/* We sort the graphs by component */
+int* members_start=(int*)calloc(n_scc+1,sizeof(int));
+int* members=(int*)malloc(sizeof(int)*(n_graphs+1));
+int* tag_stamps=(int*)calloc(fst2->number_of_tags>0?fst2->number_of_tags:1,sizeof(int));
+if (members_start==NULL || members==NULL || tag_stamps==NULL) {
+   fatal_alloc_error("compute_first_tags");
+}
+int i;
+for (i=1;i<=n_graphs;i++) {
+   members_start[scc[i]+1]++;
+}
+for (i=0;i<n_scc;i++) {
+   members_start[i+1]=members_start[i+1]+members_start[i];
+}
+for (i=1;i<=n_graphs;i++) {
+   members[members_start[scc[i]]++]=i;
+}
+for (i=n_scc;i>0;i--) {
+   members_start[i]=members_start[i-1];
+}
+members_start[0]=0;
+int size=16;
+int* tags=(int*)malloc(sizeof(int)*size);
+if (tags==NULL) {
+   fatal_alloc_error("compute_first_tags");
+}
+for (int c=0;c<n_scc;c++) {
+   int n=0;
+   for (int m=members_start[c];m<members_start[c+1];m++) {
+      int g=members[m];
+      /* We take the tags of the graph itself... */
+      for (int k=own_tags->start[g];k<own_tags->start[g+1];k++) {
+         int tag=own_tags->succ[k];
+         if (tag_stamps[tag]==c+1) continue;
+         tag_stamps[tag]=c+1;
+         if (n==size) {
+            size=size*2;
+            tags=(int*)realloc(tags,sizeof(int)*size);
+            if (tags==NULL) {
+               fatal_alloc_error("compute_first_tags");
+            }
+         }
+         tags[n++]=tag;
+      }
+      /* ...and the ones of the graphs it can call from its beginning */
+      for (int k=left_calls->start[g];k<left_calls->start[g+1];k++) {
+         int callee=left_calls->succ[k];
+         if (scc[callee]==c) {
+            /* The members of the component share the same tags */
+            continue;
+         }
+         if (scc[callee]>c) {
+            fatal_error("Internal error in compute_first_tags\n");
+         }
+         for (int j=0;j<analysis->n_first_tags[callee];j++) {
+            int tag=analysis->first_tags[callee][j];
+            if (tag_stamps[tag]==c+1) continue;
+            tag_stamps[tag]=c+1;
+            if (n==size) {
+               size=size*2;
+               tags=(int*)realloc(tags,sizeof(int)*size);
+               if (tags==NULL) {
+                  fatal_alloc_error("compute_first_tags");
+               }
+            }
+            tags[n++]=tag;
+         }
+      }
+   }
+   qsort(tags,n,sizeof(int),compare_ints);
+   for (int m=members_start[c];m<members_start[c+1];m++) {
+      int g=members[m];
+      analysis->n_first_tags[g]=n;
+      analysis->first_tags[g]=(int*)malloc(sizeof(int)*(n>0?n:1));
+      if (analysis->first_tags[g]==NULL) {
+         fatal_alloc_error("compute_first_tags");
+      }
+      memcpy(analysis->first_tags[g],tags,sizeof(int)*n);
+      if (members_start[c+1]-members_start[c]>1 || has_self_loop(left_calls,g)) {
+         analysis->left_recursive[g]=1;
       }
    }
 }
-return modification;
+free(tags);
+free(members_start);
+free(members);
+free(tag_stamps);
 }
 
 
 /**
- * Cleans the control bytes of the fst2's states. If 'graphs_matching_E'
- * is not null, graphs_matching_E[i] is set to 1 if the graph #i matches <E>;
- * 0 otherwise.
+ * Allocates an empty analysis for the given fst2.
  */
-void clean_controls(Fst2* fst2,int* graphs_matching_E) {
-int i;
-if (graphs_matching_E!=NULL) {
-   for (i=1;i<fst2->number_of_graphs+1;i++) {
-      if (is_bit_mask_set(fst2->states[fst2->initial_states[i]]->control,UNCONDITIONAL_E_MATCH))
-         graphs_matching_E[i]=1;
-      else graphs_matching_E[i]=0;
-   }
+static struct fst2_analysis* new_fst2_analysis(const Fst2* fst2) {
+struct fst2_analysis* a=(struct fst2_analysis*)malloc(sizeof(struct fst2_analysis));
+if (a==NULL) {
+   fatal_alloc_error("new_fst2_analysis");
+}
+int n=fst2->number_of_graphs;
+a->number_of_graphs=n;
+a->number_of_states=fst2->number_of_states;
+a->number_of_tags=fst2->number_of_tags;
+a->number_of_transitions=get_number_of_transitions(fst2,&(a->checksum));
+a->nullable=(char*)calloc(n+1,sizeof(char));
+a->left_recursive=(char*)calloc(n+1,sizeof(char));
+a->first_tags=(int**)calloc(n+1,sizeof(int*));
+a->n_first_tags=(int*)calloc(n+1,sizeof(int));
+if (a->nullable==NULL || a->left_recursive==NULL || a->first_tags==NULL || a->n_first_tags==NULL) {
+   fatal_alloc_error("new_fst2_analysis");
+}
+return a;
 }
-int ALL_MASKS=CONDITIONAL_E_MATCH|UNCONDITIONAL_E_MATCH|DOES_NOT_MATCH_E|TMP_LOOP_MARK|VISITED_MARK;
-for (i=0;i<fst2->number_of_states;i++) {
-   unset_bit_mask(&(fst2->states[i]->control),(unsigned char)ALL_MASKS);
+
+
+void free_fst2_analysis(struct fst2_analysis* a) {
+if (a==NULL) return;
+for (int i=0;i<=a->number_of_graphs;i++) {
+   free(a->first_tags[i]);
 }
+free(a->first_tags);
+free(a->n_first_tags);
+free(a->nullable);
+free(a->left_recursive);
+free(a);
 }
 
 
 /**
- * Returns 1 if the given state has already been visited; 0 otherwise.
+ * Analyses the graph calls of the given fst2. If 'e_loop_graph' is not NULL,
+ * it is set to the lowest number of a graph that contains a loop that
+ * can be crossed without consuming anything, or to 0 if there is no such loop.
  */
-int look_for_E_loop_in_state(int state_number,Fst2* fst2,int* graphs_matching_E) {
-Transition* l;
-Fst2State e=fst2->states[state_number];
-if (is_bit_mask_set(e->control,TMP_LOOP_MARK)) {
-   /* If we have already visited this state */
-   unset_bit_mask(&(e->control),TMP_LOOP_MARK);
-   return 1;
+static struct fst2_analysis* analyse_fst2(const Fst2* fst2,int* e_loop_graph) {
+struct fst2_analysis* a=new_fst2_analysis(fst2);
+int n_graphs=fst2->number_of_graphs;
+int i;
+char* epsilon_tags=(char*)malloc(sizeof(char)*(fst2->number_of_tags>0?fst2->number_of_tags:1));
+if (epsilon_tags==NULL) {
+   fatal_alloc_error("analyse_fst2");
 }
-set_bit_mask(&(e->control),TMP_LOOP_MARK);
-l=e->transitions;
-while (l!=NULL) {
-   if (l->tag_number<0) {
-      /* If we have a graph call */
-      if (graphs_matching_E[-l->tag_number]) {
-         /* And if we can cross it because it matches <E> */
-         if (look_for_E_loop_in_state(l->state_number,fst2,graphs_matching_E)) {
-            /* And if we have reached the current state via an <E> loop */
-            unset_bit_mask(&(e->control),TMP_LOOP_MARK);
-            return 1;
-         }
-      }
+for (i=0;i<fst2->number_of_tags;i++) {
+   epsilon_tags[i]=(char)is_epsilon_tag(fst2->tags[i]);
+}
+compute_nullable_graphs(fst2,epsilon_tags,a->nullable);
+struct adjacency* epsilon=get_epsilon_transitions(fst2,epsilon_tags,a->nullable);
+if (e_loop_graph!=NULL) {
+   /* A loop made of <E> transitions is a component with several states or
+    * a state with a transition to itself */
+   *e_loop_graph=0;
+   int* state_scc=(int*)malloc(sizeof(int)*(fst2->number_of_states>0?fst2->number_of_states:1));
+   int* scc_size=(int*)calloc(fst2->number_of_states+1,sizeof(int));
+   if (state_scc==NULL || scc_size==NULL) {
+      fatal_alloc_error("analyse_fst2");
    }
-   else if (fst2->tags[l->tag_number]->control==1) {
-      /* If we have a tag that can match <E> */
-      if (look_for_E_loop_in_state(l->state_number,fst2,graphs_matching_E)) {
-         /* And if we have reached the current state via an <E> loop */
-         unset_bit_mask(&(e->control),TMP_LOOP_MARK);
-         return 1;
+   get_strongly_connected_components(epsilon,state_scc);
+   for (i=0;i<fst2->number_of_states;i++) {
+      scc_size[state_scc[i]]++;
+   }
+   for (int g=1;*e_loop_graph==0 && g<=n_graphs;g++) {
+      for (int s=0;s<fst2->number_of_states_per_graphs[g];s++) {
+         int state=fst2->initial_states[g]+s;
+         if (scc_size[state_scc[state]]>1 || has_self_loop(epsilon,state)) {
+            *e_loop_graph=g;
+            break;
+         }
       }
    }
-  l=l->next;
-}
-unset_bit_mask(&(e->control),TMP_LOOP_MARK);
-return 0;
+   free(state_scc);
+   free(scc_size);
+}
+struct adjacency* calls=NULL;
+struct adjacency* own_tags=NULL;
+explore_graph_beginnings(fst2,epsilon,&calls,&own_tags);
+int* graph_scc=(int*)malloc(sizeof(int)*(n_graphs+1));
+if (graph_scc==NULL) {
+   fatal_alloc_error("analyse_fst2");
+}
+/* The node #0 of 'calls' does not correspond to any graph, but since it
+ * has no transition, it is a component by itself that is ignored */
+int n_scc=get_strongly_connected_components(calls,graph_scc);
+compute_first_tags(fst2,calls,own_tags,graph_scc,n_scc,a);
+free_adjacency(calls);
+free(graph_scc);
+free_adjacency(own_tags);
+free_adjacency(epsilon);
+free(epsilon_tags);
+return a;
 }
 
 
-/**
- * Returns 1 and prints an error message if an <E> loop is found the graph #n;
- * returns 0 otherwise.
- */
-int look_for_E_loops(int n,Fst2* fst2,int* graphs_matching_E,U_FILE*ferr) {
-int first_state=fst2->initial_states[n];
-for (int i=0;i<fst2->number_of_states_per_graphs[n];i++) {
-   if (look_for_E_loop_in_state(first_state+i,fst2,graphs_matching_E)) {
-      error("ERROR: <E> loop in the graph %S\n",fst2->graph_names[n]);
-      if (ferr != NULL)
-        u_fprintf(ferr,"ERROR: <E> loop in the graph %S\n",fst2->graph_names[n]);
-      return 1;
-   }
-}
-return 0;
+struct fst2_analysis* analyse_fst2(const Fst2* fst2) {
+return analyse_fst2(fst2,NULL);
 }
 
 
 /**
- * Explores the transitions that outgo from the given state.
- * Returns 1 if a recursion is found; 0 otherwise.
+ * Looks for a left recursion, exploring the graphs from the main one and, in
+ * each graph, the transitions that can be crossed without consuming anything
+ * in the order of the fst2. If a graph calls a graph that is being explored,
+ * an error message is printed with the sequence of calls from this graph to
+ * itself, and 1 is returned. Returns 0 if there is no left recursion.
  */
-int explore_state(int state_number,struct list_int* l,Fst2* fst2,int* graphs_matching_E,U_FILE*ferr) {
-Fst2State s=fst2->states[state_number];
-int ret=0;
-if (s==NULL) return 0;
-if (is_bit_mask_set(s->control,TMP_LOOP_MARK|VISITED_MARK)) {
-   /* If this state has already been processed */
-   return 0;
-}
-set_bit_mask(&(s->control),TMP_LOOP_MARK|VISITED_MARK);
-Transition* list=s->transitions;
-while (list!=NULL) {
-   if (list->tag_number<0) {
-      /* If we have a subgraph call */
-      if (look_for_recursion(-(list->tag_number),l,fst2,graphs_matching_E,ferr)) {
-         /* If there is a recursion */
-         return 1;
+static int look_for_left_recursion(const Fst2* fst2,const char* nullable,U_FILE* ferr) {
+int n_graphs=fst2->number_of_graphs;
+int n_states=(fst2->number_of_states>0)?fst2->number_of_states:1;
+char* seen=(char*)calloc(n_states,sizeof(char));
+Transition** next=(Transition**)malloc(sizeof(Transition*)*n_states);
+int* stack=(int*)malloc(sizeof(int)*n_states);
+int* stamps=(int*)calloc(n_graphs+1,sizeof(int));
+int* calls_start=(int*)malloc(sizeof(int)*(n_graphs+2));
+int size=16;
+int* calls=(int*)malloc(sizeof(int)*size);
+if (seen==NULL || next==NULL || stack==NULL || stamps==NULL || calls_start==NULL || calls==NULL) {
+   fatal_alloc_error("look_for_left_recursion");
+}
+/* First, we list the calls that each graph can make from its beginning,
+ * in the order in which they are met */
+int n_calls=0;
+for (int g=1;g<=n_graphs;g++) {
+   calls_start[g]=n_calls;
+   int stack_size=0;
+   int initial=fst2->initial_states[g];
+   if (fst2->states[initial]==NULL) continue;
+   seen[initial]=1;
+   next[initial]=fst2->states[initial]->transitions;
+   stack[stack_size++]=initial;
+   while (stack_size!=0) {
+      int s=stack[stack_size-1];
+      Transition* t=next[s];
+      if (t==NULL) {
+         stack_size--;
+         continue;
       }
-      if (graphs_matching_E[-list->tag_number] && explore_state(list->state_number,l,fst2,graphs_matching_E,ferr)) {
-         /* If the graph matches <E> */
-         return 1;
+      next[s]=t->next;
+      int go_on;
+      if (t->tag_number<0) {
+         int callee=-(t->tag_number);
+         if (stamps[callee]!=g) {
+            stamps[callee]=g;
+            if (n_calls==size) {
+               size=size*2;
+               calls=(int*)realloc(calls,sizeof(int)*size);
+               if (calls==NULL) {
+                  fatal_alloc_error("look_for_left_recursion");
+               }
+            }
+            calls[n_calls++]=callee;
+         }
+         go_on=nullable[callee];
+      } else {
+         go_on=is_epsilon_tag(fst2->tags[t->tag_number]);
       }
-   } else if (fst2->tags[list->tag_number]->control==1) {
-      /* If we have a transition that can match <E> */
-      if (explore_state(list->state_number,l,fst2,graphs_matching_E,ferr)) {
-         return 1;
+      if (go_on && !seen[t->state_number] && fst2->states[t->state_number]!=NULL) {
+         seen[t->state_number]=1;
+         next[t->state_number]=fst2->states[t->state_number]->transitions;
+         stack[stack_size++]=t->state_number;
       }
    }
-   list=list->next;
 }
-unset_bit_mask(&(s->control),TMP_LOOP_MARK);
-return ret;
-}
-
-
-/**
- * Returns 1 and prints an error message if a recursion is found in graph #n;
- * returns 0 otherwise.
- */
-int look_for_recursion(int n,struct list_int* l,Fst2* fst2,int* graphs_matching_E,U_FILE*ferr) {
-if (is_in_list(n,l)) {
-   /* If we find a graph that has already been visited */
-   print_reversed_list(l,n,fst2->graph_names,ferr);
-   error(" recalls the graph %S\n",fst2->graph_names[n]);
-   if (ferr != NULL)
-      u_fprintf(ferr," recalls the graph %S\n",fst2->graph_names[n]);
-   return 1;
+calls_start[n_graphs+1]=n_calls;
+/* Then, we explore the graph of those calls. stamps[g] is 0 if the graph
+ * has not been explored yet, 1 if it is being explored and 2 otherwise */
+int* path=stack;
+int* position=(int*)malloc(sizeof(int)*(n_graphs+1));
+int* path_index=(int*)malloc(sizeof(int)*(n_graphs+1));
+if (position==NULL || path_index==NULL) {
+   fatal_alloc_error("look_for_left_recursion");
+}
+memset(stamps,0,sizeof(int)*(n_graphs+1));
+int found=0;
+for (int root=1;!found && root<=n_graphs;root++) {
+   if (stamps[root]!=0) continue;
+   int length=0;
+   stamps[root]=1;
+   path_index[root]=length;
+   position[length]=calls_start[root];
+   path[length++]=root;
+   while (!found && length!=0) {
+      int g=path[length-1];
+      if (position[length-1]==calls_start[g+1]) {
+         stamps[g]=2;
+         length--;
+         continue;
+      }
+      int callee=calls[position[length-1]++];
+      if (stamps[callee]==1) {
+         /* The sequence of calls from 'callee' to itself is on the path */
+         int i=path_index[callee];
+         error("ERROR: %S",fst2->graph_names[callee]);
+         if (ferr!=NULL) u_fprintf(ferr,"ERROR: %S",fst2->graph_names[callee]);
+         for (i++;i<length;i++) {
+            error(" calls %S that",fst2->graph_names[path[i]]);
+            if (ferr!=NULL) u_fprintf(ferr," calls %S that",fst2->graph_names[path[i]]);
+         }
+         error(" recalls the graph %S\n",fst2->graph_names[callee]);
+         if (ferr!=NULL) u_fprintf(ferr," recalls the graph %S\n",fst2->graph_names[callee]);
+         found=1;
+      } else if (stamps[callee]==0) {
+         stamps[callee]=1;
+         path_index[callee]=length;
+         position[length]=calls_start[callee];
+         path[length++]=callee;
+      }
+   }
 }
-l=new_list_int(n,l);
-int ret=explore_state(fst2->initial_states[n],l,fst2,graphs_matching_E,ferr);
-delete_head(&l);
-return ret;
+free(seen);
+free(next);
+free(stack);
+free(stamps);
+free(calls_start);
+free(calls);
+free(position);
+free(path_index);
+return found;
 }
 
 
@@ -571,11 +751,13 @@ return ret;
  * 1) no left recursion
  * 2) no loop that can recognize the empty word (<E> with an output or subgraph
  *    that can match the empty word).
+ *
+ * If 'save_analysis' is non zero and if the .fst2 is OK, the results of the
+ * analysis are saved in the .fst2a file that goes with the .fst2.
  */
-int OK_for_Locate_write_error(const char* name,char no_empty_graph_warning,U_FILE* ferr) {
-ConditionList* conditions;
-ConditionList* conditions_for_state;
-int i,j;
+int OK_for_Locate_write_error(const char* name,char no_empty_graph_warning,U_FILE* ferr,
+                              int save_analysis) {
+int i;
 int ERROR=0;
 struct FST2_free_info fst2_free;
 Fst2* fst2=load_abstract_fst2(name,1,&fst2_free);
@@ -583,51 +765,13 @@ if (fst2==NULL) {
 	fatal_error("Cannot load graph %s\n",name);
 }
 u_printf("Recursion detection started\n");
-int* graphs_matching_E=(int*)malloc(sizeof(int)*(fst2->number_of_graphs+1));
-conditions=(ConditionList*)malloc(sizeof(ConditionList)*(fst2->number_of_graphs+1));
-if (graphs_matching_E==NULL || conditions==NULL) {
-   fatal_alloc_error("OK_for_Locate");
-}
-for (i=0;i<fst2->number_of_graphs+1;i++) {
-   graphs_matching_E[i]=0;
-   conditions[i]=NULL;
-}
-/* First, we look for tags that match the empty word <E> */
-for (i=0;i<fst2->number_of_tags;i++) {
-   check_epsilon_tag(fst2->tags[i]);
-}
-/* Then, we look for graphs that match <E> with or without conditions */
-for (i=1;i<=fst2->number_of_graphs;i++) {
-   conditions_for_state=(ConditionList*)malloc(sizeof(ConditionList)*fst2->number_of_states_per_graphs[i]);
-   if (conditions_for_state==NULL) {
-      fatal_alloc_error("OK_for_Locate");
-   }
-   for (j=0;j<fst2->number_of_states_per_graphs[i];j++) {
-      conditions_for_state[j]=NULL;
-   }
-   graphs_matching_E[i]=graph_matches_E(fst2->initial_states[i],fst2->initial_states[i],
-  								      fst2->states,fst2->tags,i,fst2->graph_names,
-  								      conditions_for_state,&conditions[i]);
-   /* If any, we remove the temp conditions */                        
-   if (conditions[i]!=NULL) free_ConditionList(conditions[i]);
-   /* And we way that the conditions for the current graph are its initial
-    * state's ones. */
-   conditions[i]=conditions_for_state[0];
-   /* Then we perform cleaning */
-   conditions_for_state[0]=NULL;
-   for (j=1;j<fst2->number_of_states_per_graphs[i];j++) {
-      free_ConditionList(conditions_for_state[j]);
-   }
-   free(conditions_for_state); 
-}
-/* Then, we use all our condition lists to determine which graphs match <E>.
- * We iterate until we find a fixed point. If some conditions remain non null
- * after this loop, it means that there are <E> dependencies between graphs
- * and this case will be dealt with later. */
 u_printf("Resolving <E> conditions\n");
-while (resolve_conditions(conditions,fst2->number_of_graphs,
-							fst2->states,fst2->initial_states,ferr)) {}
-if (is_bit_mask_set(fst2->states[fst2->initial_states[1]]->control,UNCONDITIONAL_E_MATCH)) {
+/* We look for the graphs that match <E>, for the loops that can be crossed
+ * without consuming anything and for the calls that can be made without
+ * consuming anything, all at once */
+int e_loop_graph;
+struct fst2_analysis* analysis=analyse_fst2(fst2,&e_loop_graph);
+if (analysis->nullable[1]) {
    /* If the main graph matches <E> */
    if (!no_empty_graph_warning) {
        error("ERROR: the main graph %S recognizes <E>\n",fst2->graph_names[1]);
@@ -638,7 +782,7 @@ if (is_bit_mask_set(fst2->states[fst2->initial_states[1]]->control,UNCONDITIONAL
 }
 if (!ERROR) {
    for (i=1;i<fst2->number_of_graphs+1;i++) {
-      if (is_bit_mask_set(fst2->states[fst2->initial_states[i]]->control,UNCONDITIONAL_E_MATCH)) {
+      if (analysis->nullable[i]) {
          /* If the graph matches <E> */
          if (!no_empty_graph_warning) {
              error("WARNING: the graph %S recognizes <E>\n",fst2->graph_names[i]);
@@ -648,27 +792,33 @@ if (!ERROR) {
       }
    }
 }
-clean_controls(fst2,graphs_matching_E);
 if (!ERROR) {
    u_printf("Looking for <E> loops\n");
-   for (i=1;!ERROR && i<fst2->number_of_graphs+1;i++) {
-      ERROR=look_for_E_loops(i,fst2,graphs_matching_E,ferr);
+   if (e_loop_graph!=0) {
+      error("ERROR: <E> loop in the graph %S\n",fst2->graph_names[e_loop_graph]);
+      if (ferr != NULL)
+        u_fprintf(ferr,"ERROR: <E> loop in the graph %S\n",fst2->graph_names[e_loop_graph]);
+      ERROR=1;
    }
 }
-clean_controls(fst2,NULL);
 if (!ERROR) {
    u_printf("Looking for infinite recursions\n");
    for (i=1;!ERROR && i<fst2->number_of_graphs+1;i++) {
-      ERROR=look_for_recursion(i,NULL,fst2,graphs_matching_E,ferr);
+      if (analysis->left_recursive[i]) {
+         /* We look for the recursion again, only to report it */
+         ERROR=look_for_left_recursion(fst2,analysis->nullable,ferr);
+         if (!ERROR) {
+            fatal_error("Internal error in OK_for_Locate_write_error\n");
+         }
+      }
    }
 }
-for (i=1;i<fst2->number_of_graphs+1;i++) {
-   free_ConditionList(conditions[i]);
+if (!ERROR && save_analysis) {
+   save_fst2_analysis(name,analysis);
 }
+free_fst2_analysis(analysis);
 free_abstract_Fst2(fst2,&fst2_free);
 u_printf("Recursion detection completed\n");
-free(conditions);
-free(graphs_matching_E);
 if (ERROR) return LEFT_RECURSION;
 return NO_LEFT_RECURSION;
 }
@@ -676,9 +826,166 @@ return NO_LEFT_RECURSION;
 
 int OK_for_Locate(const char* name,char no_empty_graph_warning)
 {
-    return OK_for_Locate_write_error(name,no_empty_graph_warning,NULL);
+    return OK_for_Locate_write_error(name,no_empty_graph_warning,NULL,0);
+}
+
+
+/**
+ * Builds the name of the .fst2a that goes with the given .fst2.
+ */
+void get_fst2_analysis_name(const char* fst2,char* fst2a) {
+remove_extension(fst2,fst2a);
+strcat(fst2a,".fst2a");
+}
+
+
+/**
+ * Removes the .fst2a of the given .fst2, if any. This must be done by the
+ * programs that write a .fst2, since its analysis is no longer valid.
+ */
+void remove_fst2_analysis(const char* fst2) {
+char fst2a[FILENAME_MAX];
+get_fst2_analysis_name(fst2,fst2a);
+if (fexists(fst2a)) {
+   af_remove(fst2a);
+}
 }
 
+
+/**
+ * Returns a hash of the contents of the given file, or 0 if it cannot be read.
+ * Unlike the checksum of the analysis, it also covers the tags, so that an
+ * edited box is enough to make the .fst2a stale.
+ */
+static int get_file_hash(const char* name) {
+U_FILE* f=u_fopen(BINARY,name,U_READ);
+if (f==NULL) {
+   return 0;
+}
+unsigned int h=2166136261u;
+unsigned char buffer[8192];
+size_t n;
+while ((n=fread(buffer,1,sizeof(buffer),f))>0) {
+   for (size_t i=0;i<n;i++) {
+      h=(h^buffer[i])*16777619u;
+   }
+}
+u_fclose(f);
+return (int)h;
+}
+
+
+/**
+ * Writes the given ints to the given binary file.
+ */
+static void write_ints(const int* t,int n,U_FILE* f) {
+if (n>0 && (size_t)n!=fwrite(t,sizeof(int),n,f)) {
+   fatal_error("Write error on .fst2a file\n");
+}
+}
+
+
+/**
+ * Saves the given analysis in the .fst2a that goes with the given .fst2. This
+ * file is made of ints: a header (FST2A_MAGIC, FST2A_VERSION, the numbers of graphs,
+ * states, tags and transitions of the .fst2, its size in bytes, its checksum and
+ * the hash of its contents),
+ * followed, for each graph, by its flags (1 if it matches <E>, 2 if it is left
+ * recursive), its number of first tags and these tags.
+ */
+void save_fst2_analysis(const char* fst2,const struct fst2_analysis* a) {
+char fst2a[FILENAME_MAX];
+get_fst2_analysis_name(fst2,fst2a);
+U_FILE* f=u_fopen(BINARY,fst2a,U_WRITE);
+if (f==NULL) {
+   error("Cannot create %s\n",fst2a);
+   return;
+}
+int header[FST2A_HEADER_SIZE];
+header[0]=FST2A_MAGIC;
+header[1]=FST2A_VERSION;
+header[2]=a->number_of_graphs;
+header[3]=a->number_of_states;
+header[4]=a->number_of_tags;
+header[5]=a->number_of_transitions;
+header[6]=(int)get_file_size(fst2);
+header[7]=a->checksum;
+header[8]=get_file_hash(fst2);
+write_ints(header,FST2A_HEADER_SIZE,f);
+for (int i=1;i<=a->number_of_graphs;i++) {
+   int tmp[2];
+   tmp[0]=(a->nullable[i]?1:0)|(a->left_recursive[i]?2:0);
+   tmp[1]=a->n_first_tags[i];
+   write_ints(tmp,2,f);
+   write_ints(a->first_tags[i],a->n_first_tags[i],f);
+}
+u_fclose(f);
+}
+
+
+/**
+ * Reads n ints from the given file. Returns 1 in case of success; 0 otherwise.
+ */
+static int read_ints(int* t,int n,U_FILE* f) {
+return (n==0 || (size_t)n==fread(t,sizeof(int),n,f));
+}
+
+
+/**
+ * Loads the analysis of the given fst2 from its .fst2a. Returns NULL if there
+ * is no such file, or if it does not match the given fst2.
+ */
+struct fst2_analysis* load_fst2_analysis(const char* name,const Fst2* fst2) {
+char fst2a[FILENAME_MAX];
+get_fst2_analysis_name(name,fst2a);
+if (!fexists(fst2a)) {
+   return NULL;
+}
+U_FILE* f=u_fopen(BINARY,fst2a,U_READ);
+if (f==NULL) {
+   return NULL;
+}
+struct fst2_analysis* a=new_fst2_analysis(fst2);
+int header[FST2A_HEADER_SIZE];
+int ok=(read_ints(header,FST2A_HEADER_SIZE,f)
+        && header[0]==FST2A_MAGIC && header[1]==FST2A_VERSION
+        && header[2]==a->number_of_graphs && header[3]==a->number_of_states
+        && header[4]==a->number_of_tags && header[5]==a->number_of_transitions
+        && header[6]==(int)get_file_size(name) && header[7]==a->checksum
+        && header[8]==get_file_hash(name));
+for (int i=1;ok && i<=a->number_of_graphs;i++) {
+   int tmp[2];
+   if (!read_ints(tmp,2,f) || tmp[1]<0 || tmp[1]>a->number_of_tags) {
+      ok=0;
+      break;
+   }
+   a->nullable[i]=(char)((tmp[0]&1)!=0);
+   a->left_recursive[i]=(char)((tmp[0]&2)!=0);
+   a->n_first_tags[i]=tmp[1];
+   a->first_tags[i]=(int*)malloc(sizeof(int)*(tmp[1]>0?tmp[1]:1));
+   if (a->first_tags[i]==NULL) {
+      fatal_alloc_error("load_fst2_analysis");
+   }
+   if (!read_ints(a->first_tags[i],tmp[1],f)) {
+      ok=0;
+      break;
+   }
+   for (int j=0;j<tmp[1];j++) {
+      if (a->first_tags[i][j]<0 || a->first_tags[i][j]>=a->number_of_tags) {
+         ok=0;
+         break;
+      }
+   }
+}
+u_fclose(f);
+if (!ok) {
+   free_fst2_analysis(a);
+   return NULL;
+}
+return a;
+}
+
+
 #define NOT_SEEN_YET 0
 #define SEEN 1
 #define BEING_EXPLORED 2
@@ -29,8 +29,53 @@
 #include "AbstractFst2Load.h"
 
 
+/**
+ * This structure contains the results of the analysis of the graph calls
+ * of a .fst2. A tag is considered as matching the empty word if it is <E>
+ * or a $ mark (variable, context, morphological mode). Arrays are indexed
+ * by graph numbers, from 1 to number_of_graphs.
+ */
+struct fst2_analysis {
+   /* These fields describe the .fst2 that has been analysed */
+   int number_of_graphs;
+   int number_of_states;
+   int number_of_tags;
+   int number_of_transitions;
+   /* A hash of the states and transitions, so that a .fst2a is not
+    * used for a .fst2 whose structure has changed */
+   int checksum;
+
+   /* nullable[i] is 1 if the graph #i can match <E>; 0 otherwise */
+   char* nullable;
+   /* left_recursive[i] is 1 if the graph #i can call itself, directly
+    * or not, without consuming anything; 0 otherwise */
+   char* left_recursive;
+   /* first_tags[i] is the sorted array of the tags of all the transitions
+    * that can be tried from the beginning of the graph #i, including in its
+    * subgraphs, before anything is consumed. n_first_tags[i] is its size */
+   int** first_tags;
+   int* n_first_tags;
+};
+
+
+/*
+ * The .fst2a file is made of ints. The header contains FST2A_MAGIC,
+ * FST2A_VERSION, the numbers of graphs, states, tags and transitions of
+ * the .fst2, its size in bytes, its checksum and the hash of its contents.
+ */
+#define FST2A_MAGIC 0x61327346
+#define FST2A_VERSION 2
+#define FST2A_HEADER_SIZE 9
+
+
 int OK_for_Locate(const char*,char);
-int OK_for_Locate_write_error(const char*,char,U_FILE*);
+int OK_for_Locate_write_error(const char*,char,U_FILE*,int);
+struct fst2_analysis* analyse_fst2(const Fst2*);
+void free_fst2_analysis(struct fst2_analysis*);
+void get_fst2_analysis_name(const char*,char*);
+void save_fst2_analysis(const char*,const struct fst2_analysis*);
+void remove_fst2_analysis(const char*);
+struct fst2_analysis* load_fst2_analysis(const char*,const Fst2*);
 int valid_sentence_automaton(const char*);
 int valid_sentence_automaton_write_error(const char*,U_FILE*);
 
@@ -31,6 +31,7 @@
 #include "File.h"
 #include "Error.h"
 #include "Transitions.h"
+#include "logger/SyncLogger.h"
 
 
 
@@ -57,7 +58,9 @@ const char* usage_Fst2List =
 "                    default null\r\n"\
 " -m  : mode special for description with alphabet\r\n"\
 " -v : verbose mode  default null\r\n"\
-" -r[s/l/x] \"L[,R]\"  : present recusive path(c0|...|cn) by Lc0|..|cnR : default null\r\n";
+" -r[s/l/x] \"L[,R]\"  : present recusive path(c0|...|cn) by Lc0|..|cnR : default null\r\n"\
+" --threads=N : explore the paths with N threads (default=1), 0 means one thread\r\n"\
+"               per processor. The paths are written in the same order\r\n";
 
 
 static void usage() {
@@ -167,7 +170,8 @@ public:
 	int verboseMode;
 //	int control_char; // control the output for control_chars <>
 #define	PATH_QUEUE_MAX	1024
-	struct pathAndEti pathEtiQ[PATH_QUEUE_MAX];
+	// a path longer than PATH_QUEUE_MAX is stopped, after two more marks
+	struct pathAndEti pathEtiQ[PATH_QUEUE_MAX+2];
 	int pathEtiQidx;
 #define ETIQ_MAX		1024
 
@@ -180,6 +184,11 @@ public:
 	//
 	void loadGraph(int &changeStrToIdx,unichar changeStrTo[][MAX_CHANGE_SYMBOL_SIZE],char *fname);
 	int exploirerSubAuto(int startSubAutoNum);
+	int exploirerRoot(int startSubAutoNum);
+	int exploirerSubAutoInParts(int startSubAutoNum);
+	int appendPart(const char *partName);
+	void initThreadCopy(CFstApp *ownerApp);
+	void resetPathState();
 	int getWordsFromGraph(int &changeStrToIdx,unichar changeStrTo[][MAX_CHANGE_SYMBOL_SIZE],char *fst2_file_name);
 		int findCycleSubGraph(int autoNo,int autodep,int testEtat,int depthState);
 			int outWordsOfGraph(int depth);
@@ -192,6 +201,61 @@ public:
 	} CautoQueue[2048];
 	int CautoDepth;
 
+	//
+	// explicit stack of the depth first exploration, with one frame
+	// per state of the current path, so that its size is bounded
+	//
+	struct dfsFrame {
+		int autoNo;
+		int autoDepth;
+		int etatNo;
+		int etatDepth;
+		int popAuto;	// 1 if CautoDepth must be decreased when leaving
+		int entered;
+		int partNo;		// part of the next transition, for the root frame
+		Transition *next;
+	} dfsStack[PATH_QUEUE_MAX+2];
+	int dfsDepth;
+	void pushFrame(int autoNo,int autoDepth,int etatNo,int etatDepth,int popAuto)
+	{
+		if(dfsDepth == PATH_QUEUE_MAX+2) fatal_error("Too deep exploration\n");
+		struct dfsFrame *f = &dfsStack[dfsDepth++];
+		f->autoNo = autoNo;
+		f->autoDepth = autoDepth;
+		f->etatNo = etatNo;
+		f->etatDepth = etatDepth;
+		f->popAuto = popAuto;
+		f->entered = 0;
+		f->partNo = 1;
+		f->next = 0;
+	}
+	void popFrame()
+	{
+		--dfsDepth;
+		if(dfsDepth == 0) return;	// the root entry is removed by the caller
+		--pathEtiQidx;
+		CautoDepth -= dfsStack[dfsDepth].popAuto;
+	}
+	// the call of the explored graph, which identifies the root context
+	Transition startCallTr;
+
+	//
+	// the paths of a graph are cut in parts : the part 0 is the path
+	// ending at the initial state, the part i is the paths starting with
+	// the ith transition of the initial state. When rootPartFirst is not -1,
+	// only the parts from rootPartFirst to rootPartEnd-1 are explored
+	//
+	int rootPartFirst;
+	int rootPartEnd;
+	int inRootPart(int partNo)
+	{
+		return (rootPartFirst == -1) || (dfsDepth != 1) ||
+			((partNo >= rootPartFirst) && (partNo < rootPartEnd));
+	}
+	int n_threads;
+	// the application which created this one for a thread, or NULL
+	CFstApp *owner;
+
 	void CqueuePathPr(U_FILE *f);
 
 	int *ignoreTable;
@@ -269,6 +333,12 @@ public:
 		pathEtiQidx(0),
 
         CautoDepth(0),
+        dfsDepth(0),
+        startCallTr(),
+        rootPartFirst(-1),
+        rootPartEnd(-1),
+        n_threads(1),
+        owner(NULL),
 
 		ignoreTable(0),
 		numOfIgnore(0),
@@ -302,8 +372,9 @@ public:
         mask_encoding_compatibility_input(DEFAULT_MASK_ENCODING_COMPATIBILITY_INPUT),
 
         autoStackMap(NULL),
-        mapOfCallHead(NULL),
-        mapOfCallTail(NULL),
+        callIdHash(NULL),
+        callIdHashSize(0),
+        callIdCount(0),
 
         cycInfos(NULL),
 
@@ -312,23 +383,45 @@ public:
 		headCycNodes(0),
 		cycNodeCnt(0),
 
+        EBuff(NULL),
+        TBuff(NULL),
         ePtrCnt(0),
         tPtrCnt(0),
+        EBuffSize(256),
+        TBuffSize(256),
+        EOUTLINE(NULL),
+        SOUTLINE(NULL),
         EOutCnt(0),
         SOutCnt(0),
+        EOutSize(4096),
+        SOutSize(4096),
 
         arretSubListIdx(0)
 		{
+		EBuff = (unichar *)malloc(EBuffSize * sizeof(unichar));
+		TBuff = (unichar *)malloc(TBuffSize * sizeof(unichar));
+		EOUTLINE = (unichar *)malloc(EOutSize * sizeof(unichar));
+		SOUTLINE = (unichar *)malloc(SOutSize * sizeof(unichar));
+		if(!EBuff || !TBuff || !EOUTLINE || !SOUTLINE) fatal_alloc_error("CFstApp");
 		initCallIdMap();
 	};
 	~CFstApp(){
+		free(EBuff);
+		free(TBuff);
+		free(EOUTLINE);
+		free(SOUTLINE);
+		if(owner){	// the graph, options and cycles belong to the owner
+			delete [] numOfIgnore;
+			delete [] autoStackMap;
+			return;
+		}
 	   arretExpoDel();
 		cleanCyclePath();
 		free_abstract_Fst2(a,&fst2_free);
-      if(saveSep != u_null_string) delete saveSep;
-      if(sep1 != u_null_string) delete sep1;
-		if(stopSignal != u_null_string) delete stopSignal;
-		if(saveEntre != u_null_string) delete saveEntre;
+      if(saveSep != u_null_string) delete [] saveSep;
+      if(sep1 != u_null_string) delete [] sep1;
+		if(stopSignal != u_null_string) delete [] stopSignal;
+		if(saveEntre != u_null_string) delete [] saveEntre;
 		if(ignoreTable) delete [] ignoreTable;
         if(numOfIgnore) delete [] numOfIgnore;
 		finiCallIdMap();
@@ -345,60 +438,86 @@ public:
      Transition* tran;
      int autoId;
     } *autoStackMap;
+    //
+    //    the call stacks form a tree : a call stack is identified by
+    //    the id of the stack without its last call and by this last call,
+    //    so that each stack costs one node, whatever its depth
+    //
     struct callIdMap {
-        int cnt;
-        Transition** list;
+        int parent;
+        Transition* tran;
+        int id;
         struct callIdMap *next;
-    } *mapOfCallHead,*mapOfCallTail;
-
+    } **callIdHash;
+    int callIdHashSize;
+    int callIdCount;
 
+    unsigned int callIdHashCode(int parent,Transition* tran)
+    {
+        return ((unsigned int)((size_t)tran / sizeof(Transition)) * 2654435761u
+              + (unsigned int)parent) & (callIdHashSize - 1);
+    }
     int callIdentifyId(struct callStackMapSt *cmap,int count)
     {
-        int id = 0;
-        int i;
+        int parent = (count > 1) ? cmap[count-2].autoId : -1;
+        Transition* tran = cmap[count-1].tran;
+        unsigned int h = callIdHashCode(parent,tran);
         struct callIdMap *fPtr;
-        fPtr = mapOfCallHead;
-        while(fPtr){
-            if(fPtr->cnt == count){
-                for(i = 0; i < count;i++)
-                    if(fPtr->list[i] != cmap[i].tran)
-                        break;
-                if(i == count) {
-                    return id;
+        for(fPtr = callIdHash[h];fPtr;fPtr = fPtr->next){
+            if((fPtr->parent == parent) && (fPtr->tran == tran))
+                return fPtr->id;
+        }
+        if(owner){
+            // all the stacks are identified by the owner before it
+            // explores the paths with threads
+            fatal_error("Unexpected sub-graph call in thread\n");
+        }
+        if(callIdCount >= 2*callIdHashSize){
+            int oldSize = callIdHashSize;
+            struct callIdMap **oldHash = callIdHash;
+            callIdHashSize *= 2;
+            callIdHash = new struct callIdMap*[callIdHashSize];
+            for(int i = 0; i < callIdHashSize;i++) callIdHash[i] = 0;
+            for(int i = 0; i < oldSize;i++){
+                while(oldHash[i]){
+                    fPtr = oldHash[i];
+                    oldHash[i] = fPtr->next;
+                    h = callIdHashCode(fPtr->parent,fPtr->tran);
+                    fPtr->next = callIdHash[h];
+                    callIdHash[h] = fPtr;
                 }
             }
-            id++;
-            fPtr = fPtr->next;
+            delete [] oldHash;
+            h = callIdHashCode(parent,tran);
         }
         fPtr = new struct callIdMap;
-        fPtr->cnt = count;
-        fPtr->next = 0;
-        fPtr->list = new Transition*[count];
-        for(i = 0; i < count;i++) fPtr->list[i] = cmap[i].tran;
-
-        if(mapOfCallTail){
-                mapOfCallTail->next = fPtr;
-                mapOfCallTail = fPtr;
-        } else {
-                mapOfCallTail = mapOfCallHead = fPtr;
-        }
-        return id;
+        fPtr->parent = parent;
+        fPtr->tran = tran;
+        fPtr->id = callIdCount++;
+        fPtr->next = callIdHash[h];
+        callIdHash[h] = fPtr;
+        return fPtr->id;
     }
     void initCallIdMap()
     {
-        autoStackMap = new struct callStackMapSt[1024];
-        mapOfCallHead = mapOfCallTail = 0;
+        autoStackMap = new struct callStackMapSt[PATH_QUEUE_MAX+2];
+        callIdHashSize = 1024;
+        callIdHash = new struct callIdMap*[callIdHashSize];
+        for(int i = 0; i < callIdHashSize;i++) callIdHash[i] = 0;
+        callIdCount = 0;
     }
     void finiCallIdMap()
     {
+        struct callIdMap *fPtr;
         delete [] autoStackMap;
-        while(mapOfCallHead)
-        {
-           mapOfCallTail = mapOfCallHead;
-            mapOfCallHead = mapOfCallHead->next;
-            delete [] mapOfCallTail->list;
-            delete mapOfCallTail;
+        for(int i = 0; i < callIdHashSize;i++){
+            while(callIdHash[i]){
+                fPtr = callIdHash[i];
+                callIdHash[i] = fPtr->next;
+                delete fPtr;
+            }
         }
+        delete [] callIdHash;
     }
     
 	//
@@ -596,7 +715,7 @@ public:
 		cp = headCyc;
 		while(cp){
 			tc = cp->next;
-			delete cp->pathEtiQueue;
+			delete [] cp->pathEtiQueue;
 			delete cp;
 			cp = tc;
 		}
@@ -674,19 +793,40 @@ public:
     }
 
 
-	unichar EBuff[128];
-	unichar TBuff[128];
+	//
+	//	the buffers of a path grow with it, a slot is always kept
+	//	for the final 0
+	//
+	unichar *EBuff;
+	unichar *TBuff;
 	int ePtrCnt;
 	int tPtrCnt;
-	unichar EOUTLINE[4096];
-	unichar SOUTLINE[4096];
+	int EBuffSize;
+	int TBuffSize;
+	unichar *EOUTLINE;
+	unichar *SOUTLINE;
 	int EOutCnt;
 	int SOutCnt;
+	int EOutSize;
+	int SOutSize;
 
 	void resetBuffs()
 	{
 		ePtrCnt = tPtrCnt = EOutCnt= SOutCnt = 0;
 	}
+	static void putBuff(unichar **buff,int *size,int *cnt,unichar c)
+	{
+		if(*cnt + 1 >= *size){
+			*size *= 2;
+			*buff = (unichar *)realloc(*buff,*size * sizeof(unichar));
+			if(!*buff) fatal_alloc_error("putBuff");
+		}
+		(*buff)[(*cnt)++] = c;
+	}
+	void putE(unichar c){ putBuff(&EBuff,&EBuffSize,&ePtrCnt,c); }
+	void putT(unichar c){ putBuff(&TBuff,&TBuffSize,&tPtrCnt,c); }
+	void putEOut(unichar c){ putBuff(&EOUTLINE,&EOutSize,&EOutCnt,c); }
+	void putSOut(unichar c){ putBuff(&SOUTLINE,&SOutSize,&SOutCnt,c); }
 
 	int outOneWord(unichar *suf){
 		int i;
@@ -702,37 +842,37 @@ public:
             if(prMode == PR_SEPARATION){
     			wp = sepL;
     			while(*wp) {
-      				EOUTLINE[EOutCnt++] = *wp;
-			        if(automateMode == TRANMODE)SOUTLINE[SOutCnt++] = *wp;
+      				putEOut(*wp);
+			        if(automateMode == TRANMODE)putSOut(*wp);
     				wp++;
     			}
-    			for(i = 0; i < ePtrCnt;i++) EOUTLINE[EOutCnt++] = EBuff[i];
+    			for(i = 0; i < ePtrCnt;i++) putEOut(EBuff[i]);
    				if(automateMode == TRANMODE)
                      for(i = 0; i < tPtrCnt;i++)
-                      SOUTLINE[SOutCnt++] = TBuff[i];
+                      putSOut(TBuff[i]);
     			wp = sepR;
     			while(*wp) {
-    				if(ePtrCnt) EOUTLINE[EOutCnt++] = *wp;
-			        if(automateMode == TRANMODE)SOUTLINE[SOutCnt++] = *wp;
+    				if(ePtrCnt) putEOut(*wp);
+			        if(automateMode == TRANMODE)putSOut(*wp);
     				wp++;
     			}
             } else {
-    			wp = sepL;while(*wp) EOUTLINE[EOutCnt++] = *wp++;
-    			for(i = 0; i < ePtrCnt;i++) EOUTLINE[EOutCnt++] = EBuff[i];
-				wp = saveSep;while(*wp) EOUTLINE[EOutCnt++] = *wp++;
+    			wp = sepL;while(*wp) putEOut(*wp++);
+    			for(i = 0; i < ePtrCnt;i++) putEOut(EBuff[i]);
+				wp = saveSep;while(*wp) putEOut(*wp++);
 				if(automateMode == TRANMODE)
                     for(i = 0; i < tPtrCnt;i++)
-    					EOUTLINE[EOutCnt++] = TBuff[i];
-    			wp = sepR; while(*wp) EOUTLINE[EOutCnt++] = *wp++;
+    					putEOut(TBuff[i]);
+    			wp = sepR; while(*wp) putEOut(*wp++);
             }
 		  } // condition de out
 			if((recursiveMode == LABEL) && setOut){
 			    if((automateMode == TRANMODE)&&(prMode == PR_SEPARATION)){
-				wp = entreGO;while(*wp)	SOUTLINE[SOutCnt++] = *wp++;
-				wp = suf;while(*wp)	SOUTLINE[SOutCnt++] = *wp++;
+				wp = entreGO;while(*wp)	putSOut(*wp++);
+				wp = suf;while(*wp)	putSOut(*wp++);
 			    } else {
-				wp = entreGO;while(*wp)	EOUTLINE[EOutCnt++] = *wp++;
-				wp = suf;while(*wp)	EOUTLINE[EOutCnt++] = *wp++;
+				wp = entreGO;while(*wp)	putEOut(*wp++);
+				wp = suf;while(*wp)	putEOut(*wp++);
 				}
 			}
 			EOUTLINE[EOutCnt] = 0; SOUTLINE[SOutCnt] = 0;
@@ -749,34 +889,34 @@ public:
             if(prMode == PR_SEPARATION){
     			wp = sepL;
     			while(*wp) {
-    				EOUTLINE[EOutCnt++] = *wp;
-                    if(automateMode == TRANMODE) SOUTLINE[SOutCnt++] = *wp;
+    				putEOut(*wp);
+                    if(automateMode == TRANMODE) putSOut(*wp);
     				wp++;
     			}
-    			for(i = 0; i < ePtrCnt;i++) EOUTLINE[EOutCnt++] = EBuff[i];
+    			for(i = 0; i < ePtrCnt;i++) putEOut(EBuff[i]);
 				if(automateMode == TRANMODE)
 	   				for(i = 0; i < tPtrCnt;i++)
-                        SOUTLINE[SOutCnt++] = TBuff[i];
+                        putSOut(TBuff[i]);
 //				if(recursiveMode == LABEL){
-//				  wp = entreGO;while(*wp)	EOUTLINE[EOutCnt++] = *wp++;
+//				  wp = entreGO;while(*wp)	putEOut(*wp++);
 //			    }
     			wp = sepR;
     			while(*wp) {
-    				EOUTLINE[EOutCnt++] = *wp;
-                    if(automateMode == TRANMODE) SOUTLINE[SOutCnt++] = *wp;
+    				putEOut(*wp);
+                    if(automateMode == TRANMODE) putSOut(*wp);
     				wp++;
     			}
             } else {
-    			wp = sepL;while(*wp) EOUTLINE[EOutCnt++] = *wp++;
-    			for(i = 0; i < ePtrCnt;i++) EOUTLINE[EOutCnt++] = EBuff[i];
+    			wp = sepL;while(*wp) putEOut(*wp++);
+    			for(i = 0; i < ePtrCnt;i++) putEOut(EBuff[i]);
 				wp = saveSep;
-				while(*wp) EOUTLINE[EOutCnt++] = *wp++;
+				while(*wp) putEOut(*wp++);
 				if(automateMode == TRANMODE)
-                    for(i = 0; i < tPtrCnt;i++) EOUTLINE[EOutCnt++] = TBuff[i];
+                    for(i = 0; i < tPtrCnt;i++) putEOut(TBuff[i]);
 				if(recursiveMode == LABEL){
-				  wp = entreGO;while(*wp) EOUTLINE[EOutCnt++] = *wp++;
+				  wp = entreGO;while(*wp) putEOut(*wp++);
 			    }
-    			wp = sepR; while(*wp) EOUTLINE[EOutCnt++] = *wp++;
+    			wp = sepR; while(*wp) putEOut(*wp++);
             }
             count_in_line++;
 		  }
@@ -785,7 +925,8 @@ public:
 		ePtrCnt = tPtrCnt = 0;
 
 		if(outLineLimit <= numberOfOutLine ){
-            error("End by line limit %d\r\n", numberOfOutLine);
+            // the threads stop silently, the limit is checked at the merge
+            if(!owner) error("End by line limit %d\r\n", numberOfOutLine);
             return 1;
        }
 		return 0;
@@ -795,27 +936,20 @@ public:
 	{
 	    unichar*wp;
 		if((recursiveMode == LABEL) && !count_in_line ){
-   			wp = sepL;   while(*wp) EOUTLINE[EOutCnt++] = *wp++;
-			wp = saveSep;while(*wp) EOUTLINE[EOutCnt++] = *wp++;
-			wp = sepR;   while(*wp) EOUTLINE[EOutCnt++] = *wp++;
-		    wp = entreGO;while(*wp) EOUTLINE[EOutCnt++] = *wp++;
+   			wp = sepL;   while(*wp) putEOut(*wp++);
+			wp = saveSep;while(*wp) putEOut(*wp++);
+			wp = sepR;   while(*wp) putEOut(*wp++);
+		    wp = entreGO;while(*wp) putEOut(*wp++);
 	    }
-	    EOUTLINE[EOutCnt++] = 0;
+	    putEOut(0);
 	    u_fprintf(foutput,"%S\n",EOUTLINE);
 		numberOfOutLine++;
 	}
 	void putInt(int flag,int v)
 	{
-		if(v < 10){
-			EBuff[ePtrCnt] =v % 10 + (unichar)'0';
-			if(flag) TBuff[tPtrCnt++] = EBuff[ePtrCnt];
-			ePtrCnt++;
-			return;
-		}
-		putInt(flag,v / 10);
-		EBuff[ePtrCnt] =v % 10 + (unichar)'0';
-		if(flag) TBuff[tPtrCnt++] = EBuff[ePtrCnt];
-		ePtrCnt++;
+		if(v >= 10) putInt(flag,v / 10);
+		putE(v % 10 + (unichar)'0');
+		if(flag) putT(v % 10 + (unichar)'0');
 	}
 	int prOutCycle()
 	{
@@ -833,13 +967,13 @@ public:
 				wp = 	(unichar *)Eti->input;
 
 				if(u_strcmp(wp,u_epsilon_string)){
-//					wwp = saveSep;while(*wwp) EBuff[ePtrCnt++] = *wwp++;
-					while(*wp)	EBuff[ePtrCnt++] = *wp++;
+//					wwp = saveSep;while(*wwp) putE(*wwp++);
+					while(*wp)	putE(*wp++);
 				}
 				wp = (unichar *)Eti->output;
 				if((automateMode == TRANMODE) && wp && u_strcmp(wp,u_epsilon_string)){
-//				    wwp = saveSep;while(*wwp) EBuff[ePtrCnt++] = *wwp++;
-					while(*wp) TBuff[tPtrCnt++] = *wp++;
+//				    wwp = saveSep;while(*wwp) putE(*wwp++);
+					while(*wp) putT(*wp++);
 				}
 			}
 			if (outOneWord(entreGF) != 0)
@@ -873,9 +1007,9 @@ public:
 			}
 
 			ePtrCnt = tPtrCnt = 0;
-			EBuff[ePtrCnt++] = (unichar)'C';
+			putE((unichar)'C');
 			putInt(0,h->index);
-			EBuff[ePtrCnt++] = (unichar)':';
+			putE((unichar)':');
 
 			for(i = 0; i < h->pathCnt;i++){
 				tmp = h->pathEtiQueue[i].etatNo;
@@ -886,11 +1020,11 @@ public:
 				Eti = a->tags[h->pathEtiQueue[i].eti];
 				wp = (unichar *)	Eti->input;
 				if(u_strcmp(wp,u_epsilon_string) && *wp){
-					while(*wp)	EBuff[ePtrCnt++] = *wp++;
+					while(*wp)	putE(*wp++);
 				}
 				wp = (unichar *)Eti->output;
 				if((automateMode == TRANMODE ) && wp && u_strcmp(wp,u_epsilon_string) && *wp ){
-					while(*wp) TBuff[tPtrCnt++] = *wp++;
+					while(*wp) putT(*wp++);
 				}
 			}
 			if(i == h->pathCnt) {
@@ -976,7 +1110,7 @@ public:
      void arretExpoDel()
     {
     	for(int i = 0; i<arretSubListIdx;i++)
-    		delete arretSubList[i];
+    		delete [] arretSubList[i];
     }
     //
 //
@@ -1020,6 +1154,12 @@ private:
 		pathEtiQidx(0),
 
         CautoDepth(0),
+        dfsDepth(0),
+        startCallTr(),
+        rootPartFirst(-1),
+        rootPartEnd(-1),
+        n_threads(1),
+        owner(NULL),
 
 		ignoreTable(0),
 		numOfIgnore(0),
@@ -1053,8 +1193,9 @@ private:
         mask_encoding_compatibility_input(DEFAULT_MASK_ENCODING_COMPATIBILITY_INPUT),
 
         autoStackMap(NULL),
-        mapOfCallHead(NULL),
-        mapOfCallTail(NULL),
+        callIdHash(NULL),
+        callIdHashSize(0),
+        callIdCount(0),
 
         cycInfos(NULL),
 
@@ -1063,10 +1204,18 @@ private:
 		headCycNodes(0),
 		cycNodeCnt(0),
 
+        EBuff(NULL),
+        TBuff(NULL),
         ePtrCnt(0),
         tPtrCnt(0),
+        EBuffSize(256),
+        TBuffSize(256),
+        EOUTLINE(NULL),
+        SOUTLINE(NULL),
         EOutCnt(0),
         SOutCnt(0),
+        EOutSize(4096),
+        SOutSize(4096),
 
         arretSubListIdx(0)
    {
@@ -1375,10 +1524,10 @@ int CFstApp::getWordsFromGraph(int &changeStrToIdx,unichar changeStrTo[][MAX_CHA
 //
 int CFstApp::exploirerSubAuto(int startAutoNo)
 {
-    Transition startCallTr;
 //if(listOut) prCycleNode();
     startCallTr.tag_number  = startAutoNo |FILE_PATH_MARK;
     startCallTr.state_number        = 0;
+    startCallTr.next        = 0;
     numberOfOutLine = 0;    // reset output lines
 
 
@@ -1386,6 +1535,20 @@ int CFstApp::exploirerSubAuto(int startAutoNo)
     int callSubId = callIdentifyId(autoStackMap,1);
     autoStackMap[0].autoId = callSubId;
 
+    // the cycle labels are numbered in the order of the output, so they
+    // need a single exploration
+    if(listOut && (n_threads > 1) && (recursiveMode != LABEL))
+        return exploirerSubAutoInParts(startAutoNo);
+    return exploirerRoot(startAutoNo);
+}
+
+//
+//	explore the paths from the initial state of the graph, in the parts
+//	given by rootPartFirst and rootPartEnd
+//
+int CFstApp::exploirerRoot(int startAutoNo)
+{
+    int callSubId = autoStackMap[0].autoId;
     CautoDepth = 0;
 	CautoQueue[CautoDepth].aId = callSubId;
 	CautoQueue[CautoDepth].next = 0;
@@ -1401,9 +1564,197 @@ int CFstApp::exploirerSubAuto(int startAutoNo)
     return 0;
 }
 
+#define PARTS_PER_THREAD 4
+
+struct fst2list_part {
+    int first;
+    int end;
+    char name[FILENAME_MAX];
+    int result;
+};
+
+struct fst2list_thread {
+    CFstApp *app;
+    int startAutoNo;
+    struct fst2list_part *parts;
+    int first;
+    int end;
+    int step;
+};
+
+//
+//	explore the parts given to a thread, each one into its own file
+//
+static void SYNC_CALLBACK_UNITEX explore_parts(void* privateDataPtr,unsigned int /*iNbThread*/)
+{
+    struct fst2list_thread *t = (struct fst2list_thread *)privateDataPtr;
+    CFstApp *app = t->app;
+    for(int i = t->first; i < t->end;i += t->step){
+        struct fst2list_part *part = &t->parts[i];
+        app->foutput = u_fopen_creating_versatile_encoding(app->encoding_output,0,part->name,U_WRITE);
+        if(!app->foutput){
+            fatal_error("Cannot open file %s\n",part->name);
+        }
+        app->rootPartFirst = part->first;
+        app->rootPartEnd = part->end;
+        app->numberOfOutLine = 0;
+        app->resetPathState();
+        part->result = app->exploirerRoot(t->startAutoNo);
+        u_fclose(app->foutput);
+        app->foutput = 0;
+    }
+}
+
+//
+//	explore the paths with n_threads threads : the parts of the graph
+//	are gathered in consecutive groups, each group is saved in a temporary
+//	file, and the files are appended to the output in their order
+//
+int CFstApp::exploirerSubAutoInParts(int startAutoNo)
+{
+    int i,j;
+    int nParts = 1;
+    Transition *sui;
+    for(sui = a->states[a->initial_states[startAutoNo]]->transitions;sui;sui = sui->next)
+        nParts++;
+    int nGroups = n_threads*PARTS_PER_THREAD;
+    if(nGroups > nParts) nGroups = nParts;
+    int nThreads = (n_threads < nGroups) ? n_threads : nGroups;
+    if(nThreads < 2) return exploirerRoot(startAutoNo);
+
+    struct fst2list_part *parts = new struct fst2list_part[nGroups];
+    char ext[64];
+    for(i = 0; i < nGroups;i++){
+        parts[i].first = (int)(((long)nParts*i)/nGroups);
+        parts[i].end = (int)(((long)nParts*(i+1))/nGroups);
+        parts[i].result = 0;
+        sprintf(ext,".part%d.tmp",i);
+        makeOfileName(parts[i].name,0,ext);
+    }
+    struct fst2list_thread *threads = new struct fst2list_thread[nThreads];
+    void **ptrs = new void*[nThreads];
+    for(i = 0; i < nThreads;i++){
+        threads[i].app = new CFstApp();
+        threads[i].app->initThreadCopy(this);
+        threads[i].startAutoNo = startAutoNo;
+        threads[i].parts = parts;
+        threads[i].first = i;
+        threads[i].end = nGroups;
+        threads[i].step = nThreads;
+        ptrs[i] = &threads[i];
+    }
+    SyncDoRunThreads(nThreads,explore_parts,ptrs);
+
+    int result = 0;
+    numberOfOutLine = 0;
+    for(i = 0; i < nGroups;i++){
+        if(!result){
+            result = parts[i].result;
+            if(appendPart(parts[i].name)){
+                error("End by line limit %d\r\n", numberOfOutLine);
+                result = 1;
+            }
+        }
+        af_remove(parts[i].name);
+    }
+    for(i = 0; i < nThreads;i++){
+        CFstApp *app = threads[i].app;
+        totalPath += app->totalPath;
+        totalLoop += app->totalLoop;
+        stopPath += app->stopPath;
+        errPath += app->errPath;
+        for(j = 1; j <= a->number_of_graphs;j++)
+            numOfIgnore[j] += app->numOfIgnore[j];
+        delete app;
+    }
+    delete [] ptrs;
+    delete [] threads;
+    delete [] parts;
+    return result;
+}
+
+//
+//	copy a part file to the output, up to the line limit,
+//	and return 1 if the limit is reached
+//
+int CFstApp::appendPart(const char *partName)
+{
+    int c;
+    U_FILE *f = u_fopen_versatile_encoding(encoding_output,0,USE_ENCODING_VALUE,partName,U_READ);
+    if(!f){
+        fatal_error("Cannot open file %s\n",partName);
+    }
+    while((numberOfOutLine < outLineLimit) && ((c = u_fgetc_raw(f)) != EOF)){
+        u_fputc_raw((unichar)c,foutput);
+        if(c == '\n') numberOfOutLine++;
+    }
+    u_fclose(f);
+    return (numberOfOutLine >= outLineLimit);
+}
+
+//
+//	prepare an application which explores the paths for a thread :
+//	the graph, the options, the call identifiers and the cycles are
+//	shared with the owner, only the path and the output are its own
+//
+void CFstApp::initThreadCopy(CFstApp *ownerApp)
+{
+    owner = ownerApp;
+    a = owner->a;
+    prMode = owner->prMode;
+    automateMode = owner->automateMode;
+    listOut = owner->listOut;
+    verboseMode = owner->verboseMode;
+    ignoreTable = owner->ignoreTable;
+    numOfIgnore = new int [a->number_of_graphs+1];
+    for(int i = 1; i <= a->number_of_graphs;i++) numOfIgnore[i] = 0;
+    outLineLimit = owner->outLineLimit;
+    recursiveMode = owner->recursiveMode;
+    display_control = owner->display_control;
+    traitAuto = owner->traitAuto;
+    niveau_traite_mot = owner->niveau_traite_mot;
+    saveSep = owner->saveSep;
+    sepL = owner->sepL;
+    sepR = owner->sepR;
+    sep1 = owner->sep1;
+    stopSignal = owner->stopSignal;
+    saveEntre = owner->saveEntre;
+    entreGO = owner->entreGO;
+    entreGF = owner->entreGF;
+    encoding_output = owner->encoding_output;
+    bom_output = owner->bom_output;
+    mask_encoding_compatibility_input = owner->mask_encoding_compatibility_input;
+    delete [] callIdHash;
+    callIdHash = owner->callIdHash;
+    callIdHashSize = owner->callIdHashSize;
+    callIdCount = owner->callIdCount;
+    headCyc = owner->headCyc;
+    cyclePathCnt = owner->cyclePathCnt;
+    headCycNodes = owner->headCycNodes;
+    cycNodeCnt = owner->cycNodeCnt;
+    autoStackMap[0] = owner->autoStackMap[0];
+    resetPathState();
+}
+
+//
+//	forget the path and the line being built, before exploring a part
+//
+void CFstApp::resetPathState()
+{
+    resetBuffs();
+    count_in_line = 0;
+    pathEtiQidx = 0;
+    CautoDepth = 0;
+    dfsDepth = 0;
+}
+
 //
 //	find cycle path by node and call
 //
+//	the exploration is a depth first one, with an explicit stack of frames:
+//	entering a frame checks the state, then each of its transitions
+//	pushes the frame of the next state, which is popped when done
+//
 int CFstApp::findCycleSubGraph(int automateNo,int autoDepth,int stateNo,int stateDepth)
 {
 	int skipCnt = 0;
@@ -1412,173 +1763,186 @@ int CFstApp::findCycleSubGraph(int automateNo,int autoDepth,int stateNo,int stat
 	int nEtat;
     int callId;
     int scanner;
-//	prAutoStack(autoDepth);
-	if(listOut && WasCycleNode(automateNo,stateNo)){
-		pathEtiQ[pathEtiQidx-1].etatNo |= LOOP_PATH_MARK;
-	}
-	if( pathEtiQidx > PATH_QUEUE_MAX){
-		if(listOut){
-				errPath++;
-				pathEtiQ[pathEtiQidx].etatNo = STOP_PATH_MARK;
-				pathEtiQ[pathEtiQidx].eti = 0;
-				pathEtiQidx++;
-				if (outWordsOfGraph(pathEtiQidx) != 0)
-                    return 1;
-				pathEtiQidx--;
-		} else
-			error("Warning:too many calls\n");
-		return 0;
-	}
-	if(IsCyclePath(stateDepth)){
-		if(recursiveMode == STOP)	return 0;
-//		if(!listOut){
-//            a->etat[stateNo]->controle |= LOOP_NODE_MARK;
-//		}
-		return 0;
-	}
-
-	if (is_final_state(a->states[stateNo])) {	// terminal node
-		if(autoDepth != 1){		// check continue  condition
-			skipCnt = 0;	// find next state
-			for(i = CautoDepth;i>=0; --i){
-				if(CautoQueue[i].aId == -1)
-					skipCnt++;
-				else {
-					if(skipCnt)
-						skipCnt--;
-					else
-						break;
-				}
+	int partNo;
+	struct dfsFrame *f;
+	Transition *sui;
+	dfsDepth = 0;
+	pushFrame(automateNo,autoDepth,stateNo,stateDepth,0);
+	while(dfsDepth){
+		f = &dfsStack[dfsDepth-1];
+		automateNo = f->autoNo;
+		autoDepth = f->autoDepth;
+		stateNo = f->etatNo;
+		stateDepth = f->etatDepth;
+		if(!f->entered){
+			f->entered = 1;
+			f->next = a->states[stateNo]->transitions;
+		//	prAutoStack(autoDepth);
+			if(listOut && WasCycleNode(automateNo,stateNo)){
+				pathEtiQ[pathEtiQidx-1].etatNo |= LOOP_PATH_MARK;
+			}
+			if( pathEtiQidx > PATH_QUEUE_MAX){
+				if(listOut){
+						errPath++;
+						pathEtiQ[pathEtiQidx].etatNo = STOP_PATH_MARK;
+						pathEtiQ[pathEtiQidx].eti = 0;
+						pathEtiQidx++;
+						if (outWordsOfGraph(pathEtiQidx) != 0)
+		                    return 1;
+						pathEtiQidx--;
+				} else
+					error("Warning:too many calls\n");
+				popFrame();
+				continue;
+			}
+			if(IsCyclePath(stateDepth)){
+		//		if(!listOut){
+		//            a->etat[stateNo]->controle |= LOOP_NODE_MARK;
+		//		}
+				popFrame();
+				continue;
 			}
 
-			// ?
-			if( i == 0) {
-                //fatal_error("not want state arrive");
-                error("not want state arrive");
-                return 1;
-            }
-			int tauto = CautoQueue[i].aId;
-			nEtat = CautoQueue[i].next;
-			CautoDepth++;
-			CautoQueue[CautoDepth].aId = -1;
-			CautoQueue[CautoDepth].next = 0;
-
-			pathEtiQ[pathEtiQidx].etatNo = nEtat;
-			pathEtiQ[pathEtiQidx].eti = 0;
-			pathEtiQ[pathEtiQidx].autoNo = tauto;
-			pathEtiQidx++;
-			if (findCycleSubGraph(tauto,autoDepth-1,nEtat,stateDepth+1) != 0)
-                return 1;
-			pathEtiQidx--;
-			CautoDepth--;
-		} else {	// stop condition
-			if(listOut){
-				totalPath++;
-				pathEtiQ[pathEtiQidx].etatNo = STOP_PATH_MARK;
-				pathEtiQ[pathEtiQidx].eti = 0;
-				pathEtiQ[pathEtiQidx].autoNo = automateNo;
-				pathEtiQidx++;
-				if (outWordsOfGraph(pathEtiQidx) != 0)
-                    return 1;
-				pathEtiQidx--;
-			} else {
+			if (is_final_state(a->states[stateNo]) && inRootPart(0)) {	// terminal node
+				if(autoDepth != 1){		// check continue  condition
+					skipCnt = 0;	// find next state
+					for(i = CautoDepth;i>=0; --i){
+						if(CautoQueue[i].aId == -1)
+							skipCnt++;
+						else {
+							if(skipCnt)
+								skipCnt--;
+							else
+								break;
+						}
+					}
 
-			}
-		}
-	}
-	for(Transition *sui = a->states[stateNo]->transitions;
-	sui != 0 ; sui = sui->next){
-
-		if(sui->tag_number & STOP_PATH_MARK){
-			if(listOut){
-				totalPath++;
-				pathEtiQ[pathEtiQidx].autoNo = automateNo;
-				pathEtiQ[pathEtiQidx].etatNo = STOP_PATH_MARK;
-				pathEtiQ[pathEtiQidx].eti = sui->tag_number
-					& ~STOP_PATH_MARK;
-				pathEtiQidx++;
-				if (outWordsOfGraph(pathEtiQidx) != 0)
-                    return 1;
-				pathEtiQidx--;
+					// ?
+					if( i == 0) {
+		                //fatal_error("not want state arrive");
+		                error("not want state arrive");
+		                return 1;
+		            }
+					int tauto = CautoQueue[i].aId;
+					nEtat = CautoQueue[i].next;
+					CautoDepth++;
+					CautoQueue[CautoDepth].aId = -1;
+					CautoQueue[CautoDepth].next = 0;
+
+					pathEtiQ[pathEtiQidx].etatNo = nEtat;
+					pathEtiQ[pathEtiQidx].eti = 0;
+					pathEtiQ[pathEtiQidx].autoNo = tauto;
+					pathEtiQidx++;
+					pushFrame(tauto,autoDepth-1,nEtat,stateDepth+1,1);
+					continue;
+				} else {	// stop condition
+					if(listOut){
+						totalPath++;
+						pathEtiQ[pathEtiQidx].etatNo = STOP_PATH_MARK;
+						pathEtiQ[pathEtiQidx].eti = 0;
+						pathEtiQ[pathEtiQidx].autoNo = automateNo;
+						pathEtiQidx++;
+						if (outWordsOfGraph(pathEtiQidx) != 0)
+		                    return 1;
+						pathEtiQidx--;
+					} else {
+
+					}
+				}
 			}
 			continue;
 		}
-		if(display_control == GRAPH)
-		{
-			if(listOut){
-			    pathEtiQ[pathEtiQidx].autoNo = automateNo;
-    			pathEtiQ[pathEtiQidx].etatNo = sui->state_number;
-    			pathEtiQ[pathEtiQidx].eti = sui->tag_number;
-    			pathEtiQidx++;
-    			if (findCycleSubGraph(automateNo,autoDepth,sui->state_number,stateDepth+1) != 0)
-                    return 1;
-    			pathEtiQidx--;
-			}
+		sui = f->next;
+		if(sui == 0){
+			popFrame();
 			continue;
 		}
-		if(sui->tag_number & FILE_PATH_MARK ) {	// handling sub call
-			if(ignoreTable[sui->tag_number & SUB_ID_MASK]){
-			   // find stop condition path
+		f->next = sui->next;
+		partNo = f->partNo++;
+		if(!inRootPart(partNo)) continue;
+
+			if(sui->tag_number & STOP_PATH_MARK){
 				if(listOut){
 					totalPath++;
-					stopPath++;
-
-					numOfIgnore[sui->tag_number & SUB_ID_MASK]++;
-
 					pathEtiQ[pathEtiQidx].autoNo = automateNo;
-					pathEtiQ[pathEtiQidx].eti = sui->tag_number;
 					pathEtiQ[pathEtiQidx].etatNo = STOP_PATH_MARK;
+					pathEtiQ[pathEtiQidx].eti = sui->tag_number
+						& ~STOP_PATH_MARK;
 					pathEtiQidx++;
 					if (outWordsOfGraph(pathEtiQidx) != 0)
-                        return 1;
+	                    return 1;
 					pathEtiQidx--;
 				}
 				continue;
 			}
-			//
-			//    find cycle call
-			//
-			tmp = sui->tag_number & SUB_ID_MASK;
-
-    	    for(scanner = 0;scanner < autoDepth;scanner++)
-        	    if(autoStackMap[scanner].tran->tag_number == sui->tag_number)
-        	       break;
-            autoStackMap[autoDepth].tran = sui;
-            if(scanner == autoDepth)
+			if(display_control == GRAPH)
 			{
-			   callId =  callIdentifyId(autoStackMap,autoDepth+1);
-           	} else { // find recusive call
-              pathEtiQ[pathEtiQidx].eti = 0;
-              pathEtiQ[pathEtiQidx].autoNo = autoStackMap[scanner].autoId;;
-              pathEtiQ[pathEtiQidx].etatNo = a->initial_states[tmp]| LOOP_PATH_MARK;;
-              ++pathEtiQidx;
-              if(!IsCyclePath(stateDepth)) fatal_error("recursive find fail");
-              --pathEtiQidx;
-              continue;
-            }
-            pathEtiQ[pathEtiQidx].eti = 0;
-            pathEtiQ[pathEtiQidx].autoNo = callId;
-            pathEtiQ[pathEtiQidx].etatNo = a->initial_states[tmp];
-            ++pathEtiQidx;
-            autoStackMap[autoDepth].autoId = callId;
-
-            CautoDepth++;
-			CautoQueue[CautoDepth].aId = callId;
-			CautoQueue[CautoDepth].next = sui->state_number;
-			if (findCycleSubGraph(callId,autoDepth+1,
-                  a->initial_states[tmp],stateDepth+1) != 0)
-                  return 1;
-			--pathEtiQidx;
-			--CautoDepth;
-			continue;
-		}
-		pathEtiQ[pathEtiQidx].etatNo = sui->state_number;
-		pathEtiQ[pathEtiQidx].eti = sui->tag_number;
-		pathEtiQ[pathEtiQidx].autoNo = automateNo;
-		++pathEtiQidx;
-		if (findCycleSubGraph(automateNo,autoDepth,sui->state_number,stateDepth+1) != 0)
-            return 1;
-		pathEtiQidx--;
+				if(listOut){
+				    pathEtiQ[pathEtiQidx].autoNo = automateNo;
+	    			pathEtiQ[pathEtiQidx].etatNo = sui->state_number;
+	    			pathEtiQ[pathEtiQidx].eti = sui->tag_number;
+	    			pathEtiQidx++;
+	    			pushFrame(automateNo,autoDepth,sui->state_number,stateDepth+1,0);
+				}
+				continue;
+			}
+			if(sui->tag_number & FILE_PATH_MARK ) {	// handling sub call
+				if(ignoreTable[sui->tag_number & SUB_ID_MASK]){
+				   // find stop condition path
+					if(listOut){
+						totalPath++;
+						stopPath++;
+
+						numOfIgnore[sui->tag_number & SUB_ID_MASK]++;
+
+						pathEtiQ[pathEtiQidx].autoNo = automateNo;
+						pathEtiQ[pathEtiQidx].eti = sui->tag_number;
+						pathEtiQ[pathEtiQidx].etatNo = STOP_PATH_MARK;
+						pathEtiQidx++;
+						if (outWordsOfGraph(pathEtiQidx) != 0)
+	                        return 1;
+						pathEtiQidx--;
+					}
+					continue;
+				}
+				//
+				//    find cycle call
+				//
+				tmp = sui->tag_number & SUB_ID_MASK;
+
+	    	    for(scanner = 0;scanner < autoDepth;scanner++)
+	        	    if(autoStackMap[scanner].tran->tag_number == sui->tag_number)
+	        	       break;
+	            autoStackMap[autoDepth].tran = sui;
+	            if(scanner == autoDepth)
+				{
+				   callId =  callIdentifyId(autoStackMap,autoDepth+1);
+	           	} else { // find recusive call
+	              pathEtiQ[pathEtiQidx].eti = 0;
+	              pathEtiQ[pathEtiQidx].autoNo = autoStackMap[scanner].autoId;;
+	              pathEtiQ[pathEtiQidx].etatNo = a->initial_states[tmp]| LOOP_PATH_MARK;;
+	              ++pathEtiQidx;
+	              if(!IsCyclePath(stateDepth)) fatal_error("recursive find fail");
+	              --pathEtiQidx;
+	              continue;
+	            }
+	            pathEtiQ[pathEtiQidx].eti = 0;
+	            pathEtiQ[pathEtiQidx].autoNo = callId;
+	            pathEtiQ[pathEtiQidx].etatNo = a->initial_states[tmp];
+	            ++pathEtiQidx;
+	            autoStackMap[autoDepth].autoId = callId;
+
+	            CautoDepth++;
+				CautoQueue[CautoDepth].aId = callId;
+				CautoQueue[CautoDepth].next = sui->state_number;
+				pushFrame(callId,autoDepth+1,a->initial_states[tmp],stateDepth+1,1);
+				continue;
+			}
+			pathEtiQ[pathEtiQidx].etatNo = sui->state_number;
+			pathEtiQ[pathEtiQidx].eti = sui->tag_number;
+			pathEtiQ[pathEtiQidx].autoNo = automateNo;
+			++pathEtiQidx;
+			pushFrame(automateNo,autoDepth,sui->state_number,stateDepth+1,0);
 	}
     return 0;
 }
@@ -1689,8 +2053,8 @@ int CFstApp::outWordsOfGraph(int depth)
 //		           if(ePtrCnt || tPtrCnt) outOneWord(0);
 //		           else if(control_char) outOneWord(0);
 //                   control_char = 1;
-//  				   while(*ep) EBuff[ePtrCnt++] = *ep++;
-//				   while(*tp) TBuff[tPtrCnt++] = *tp++;
+//  				   while(*ep) putE(*ep++);
+//				   while(*tp) putT(*tp++);
 //				   continue;
              }
 
@@ -1708,9 +2072,9 @@ int CFstApp::outWordsOfGraph(int depth)
                         if (outOneWord(0) != 0)
                             return 1;
                     }
-           			while(*ep) EBuff[ePtrCnt++] = *ep++;
+           			while(*ep) putE(*ep++);
            			if(automateMode == TRANMODE)
-                         while(*tp) TBuff[tPtrCnt++] = *tp++;
+                         while(*tp) putT(*tp++);
 
             		if(niveau_traite_mot) {
             			if(ePtrCnt|| tPtrCnt) {
@@ -1736,9 +2100,9 @@ int CFstApp::outWordsOfGraph(int depth)
 				}	else {
 					resetBuffs();
 				}
-				while(*sp)	EOUTLINE[EOutCnt++] = *sp++;
+				while(*sp)	putEOut(*sp++);
 				wp = entreGF;
-                while(*wp) EOUTLINE[EOutCnt++] = *wp++;
+                while(*wp) putEOut(*wp++);
                 markPreCtlChar = markCtlChar;
 				continue;
 			} else if(recursiveMode == SYMBOL) {	// SYMBOL
@@ -1748,15 +2112,15 @@ int CFstApp::outWordsOfGraph(int depth)
                         }
 				wp = entreGO;
 				while(*wp){
-					if(automateMode == TRANMODE)  TBuff[tPtrCnt++] = *wp;
-					EBuff[ePtrCnt++] = *wp;
+					if(automateMode == TRANMODE)  putT(*wp);
+					putE(*wp);
 					wp++;
 				}
-				while(*ep)	EBuff[ePtrCnt++] = *ep++;
-				EBuff[ePtrCnt++] = (unichar)'|';
+				while(*ep)	putE(*ep++);
+				putE((unichar)'|');
 				if(automateMode == TRANMODE){
-					while(*tp) TBuff[tPtrCnt++] = *tp++;
-					TBuff[tPtrCnt++] = (unichar)'|';
+					while(*tp) putT(*tp++);
+					putT((unichar)'|');
 				}
 				struct cyclePathMark *h = headCyc;
 				int findId = pathEtiQ[s].etatNo & PATHID_MASK;
@@ -1767,15 +2131,15 @@ int CFstApp::outWordsOfGraph(int depth)
 					}
 					if(i != h->pathCnt){
 						if(automateMode == TRANMODE){
-							EBuff[ePtrCnt++] = (unichar)'C';
-                            TBuff[tPtrCnt++] = (unichar)'C';
+							putE((unichar)'C');
+                            putT((unichar)'C');
 							putInt(1,h->index);
-							EBuff[ePtrCnt++] = (unichar)'|';
-                            TBuff[tPtrCnt++] = (unichar)'|';
+							putE((unichar)'|');
+                            putT((unichar)'|');
 						} else {
-							EBuff[ePtrCnt++] =(unichar)'C';
+							putE((unichar)'C');
 							putInt(0,h->index);
-							EBuff[ePtrCnt++] = (unichar)'|';
+							putE((unichar)'|');
 						}
 					}
 					h = h->next;
@@ -1784,8 +2148,8 @@ int CFstApp::outWordsOfGraph(int depth)
                 --ePtrCnt;
 				wp = entreGF;
 				while(*wp){
-					if(automateMode == TRANMODE) TBuff[tPtrCnt++] = *wp;
-					EBuff[ePtrCnt++] = *wp;
+					if(automateMode == TRANMODE) putT(*wp);
+					putE(*wp);
 					wp++;
 				}
                 if (outOneWord(0) != 0)
@@ -1799,24 +2163,24 @@ int CFstApp::outWordsOfGraph(int depth)
                     // mark the stop
                     wp = entreGO;
                     while(*wp){
-                    EOUTLINE[EOutCnt++] = *wp;
+                    putEOut(*wp);
    					if((automateMode == TRANMODE) && (prMode == PR_SEPARATION))
-                    SOUTLINE[SOutCnt++] = *wp;
+                    putSOut(*wp);
                     wp++;
                     }
 				}
-    			while(*ep) EBuff[ePtrCnt++] = *ep++;
+    			while(*ep) putE(*ep++);
     			if(automateMode == TRANMODE)
-                     while(*tp) TBuff[tPtrCnt++] = *tp++;
+                     while(*tp) putT(*tp++);
                 if(pathEtiQ[s].etatNo & STOP_PATH_MARK) {
                     wp = entreGF;
                     while(*wp){
                         if(automateMode == TRANMODE){
-                            TBuff[tPtrCnt++] = *wp;
+                            putT(*wp);
                             if(prMode == PR_SEPARATION)
-                            EBuff[ePtrCnt++] = *wp;
+                            putE(*wp);
                         } else
-                            EBuff[ePtrCnt++] = *wp;
+                            putE(*wp);
 
                         wp++;
                     }
@@ -1855,7 +2219,7 @@ int CFstApp::outWordsOfGraph(int depth)
                     if (outOneWord(0) != 0)
                         return 1;
                 }
-				while(*tp) TBuff[tPtrCnt++] = *tp++;
+				while(*tp) putT(*tp++);
 			}
 			if(pathEtiQ[s].eti & FILE_PATH_MARK) {
                     if (outOneWord((unichar *)a->graph_names[pathEtiQ[s].eti & SUB_ID_MASK]) != 0)
@@ -1876,9 +2240,9 @@ int CFstApp::outWordsOfGraph(int depth)
 
 			switch(display_control){
 			case GRAPH:
-				EBuff[ePtrCnt++] = (unichar)'{';
-				while(*ep)	EBuff[ePtrCnt++] = *ep++;
-				EBuff[ePtrCnt++] = (unichar)'}';
+				putE((unichar)'{');
+				while(*ep)	putE(*ep++);
+				putE((unichar)'}');
                 if (outOneWord(0) != 0)
                         return 1;
                break;
@@ -1899,9 +2263,9 @@ int CFstApp::outWordsOfGraph(int depth)
                     if (outOneWord(0) != 0)
                         return 1;
                 }
-        while(*ep) EBuff[ePtrCnt++] = *ep++;
+        while(*ep) putE(*ep++);
         if(automateMode == TRANMODE)
-			while(*tp) TBuff[tPtrCnt++] = *tp++;
+			while(*tp) putT(*tp++);
 		if(niveau_traite_mot) {
 			if(ePtrCnt|| tPtrCnt)   {
                     if (outOneWord(0) != 0)
@@ -2119,6 +2483,16 @@ int main_Fst2List(int argc,char* const argv[]) {
 
 		}
 			break;
+		case '-':
+			if(!strncmp(argv[iargIndex],"--threads=",10)){
+				char foo;
+				if(1 != sscanf(argv[iargIndex]+10,"%d%c",&aa.n_threads,&foo) || aa.n_threads < 0){
+					fatal_error("Invalid number of threads: %s\n",argv[iargIndex]+10);
+				}
+				break;
+			}
+			usage();
+      return 1;
 		default:
 			usage();
       return 1;
@@ -2129,9 +2503,11 @@ int main_Fst2List(int argc,char* const argv[]) {
       usage();
       return 1;
    }
+	if(aa.n_threads == 0) aa.n_threads = (int)SyncGetNumberOfProcessors();
+	if((aa.n_threads > 1) && !IsSeveralThreadsPossible()) aa.n_threads = 1;
 	aa.fileNameSet(argv[iargIndex],ofilename);
     aa.fileEncodingSet(encoding_output,bom_output,mask_encoding_compatibility_input);
 	aa.getWordsFromGraph(changeStrToIdx,changeStrTo,argv[iargIndex]);
-	if(ofilename) delete ofilename;
+	if(ofilename) delete [] ofilename;
 	return 0;
 }
@@ -26,6 +26,7 @@
 #include "LocateConstants.h"
 #include "UnitexGetOpt.h"
 #include "Fst2Txt.h"
+#include "logger/SyncLogger.h"
 
 
 const char* usage_Fst2Txt =
@@ -40,6 +41,12 @@ const char* usage_Fst2Txt =
          "  -x/--dont_start_on_space: disables morphological use of space (default)\n"
          "  -c/--char_by_char: uses char by char tokenization; useful for languages like Thai\n"
          "  -w/--word_by_word: uses word by word tokenization (default)\n"
+         "  --threads=N: uses N threads (default=1). If N is 0, one thread is used\n"
+         "               per processor. The text is then loaded in memory and cut\n"
+         "               into chunks that are processed at the same time, unless\n"
+         "               it is larger than 1 GB\n"
+         "  --separator=SEP: the text is only cut just after the occurrences of\n"
+         "                   SEP, where \\n stands for a newline (default=\\n\\n)\n"
          "\n"
          "Output options:\n"
          "  -M/--merge (default)\n"
@@ -50,6 +57,23 @@ const char* usage_Fst2Txt =
          "Applies a grammar to a text. The text file is modified.\n";
 
 
+/**
+ * Replaces the \n sequences of the given separator by newlines.
+ */
+static void unescape_separator(unichar* s) {
+int j=0;
+for (int i=0;s[i]!='\0';i++) {
+   if (s[i]=='\\' && s[i+1]=='n') {
+      s[j++]='\n';
+      i++;
+   } else {
+      s[j++]=s[i];
+   }
+}
+s[j]='\0';
+}
+
+
 static void usage() {
 u_printf("%S",COPYRIGHT);
 u_printf(usage_Fst2Txt);
@@ -69,6 +93,8 @@ const struct option_TS lopts_Fst2Txt[]= {
       {"input_encoding",required_argument_TS,NULL,'k'},
       {"output_encoding",required_argument_TS,NULL,'q'},
       {"help",no_argument_TS,NULL,'h'},
+      {"threads",required_argument_TS,NULL,1},
+      {"separator",required_argument_TS,NULL,2},
       {NULL,no_argument_TS,NULL,0}
 };
 
@@ -82,6 +108,7 @@ if (argc==1) {
 struct fst2txt_parameters* p=new_fst2txt_parameters();
 int val,index=-1;
 struct OptVars* vars=new_OptVars();
+char foo;
 while (EOF!=(val=getopt_long_TS(argc,argv,optstring_Fst2Txt,lopts_Fst2Txt,&index,vars))) {
    switch(val) {
    case 't': if (vars->optarg[0]=='\0') {
@@ -106,6 +133,17 @@ while (EOF!=(val=getopt_long_TS(argc,argv,optstring_Fst2Txt,lopts_Fst2Txt,&index
    case 'w': p->tokenization_policy=WORD_BY_WORD_TOKENIZATION; break;
    case 's': p->space_policy=START_WITH_SPACE; break;
    case 'x': p->space_policy=DONT_START_WITH_SPACE; break;
+   case 1: if (1!=sscanf(vars->optarg,"%d%c",&(p->n_threads),&foo) || p->n_threads<0) {
+                fatal_error("Invalid number of threads: %s\n",vars->optarg);
+             }
+             break;
+   case 2: if (vars->optarg[0]=='\0') {
+                fatal_error("You must specify a non empty separator\n");
+             }
+             free(p->separator);
+             p->separator=u_strdup(vars->optarg);
+             unescape_separator(p->separator);
+             break;
    case 'h': usage(); return 0;
    case ':': if (index==-1) fatal_error("Missing argument for option -%c\n",vars->optopt);
              else fatal_error("Missing argument for option --%s\n",lopts_Fst2Txt[index].name);
@@ -133,6 +171,12 @@ if (vars->optind!=argc-1) {
 if (p->text_file==NULL) {
    fatal_error("You must specify the text file\n");
 }
+if (p->n_threads<=0) {
+   p->n_threads=(int)SyncGetNumberOfProcessors();
+}
+if (p->n_threads>1 && !IsSeveralThreadsPossible()) {
+   p->n_threads=1;
+}
 
 char tmp[FILENAME_MAX];
 remove_extension(p->text_file,tmp);
@@ -20,14 +20,24 @@
  */
 
 #include "Error.h"
+#include "File.h"
 #include "Fst2TxtAsRoutine.h"
 #include "TransductionStack.h"
+#include "Ustring.h"
+#include "logger/SyncLogger.h"
 
 #define MAX_DEPTH 300
 #define MOT_BUFFER_TOKEN_SIZE (1000)
 
 #define CAPACITY_LIMIT 16384
 #define MINIMAL_SIZE_PRELOADED_TEXT (2048+1)
+/* Size under which the output stack is saved on the C stack before a subgraph call */
+#define SAVED_STACK_SIZE 256
+/* Number of text chunks given to each thread */
+#define CHUNKS_PER_THREAD 4
+/* Above this size in bytes, the text is not loaded in memory and it is processed
+ * with one thread, because the positions in the text are ints */
+#define MAX_IN_MEMORY_TEXT_SIZE (1024L*1024*1024)
 
 void build_state_token_trees(struct fst2txt_parameters*);
 void parse_text(struct fst2txt_parameters*);
@@ -40,7 +50,12 @@ int main_fst2txt(struct fst2txt_parameters* p) {
         return 1;
     }
 
-    p->text_buffer=new_buffer_for_file(UNICHAR_BUFFER,p->f_input,CAPACITY_LIMIT);
+    if (p->n_threads>1 && get_file_size(p->f_input)>MAX_IN_MEMORY_TEXT_SIZE) {
+        u_printf("The text is too large to be loaded in memory: it will be processed with one thread\n");
+        p->n_threads=1;
+    }
+    /* When several threads are used, the whole text is loaded in memory */
+    p->text_buffer=new_buffer_for_file(UNICHAR_BUFFER,p->f_input,(p->n_threads>1)?0:CAPACITY_LIMIT);
     p->buffer=p->text_buffer->unichar_buffer;
 
     p->f_output=u_fopen_creating_versatile_encoding(p->encoding_output,p->bom_output,p->temp_file,U_WRITE);
@@ -96,6 +111,7 @@ p->f_input=NULL;
 p->f_output=NULL;
 p->fst2=NULL;
 p->alphabet=NULL;
+p->tag_kind=NULL;
 p->text_file=NULL;
 p->temp_file=NULL;
 p->fst_file=NULL;
@@ -115,6 +131,8 @@ p->input_length=0;
 p->encoding_output = DEFAULT_ENCODING_OUTPUT;
 p->bom_output = DEFAULT_BOM_OUTPUT;
 p->mask_encoding_compatibility_input = DEFAULT_MASK_ENCODING_COMPATIBILITY_INPUT;
+p->n_threads=1;
+p->separator=u_strdup("\n\n");
 return p;
 }
 
@@ -138,6 +156,8 @@ free_Variables(p->variables);
 free_buffer(p->text_buffer);
 free_abstract_Fst2(p->fst2,NULL);
 free_alphabet(p->alphabet);
+free(p->tag_kind);
+free(p->separator);
 free_stack_unichar(p->stack);
 free(p);
 }
@@ -208,7 +228,213 @@ if (s!=NULL) push_output_string(p,s);
 }
 
 
+/**
+ * Tries to apply the grammar at the current origin. Then, 'p->output'
+ * contains the output of the longest match and 'p->input_length' its
+ * length, which is 0 if nothing was matched.
+ */
+static void apply_at_current_origin(struct fst2txt_parameters* p,int initial_state,int* within_tag) {
+p->output[0]='\0';
+empty(p->stack);
+p->input_length=0;
+if (p->buffer[p->current_origin]=='{') {
+   *within_tag=1;
+} else if (p->buffer[p->current_origin]=='}') {
+   *within_tag=0;
+} else if (!(*within_tag) && (p->buffer[p->current_origin]!=' ' || p->space_policy==START_WITH_SPACE)) {
+   // we don't start a match on a space
+   unichar mot_token_buffer[MOT_BUFFER_TOKEN_SIZE];
+   scan_graph(0,initial_state,0,0,NULL,mot_token_buffer,p);
+}
+}
+
+
+/**
+ * This structure describes a chunk of the text. It is parsed from 'start'
+ * to 'end', starting outside a tag if 'within_tag' is 0. 'stop' is the
+ * position where the parsing actually stopped, which may be after 'end'
+ * if a match goes over it, and 'within_tag_at_stop' is the tag state
+ * at this position.
+ */
+struct fst2txt_chunk {
+   int start;
+   int end;
+   int within_tag;
+   int stop;
+   int within_tag_at_stop;
+   Ustring* output;
+};
+
+
+/**
+ * The chunks first, first+step, ... that are before 'end' are parsed with
+ * the given parameters.
+ */
+struct fst2txt_chunk_job {
+   struct fst2txt_parameters* p;
+   struct fst2txt_chunk* chunks;
+   int first;
+   int end;
+   int step;
+};
+
+
+/**
+ * Parses the given chunk of the in-memory text.
+ */
+static void parse_chunk(struct fst2txt_parameters* p,struct fst2txt_chunk* chunk) {
+int initial_state=p->fst2->initial_states[1];
+int within_tag=chunk->within_tag;
+empty(chunk->output);
+p->current_origin=chunk->start;
+while (p->current_origin<chunk->end) {
+   apply_at_current_origin(p,initial_state,&within_tag);
+   u_strcat(chunk->output,p->output);
+   if (p->input_length==0) {
+      u_strcat(chunk->output,p->buffer[p->current_origin]);
+      (p->current_origin)++;
+   } else {
+      p->current_origin=p->current_origin+p->input_length;
+   }
+}
+chunk->stop=p->current_origin;
+chunk->within_tag_at_stop=within_tag;
+}
+
+
+static void SYNC_CALLBACK_UNITEX parse_chunks(void* privateDataPtr,unsigned int /*iNbThread*/) {
+struct fst2txt_chunk_job* job=(struct fst2txt_chunk_job*)privateDataPtr;
+for (int i=job->first;i<job->end;i+=job->step) {
+   parse_chunk(job->p,&(job->chunks[i]));
+}
+}
+
+
+/**
+ * Returns a copy of the given parameters that shares the text, the grammar
+ * and the token trees with them, but that has its own output stack and
+ * variables, so that it can be used by another thread.
+ */
+static struct fst2txt_parameters* new_thread_fst2txt_parameters(struct fst2txt_parameters* p) {
+struct fst2txt_parameters* copy=(struct fst2txt_parameters*)malloc(sizeof(struct fst2txt_parameters));
+if (copy==NULL) {
+   fatal_alloc_error("new_thread_fst2txt_parameters");
+}
+memcpy(copy,p,sizeof(struct fst2txt_parameters));
+copy->stack=new_stack_unichar(MAX_OUTPUT_LENGTH);
+copy->variables=new_Variables(p->fst2->input_variables);
+return copy;
+}
+
+
+static void free_thread_fst2txt_parameters(struct fst2txt_parameters* p) {
+free_stack_unichar(p->stack);
+free_Variables(p->variables);
+free(p);
+}
+
+
+/**
+ * Returns the position that follows the first occurrence of 'separator'
+ * in the text at or after 'pos', or -1 if there is none.
+ */
+static int get_chunk_end(struct fst2txt_parameters* p,int pos,const unichar* separator) {
+int length=u_strlen(separator);
+int last=p->text_buffer->size-length;
+for (;pos<=last;pos++) {
+   int i=0;
+   while (i<length && p->buffer[pos+i]==separator[i]) {
+      i++;
+   }
+   if (i==length) {
+      return pos+length;
+   }
+}
+return -1;
+}
+
+
+/**
+ * Parses the text in memory with several threads. The text is cut into
+ * chunks just after occurrences of the separator, and the chunks are
+ * parsed independently. When the parsing of a chunk does not stop exactly
+ * where the next one starts, because a match goes over the separator, the
+ * next chunk is parsed again from the right position. So, the output is
+ * always the same as the one of the sequential parsing.
+ */
+static void parse_text_in_chunks(struct fst2txt_parameters* p) {
+fill_buffer(p->text_buffer,p->f_input);
+int size=p->text_buffer->size;
+int max_chunks=p->n_threads*CHUNKS_PER_THREAD;
+struct fst2txt_chunk* chunks=(struct fst2txt_chunk*)malloc(max_chunks*sizeof(struct fst2txt_chunk));
+if (chunks==NULL) {
+   fatal_alloc_error("parse_text_in_chunks");
+}
+int n_chunks=0;
+int start=0;
+while (start<size) {
+   int end=size;
+   if (n_chunks<max_chunks-1 && p->separator[0]!='\0') {
+      int pos=(int)((long)size*(n_chunks+1)/max_chunks);
+      end=get_chunk_end(p,(pos>start)?pos:start,p->separator);
+      if (end==-1) {
+         end=size;
+      }
+   }
+   chunks[n_chunks].start=start;
+   chunks[n_chunks].end=end;
+   chunks[n_chunks].within_tag=0;
+   chunks[n_chunks].output=new_Ustring(end-start+1);
+   n_chunks++;
+   start=end;
+}
+int n_threads=(p->n_threads<n_chunks)?p->n_threads:n_chunks;
+struct fst2txt_chunk_job* jobs=(struct fst2txt_chunk_job*)malloc(n_threads*sizeof(struct fst2txt_chunk_job));
+void** job_ptrs=(void**)malloc(n_threads*sizeof(void*));
+if (jobs==NULL || job_ptrs==NULL) {
+   fatal_alloc_error("parse_text_in_chunks");
+}
+for (int t=0;t<n_threads;t++) {
+   jobs[t].p=new_thread_fst2txt_parameters(p);
+   jobs[t].chunks=chunks;
+   jobs[t].first=t;
+   jobs[t].end=n_chunks;
+   jobs[t].step=n_threads;
+   job_ptrs[t]=&(jobs[t]);
+}
+if (n_threads>1) {
+   SyncDoRunThreads(n_threads,parse_chunks,job_ptrs);
+} else if (n_threads==1) {
+   parse_chunks(&(jobs[0]),0);
+}
+/* Now, we check the chunk boundaries and we write the outputs */
+int position=0;
+int within_tag=0;
+for (int i=0;i<n_chunks;i++) {
+   if (chunks[i].start!=position || chunks[i].within_tag!=within_tag) {
+      chunks[i].start=position;
+      chunks[i].within_tag=within_tag;
+      parse_chunk(jobs[0].p,&(chunks[i]));
+   }
+   u_fprintf(p->f_output,"%S",chunks[i].output->str);
+   position=chunks[i].stop;
+   within_tag=chunks[i].within_tag_at_stop;
+   free_Ustring(chunks[i].output);
+}
+for (int t=0;t<n_threads;t++) {
+   free_thread_fst2txt_parameters(jobs[t].p);
+}
+free(job_ptrs);
+free(jobs);
+free(chunks);
+}
+
+
 void parse_text(struct fst2txt_parameters* p) {
+if (p->n_threads>1) {
+   parse_text_in_chunks(p);
+   return;
+}
 fill_buffer(p->text_buffer,p->f_input);
 int debut=p->fst2->initial_states[1];
 p->variables=new_Variables(p->fst2->input_variables);
@@ -227,21 +453,7 @@ while (p->current_origin<p->text_buffer->size) {
          n_blocks++;
          u_printf("\rBlock %d        ",n_blocks);
       }
-      p->output[0]='\0';
-      empty(p->stack);
-      p->input_length=0;
-
-
-      //memset(p->buffer,0,p->current_origin);
-      if (p->buffer[p->current_origin]=='{') {
-         within_tag=1;
-      } else if (p->buffer[p->current_origin]=='}') {
-         within_tag=0;
-      } else if (!within_tag && (p->buffer[p->current_origin]!=' ' || p->space_policy==START_WITH_SPACE)) {
-         // we don't start a match on a space
-        unichar mot_token_buffer[MOT_BUFFER_TOKEN_SIZE];
-        scan_graph(0,debut,0,0,NULL,mot_token_buffer,p);
-      }
+      apply_at_current_origin(p,debut,&within_tag);
       u_fprintf(p->f_output,"%S",p->output);
       if (p->input_length==0) {
          // if no input was read, we go on
@@ -391,7 +603,7 @@ int SOMMET=p->stack->stack_pointer+1;
 int pos2;
 
 /* If there are some letter sequence transitions like %hello, we process them */
-if (p->token_tree[e]->transition_array!=NULL) {
+if (p->token_tree[e]->size!=0) {
    if (p->buffer[pos+p->current_origin]==' ') {pos2=pos+1;if (p->output_policy==MERGE_OUTPUTS) push(p->stack,' ');}
    /* we don't keep this line because of problems occur in sentence tokenizing
     * if the return sequence is defautly considered as a separator like space
@@ -400,8 +612,10 @@ if (p->token_tree[e]->transition_array!=NULL) {
    else pos2=pos;
    int position=0;
    unichar *token=mot_token_buffer;
-   if (p->tokenization_policy==CHAR_BY_CHAR_TOKENIZATION
-       || (is_letter(p->buffer[pos2+p->current_origin],p->alphabet) && (pos2+p->current_origin==0 || !is_letter(p->buffer[pos2+p->current_origin-1],p->alphabet)))) {
+   /* We don't read the token if no tag of the tree can start with its first letter */
+   if (may_start_token(p->buffer[pos2+p->current_origin],p->token_tree[e]) &&
+       (p->tokenization_policy==CHAR_BY_CHAR_TOKENIZATION
+       || (is_letter(p->buffer[pos2+p->current_origin],p->alphabet) && (pos2+p->current_origin==0 || !is_letter(p->buffer[pos2+p->current_origin-1],p->alphabet))))) {
       /* If we are in character by character mode */
       while (pos2+p->current_origin<p->text_buffer->size && is_letter(p->buffer[pos2+p->current_origin],p->alphabet)) {
          token[position++]=p->buffer[(pos2++)+p->current_origin];
@@ -458,9 +672,15 @@ while (t!=NULL) {
       if (n_etiq<0) {
          // case of a sub-graph
          struct parsing_info* liste=NULL;
-         unichar* pile_old;
+         /* The stack is usually short, so we save it on the C stack when we can */
+         unichar pile_buffer[SAVED_STACK_SIZE];
+         unichar* pile_old=pile_buffer;
          p->stack->stack[p->stack->stack_pointer+1]='\0';
-         pile_old = u_strdup(p->stack->stack);
+         if (p->stack->stack_pointer+2>SAVED_STACK_SIZE) {
+            pile_old=u_strdup(p->stack->stack);
+         } else {
+            u_strcpy(pile_old,p->stack->stack);
+         }
          scan_graph((((unsigned)n_etiq)-1),p->fst2->initial_states[-n_etiq],pos,depth,&liste,mot_token_buffer,p);
          while (liste!=NULL) {
             p->stack->stack_pointer=liste->stack_pointer-1;
@@ -472,21 +692,23 @@ while (t!=NULL) {
             free_parsing_info(l_tmp, prv_alloc_recycle);
          }
          u_strcpy(p->stack->stack,pile_old);
-         free(pile_old);
+         if (pile_old!=pile_buffer) {
+            free(pile_old);
+         }
          p->stack->stack_pointer=SOMMET-1;
       }
       else {
          // case of a normal tag
          Fst2Tag etiq=p->fst2->tags[n_etiq];
          unichar* contenu=etiq->input;
-         int contenu_len_possible_match=u_len_possible_match(contenu);
-         if (etiq->type==BEGIN_OUTPUT_VAR_TAG) {
-        	 fatal_error("Unsupported $|XXX( tags in Fst2Txt\n");
-         }
-         if (etiq->type==END_OUTPUT_VAR_TAG) {
-           	 fatal_error("Unsupported $|XXX) tags in Fst2Txt\n");
+         enum fst2txt_tag_kind kind=p->tag_kind[n_etiq];
+         if (kind==FST2TXT_OUTPUT_VAR_TAG) {
+            if (etiq->type==BEGIN_OUTPUT_VAR_TAG) {
+               fatal_error("Unsupported $|XXX( tags in Fst2Txt\n");
+            }
+            fatal_error("Unsupported $|XXX) tags in Fst2Txt\n");
          }
-         if (etiq->type==BEGIN_VAR_TAG) {
+         if (kind==FST2TXT_BEGIN_VAR_TAG) {
             // case of a $a( variable tag
             //int old;
             struct transduction_variable* L=get_transduction_variable(p->variables,etiq->variable);
@@ -504,7 +726,7 @@ while (t!=NULL) {
             scan_graph(n_graph,t->state_number,pos2,depth,liste_arrivee,mot_token_buffer,p);
             //L->start=old;
          }
-         else if (etiq->type==END_VAR_TAG) {
+         else if (kind==FST2TXT_END_VAR_TAG) {
               // case of a $a) variable tag
               //int old;
               struct transduction_variable* L=get_transduction_variable(p->variables,etiq->variable);
@@ -519,7 +741,7 @@ while (t!=NULL) {
               scan_graph(n_graph,t->state_number,pos,depth,liste_arrivee,mot_token_buffer,p);
               //L->end=old;
          }
-         else if ((contenu_len_possible_match==5) && (!u_trymatch_superfast5(contenu,ETIQ_MOT_LN5))) {
+         else if (kind==FST2TXT_MOT_TAG) {
               // case of transition by any sequence of letters
               if (p->buffer[pos+p->current_origin]==' ' && pos+p->current_origin+1<p->text_buffer->size) {
                  pos2=pos+1;
@@ -547,7 +769,7 @@ while (t!=NULL) {
                      }
               }
          }
-         else if ((contenu_len_possible_match==4) && (!u_trymatch_superfast4(contenu,ETIQ_NB_LN4))) {
+         else if (kind==FST2TXT_NB_TAG) {
               // case of transition by any sequence of digits
               if (p->buffer[pos+p->current_origin]==' ') {
                  pos2=pos+1;
@@ -573,7 +795,7 @@ while (t!=NULL) {
                  scan_graph(n_graph,t->state_number,pos2,depth,liste_arrivee,mot_token_buffer,p);
               }
          }
-         else if ((contenu_len_possible_match==5) && (!u_trymatch_superfast5(contenu,ETIQ_MAJ_LN5))) {
+         else if (kind==FST2TXT_MAJ_TAG) {
               // case of upper case letter sequence
               if (p->buffer[pos+p->current_origin]==' ') {pos2=pos+1;if (p->output_policy==MERGE_OUTPUTS) push(p->stack,' ');}
               //else if (buffer[pos+origine_courante]==0x0d) {pos2=pos+2;if (MODE==MERGE) empiler(0x0a);}
@@ -599,7 +821,7 @@ while (t!=NULL) {
                  }
               }
          }
-         else if ((contenu_len_possible_match==5) && (!u_trymatch_superfast5(contenu,ETIQ_MIN_LN5))) {
+         else if (kind==FST2TXT_MIN_TAG) {
               // case of lower case letter sequence
               if (p->buffer[pos+p->current_origin]==' ') {pos2=pos+1;if (p->output_policy==MERGE_OUTPUTS) push(p->stack,' ');}
               //else if (buffer[pos+origine_courante]==0x0d) {pos2=pos+2;if (MODE==MERGE) empiler(0x0a);}
@@ -625,7 +847,7 @@ while (t!=NULL) {
                  }
               }
          }
-         else if ((contenu_len_possible_match==5) && (!u_trymatch_superfast5(contenu,ETIQ_PRE_LN5))) {
+         else if (kind==FST2TXT_PRE_TAG) {
               // case of a sequence beginning by an upper case letter
               if (p->buffer[pos+p->current_origin]==' ') {pos2=pos+1;if (p->output_policy==MERGE_OUTPUTS) push(p->stack,' ');}
               //else if (buffer[pos+origine_courante]==0x0d) {pos2=pos+2;if (MODE==MERGE) empiler(0x0a);}
@@ -651,7 +873,7 @@ while (t!=NULL) {
                  }
               }
          }
-         else if ((contenu_len_possible_match==5) && (!u_trymatch_superfast5(contenu,ETIQ_PNC_LN5))) {
+         else if (kind==FST2TXT_PNC_TAG) {
               // case of a punctuation sequence
               if (p->buffer[pos+p->current_origin]==' ') {pos2=pos+1;if (p->output_policy==MERGE_OUTPUTS) push(p->stack,' ');}
               //else if (buffer[pos+origine_courante]==0x0d) {pos2=pos+2;if (MODE==MERGE) empiler(0x0a);}
@@ -693,13 +915,13 @@ while (t!=NULL) {
                    }
               }
          }
-         else if ((contenu_len_possible_match==3) && (!u_trymatch_superfast3(contenu,ETIQ_E_LN3))) {
+         else if (kind==FST2TXT_EPSILON_TAG) {
               // case of an empty sequence
               // in both modes MERGE and REPLACE, we process the transduction if any
               traiter_transduction(p,etiq->output);
               scan_graph(n_graph,t->state_number,pos,depth,liste_arrivee,mot_token_buffer,p);
          }
-         else if ((contenu_len_possible_match==3) && (!u_trymatch_superfast3(contenu,ETIQ_CIRC_LN3))) {
+         else if (kind==FST2TXT_NEW_LINE_TAG) {
               // case of a new line sequence
               if (p->buffer[pos+p->current_origin]=='\n') {
                  // in both modes MERGE and REPLACE, we process the transduction if any
@@ -711,7 +933,7 @@ while (t!=NULL) {
                  scan_graph(n_graph,t->state_number,pos+1,depth,liste_arrivee,mot_token_buffer,p);
               }
          }
-         else if ((contenu_len_possible_match==1) && (!u_trymatch_superfast1(contenu,'#')) && (!(etiq->control&RESPECT_CASE_TAG_BIT_MASK))) {
+         else if (kind==FST2TXT_NO_SPACE_TAG) {
               // case of a no space condition
               if (p->buffer[pos+p->current_origin]!=' ') {
                 // in both modes MERGE and REPLACE, we process the transduction if any
@@ -719,7 +941,7 @@ while (t!=NULL) {
                 scan_graph(n_graph,t->state_number,pos,depth,liste_arrivee,mot_token_buffer,p);
               }
          }
-         else if ((contenu_len_possible_match==1) && (!u_trymatch_superfast1(contenu,' '))) {
+         else if (kind==FST2TXT_SPACE_TAG) {
          // case of an obligatory space
               if (p->buffer[pos+p->current_origin]==' ') {
                 // in both modes MERGE and REPLACE, we process the transduction if any
@@ -731,7 +953,7 @@ while (t!=NULL) {
                 scan_graph(n_graph,t->state_number,pos+1,depth,liste_arrivee,mot_token_buffer,p);
               }
          }
-         else if ((contenu_len_possible_match==3) && (!u_trymatch_superfast5(contenu,ETIQ_L_LN3))) {
+         else if (kind==FST2TXT_LETTER_TAG) {
               // case of a single letter
               if (p->buffer[pos+p->current_origin]==' ') {pos2=pos+1;if (p->output_policy==MERGE_OUTPUTS) push(p->stack,' ');}
               //else if (buffer[pos+origine_courante]==0x0d) {pos2=pos+2;if (MODE==MERGE) empiler(0x0a);}
@@ -799,44 +1021,68 @@ while (t!=NULL) {
 
 
 
-int not_a_letter_sequence(Fst2Tag e,Alphabet* alphabet) {
-// we return false only if e is a letter sequence like %hello
-if (e->control&RESPECT_CASE_TAG_BIT_MASK
-	|| e->type==BEGIN_VAR_TAG
-    || e->type==END_VAR_TAG
-    || e->type==BEGIN_OUTPUT_VAR_TAG
-    || e->type==END_OUTPUT_VAR_TAG) {
-   // case of @hello $a( and $a)
-   return 1;
-}
+/**
+ * Returns the kind of the given tag. The tests are done in the order
+ * that scan_graph used when it compared the tag inputs by itself.
+ */
+static enum fst2txt_tag_kind get_tag_kind(Fst2Tag e) {
+if (e->type==BEGIN_OUTPUT_VAR_TAG || e->type==END_OUTPUT_VAR_TAG) return FST2TXT_OUTPUT_VAR_TAG;
+if (e->type==BEGIN_VAR_TAG) return FST2TXT_BEGIN_VAR_TAG;
+if (e->type==END_VAR_TAG) return FST2TXT_END_VAR_TAG;
 unichar* s=e->input;
-if (!is_letter(s[0],alphabet)) return 1;
-int s_len_possible_match=u_len_possible_match(s);
-if (s_len_possible_match==1) {
-    if ((!u_trymatch_superfast1(s,'#')) ||
-        (!u_trymatch_superfast1(s,' ')))
-        return 1;
+switch (u_len_possible_match(s)) {
+   case 5: {
+      if (!u_trymatch_superfast5(s,ETIQ_MOT_LN5)) return FST2TXT_MOT_TAG;
+      if (!u_trymatch_superfast5(s,ETIQ_MAJ_LN5)) return FST2TXT_MAJ_TAG;
+      if (!u_trymatch_superfast5(s,ETIQ_MIN_LN5)) return FST2TXT_MIN_TAG;
+      if (!u_trymatch_superfast5(s,ETIQ_PRE_LN5)) return FST2TXT_PRE_TAG;
+      if (!u_trymatch_superfast5(s,ETIQ_PNC_LN5)) return FST2TXT_PNC_TAG;
+      break;
+   }
+   case 4: {
+      if (!u_trymatch_superfast4(s,ETIQ_NB_LN4)) return FST2TXT_NB_TAG;
+      break;
+   }
+   case 3: {
+      if (!u_trymatch_superfast3(s,ETIQ_E_LN3)) return FST2TXT_EPSILON_TAG;
+      if (!u_trymatch_superfast3(s,ETIQ_CIRC_LN3)) return FST2TXT_NEW_LINE_TAG;
+      if (!u_trymatch_superfast3(s,ETIQ_L_LN3)) return FST2TXT_LETTER_TAG;
+      break;
+   }
+   case 1: {
+      if (!u_trymatch_superfast1(s,'#') && !(e->control&RESPECT_CASE_TAG_BIT_MASK)) return FST2TXT_NO_SPACE_TAG;
+      if (!u_trymatch_superfast1(s,' ')) return FST2TXT_SPACE_TAG;
+      break;
+   }
+   default: break;
 }
-if (s_len_possible_match==3) {
-    if ((!u_trymatch_superfast3(s,ETIQ_L_LN3)) ||
-        (!u_trymatch_superfast3(s,ETIQ_E_LN3)) ||
-        (!u_trymatch_superfast3(s,ETIQ_CIRC_LN3)))
-        return 1;
+return FST2TXT_LITERAL_TAG;
 }
-// added in revision 1028
-if (s_len_possible_match==4) {
-    if ((!u_trymatch_superfast4(s,ETIQ_NB_LN4)))
-        return 1;
+
+
+/**
+ * Computes the kind of each tag of the fst2.
+ */
+static void compute_tag_kinds(struct fst2txt_parameters* p) {
+free(p->tag_kind);
+p->tag_kind=(enum fst2txt_tag_kind*)malloc(p->fst2->number_of_tags*sizeof(enum fst2txt_tag_kind));
+if (p->tag_kind==NULL) {
+   fatal_alloc_error("compute_tag_kinds");
 }
-if (s_len_possible_match==5) {
-    if ((!u_trymatch_superfast5(s,ETIQ_MOT_LN5)) ||
-        (!u_trymatch_superfast5(s,ETIQ_MAJ_LN5)) ||
-        (!u_trymatch_superfast5(s,ETIQ_MIN_LN5)) ||
-        (!u_trymatch_superfast5(s,ETIQ_PRE_LN5)) ||
-        (!u_trymatch_superfast5(s,ETIQ_PNC_LN5)))
-        return 1;
+for (int i=0;i<p->fst2->number_of_tags;i++) {
+   p->tag_kind[i]=get_tag_kind(p->fst2->tags[i]);
+}
+}
+
+
+int not_a_letter_sequence(int n_tag,struct fst2txt_parameters* p) {
+// we return false only if e is a letter sequence like %hello
+Fst2Tag e=p->fst2->tags[n_tag];
+if (e->control&RESPECT_CASE_TAG_BIT_MASK || p->tag_kind[n_tag]!=FST2TXT_LITERAL_TAG) {
+   // case of @hello $a( $a) <MOT> ...
+   return 1;
 }
-return 0;
+return !is_letter(e->input[0],p->alphabet);
 }
 
 
@@ -847,7 +1093,7 @@ Transition* add_tag_to_token_tree(struct fst2txt_token_tree* tree,Transition* tr
 if (trans==NULL) return NULL;
 // case 2: transition by something else that a sequence of letter like %hello
 //         or sub-graph call
-if (trans->tag_number<0 || not_a_letter_sequence(p->fst2->tags[trans->tag_number],p->alphabet)) {
+if (trans->tag_number<0 || not_a_letter_sequence(trans->tag_number,p)) {
    trans->next=add_tag_to_token_tree(tree,trans->next,p);
    return trans;
 }
@@ -870,8 +1116,10 @@ p->token_tree=(struct fst2txt_token_tree**)malloc(p->n_token_trees*sizeof(struct
 if (p->token_tree==NULL) {
    fatal_alloc_error("build_state_token_trees\n");
 }
+compute_tag_kinds(p);
 for (int i=0;i<p->n_token_trees;i++) {
    p->token_tree[i]=new_fst2txt_token_tree();
    p->fst2->states[i]->transitions=add_tag_to_token_tree(p->token_tree[i],p->fst2->states[i]->transitions,p);
+   compute_first_letters(p->token_tree[i],p->alphabet);
 }
 }
@@ -36,6 +36,30 @@
 #define MAX_OUTPUT_LENGTH 10000
 
 
+/**
+ * The kind of a tag, as seen by Fst2Txt. It is computed once for each tag
+ * of the fst2, so that the exploration does not have to compare the tag
+ * inputs with "<MOT>", "<NB>", etc. at each step.
+ */
+enum fst2txt_tag_kind {
+   FST2TXT_LITERAL_TAG,
+   FST2TXT_MOT_TAG,
+   FST2TXT_NB_TAG,
+   FST2TXT_MAJ_TAG,
+   FST2TXT_MIN_TAG,
+   FST2TXT_PRE_TAG,
+   FST2TXT_PNC_TAG,
+   FST2TXT_EPSILON_TAG,
+   FST2TXT_NEW_LINE_TAG,
+   FST2TXT_NO_SPACE_TAG,
+   FST2TXT_SPACE_TAG,
+   FST2TXT_LETTER_TAG,
+   FST2TXT_BEGIN_VAR_TAG,
+   FST2TXT_END_VAR_TAG,
+   FST2TXT_OUTPUT_VAR_TAG
+};
+
+
 /**
  * This structure represents the parameters required by Fst2Txt.
  */
@@ -49,6 +73,8 @@ struct fst2txt_parameters {
    U_FILE* f_output;
    Fst2* fst2;
    Alphabet* alphabet;
+   /* tag_kind[i] is the kind of the tag #i of the fst2 */
+   enum fst2txt_tag_kind* tag_kind;
 
    OutputPolicy output_policy;
    TokenizationPolicy tokenization_policy;
@@ -77,6 +103,12 @@ struct fst2txt_parameters {
    Encoding encoding_output;
    int bom_output;
    int mask_encoding_compatibility_input;
+
+   /* If n_threads>1, the text is loaded in memory and cut into chunks just
+    * after the occurrences of 'separator', and these chunks are processed
+    * by n_threads threads */
+   int n_threads;
+   unichar* separator;
 };
 
 struct fst2txt_parameters* new_fst2txt_parameters();
@@ -41,6 +41,8 @@ t->transition_array=(Transition**)malloc(t->capacity*sizeof(Transition*));
 if (t->transition_array==NULL) {
    fatal_alloc_error("new_fst2txt_token_tree");
 }
+t->first_letters=NULL;
+t->n_first_letters=0;
 return t;
 }
 
@@ -55,6 +57,7 @@ for (int i=0;i<t->size;i++) {
    free_Transition_list(t->transition_array[i]);
 }
 free(t->transition_array);
+free(t->first_letters);
 free(t);
 }
 
@@ -86,6 +89,78 @@ tree->transition_array[n]=new_Transition(tag_number,dest_state,tree->transition_
 }
 
 
+static int compare_unichars(const void* a,const void* b) {
+return (int)*((const unichar*)a)-(int)*((const unichar*)b);
+}
+
+
+/**
+ * Computes the characters that can start a token of the given tree. This
+ * must be called once all the tokens have been added.
+ */
+void compute_first_letters(struct fst2txt_token_tree* tree,Alphabet* alphabet) {
+free(tree->first_letters);
+int capacity=16;
+int n=0;
+unichar* letters=(unichar*)malloc(capacity*sizeof(unichar));
+if (letters==NULL) {
+   fatal_alloc_error("compute_first_letters");
+}
+for (struct string_hash_tree_transition* trans=tree->hash->root->trans;trans!=NULL;trans=trans->next) {
+   /* A token letter matches itself and its uppercase equivalents */
+   unichar tmp[2];
+   const unichar* upper=tmp;
+   tmp[1]='\0';
+   if (alphabet==NULL) {
+      tmp[0]=u_toupper(trans->letter);
+   } else if (alphabet->pos_in_represent_list[trans->letter]!=0) {
+      upper=alphabet->t_array_collection[alphabet->pos_in_represent_list[trans->letter]];
+   } else {
+      tmp[0]='\0';
+   }
+   int length=u_strlen(upper);
+   if (n+length+1>capacity) {
+      capacity=2*(n+length+1);
+      letters=(unichar*)realloc(letters,capacity*sizeof(unichar));
+      if (letters==NULL) {
+         fatal_alloc_error("compute_first_letters");
+      }
+   }
+   letters[n++]=trans->letter;
+   for (int i=0;i<length;i++) {
+      letters[n++]=upper[i];
+   }
+}
+qsort(letters,n,sizeof(unichar),compare_unichars);
+/* We remove duplicates */
+int size=0;
+for (int i=0;i<n;i++) {
+   if (size==0 || letters[size-1]!=letters[i]) {
+      letters[size++]=letters[i];
+   }
+}
+tree->first_letters=letters;
+tree->n_first_letters=size;
+}
+
+
+/**
+ * Returns 1 if a token of the given tree may start with the given text
+ * character; 0 otherwise.
+ */
+int may_start_token(unichar c,struct fst2txt_token_tree* tree) {
+int start=0;
+int end=tree->n_first_letters-1;
+while (start<=end) {
+   int middle=(start+end)/2;
+   if (tree->first_letters[middle]==c) return 1;
+   if (tree->first_letters[middle]<c) start=middle+1;
+   else end=middle-1;
+}
+return 0;
+}
+
+
 /**
  * This function explores a token tree, comparing it with the given token in order to
  * find out the tokens that match the text token, and then, to add to corresponding
@@ -34,12 +34,19 @@
  * then 'transition_array[n]' contains the transitions associated to 't'.
  * 'capacity' is the maximum size of the array and 'size' is its actual
  * size.
+ *
+ * 'first_letters' is the sorted array of the text characters that can
+ * start a token of the tree, i.e. the first letters of the tokens and
+ * their uppercase equivalents. It allows to skip the tree without reading
+ * the current text token.
  */
 struct fst2txt_token_tree {
    struct string_hash* hash;
    Transition** transition_array;
    int capacity;
    int size;
+   unichar* first_letters;
+   int n_first_letters;
 };
 
 
@@ -48,6 +55,8 @@ struct fst2txt_token_tree* new_fst2txt_token_tree();
 void free_fst2txt_token_tree(struct fst2txt_token_tree*);
 
 void add_tag(unichar*,int,int,struct fst2txt_token_tree*);
+void compute_first_letters(struct fst2txt_token_tree*,Alphabet*);
+int may_start_token(unichar,struct fst2txt_token_tree*);
 Transition* get_matching_tags(unichar*,struct fst2txt_token_tree*,Alphabet*);
 
 
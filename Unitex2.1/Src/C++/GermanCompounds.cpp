@@ -21,14 +21,32 @@
 
 #include "GermanCompounds.h"
 #include "Error.h"
+#include "Vector.h"
+#include "logger/SyncLogger.h"
 
 
+/**
+ * Above this number of analysed suffixes, the memo of a thread is emptied
+ * before the next word.
+ */
+#define MAX_GERMAN_MEMO_SIZE 200000
+
+/**
+ * Number of words read at once, per thread.
+ */
+#define WORDS_PER_THREAD 1024
+
+
+
+static void free_german_decompositions(void*);
+
 
 //
 // this function analyses the german compound words
 //
 void analyse_german_compounds(const Alphabet* alph,const unsigned char* bin,const struct INF_codes* inf,
-                                 U_FILE* words,U_FILE* result,U_FILE* debug,U_FILE* new_unknown_words) {
+                                 U_FILE* words,U_FILE* result,U_FILE* debug,U_FILE* new_unknown_words,
+                                 int n_threads) {
 char* tableau_correct_left_component=(char*)malloc(sizeof(char)*(inf->N));
 if (tableau_correct_left_component==NULL) {
    fatal_alloc_error("analyse_german_compounds");
@@ -39,8 +57,14 @@ if (tableau_correct_right_component==NULL) {
 }
 check_valid_left_component_german(tableau_correct_left_component,inf);
 check_valid_right_component_german(tableau_correct_right_component,inf);
-analyse_german_word_list(bin,inf,words,result,debug,new_unknown_words,tableau_correct_left_component,
-                         tableau_correct_right_component,alph);
+struct german_infos infos;
+infos.bin=bin;
+infos.inf=inf;
+infos.left=tableau_correct_left_component;
+infos.right=tableau_correct_right_component;
+infos.alphabet=alph;
+infos.memo=NULL;
+analyse_german_word_list(&infos,words,result,debug,new_unknown_words,n_threads);
 free(tableau_correct_left_component);
 free(tableau_correct_right_component);
 }
@@ -181,205 +205,204 @@ return res;
 
 
 //
-// this function reads words in the word file and try analyse them
+// a word read in multi-thread mode, with the lines produced by its analysis
 //
-void analyse_german_word_list(const unsigned char* bin,const struct INF_codes* inf,
-                              U_FILE* words,U_FILE* result,U_FILE* debug,U_FILE* new_unknown_words,
-                              const char* left,const char* right,const Alphabet* alphabet) {
-unichar s[1000];
-u_printf("Analysing german unknown words...\n");
-int n=0;
-while (EOF!=u_fgets_limit2(s,1000,words)) {
-  if (!analyse_german_word(s,debug,result,left,right,inf,alphabet,bin)) {
-     // if the analysis has failed, we store the word in the new unknown word file
-     u_fprintf(new_unknown_words,"%S\n",s);
-  } else {n++;}
+struct german_word_info {
+   unichar* word;
+   Ustring* result;
+   Ustring* debug;
+   int decomposed;
+};
+
+
+
+//
+// the words first, first+step, ... that are before end are analysed
+// with the given infos, whose memo is private
+//
+struct german_job {
+   struct german_infos infos;
+   struct german_word_info* words;
+   int first;
+   int end;
+   int step;
+};
+
+
+
+static void SYNC_CALLBACK_UNITEX analyse_german_words(void* privateDataPtr,unsigned int /*iNbThread*/) {
+struct german_job* job=(struct german_job*)privateDataPtr;
+for (int i=job->first;i<job->end;i+=job->step) {
+   struct german_word_info* w=&(job->words[i]);
+   w->decomposed=analyse_german_word(w->word,w->result,w->debug,&(job->infos));
 }
-u_printf("%d words decomposed as compound words\n",n);
 }
 
 
 
 //
-// this function try to analyse an unknown german word
+// this function reads words in the word file and try analyse them. The words
+// are read by blocks, and the words of a block are shared between n_threads
+// threads. Then, the results are written in the order of the word file.
 //
-int analyse_german_word(const unichar* mot,U_FILE* debug_file,U_FILE* result_file,const char* left,const char* right,
-                        const struct INF_codes* inf_codes,const Alphabet* alphabet,const unsigned char* bin) {
-unichar decomposition[2000];
-unichar dela_line[2000];
-unichar correct_word[2000];
-decomposition[0]='\0';
-dela_line[0]='\0';
-correct_word[0]='\0';
-struct german_word_decomposition_list* l=NULL;
-explore_state_german(4,correct_word,0,mot,0,decomposition,dela_line,&l,1,left,right,inf_codes,alphabet,bin);
-if (l==NULL) {
-   return 0;
+void analyse_german_word_list(struct german_infos* infos,
+                              U_FILE* words,U_FILE* result,U_FILE* debug,U_FILE* new_unknown_words,
+                              int n_threads) {
+unichar s[1000];
+u_printf("Analysing german unknown words...\n");
+if (n_threads<1) {
+   n_threads=1;
+}
+int max_words=n_threads*WORDS_PER_THREAD;
+struct german_word_info* block=(struct german_word_info*)malloc(max_words*sizeof(struct german_word_info));
+struct german_job* jobs=(struct german_job*)malloc(n_threads*sizeof(struct german_job));
+void** job_ptrs=(void**)malloc(n_threads*sizeof(void*));
+if (block==NULL || jobs==NULL || job_ptrs==NULL) {
+   fatal_alloc_error("analyse_german_word_list");
+}
+for (int t=0;t<n_threads;t++) {
+   jobs[t].infos=*infos;
+   jobs[t].infos.memo=new_hash_table((HASH_FUNCTION)hash_unichar,(EQUAL_FUNCTION)u_equal,
+                                     (FREE_FUNCTION)free,free_german_decompositions,(KEYCOPY_FUNCTION)keycopy);
+   jobs[t].words=block;
+   jobs[t].first=t;
+   jobs[t].step=n_threads;
+   job_ptrs[t]=&(jobs[t]);
+}
+for (int i=0;i<max_words;i++) {
+   block[i].result=new_Ustring(256);
+   block[i].debug=(debug!=NULL)?new_Ustring(256):NULL;
 }
-struct german_word_decomposition_list* tmp=l;
-while (tmp!=NULL) {
-   if (debug_file!=NULL) {
-      u_fprintf(debug_file,"%S = %S\n",mot,tmp->element->decomposition);
+int n=0;
+int n_words;
+do {
+   for (n_words=0;n_words<max_words && EOF!=u_fgets_limit2(s,1000,words);n_words++) {
+      block[n_words].word=u_strdup(s);
+   }
+   for (int t=0;t<n_threads;t++) {
+      jobs[t].end=n_words;
    }
-   u_fprintf(result_file,"%S\n",tmp->element->dela_line);
-   tmp=tmp->suivant;
+   if (n_threads==1) {
+      analyse_german_words(job_ptrs[0],0);
+   } else {
+      SyncDoRunThreads(n_threads,analyse_german_words,job_ptrs);
+   }
+   for (int i=0;i<n_words;i++) {
+      if (!block[i].decomposed) {
+         // if the analysis has failed, we store the word in the new unknown word file
+         u_fprintf(new_unknown_words,"%S\n",block[i].word);
+      } else {
+         n++;
+         if (debug!=NULL) {
+            u_fprintf(debug,"%S",block[i].debug->str);
+         }
+         u_fprintf(result,"%S",block[i].result->str);
+      }
+      free(block[i].word);
+   }
+} while (n_words==max_words);
+for (int i=0;i<max_words;i++) {
+   free_Ustring(block[i].result);
+   free_Ustring(block[i].debug);
 }
-if (l!=NULL) {
-  free_german_word_decomposition_list(l);
+for (int t=0;t<n_threads;t++) {
+   free_hash_table(jobs[t].infos.memo);
 }
-return 1;
+free(job_ptrs);
+free(jobs);
+free(block);
+u_printf("%d words decomposed as compound words\n",n);
 }
 
 
 
-
-struct german_word_decomposition* new_german_word_decomposition() {
-struct german_word_decomposition* tmp;
-tmp=(struct german_word_decomposition*)malloc(sizeof(struct german_word_decomposition));
-if (tmp==NULL) {
-   fatal_alloc_error("new_german_word_decomposition");
+//
+// the 5 strings of a decomposition are allocated in the same block as the
+// structure itself, so that a decomposition is freed with a single free
+//
+static struct german_decomposition* new_german_decomposition(const unichar* decomposition,
+                       const unichar* components,const unichar* inflected,const unichar* lemma,
+                       const unichar* codes) {
+const unichar* src[5]={decomposition,components,inflected,lemma,codes};
+int length[5];
+int total=0;
+for (int i=0;i<5;i++) {
+   length[i]=u_strlen(src[i])+1;
+   total=total+length[i];
+}
+struct german_decomposition* d=(struct german_decomposition*)malloc(sizeof(struct german_decomposition)
+                                                                   +total*sizeof(unichar));
+if (d==NULL) {
+   fatal_alloc_error("new_german_decomposition");
+}
+unichar* dest[5];
+dest[0]=(unichar*)(d+1);
+for (int i=0;i<5;i++) {
+   if (i>0) {
+      dest[i]=dest[i-1]+length[i-1];
+   }
+   memcpy(dest[i],src[i],length[i]*sizeof(unichar));
 }
-tmp->n_parts=0;
-tmp->decomposition[0]='\0';
-tmp->dela_line[0]='\0';
-return tmp;
+d->decomposition=dest[0];
+d->components=dest[1];
+d->inflected=dest[2];
+d->lemma=dest[3];
+d->codes=dest[4];
+return d;
 }
 
 
 
-void free_german_word_decomposition(struct german_word_decomposition* t) {
-if (t==NULL) return;
-free(t);
+static void free_german_decomposition(void* ptr) {
+free(ptr);
 }
 
 
 
-struct german_word_decomposition_list* new_german_word_decomposition_list() {
-struct german_word_decomposition_list* tmp;
-tmp=(struct german_word_decomposition_list*)malloc(sizeof(struct german_word_decomposition_list));
-if (tmp==NULL) {
-   fatal_alloc_error("new_german_word_decomposition_list");
-}
-tmp->element=NULL;
-tmp->suivant=NULL;
-return tmp;
+static void free_german_decompositions(void* ptr) {
+free_vector_ptr((vector_ptr*)ptr,free_german_decomposition);
 }
 
 
-void free_german_word_decomposition_list(struct german_word_decomposition_list* l) {
-struct german_word_decomposition_list* tmp;
-while (l!=NULL) {
-   free_german_word_decomposition(l->element);
-   tmp=l->suivant;
-   free(l);
-   l=tmp;
-}
-}
+
+//
+// a component found at the beginning of a word
+//
+struct german_prefix {
+   int index;
+   /* the component is stored right after the structure */
+   unichar component[1];
+};
 
 
 
 //
-// this function explores the dictionary to decompose the word mot
+// this function explores the dictionary in order to find, in one pass, all the
+// components of at least 2 letters that start the given word. A component is kept
+// if it is a valid right one when it covers the whole word, or a valid left one
+// otherwise. The components are added to prefixes in the order of the exploration.
 //
-void explore_state_german(int adresse,unichar* current_component,int pos_in_current_component,
-                   const unichar* original_word,int pos_in_original_word,const unichar* decomposition,
-                   unichar* dela_line,struct german_word_decomposition_list** L,int n_decomp,
-                   const char* left,const char* right,
-                   const struct INF_codes* inf_codes,const Alphabet* alphabet,
-                   const unsigned char* tableau_bin) {
+static void get_german_prefixes(int adresse,unichar* current_component,int pos_in_current_component,
+                                const unichar* word,vector_ptr* prefixes,const struct german_infos* infos) {
+const unsigned char* tableau_bin=infos->bin;
 int c;
 int index,t;
 c=tableau_bin[adresse]*256+tableau_bin[adresse+1];
 if (!(c&32768)) {
   // if we are in a terminal state
   index=tableau_bin[adresse+2]*256*256+tableau_bin[adresse+3]*256+tableau_bin[adresse+4];
-  current_component[pos_in_current_component]='\0';
-  if (pos_in_current_component>1) {
-    // we don't consider words with a length of 1
-    if (original_word[pos_in_original_word]=='\0') {
-      // if we have explored the entire original word
-      if (right[index]) {
-         // and if we have a valid right component
-         struct list_ustring* l=inf_codes->codes[index];
-         while (l!=NULL) {
-            unichar dec[500];
-            u_strcpy(dec,decomposition);
-            if (dec[0]!='\0') {u_strcat(dec," +++ ");}
-            unichar entry[500];
-            uncompress_entry(current_component,l->string,entry);
-            u_strcat(dec,entry);
-            unichar new_dela_line[500];
-            struct dela_entry* tmp_entry=tokenize_DELAF_line(entry,1);
-            if (tmp_entry==NULL) {
-               /* If there was an error in the dictionary, we skip the entry */
-               l=l->next;
-               continue;
-            }
-            // change case if there is a prefix
-            // prefixes are downcase, nouns (=suffixes) uppercase:
-            // "investitionsObjekte" -> "Investitionsobjekte"
-            if ( u_strlen(dela_line) != 0 ) {
-              // capitalize dela_line
-              dela_line[0] = u_toupper((unichar) dela_line[0]);
-              // downcase lemma and inflected
-              tmp_entry->inflected[0] = u_tolower(tmp_entry->inflected[0]);
-              tmp_entry->lemma[0] = u_tolower(tmp_entry->lemma[0]);
-            }
-            u_strcpy(new_dela_line,dela_line);
-            u_strcat(new_dela_line,tmp_entry->inflected);
-            u_strcat(new_dela_line,",");
-            u_strcat(new_dela_line,dela_line);
-            u_strcat(new_dela_line,tmp_entry->lemma);
-            u_strcat(new_dela_line,".");
-            u_strcat(new_dela_line,tmp_entry->semantic_codes[0]);
-            int k;
-            for (k=1;k<tmp_entry->n_semantic_codes;k++) {
-               u_strcat(new_dela_line,"+");
-               u_strcat(new_dela_line,tmp_entry->semantic_codes[k]);
-            }
-            for (k=0;k<tmp_entry->n_inflectional_codes;k++) {
-               u_strcat(new_dela_line,":");
-               u_strcat(new_dela_line,tmp_entry->inflectional_codes[k]);
-            }
-            free_dela_entry(tmp_entry);
-            struct german_word_decomposition* wd=new_german_word_decomposition();
-            wd->n_parts=n_decomp;
-            u_strcpy(wd->decomposition,dec);
-            u_strcpy(wd->dela_line,new_dela_line);
-            if (check_valid_right_component_for_one_INF_code_german(l->string)) {
-               // if we got a correct right component (N-FF)
-               struct german_word_decomposition_list* wdl=new_german_word_decomposition_list();
-               wdl->element=wd;
-               wdl->suivant=(*L);
-               (*L)=wdl;
-            } else {
-               free_german_word_decomposition(wd);
-            }
-            l=l->next;
-         }
-      }
-    }
-    else {
-      // else, we must explore the rest of the original word
-      if (left[index]) {
-         // but only if the current component was a valid left one
-         // we go on with the next component
-         unichar dec[2000];
-         unichar line[500];
-         u_strcpy(dec,decomposition);
-         if (dec[0]!='\0') {u_strcat(dec," +++ ");}
-         unichar sia_code[500];
-         unichar entry[500];
-         get_first_sia_code_german(index,sia_code,inf_codes);
-         uncompress_entry(current_component,sia_code,entry);
-         u_strcat(dec,entry);
-         u_strcpy(line,dela_line);
-         u_strcat(line,current_component);
-         unichar temp[500];
-         explore_state_german(4,temp,0,original_word,pos_in_original_word,
-                  dec,line,L,n_decomp+1,left,right,inf_codes,alphabet,tableau_bin);
-      }
-    }
+  // we don't consider words with a length of 1
+  if (pos_in_current_component>1
+      && ((word[pos_in_current_component]=='\0')?infos->right[index]:infos->left[index])) {
+     struct german_prefix* p=(struct german_prefix*)malloc(sizeof(struct german_prefix)
+                                                          +pos_in_current_component*sizeof(unichar));
+     if (p==NULL) {
+        fatal_alloc_error("get_german_prefixes");
+     }
+     memcpy(p->component,current_component,pos_in_current_component*sizeof(unichar));
+     p->component[pos_in_current_component]='\0';
+     p->index=index;
+     vector_ptr_add(prefixes,p);
   }
   t=adresse+5;
 }
@@ -387,19 +410,231 @@ else {
   c=c-32768;
   t=adresse+2;
 }
-if (original_word[pos_in_original_word]=='\0') {
+if (word[pos_in_current_component]=='\0') {
    // if we have finished, we return
    return;
 }
 // if not, we go on with the next letter
 for (int i=0;i<c;i++) {
-  if (is_equal_or_uppercase((unichar)(tableau_bin[t]*256+tableau_bin[t+1]),original_word[pos_in_original_word],alphabet)
-      || is_equal_or_uppercase(original_word[pos_in_original_word],(unichar)(tableau_bin[t]*256+tableau_bin[t+1]),alphabet)) {
+  unichar letter=(unichar)(tableau_bin[t]*256+tableau_bin[t+1]);
+  if (is_equal_or_uppercase(letter,word[pos_in_current_component],infos->alphabet)
+      || is_equal_or_uppercase(word[pos_in_current_component],letter,infos->alphabet)) {
     index=tableau_bin[t+2]*256*256+tableau_bin[t+3]*256+tableau_bin[t+4];
-    current_component[pos_in_current_component]=(unichar)(tableau_bin[t]*256+tableau_bin[t+1]);
-    explore_state_german(index,current_component,pos_in_current_component+1,original_word,pos_in_original_word+1,
-                  decomposition,dela_line,L,n_decomp,left,right,inf_codes,alphabet,tableau_bin);
+    current_component[pos_in_current_component]=letter;
+    get_german_prefixes(index,current_component,pos_in_current_component+1,word,prefixes,infos);
   }
   t=t+5;
 }
 }
+
+
+
+static const vector_ptr* analyse_german_suffix(const unichar*,struct german_infos*);
+
+
+//
+// this function adds to res a decomposition for each valid right entry of the
+// given component, which is supposed to be the end of the word
+//
+static void get_final_german_decompositions(const struct german_prefix* p,vector_ptr* res,
+                                            const struct german_infos* infos) {
+for (struct list_ustring* l=infos->inf->codes[p->index];l!=NULL;l=l->next) {
+   if (!check_valid_right_component_for_one_INF_code_german(l->string)) {
+      continue;
+   }
+   unichar entry[2000];
+   uncompress_entry(p->component,l->string,entry);
+   struct dela_entry* tmp_entry=tokenize_DELAF_line(entry,1);
+   if (tmp_entry==NULL) {
+      /* If there was an error in the dictionary, we skip the entry */
+      continue;
+   }
+   // if we got a correct right component (N-FF)
+   unichar codes[2000];
+   u_strcpy(codes,".");
+   u_strcat(codes,tmp_entry->semantic_codes[0]);
+   int k;
+   for (k=1;k<tmp_entry->n_semantic_codes;k++) {
+      u_strcat(codes,"+");
+      u_strcat(codes,tmp_entry->semantic_codes[k]);
+   }
+   for (k=0;k<tmp_entry->n_inflectional_codes;k++) {
+      u_strcat(codes,":");
+      u_strcat(codes,tmp_entry->inflectional_codes[k]);
+   }
+   vector_ptr_add(res,new_german_decomposition(entry,U_EMPTY,tmp_entry->inflected,
+                                                tmp_entry->lemma,codes));
+   free_dela_entry(tmp_entry);
+}
+}
+
+
+
+//
+// this function returns the decompositions of the given word suffix, in the
+// order in which they are found. Since many words share the same suffixes,
+// they are kept in the memo of infos, but only for the suffixes that start
+// with a component: most suffixes do not, and looking them up in the
+// dictionary is cheaper than hashing them. A suffix without decomposition
+// is stored with a NULL value, so that it only costs its key.
+//
+static const vector_ptr* analyse_german_suffix(const unichar* suffix,struct german_infos* infos) {
+static const vector_ptr no_decomposition={0,NULL,0};
+unichar current_component[1000];
+vector_ptr* prefixes=new_vector_ptr(8);
+get_german_prefixes(4,current_component,0,suffix,prefixes,infos);
+if (prefixes->nbelems==0) {
+   free_vector_ptr(prefixes,free);
+   return &no_decomposition;
+}
+int ret;
+struct any* value=get_value(infos->memo,(void*)suffix,HT_INSERT_IF_NEEDED,&ret);
+if (ret==HT_KEY_ALREADY_THERE) {
+   free_vector_ptr(prefixes,free);
+   return (value->_ptr!=NULL)?(const vector_ptr*)value->_ptr:&no_decomposition;
+}
+value->_ptr=NULL;
+vector_ptr* res=new_vector_ptr(4);
+for (int i=0;i<prefixes->nbelems;i++) {
+   struct german_prefix* p=(struct german_prefix*)prefixes->tab[i];
+   int length=u_strlen(p->component);
+   if (suffix[length]=='\0') {
+      // if the component is the whole suffix, we take all its valid right entries
+      get_final_german_decompositions(p,res,infos);
+      continue;
+   }
+   // else, the component is a valid left one, and we go on with the rest of the suffix
+   const vector_ptr* tails=analyse_german_suffix(suffix+length,infos);
+   if (tails->nbelems==0) {
+      continue;
+   }
+   unichar sia_code[2000];
+   unichar entry[2000];
+   get_first_sia_code_german(p->index,sia_code,infos->inf);
+   uncompress_entry(p->component,sia_code,entry);
+   for (int j=0;j<tails->nbelems;j++) {
+      struct german_decomposition* tail=(struct german_decomposition*)tails->tab[j];
+      unichar decomposition[4000];
+      unichar components[2000];
+      u_strcpy(decomposition,entry);
+      u_strcat(decomposition," +++ ");
+      u_strcat(decomposition,tail->decomposition);
+      u_strcpy(components,p->component);
+      u_strcat(components,tail->components);
+      vector_ptr_add(res,new_german_decomposition(decomposition,components,tail->inflected,
+                                                   tail->lemma,tail->codes));
+   }
+}
+free_vector_ptr(prefixes,free);
+if (res->nbelems==0) {
+   free_vector_ptr(res);
+   res=NULL;
+}
+value->_ptr=res;
+return (res!=NULL)?res:&no_decomposition;
+}
+
+
+
+//
+// this function appends to result_lines the DELAF line of the word made of
+// the given left components followed by the decomposition d
+//
+static void add_german_line(Ustring* result_lines,const unichar* left_components,
+                            const struct german_decomposition* d) {
+if (left_components[0]=='\0') {
+   u_strcat(result_lines,d->inflected);
+   u_strcat(result_lines,',');
+   u_strcat(result_lines,d->lemma);
+} else {
+   // change case if there is a prefix
+   // prefixes are downcase, nouns (=suffixes) uppercase:
+   // "investitionsObjekte" -> "Investitionsobjekte"
+   unichar first=u_toupper(left_components[0]);
+   u_strcat(result_lines,first);
+   u_strcat(result_lines,left_components+1);
+   u_strcat(result_lines,d->components);
+   u_strcat(result_lines,u_tolower(d->inflected[0]));
+   u_strcat(result_lines,d->inflected+1);
+   u_strcat(result_lines,',');
+   u_strcat(result_lines,first);
+   u_strcat(result_lines,left_components+1);
+   u_strcat(result_lines,d->components);
+   u_strcat(result_lines,u_tolower(d->lemma[0]));
+   u_strcat(result_lines,d->lemma+1);
+}
+u_strcat(result_lines,d->codes);
+u_strcat(result_lines,'\n');
+}
+
+
+
+//
+// this function try to analyse an unknown german word. The DELAF lines are
+// appended to result_lines, and the decompositions to debug_lines, if not NULL.
+// Returns 1 if the word could be decomposed; 0 otherwise.
+//
+// The decompositions are given in the reverse order of their discovery, so that
+// we explore the components that start the word from the last one to the first.
+// The whole word is not stored in the memo, since words are not supposed to
+// appear twice in the list: only its suffixes are.
+//
+int analyse_german_word(const unichar* mot,Ustring* result_lines,Ustring* debug_lines,
+                        struct german_infos* infos) {
+empty(result_lines);
+if (debug_lines!=NULL) {
+   empty(debug_lines);
+}
+if (infos->memo->number_of_elements>MAX_GERMAN_MEMO_SIZE) {
+   clear_hash_table(infos->memo);
+}
+unichar current_component[1000];
+vector_ptr* prefixes=new_vector_ptr(8);
+get_german_prefixes(4,current_component,0,mot,prefixes,infos);
+int decomposed=0;
+for (int i=prefixes->nbelems-1;i>=0;i--) {
+   struct german_prefix* p=(struct german_prefix*)prefixes->tab[i];
+   int length=u_strlen(p->component);
+   if (mot[length]=='\0') {
+      // the word is a simple one
+      vector_ptr* l=new_vector_ptr(4);
+      get_final_german_decompositions(p,l,infos);
+      for (int j=l->nbelems-1;j>=0;j--) {
+         struct german_decomposition* d=(struct german_decomposition*)l->tab[j];
+         if (debug_lines!=NULL) {
+            u_strcat(debug_lines,mot);
+            u_strcat(debug_lines," = ");
+            u_strcat(debug_lines,d->decomposition);
+            u_strcat(debug_lines,'\n');
+         }
+         add_german_line(result_lines,U_EMPTY,d);
+         decomposed=1;
+      }
+      free_vector_ptr(l,free_german_decomposition);
+      continue;
+   }
+   const vector_ptr* tails=analyse_german_suffix(mot+length,infos);
+   if (tails->nbelems==0) {
+      continue;
+   }
+   unichar sia_code[2000];
+   unichar entry[2000];
+   get_first_sia_code_german(p->index,sia_code,infos->inf);
+   uncompress_entry(p->component,sia_code,entry);
+   for (int j=tails->nbelems-1;j>=0;j--) {
+      struct german_decomposition* tail=(struct german_decomposition*)tails->tab[j];
+      if (debug_lines!=NULL) {
+         u_strcat(debug_lines,mot);
+         u_strcat(debug_lines," = ");
+         u_strcat(debug_lines,entry);
+         u_strcat(debug_lines," +++ ");
+         u_strcat(debug_lines,tail->decomposition);
+         u_strcat(debug_lines,'\n');
+      }
+      add_german_line(result_lines,p->component,tail);
+      decomposed=1;
+   }
+}
+free_vector_ptr(prefixes,free);
+return decomposed;
+}
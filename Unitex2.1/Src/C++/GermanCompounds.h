@@ -27,36 +27,48 @@
 #include "Alphabet.h"
 #include "DELA.h"
 #include "String_hash.h"
+#include "HashTable.h"
+#include "Ustring.h"
 
 
-struct german_word_decomposition {
-   int n_parts;
-   unichar decomposition[2000];
-   unichar dela_line[2000];
+/**
+ * A decomposition of the end of a word, starting at a given position.
+ * 'decomposition' is the list of the entries of its components, separated
+ * by " +++ ", 'components' is the concatenation of its left components, and
+ * 'inflected', 'lemma' and 'codes' come from the entry of its last component.
+ */
+struct german_decomposition {
+   unichar* decomposition;
+   unichar* components;
+   unichar* inflected;
+   unichar* lemma;
+   unichar* codes;
 };
 
-struct german_word_decomposition_list {
-   struct german_word_decomposition* element;
-   struct german_word_decomposition_list* suivant;
+
+/**
+ * The information needed to analyse german words. 'memo' associates to each
+ * word suffix already analysed the vector_ptr of its decompositions.
+ */
+struct german_infos {
+   const unsigned char* bin;
+   const struct INF_codes* inf;
+   const char* left;
+   const char* right;
+   const Alphabet* alphabet;
+   struct hash_table* memo;
 };
 
 
-void analyse_german_compounds(const Alphabet*,const unsigned char*,const struct INF_codes*,U_FILE*,U_FILE*,U_FILE*,U_FILE*);
+void analyse_german_compounds(const Alphabet*,const unsigned char*,const struct INF_codes*,U_FILE*,U_FILE*,U_FILE*,U_FILE*,int);
 void check_valid_right_component_german(char*,const struct INF_codes*);
 void check_valid_left_component_german(char*,const struct INF_codes*);
 char check_valid_left_component_for_an_INF_line_german(const struct list_ustring*);
 char check_valid_left_component_for_one_INF_code_german(const unichar*);
 char check_valid_right_component_for_an_INF_line_german(const struct list_ustring*);
 char check_valid_right_component_for_one_INF_code_german(const unichar*);
-void analyse_german_word_list(const unsigned char*,const struct INF_codes*,U_FILE*,U_FILE*,U_FILE*,U_FILE*,const char*,const char*,const Alphabet*);
-int analyse_german_word(const unichar*,U_FILE*,U_FILE*,const char*,const char*,const struct INF_codes*,const Alphabet*,const unsigned char*);
+void analyse_german_word_list(struct german_infos*,U_FILE*,U_FILE*,U_FILE*,U_FILE*,int);
+int analyse_german_word(const unichar*,Ustring*,Ustring*,struct german_infos*);
 void get_first_sia_code_german(int,unichar*,const struct INF_codes*);
 
-struct german_word_decomposition* new_german_word_decomposition();
-void free_german_word_decomposition(struct german_word_decomposition*);
-struct german_word_decomposition_list* new_german_word_decomposition_list();
-void free_german_word_decomposition_list(struct german_word_decomposition_list*);
-void explore_state_german(int,unichar*,int,const unichar*,int,const unichar*,unichar*,
-      struct german_word_decomposition_list**,int,const char*,const char*,const struct INF_codes*,const Alphabet*,const unsigned char*);
-
 #endif
@@ -34,6 +34,32 @@
 #include "Grf2Fst2.h"
 #include "UnitexGetOpt.h"
 #include "ProgramInvoker.h"
+#include "logger/SyncLogger.h"
+#include "DirHelper.h"
+#include "Af_stdio.h"
+
+
+/**
+ * Creates the cache directory if needed, and checks once that a file can be
+ * created in it, so that a bad directory does not cause one error per graph.
+ * Returns 1 if the directory can be used, 0 otherwise.
+ */
+static int prepare_cache_dir(const char* cache_dir) {
+/* mkDirPortable fails when the directory already exists: the probe file
+ * below is what tells us whether it can be used */
+mkDirPortable(cache_dir);
+char probe[FILENAME_MAX];
+if (snprintf(probe,FILENAME_MAX,"%scache.tmp",cache_dir)>=FILENAME_MAX) {
+   return 0;
+}
+U_FILE* f=u_fopen(BINARY,probe,U_WRITE);
+if (f==NULL) {
+   return 0;
+}
+u_fclose(f);
+af_remove(probe);
+return 1;
+}
 
 
 const char* usage_Grf2Fst2 =
@@ -54,6 +80,11 @@ const char* usage_Grf2Fst2 =
          "  -c/--char_by_char: lexical units are single letters. If both -a and -c options are\n"
          "                     unused, lexical units will be sequences of any unicode letters.\n"
          "  -d DIR/--pkgdir=DIR: path of the root dir of all grammar packages\n"
+         "  --threads=N: compiles N graphs at the same time (default=1). If N is 0,\n"
+         "               one thread is used per processor\n"
+         "  --cache=DIR: keeps the compiled graphs in DIR, so that only the graphs\n"
+         "               that have changed are compiled again. DIR is created\n"
+         "               if it does not exist\n"
          "  -h/--help: this help\n"
          "\n"
          "Compiles the grammar <grf> and saves the result in a FST2 file\n"
@@ -125,6 +156,8 @@ const struct option_TS lopts_Grf2Fst2[]= {
       {"input_encoding",required_argument_TS,NULL,'k'},
       {"output_encoding",required_argument_TS,NULL,'q'},
       {"output",required_argument_TS,NULL,'o'},
+      {"threads",required_argument_TS,NULL,1},
+      {"cache",required_argument_TS,NULL,2},
       {"help",no_argument_TS,NULL,'h'},
       {NULL,no_argument_TS,NULL,0}
 };
@@ -147,6 +180,7 @@ char fst2_file_name[FILENAME_MAX];
 infos->verbose_name_grf=1;
 
 int val,index=-1;
+char foo;
 struct OptVars* vars=new_OptVars();
 fst2_file_name[0]='\0';
 while (EOF!=(val=getopt_long_TS(argc,argv,optstring_Grf2Fst2,lopts_Grf2Fst2,&index,vars))) {
@@ -177,6 +211,26 @@ while (EOF!=(val=getopt_long_TS(argc,argv,optstring_Grf2Fst2,lopts_Grf2Fst2,&ind
              strcpy(fst2_file_name,vars->optarg);
              break;
    case 'd': strcpy(infos->repository,vars->optarg); break;
+   case 1: if (1!=sscanf(vars->optarg,"%d%c",&(infos->n_threads),&foo) || infos->n_threads<0) {
+                fatal_error("Invalid number of threads: %s\n",vars->optarg);
+             }
+             break;
+   case 2: if (vars->optarg[0]=='\0') {
+                fatal_error("You must specify a non empty cache directory\n");
+             }
+             if (strlen(vars->optarg)+1>=FILENAME_MAX) {
+                error("Cache directory name too long, the cache is not used: %s\n",vars->optarg);
+                break;
+             }
+             strcpy(infos->cache_dir,vars->optarg);
+             if (infos->cache_dir[strlen(infos->cache_dir)-1]!=PATH_SEPARATOR_CHAR) {
+                strcat(infos->cache_dir,PATH_SEPARATOR_STRING);
+             }
+             if (!prepare_cache_dir(infos->cache_dir)) {
+                error("Cannot use %s as cache directory, the cache is not used\n",vars->optarg);
+                infos->cache_dir[0]='\0';
+             }
+             break;
    case 'h': usage(); return 0;
    case ':': if (index==-1) fatal_error("Missing argument for option -%c\n",vars->optopt);
              else fatal_error("Missing argument for option --%s\n",lopts_Grf2Fst2[index].name);
@@ -210,10 +264,18 @@ strcat(fst2_file_name,".fst2");
 infos->encoding_output = encoding_output;
 infos->bom_output = bom_output;
 infos->mask_encoding_compatibility_input = mask_encoding_compatibility_input;
+if (infos->n_threads<=0) {
+   infos->n_threads=(int)SyncGetNumberOfProcessors();
+}
+if (infos->n_threads>1 && !IsSeveralThreadsPossible()) {
+   infos->n_threads=1;
+}
 if ((infos->fst2=u_fopen_creating_unitex_text_format(encoding_output,bom_output,fst2_file_name,U_WRITE))==NULL) {
    error("Cannot open file %s\n",fst2_file_name);
    return 1;
 }
+/* The analysis that Fst2Check may have saved for the old .fst2 is now wrong */
+remove_fst2_analysis(fst2_file_name);
 u_fprintf(infos->fst2,"0000000000\n");
 int result=compile_grf(argv[vars->optind],infos);
 if (result==0) {
@@ -25,6 +25,9 @@
 #include "File.h"
 #include "Transitions.h"
 #include "SingleGraph.h"
+#include "Vector.h"
+#include "Ustring.h"
+#include "logger/SyncLogger.h"
 
 
 /* Maximum length for the content of a grf box */
@@ -40,6 +43,78 @@
 #define EMPTY_GRAPH 1
 #define NON_EMPTY_GRAPH 2
 
+/* States of a graph section */
+#define GRF_OK 0
+#define GRF_CANNOT_OPEN 1
+#define GRF_INVALID 2
+#define GRF_BOX_TOO_LONG 3
+
+#define GRF_CACHE_MAGIC 0x43324647
+#define GRF_CACHE_VERSION 1
+#define GRF_CACHE_EXTENSION ".g2c"
+
+
+/**
+ * A graph section contains everything that is needed to write the graph #n
+ * into the .fst2. The .grf is first read with its own numbering:
+ * local tags and local subgraph names are numbered in the order they are
+ * found, a tag being a number >=0 and a call to the local subgraph #i being
+ * -(i+1). Context start marks are numbered the same way. This does not
+ * depend on the other graphs, so that all the graphs of a wave can be read
+ * at the same time. Then, merge_grf_section gives the global numbers of the
+ * local ones, graph after graph, in the same order as a sequential
+ * compilation would do. That's why the .fst2 does not depend on the number
+ * of threads or on the cache.
+ *
+ * When a cache is used, a section is saved as a list of int: the local
+ * tables, the graph in local numbering, the global numbers it was compiled
+ * with and the compiled graph. If the global numbers are the same the next
+ * time, the compiled graph is reused as is; otherwise, the graph is compiled
+ * again from its local form, without reading the .grf. Only the
+ * minimization depends on the global numbers.
+ */
+struct grf_section {
+   int n;
+   unichar* name;
+   char file_name[FILENAME_MAX];
+   struct compilation_info* infos;
+   int status;
+   /* 1 if the compiled graph has been emptied */
+   int emptied;
+   /* Local tables */
+   struct string_hash* tags;
+   struct string_hash* graph_names;
+   /* Local tag number of each context start mark */
+   vector_int* contexts;
+   /* Global numbers of the local tags followed by the ones of the local graphs */
+   int* ids;
+   SingleGraph graph;
+   /* 0 if the section must not be saved in the cache, because the reading
+    * of the .grf printed something that would not be printed again */
+   int cacheable;
+   unsigned int key[2];
+   /* Cache record, if any. 'final_pos' is the position of the global
+    * numbers, followed by the compiled graph */
+   vector_int* record;
+   int graph_pos;
+   int final_pos;
+   int from_cache;
+   /* Messages about the .grf, printed when the graph is saved so that they
+    * appear in the graph order */
+   Ustring* messages;
+};
+
+
+/**
+ * The sections of graphs that are processed by one thread.
+ */
+struct grf_job {
+   struct grf_section** sections;
+   int first;
+   int end;
+   int step;
+};
+
 
 
 /**
@@ -68,7 +143,10 @@ infos->encoding_output = DEFAULT_ENCODING_OUTPUT;
 infos->bom_output = DEFAULT_BOM_OUTPUT;
 infos->mask_encoding_compatibility_input = DEFAULT_MASK_ENCODING_COMPATIBILITY_INPUT;
 infos->verbose_name_grf=1;
-
+infos->n_threads=1;
+infos->cache_dir[0]='\0';
+infos->options_key[0]=0;
+infos->options_key[1]=0;
 return infos;
 }
 
@@ -162,9 +240,9 @@ return 0;
 
 /**
  * Computes the absolute path of the graph #n, taking into account references
- * to the graph repository, if any.
+ * to the graph repository, if any. Warnings are added to 'messages'.
  */
-void get_absolute_name(char* name,int n,struct compilation_info* infos) {
+void get_absolute_name(char* name,int n,struct compilation_info* infos,Ustring* messages) {
 unichar temp[FILENAME_MAX];
 int offset;
 int abs_path_name_warning=0; // 1 windows, 2 unix
@@ -202,7 +280,7 @@ u_strcat(temp,".grf");
 /* Finally, we turn the file name into ISO-8859-1 */
 u_to_char(name,temp);
 if (abs_path_name_warning!=0) {
-   error("Absolute path name detected (%s):\n"
+   u_strcatf(messages,"Absolute path name detected (%s):\n"
          "%s\n"
          "Absolute path names are not portable!\n",
          ((abs_path_name_warning==1) ? "Windows" :
@@ -485,7 +563,8 @@ if (u_ends_with(dest,".grf")) {
  */
 int process_box_line_token(unichar* input,int *pos,
                            struct fifo* tokens,
-                           int n,struct compilation_info* infos) {
+                           struct grf_section* section) {
+struct compilation_info* infos=section->infos;
 if (input[*pos]=='\0') {
    fatal_error("Empty string in process_box_line_token\n");
 }
@@ -497,7 +576,7 @@ if (input[*pos]==':') {
    if (input[(*pos)+1]!= ':') {
       /* If the subgraph is not in the repository, we copy the path
        * of the current graph */
-      u_strcpy(&(token[1]),infos->graph_names->value[n]);
+      u_strcpy(&(token[1]),section->name);
       /* And we remove the current graph name */
       l=u_strlen(token);
       while (token[l]!=':') {
@@ -520,8 +599,8 @@ if (input[*pos]==':') {
    /* Now that we have the path prefix, we can add the subgraph call */
    get_subgraph_call(input,pos,&(token[l]));
    put_ptr(tokens,u_strdup(token));
-   /* We add this graph name to the graph names, if not already present */
-   get_value_index(token+1,infos->graph_names);
+   /* We add this graph name to the local graph names, if not already present */
+   get_value_index(token+1,section->graph_names);
    return 0;
 }
 /* If we have found a '+' */
@@ -596,8 +675,8 @@ return 0;
  * Takes a token sequence and turns it into an integer sequence.
  */
 void token_sequence_2_integer_sequence(struct fifo* u_tokens,unichar* output,
-                                int* i_tokens,struct compilation_info* infos,
-                                int *n_tokens,int current_graph) {
+                                int* i_tokens,struct grf_section* section,
+                                int *n_tokens) {
 if (u_tokens==NULL) {
    fatal_error("NULL error in token_sequence_2_integer_sequence\n");
 }
@@ -611,23 +690,24 @@ int is_an_output=(output!=NULL && output[0]!='\0');
 if (token[0]==':' && token[1]!='\0') {
    /* If we have a subgraph call */
    if (is_an_output) {
-      error("WARNING in %S: ignoring output associated to subgraph call %S\n",
-            infos->graph_names->value[current_graph],token);
+      u_strcatf(section->messages,"WARNING in %S: ignoring output associated to subgraph call %S\n",
+            section->name,token);
+      section->cacheable=0;
    }
    if (!is_empty(u_tokens)) {
       fatal_error("%S: unexpected token after subgraph call in token_sequence_2_integer_sequence\n",
-            infos->graph_names->value[current_graph]);
+            section->name);
    }
-   i_tokens[(*n_tokens)++]=-get_value_index(&(token[1]),infos->graph_names);
+   i_tokens[(*n_tokens)++]=-(get_value_index(&(token[1]),section->graph_names)+1);
    free(token);
    return;
 }
 if (is_an_output) {
    /* If there is an output, we associate it to the first token */
    u_sprintf(tmp,"%S/%S",token,output);
-   i_tokens[(*n_tokens)++]=get_value_index(tmp,infos->tags);
+   i_tokens[(*n_tokens)++]=get_value_index(tmp,section->tags);
 } else {
-   i_tokens[(*n_tokens)++]=get_value_index(token,infos->tags);
+   i_tokens[(*n_tokens)++]=get_value_index(token,section->tags);
 }
 free(token);
 
@@ -636,10 +716,10 @@ while (!is_empty(u_tokens)) {
    token=(unichar*)take_ptr(u_tokens);
    if (token[0]==':' && token[1]!='\0') {
       fatal_error("%S: unexpected subgraph call in token_sequence_2_integer_sequence\n",
-            infos->graph_names->value[current_graph]);
+            section->name);
    }
    u_sprintf(tmp,"%S",token);
-   i_tokens[(*n_tokens)++]=get_value_index(tmp,infos->tags);
+   i_tokens[(*n_tokens)++]=get_value_index(tmp,section->tags);
    free(token);
 }
 }
@@ -679,15 +759,15 @@ while (transitions!=NULL) {
  * be 0 for the first call and 4 for the second call).
  */
 void process_box_line(SingleGraph graph,unichar* input,unichar* output,struct list_int* transitions,
-                     int *pos,int state,int n,struct compilation_info* infos) {
+                     int *pos,int state,struct grf_section* section) {
 int result=0;
 struct fifo* sequence=new_fifo();
 while (result==0 && input[*pos]!='\0') {
-   result=process_box_line_token(input,pos,sequence,n,infos);
+   result=process_box_line_token(input,pos,sequence,section);
 }
 int sequence_ent[MAX_TOKENS_IN_A_SEQUENCE];
 int n_tokens;
-token_sequence_2_integer_sequence(sequence,output,sequence_ent,infos,&n_tokens,n);
+token_sequence_2_integer_sequence(sequence,output,sequence_ent,section,&n_tokens);
 free_fifo(sequence);
 write_transitions(graph,sequence_ent,transitions,state,n_tokens);
 }
@@ -699,24 +779,23 @@ write_transitions(graph,sequence_ent,transitions,state,n_tokens);
  */
 void process_variable_or_context(SingleGraph graph,unichar* input,
                                 struct list_int* transitions,
-                                int state,struct compilation_info* infos,
-                                int current_graph) {
+                                int state,struct grf_section* section) {
 struct fifo* tmp=new_fifo();
 put_ptr(tmp,u_strdup(input));
 int token[1];
 int i;
-token_sequence_2_integer_sequence(tmp,NULL,token,infos,&i,current_graph);
+token_sequence_2_integer_sequence(tmp,NULL,token,section,&i);
 free_fifo(tmp);
 write_transitions(graph,token,transitions,state,1);
 }
 
 
 /**
- * Processes the given grf state of the graph #n.
+ * Processes the given grf state of the graph of the given section.
  */
 void process_grf_state(unichar* box_content,struct list_int* transitions,
                       SingleGraph graph,int current_state,
-                      int n,struct compilation_info* infos) {
+                      struct grf_section* section) {
 unichar input[MAX_GRF_BOX_CONTENT];
 unichar output[MAX_GRF_BOX_CONTENT];
 if (transitions==NULL) {
@@ -738,11 +817,13 @@ if ((length>2 && box_content[0]=='$' &&
    u_strcpy(input,box_content);
    if (box_content[1]=='!' || box_content[1]=='[') {
       /* If we have a context start mark, we adds a unique number to it
-       * (see declaration of CONTEXT_COUNTER) */
-      u_sprintf(input,"%s%d",(box_content[1]=='!')?"$![":"$[",(infos->CONTEXT_COUNTER)++);
+       * (see declaration of CONTEXT_COUNTER). This is a local number that
+       * will be shifted when the section is merged */
+      u_sprintf(input,"%s%d",(box_content[1]=='!')?"$![":"$[",section->contexts->nbelems);
+      vector_int_add(section->contexts,get_value_index(input,section->tags));
    }
    u_strcpy(output,"");
-   process_variable_or_context(graph,input,transitions,current_state,infos,n);
+   process_variable_or_context(graph,input,transitions,current_state,section);
    return;
 }
 /* Otherwise, we deal with the output of the box, if any */
@@ -750,17 +831,17 @@ split_input_output(box_content,input,output);
 /* And we process the box input */
 int pos=0;
 while (input[pos]!='\0') {
-   process_box_line(graph,input,output,transitions,&pos,current_state,n,infos);
+   process_box_line(graph,input,output,transitions,&pos,current_state,section);
 }
 }
 
 
 /**
- * Reads one line of the graph #n. The box content is stored into 'box_content' and
- * the outgoing transitions are stored into 'transitions'.
+ * Reads one line of the graph of the given section. The box content is stored
+ * into 'box_content' and the outgoing transitions are stored into 'transitions'.
  * It returns 0 if the box is too large; 1 otherwise.
  */
-int read_grf_line(U_FILE* f,unichar* box_content,struct list_int* *transitions,int n,struct compilation_info* infos) {
+int read_grf_line(U_FILE* f,unichar* box_content,struct list_int* *transitions,struct grf_section* section) {
 *transitions=NULL;
 unichar c;
 int n_sortantes;
@@ -778,10 +859,10 @@ while (((c=(unichar)u_fgetc(f))!='"') && (i<MAX_GRF_BOX_CONTENT)) {
 }
 /* If the box content is too long */
 if (i>=MAX_GRF_BOX_CONTENT) {
-   error("ERROR in graph %S.grf:\n"
+   u_strcatf(section->messages,"ERROR in graph %S.grf:\n"
          "Too many characters in box. The number of characters\n"
          "per box should be lower than %d\n",
-         infos->graph_names->value[n],MAX_GRF_BOX_CONTENT);
+         section->name,MAX_GRF_BOX_CONTENT);
    return 0;
 }
 box_content[i]='\0';
@@ -801,28 +882,368 @@ return 1;
 
 
 /**
- * This function compiles the graph number #n and saves its states into the
- * output .fst2.
+ * Allocates, initializes and returns a section for the graph #n.
+ */
+static struct grf_section* new_grf_section(int n,struct compilation_info* infos) {
+struct grf_section* section=(struct grf_section*)malloc(sizeof(struct grf_section));
+if (section==NULL) {
+   fatal_alloc_error("new_grf_section");
+}
+section->n=n;
+section->name=infos->graph_names->value[n];
+section->file_name[0]='\0';
+section->infos=infos;
+section->status=GRF_OK;
+section->emptied=0;
+section->tags=new_string_hash(64);
+section->graph_names=new_string_hash(16);
+section->contexts=new_vector_int(4);
+section->ids=NULL;
+section->graph=NULL;
+section->cacheable=1;
+section->key[0]=infos->options_key[0];
+section->key[1]=infos->options_key[1];
+section->record=NULL;
+section->graph_pos=-1;
+section->final_pos=-1;
+section->from_cache=0;
+section->messages=new_Ustring();
+return section;
+}
+
+
+/**
+ * Frees the memory associated to the given section.
+ */
+static void free_grf_section(struct grf_section* section) {
+if (section==NULL) return;
+free_string_hash(section->tags);
+free_string_hash(section->graph_names);
+free_vector_int(section->contexts);
+free(section->ids);
+free_SingleGraph(section->graph,NULL);
+free_vector_int(section->record);
+free_Ustring(section->messages);
+free(section);
+}
+
+
+/**
+ * Adds the given bytes to the given key.
+ */
+static void hash_grf_bytes(unsigned int* key,const void* data,size_t size) {
+const unsigned char* bytes=(const unsigned char*)data;
+for (size_t i=0;i<size;i++) {
+   key[0]=(key[0]^bytes[i])*16777619u;
+   key[1]=(key[1]+bytes[i])*0x5bd1e995u;
+   key[1]=key[1]^(key[1]>>15);
+}
+}
+
+
+/**
+ * Computes the key of the options that change the compilation of a graph:
+ * the tokenization, including the letters of the alphabet if any, and the
+ * input encoding.
+ */
+static void compute_options_key(struct compilation_info* infos) {
+infos->options_key[0]=2166136261u;
+infos->options_key[1]=0x9747b28cu;
+int options[3];
+options[0]=GRF_CACHE_VERSION;
+options[1]=infos->tokenization_policy;
+options[2]=infos->mask_encoding_compatibility_input;
+hash_grf_bytes(infos->options_key,options,sizeof(options));
+if (infos->tokenization_policy==WORD_BY_WORD_TOKENIZATION) {
+   unsigned char letters[0x10000/8];
+   memset(letters,0,sizeof(letters));
+   for (int c=1;c<0x10000;c++) {
+      if (is_letter((unichar)c,infos->alphabet)) letters[c/8]=(unsigned char)(letters[c/8]|(1<<(c%8)));
+   }
+   hash_grf_bytes(infos->options_key,letters,sizeof(letters));
+}
+}
+
+
+/**
+ * Adds the content of the .grf and the name of the graph to the key of the
+ * given section. Returns 0 if the .grf cannot be opened; 1 otherwise.
+ */
+static int compute_grf_key(struct grf_section* section) {
+U_FILE* f=u_fopen(BINARY,section->file_name,U_READ);
+if (f==NULL) return 0;
+long size=get_file_size(f);
+char* content=(char*)malloc(size+1);
+if (content==NULL) {
+   fatal_alloc_error("compute_grf_key");
+}
+size=(long)fread(content,1,size,f);
+u_fclose(f);
+hash_grf_bytes(section->key,section->name,u_strlen(section->name)*sizeof(unichar));
+hash_grf_bytes(section->key,content,size);
+free(content);
+return 1;
+}
+
+
+/**
+ * Builds the name of the cache file of the given section. Returns 0 if it
+ * does not fit in FILENAME_MAX; 1 otherwise.
+ */
+static int get_grf_cache_name(struct grf_section* section,char* name) {
+int n=snprintf(name,FILENAME_MAX,"%s%08x%08x%s",section->infos->cache_dir,section->key[0],section->key[1],GRF_CACHE_EXTENSION);
+return (n>=0 && n<FILENAME_MAX);
+}
+
+
+static void add_record_string(vector_int* record,const unichar* s) {
+int length=u_strlen(s);
+vector_int_add(record,length);
+for (int i=0;i<length;i++) {
+   vector_int_add(record,s[i]);
+}
+}
+
+
+/**
+ * Reads a string saved by add_record_string at '*pos' and inserts it into
+ * the given string_hash. Returns 0 if the record is not valid.
+ */
+static int read_record_string(vector_int* record,int *pos,struct string_hash* hash) {
+if (*pos>=record->nbelems) return 0;
+int length=record->tab[(*pos)++];
+if (length<0 || length>record->nbelems-*pos) return 0;
+unichar* s=(unichar*)malloc((length+1)*sizeof(unichar));
+if (s==NULL) {
+   fatal_alloc_error("read_record_string");
+}
+for (int i=0;i<length;i++) {
+   s[i]=(unichar)record->tab[(*pos)++];
+}
+s[length]='\0';
+int old_size=hash->size;
+int ok=(get_value_index(s,hash)==old_size);
+free(s);
+return ok;
+}
+
+
+/**
+ * Saves the given graph in the given record. If 'with_final_states' is not
+ * null, each state starts with 1 if the state is final and 0 otherwise.
+ * The transitions are saved in the order of the transition lists.
+ */
+static void add_record_graph(vector_int* record,SingleGraph graph,int with_final_states) {
+vector_int_add(record,graph->number_of_states);
+for (int i=0;i<graph->number_of_states;i++) {
+   SingleGraphState s=graph->states[i];
+   if (with_final_states) {
+      vector_int_add(record,is_final_state(s));
+   }
+   int pos=vector_int_add(record,0);
+   int n_transitions=0;
+   for (Transition* t=s->outgoing_transitions;t!=NULL;t=t->next) {
+      vector_int_add(record,t->tag_number);
+      vector_int_add(record,t->state_number);
+      n_transitions++;
+   }
+   record->tab[pos]=n_transitions;
+}
+}
+
+
+/**
+ * Returns the position that follows the graph saved at 'pos', or -1 if the
+ * record is not valid.
+ */
+static int skip_record_graph(vector_int* record,int pos,int with_final_states) {
+if (pos>=record->nbelems) return -1;
+int n_states=record->tab[pos++];
+if (n_states<0) return -1;
+for (int i=0;i<n_states;i++) {
+   pos=pos+with_final_states;
+   if (pos>=record->nbelems) return -1;
+   int n_transitions=record->tab[pos++];
+   if (n_transitions<0 || n_transitions>(record->nbelems-pos)/2) return -1;
+   for (int j=0;j<n_transitions;j++) {
+      int dest=record->tab[pos+2*j+1];
+      if (dest<0 || dest>=n_states) return -1;
+   }
+   pos=pos+2*n_transitions;
+}
+return pos;
+}
+
+
+/**
+ * Builds the graph saved at 'pos' by add_record_graph.
+ */
+static SingleGraph get_record_graph(vector_int* record,int pos,int with_final_states) {
+SingleGraph graph=new_SingleGraph();
+int n_states=record->tab[pos++];
+if (n_states>0) {
+   set_state_array_capacity(graph,n_states);
+}
+for (int i=0;i<n_states;i++) {
+   SingleGraphState s=add_state(graph);
+   if (with_final_states && record->tab[pos++]) {
+      set_final_state(s);
+   }
+   int n_transitions=record->tab[pos++];
+   /* Transitions are inserted at the head of the list, so we add them
+    * backwards in order to get the saved order */
+   for (int j=n_transitions-1;j>=0;j--) {
+      add_outgoing_transition(s,record->tab[pos+2*j],record->tab[pos+2*j+1]);
+   }
+   pos=pos+2*n_transitions;
+}
+return graph;
+}
+
+
+/**
+ * Tries to load the section from the cache. Returns 1 in case of success;
+ * 0 otherwise.
+ */
+static int load_grf_cache(struct grf_section* section) {
+char name[FILENAME_MAX];
+if (!get_grf_cache_name(section,name)) return 0;
+U_FILE* f=u_fopen(BINARY,name,U_READ);
+if (f==NULL) return 0;
+long size=get_file_size(f);
+int n=(int)(size/sizeof(int));
+if (n<7 || size%sizeof(int)!=0) {
+   u_fclose(f);
+   return 0;
+}
+vector_int* record=new_vector_int(n);
+record->nbelems=(int)fread(record->tab,sizeof(int),n,f);
+u_fclose(f);
+int* t=record->tab;
+if (record->nbelems!=n || t[0]!=GRF_CACHE_MAGIC || t[1]!=GRF_CACHE_VERSION
+    || t[2]!=(int)section->key[0] || t[3]!=(int)section->key[1]
+    || t[4]<0 || t[5]<0 || t[6]<0 || t[6]>n-7) {
+   free_vector_int(record);
+   return 0;
+}
+int n_tags=t[4];
+int n_graphs=t[5];
+int n_contexts=t[6];
+int pos=7;
+int ok=1;
+for (int i=0;ok && i<n_contexts;i++) {
+   ok=(t[pos]>=0 && t[pos]<n_tags);
+   vector_int_add(section->contexts,t[pos++]);
+}
+for (int i=0;ok && i<n_tags;i++) {
+   ok=read_record_string(record,&pos,section->tags);
+}
+for (int i=0;ok && i<n_graphs;i++) {
+   ok=read_record_string(record,&pos,section->graph_names);
+}
+int graph_pos=pos;
+int final_pos=ok?skip_record_graph(record,graph_pos,0):-1;
+int end=-1;
+if (final_pos!=-1 && final_pos+n_tags+n_graphs<=n) {
+   end=skip_record_graph(record,final_pos+n_tags+n_graphs,1);
+}
+if (end!=n) {
+   /* If the cache file is not valid, we forget what we have read */
+   free_string_hash(section->tags);
+   free_string_hash(section->graph_names);
+   section->tags=new_string_hash(64);
+   section->graph_names=new_string_hash(16);
+   section->contexts->nbelems=0;
+   free_vector_int(record);
+   return 0;
+}
+section->record=record;
+section->graph_pos=graph_pos;
+section->final_pos=final_pos;
+section->from_cache=1;
+return 1;
+}
+
+
+/**
+ * Starts the cache record of the given section with its local tables and
+ * its graph in local numbering.
  */
-int compile_grf(int n,struct compilation_info* infos) {
+static void start_grf_record(struct grf_section* section) {
+vector_int* record=new_vector_int(1024);
+vector_int_add(record,GRF_CACHE_MAGIC);
+vector_int_add(record,GRF_CACHE_VERSION);
+vector_int_add(record,(int)section->key[0]);
+vector_int_add(record,(int)section->key[1]);
+vector_int_add(record,section->tags->size);
+vector_int_add(record,section->graph_names->size);
+vector_int_add(record,section->contexts->nbelems);
+for (int i=0;i<section->contexts->nbelems;i++) {
+   vector_int_add(record,section->contexts->tab[i]);
+}
+for (int i=0;i<section->tags->size;i++) {
+   add_record_string(record,section->tags->value[i]);
+}
+for (int i=0;i<section->graph_names->size;i++) {
+   add_record_string(record,section->graph_names->value[i]);
+}
+section->graph_pos=record->nbelems;
+add_record_graph(record,section->graph,0);
+section->final_pos=record->nbelems;
+section->record=record;
+}
+
+
+/**
+ * Completes the cache record of the given section with the global numbers
+ * and the compiled graph, and saves it.
+ */
+static void save_grf_cache(struct grf_section* section) {
+vector_int* record=section->record;
+record->nbelems=section->final_pos;
+int n_ids=section->tags->size+section->graph_names->size;
+for (int i=0;i<n_ids;i++) {
+   vector_int_add(record,section->ids[i]);
+}
+add_record_graph(record,section->graph,1);
+char name[FILENAME_MAX];
+if (!get_grf_cache_name(section,name)) return;
+U_FILE* f=u_fopen(BINARY,name,U_WRITE);
+if (f==NULL) {
+   error("Cannot create %s\n",name);
+   return;
+}
+if ((size_t)record->nbelems!=fwrite(record->tab,sizeof(int),record->nbelems,f)) {
+   error("Cannot write %s\n",name);
+}
+u_fclose(f);
+}
+
+
+/**
+ * Reads the .grf of the given section and builds its graph in local numbering.
+ */
+static void read_grf_section(struct grf_section* section) {
 int i;
 int n_states;
-char name[FILENAME_MAX];
 struct list_int* transitions;
 unichar ligne[MAX_GRF_BOX_CONTENT];
-SingleGraph graph=new_SingleGraph();
-if (infos->verbose_name_grf!=0) {
-  u_printf("Compiling graph %S\n",infos->graph_names->value[n]);
-}
+struct compilation_info* infos=section->infos;
 /* We get the absolute path of the graph */
-get_absolute_name(name,n,infos);
-U_FILE* f=u_fopen_existing_versatile_encoding(infos->mask_encoding_compatibility_input,name,U_READ);
+get_absolute_name(section->file_name,section->n,infos,section->messages);
+if (infos->cache_dir[0]!='\0') {
+   if (!compute_grf_key(section)) {
+      section->status=GRF_CANNOT_OPEN;
+      return;
+   }
+   if (load_grf_cache(section)) {
+      return;
+   }
+}
+U_FILE* f=u_fopen_existing_versatile_encoding(infos->mask_encoding_compatibility_input,section->file_name,U_READ);
 if (f==NULL) {
-   error("Cannot open the graph %S.grf\n(%s)\n",infos->graph_names->value[n],name);
-   write_graph(infos->fst2,graph,-n,infos->graph_names->value[n]);
-   free_SingleGraph(graph,NULL);
-   if (n==0) return 0;
-   return 1;
+   section->status=GRF_CANNOT_OPEN;
+   return;
 }
 /* If we can open the .grf file, we start with skipping the header. We skip
  * the first '#' and then we look for the second. */
@@ -830,12 +1251,12 @@ u_fgetc(f);
 int c;
 while ((c=u_fgetc(f))!=EOF && c!='#') {}
 if (c==EOF) {
-   error("Invalid graph %S.grf\n(%s)\n",infos->graph_names->value[n],name);
-   write_graph(infos->fst2,graph,-n,infos->graph_names->value[n]);
-   free_SingleGraph(graph,NULL);
-   if (n==0) return 0;
-   return 1;
+   u_fclose(f);
+   section->status=GRF_INVALID;
+   return;
 }
+SingleGraph graph=new_SingleGraph();
+section->graph=graph;
 /* Skip the newline and the number of states */
 u_fscanf(f,"%d\n",&n_states);
 /* If necessary, we resize the graph that it can hold all the states */
@@ -849,20 +1270,103 @@ for (i=0;i<n_states;i++) {
 graph->number_of_states=n_states;
 for (i=0;i<n_states;i++) {
    /* We read one line and we process it */
-   int result=read_grf_line(f,ligne,&transitions,n,infos);
+   int result=read_grf_line(f,ligne,&transitions,section);
    if (result==0) {
-      /* In case of error, we dump the graph and return */
-      write_graph(infos->fst2,graph,-n,infos->graph_names->value[n]);
-      free_SingleGraph(graph,NULL);
+      /* In case of error, the graph will be dumped as is */
+      section->status=GRF_BOX_TOO_LONG;
       u_fclose(f);
-      if (n==1) return 0;
-      return 1;
+      return;
    }
    /* We process the box */
-   process_grf_state(ligne,transitions,graph,i,n,infos);
+   process_grf_state(ligne,transitions,graph,i,section);
    free_list_int(transitions);
 }
 u_fclose(f);
+}
+
+
+/**
+ * Gives the global numbers of the local tags and subgraphs of the given
+ * section. Sections must be merged in the order of the graph numbers.
+ */
+static void merge_grf_section(struct grf_section* section) {
+if (section->status==GRF_CANNOT_OPEN || section->status==GRF_INVALID) return;
+struct compilation_info* infos=section->infos;
+int n_tags=section->tags->size;
+int n_graphs=section->graph_names->size;
+section->ids=(int*)malloc((n_tags+n_graphs+1)*sizeof(int));
+if (section->ids==NULL) {
+   fatal_alloc_error("merge_grf_section");
+}
+/* The i-th context start mark gets the global number CONTEXT_COUNTER+i */
+for (int i=0;i<n_tags;i++) {
+   section->ids[i]=-1;
+}
+for (int i=0;i<section->contexts->nbelems;i++) {
+   section->ids[section->contexts->tab[i]]=i;
+}
+unichar tmp[64];
+for (int i=0;i<n_tags;i++) {
+   if (section->ids[i]!=-1) {
+      u_sprintf(tmp,"%s%d",(section->tags->value[i][1]=='!')?"$![":"$[",infos->CONTEXT_COUNTER+section->ids[i]);
+      section->ids[i]=get_value_index(tmp,infos->tags);
+   } else {
+      section->ids[i]=get_value_index(section->tags->value[i],infos->tags);
+   }
+}
+infos->CONTEXT_COUNTER=infos->CONTEXT_COUNTER+section->contexts->nbelems;
+for (int i=0;i<n_graphs;i++) {
+   section->ids[n_tags+i]=get_value_index(section->graph_names->value[i],infos->graph_names);
+}
+}
+
+
+/**
+ * Replaces the local numbers of the graph of the given section by the
+ * global ones.
+ */
+static void set_global_numbers(struct grf_section* section) {
+SingleGraph graph=section->graph;
+int n_tags=section->tags->size;
+for (int i=0;i<graph->number_of_states;i++) {
+   if (graph->states[i]==NULL) continue;
+   for (Transition* t=graph->states[i]->outgoing_transitions;t!=NULL;t=t->next) {
+      if (t->tag_number>=0) {
+         t->tag_number=section->ids[t->tag_number];
+      } else {
+         t->tag_number=-section->ids[n_tags-t->tag_number-1];
+      }
+   }
+}
+}
+
+
+/**
+ * Compiles the graph of the given section, or gets it from the cache if it
+ * was compiled with the same global numbers.
+ */
+static void compile_grf_section(struct grf_section* section) {
+if (section->status==GRF_CANNOT_OPEN || section->status==GRF_INVALID) return;
+int use_cache=(section->infos->cache_dir[0]!='\0' && section->cacheable
+               && section->status==GRF_OK);
+if (section->from_cache) {
+   int n_ids=section->tags->size+section->graph_names->size;
+   if (!memcmp(section->ids,section->record->tab+section->final_pos,n_ids*sizeof(int))) {
+      /* If the graph was compiled with the same numbers, we are done */
+      section->graph=get_record_graph(section->record,section->final_pos+n_ids,1);
+      section->emptied=(section->graph->number_of_states==0);
+      return;
+   }
+   section->graph=get_record_graph(section->record,section->graph_pos,0);
+} else if (use_cache) {
+   start_grf_record(section);
+}
+set_global_numbers(section);
+if (section->status==GRF_BOX_TOO_LONG) {
+   /* The graph will be dumped as is */
+   return;
+}
+SingleGraph graph=section->graph;
 /* Once we have loaded the graph, we process it. */
 set_initial_state(graph->states[0]);
 set_final_state(graph->states[1]);
@@ -873,25 +1377,111 @@ check_accessibility(graph->states,0);
 remove_useless_states(graph,NULL);
 if (graph->states[0]==NULL) {
    /* If the graph has been emptied */
-   write_graph(infos->fst2,graph,-n,infos->graph_names->value[n]);
+   section->emptied=1;
+} else {
+   /* Now, we minimize the automaton assuming that reversed transitions are still there */
+   minimize(graph,0);
+}
+if (use_cache) {
+   save_grf_cache(section);
+}
+}
+
+
+/**
+ * Saves the graph of the given section into the output .fst2.
+ * It returns 0 if the compilation has failed; 1 otherwise.
+ */
+static int write_grf_section(struct grf_section* section) {
+struct compilation_info* infos=section->infos;
+int n=section->n;
+if (infos->verbose_name_grf!=0) {
+  u_printf("Compiling graph %S\n",section->name);
+}
+if (section->messages->len!=0) {
+   error("%S",section->messages->str);
+}
+switch (section->status) {
+case GRF_CANNOT_OPEN:
+case GRF_INVALID: {
+   if (section->status==GRF_CANNOT_OPEN) {
+      error("Cannot open the graph %S.grf\n(%s)\n",section->name,section->file_name);
+   } else {
+      error("Invalid graph %S.grf\n(%s)\n",section->name,section->file_name);
+   }
+   SingleGraph graph=new_SingleGraph();
+   write_graph(infos->fst2,graph,-n,section->name);
    free_SingleGraph(graph,NULL);
+   return 1;
+}
+case GRF_BOX_TOO_LONG: {
+   /* In case of error, we dump the graph */
+   write_graph(infos->fst2,section->graph,-n,section->name);
+   if (n==1) return 0;
+   return 1;
+}
+}
+write_graph(infos->fst2,section->graph,-n,section->name);
+if (section->emptied) {
    if (infos->no_empty_graph_warning) return 1;
    if (n==0) {
-      error("ERROR: Main graph %S.grf has been emptied\n",infos->graph_names->value[n]);
+      error("ERROR: Main graph %S.grf has been emptied\n",section->name);
       return 0;
    }
-   error("WARNING: graph %S.grf has been emptied\n",infos->graph_names->value[n]);
-   return 1;
+   error("WARNING: graph %S.grf has been emptied\n",section->name);
 }
-/* Now, we minimize the automaton assuming that reversed transitions are still there */
-minimize(graph,0);
-/* And we save it */
-write_graph(infos->fst2,graph,-n,infos->graph_names->value[n]);
-free_SingleGraph(graph,NULL);
 return 1;
 }
 
 
+static void SYNC_CALLBACK_UNITEX read_grf_sections(void* privateDataPtr,unsigned int /*iNbThread*/) {
+struct grf_job* job=(struct grf_job*)privateDataPtr;
+for (int i=job->first;i<job->end;i=i+job->step) {
+   read_grf_section(job->sections[i]);
+}
+}
+
+
+static void SYNC_CALLBACK_UNITEX compile_grf_sections(void* privateDataPtr,unsigned int /*iNbThread*/) {
+struct grf_job* job=(struct grf_job*)privateDataPtr;
+for (int i=job->first;i<job->end;i=i+job->step) {
+   compile_grf_section(job->sections[i]);
+}
+}
+
+
+/**
+ * Calls the given function on the sections [first;end[, dispatching them
+ * over the threads.
+ */
+static void run_grf_jobs(struct grf_section** sections,int first,int end,int n_threads,
+                         t_thread_func function) {
+if (n_threads>end-first) {
+   n_threads=end-first;
+}
+if (n_threads<=1) {
+   struct grf_job job={sections,first,end,1};
+   function(&job,0);
+   return;
+}
+struct grf_job* jobs=(struct grf_job*)malloc(n_threads*sizeof(struct grf_job));
+void** job_ptrs=(void**)malloc(n_threads*sizeof(void*));
+if (jobs==NULL || job_ptrs==NULL) {
+   fatal_alloc_error("run_grf_jobs");
+}
+for (int t=0;t<n_threads;t++) {
+   jobs[t].sections=sections;
+   jobs[t].first=first+t;
+   jobs[t].end=end;
+   jobs[t].step=n_threads;
+   job_ptrs[t]=&(jobs[t]);
+}
+SyncDoRunThreads(n_threads,function,job_ptrs);
+free(job_ptrs);
+free(jobs);
+}
+
+
 /**
  * This function takes the main graph name as given to the program and
  * computes its path and its name without path and extension. Then, the
@@ -922,20 +1512,54 @@ get_value_index(temp3,infos->graph_names);
 /**
  * This is the main function that takes a main graph and compiles it.
  * It returns 1 in case of success; 0 otherwise.
+ *
+ * The graphs are processed by waves: the first wave is the main graph, and
+ * each wave contains the graphs that were found by merging the previous one.
+ * The graphs of a wave are read and compiled at the same time, and then
+ * saved in order.
  */
 int compile_grf(char* main_graph,struct compilation_info* infos) {
-int current_graph=1;
-int result;
+/* All the cache names have the same length, so that we can check once
+ * that they fit */
+if (infos->cache_dir[0]!='\0'
+    && strlen(infos->cache_dir)+16+strlen(GRF_CACHE_EXTENSION)>=FILENAME_MAX) {
+   error("Cache directory name too long, the cache is not used: %s\n",infos->cache_dir);
+   infos->cache_dir[0]='\0';
+}
 extract_path_and_main_graph(main_graph,infos);
-do {
-   result=compile_grf(current_graph,infos);
-   if (result==0 && current_graph==1) {
+compute_options_key(infos);
+struct grf_section** sections=NULL;
+int first=1;
+while (first<infos->graph_names->size) {
+   int end=infos->graph_names->size;
+   /* The array is indexed by graph numbers */
+   sections=(struct grf_section**)realloc(sections,end*sizeof(struct grf_section*));
+   if (sections==NULL) {
+      fatal_alloc_error("compile_grf");
+   }
+   for (int n=first;n<end;n++) {
+      sections[n]=new_grf_section(n,infos);
+   }
+   run_grf_jobs(sections,first,end,infos->n_threads,read_grf_sections);
+   for (int n=first;n<end;n++) {
+      merge_grf_section(sections[n]);
+   }
+   run_grf_jobs(sections,first,end,infos->n_threads,compile_grf_sections);
+   int result=1;
+   for (int n=first;n<end;n++) {
+      if (result!=0) {
+         result=write_grf_section(sections[n]);
+      }
+      free_grf_section(sections[n]);
+   }
+   if (result==0) {
       /* If the main graph has been emptied, then the compilation has failed */
+      free(sections);
       return 0;
    }
-   if (result==-1) return 0;
-   current_graph++;
-} while (current_graph<infos->graph_names->size);
+   first=end;
+}
+free(sections);
 return 1;
 }
 
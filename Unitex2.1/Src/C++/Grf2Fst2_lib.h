@@ -72,6 +72,16 @@ Encoding encoding_output;
 int bom_output;
 int mask_encoding_compatibility_input;
 int verbose_name_grf;
+
+   /* Number of graphs that are compiled at the same time */
+   int n_threads;
+
+   /* If not empty, the directory where compiled graphs are cached, so that
+    * an unchanged graph does not need to be compiled again */
+   char cache_dir[FILENAME_MAX];
+
+   /* Hash of the options that have an influence on the compilation of a graph */
+   unsigned int options_key[2];
 };
 
 
@@ -36,7 +36,7 @@
 #include "TfstStats.h"
 #include "HashTable.h"
 
-void implode(Tfst*,U_FILE*,U_FILE*,struct hash_table* form_frequencies);
+void implode(Tfst*,U_FILE*,U_FILE*,struct tfst_binary_writer*,struct hash_table* form_frequencies);
 
 
 const char* usage_ImplodeTfst =
@@ -84,6 +84,8 @@ char input_tfst[FILENAME_MAX]="";
 char input_tind[FILENAME_MAX]="";
 char output_tfst[FILENAME_MAX]="";
 char output_tind[FILENAME_MAX]="";
+char input_tfstb[FILENAME_MAX]="";
+char output_tfstb[FILENAME_MAX]="";
 struct OptVars* vars=new_OptVars();
 while (EOF!=(val=getopt_long_TS(argc,argv,optstring_ImplodeTfst,lopts_ImplodeTfst,&index,vars))) {
    switch(val) {
@@ -119,6 +121,7 @@ if (vars->optind!=argc-1) {
 strcpy(input_tfst,argv[vars->optind]);
 remove_extension(input_tfst,input_tind);
 strcat(input_tind,".tind");
+get_tfst_binary_name(input_tfst,input_tfstb);
 char foo[FILENAME_MAX];
 remove_path(input_tfst,foo);
 int elag=!strcmp(foo,"text-elag.tfst");
@@ -127,6 +130,9 @@ if (output_tfst[0]=='\0') {
    no_explicit_output=1;
    sprintf(output_tfst,"%s.new",input_tfst);
    sprintf(output_tind,"%s.new",input_tind);
+   sprintf(output_tfstb,"%s.new",input_tfstb);
+} else {
+   get_tfst_binary_name(output_tfst,output_tfstb);
 }
 u_printf("Loading '%s'...\n",input_tfst);
 Tfst* tfst=open_text_automaton(input_tfst);
@@ -141,13 +147,15 @@ U_FILE* f_tind=u_fopen(BINARY,output_tind,U_WRITE);
 if (f_tind==NULL) {
    fatal_error("Cannot open '%s' for writing\n",output_tind);
 }
+struct tfst_binary_writer* f_tfstb=new_tfst_binary_writer(output_tfstb);
 /* We use this hash table to rebuild files tfst_tags_by_freq/alph.txt */
 struct hash_table* form_frequencies=new_hash_table((HASH_FUNCTION)hash_unichar,(EQUAL_FUNCTION)u_equal,
         (FREE_FUNCTION)free,NULL,(KEYCOPY_FUNCTION)keycopy);
 
-implode(tfst,f_tfst,f_tind,form_frequencies);
+implode(tfst,f_tfst,f_tind,f_tfstb,form_frequencies);
 u_fclose(f_tfst);
 u_fclose(f_tind);
+close_tfst_binary_writer(f_tfstb,output_tfst);
 close_text_automaton(tfst);
 
 /* We save statistics */
@@ -184,6 +192,10 @@ if (no_explicit_output) {
    af_remove(input_tind);
    af_rename(output_tfst,input_tfst);
    af_rename(output_tind,input_tind);
+   af_remove(input_tfstb);
+   if (f_tfstb!=NULL) {
+      af_rename(output_tfstb,input_tfstb);
+   }
 }
 free_OptVars(vars);
 return 0;
@@ -319,9 +331,9 @@ return list;
  * codes. For instance, if there are two transition from X to Y
  * that are tagged with "{rouge,.A:fs}" and "{rouge,.A:ms}", then
  * we will merge them into the single one "{rouge,.A:fs:ms}".
- * The resulting tfst is stored into the given .tfst and .tind files.
+ * The resulting tfst is stored into the given .tfst, .tind and .tfstb files.
  */
-void implode(Tfst* tfst,U_FILE* f_tfst,U_FILE* f_tind,struct hash_table* form_frequencies) {
+void implode(Tfst* tfst,U_FILE* f_tfst,U_FILE* f_tind,struct tfst_binary_writer* f_tfstb,struct hash_table* form_frequencies) {
 u_printf("Imploding tags...\n");
 unichar tag_content[4096];
 unichar tmp[4096];
@@ -393,7 +405,7 @@ for (int i=1;i<=tfst->N;i++) {
       state->outgoing_transitions=new_transitions;
    }
    /* Finally, we save the current sentence */
-   save_current_sentence(tfst,f_tfst,f_tind,new_tags->value,new_tags->size,form_frequencies);
+   save_current_sentence(tfst,f_tfst,f_tind,f_tfstb,new_tags->value,new_tags->size,form_frequencies);
    /* We free the tags */
    free_string_hash(new_tags);
 }
@@ -53,6 +53,12 @@ if (korean==NULL) {
 	u_strcpy(dest,src);
    return;
 }
+if (!only_syllables) {
+   /* No need to cache anything, since the conversion is done
+    * with the precomputed character table */
+   korean->Hanguls_to_Jamos(src,dest,0);
+   return;
+}
 int ret;
 struct any* value=get_value(korean->table,src,HT_INSERT_IF_NEEDED,&ret);
 if (ret==HT_KEY_ADDED) {
@@ -70,8 +76,31 @@ u_strcpy(dest,(unichar*)(value->_ptr));
  * Converts a syllable text into a Jamo one, including Chinese -> Hangul conversion
  * and Jamo compatible -> Jamo conversion. If 'only_syllables' is non zero,
  * characters that are neither Chinese chars nor Hanguls are left untouched.
+ *
+ * Since every character is converted independently of its neighbours when
+ * 'only_syllables' is zero, this case is handled with the character table
+ * computed once by initCharToJamosTable.
  */
 void Korean::Hanguls_to_Jamos(unichar* src,unichar* dest,int only_syllables) {
+if (only_syllables) {
+   convert_Hanguls_to_Jamos(src,dest,1);
+   return;
+}
+int n=0;
+for (int i=0;src[i]!='\0';i++) {
+   if (i==1024) {
+      fatal_error("Token too long in Korean::Hanguls_to_Jamos\n");
+   }
+   n+=char_to_Jamos(src[i],dest+n);
+}
+dest[n]='\0';
+}
+
+
+/**
+ * The actual conversion done by Hanguls_to_Jamos, without any table.
+ */
+void Korean::convert_Hanguls_to_Jamos(unichar* src,unichar* dest,int only_syllables) {
 unichar temp[1024];
 /* Then, we put a syllable bound before every character that is
  * 1) not a syllable one but in the alphabet (i.e. latin letters)
@@ -173,16 +202,19 @@ return 1;
  * the function should return 1.
  */
 int get_length_in_jamo(unichar hangul,Korean* korean) {
-unichar t[2];
-t[0]=hangul;
-t[1]='\0';
-unichar t2[16];
-Hanguls_to_Jamos(t,t2,korean,0);
-int pos=0;
-if (t2[0]==KR_SYLLABLE_BOUND) {
-   pos=1;
+if (hangul=='\0') {
+   return 0;
+}
+if (korean==NULL) {
+   /* No Korean data? The character is left unchanged */
+   return (hangul==KR_SYLLABLE_BOUND)?0:1;
+}
+unichar t[16];
+int length=korean->char_to_Jamos(hangul,t);
+if (length>0 && t[0]==KR_SYLLABLE_BOUND) {
+   length--;
 }
-return u_strlen(t2+pos);
+return length;
 }
 
 
@@ -292,6 +324,52 @@ for (int i=0;i<JAMO_SIZE;i++) {
 }
 
 
+/**
+ * Fills the character table used by Hanguls_to_Jamos, by converting once
+ * every character that is not left unchanged.
+ */
+void Korean::initCharToJamosTable() {
+unichar src[2];
+unichar dest[16];
+src[1]='\0';
+int capacity=0x10000;
+jamo_pool=(unichar*)malloc(capacity*sizeof(unichar));
+if (jamo_pool==NULL) {
+   fatal_alloc_error("initCharToJamosTable");
+}
+/* Position 0 is not used, since 0 stands for unmodified characters */
+int size=1;
+for (int c=1;c<0x10000;c++) {
+   src[0]=(unichar)c;
+   convert_Hanguls_to_Jamos(src,dest,0);
+   int length=u_strlen(dest);
+   if (length==1 && dest[0]==c) {
+      continue;
+   }
+   unsigned int* block=char_to_Jamos_table[c>>8];
+   if (block==NULL) {
+      block=(unsigned int*)calloc(256,sizeof(unsigned int));
+      if (block==NULL) {
+         fatal_alloc_error("initCharToJamosTable");
+      }
+      char_to_Jamos_table[c>>8]=block;
+   }
+   if (size+length+1>capacity) {
+      capacity=capacity*2;
+      jamo_pool=(unichar*)realloc(jamo_pool,capacity*sizeof(unichar));
+      if (jamo_pool==NULL) {
+         fatal_alloc_error("initCharToJamosTable");
+      }
+   }
+   block[c&0xFF]=size;
+   jamo_pool[size++]=(unichar)length;
+   for (int i=0;i<length;i++) {
+      jamo_pool[size++]=dest[i];
+   }
+}
+}
+
+
 /**
  * Converts the given Hangul syllable into its Jamo string equivalent.
  * Returns the updated position in the output string.
@@ -217,6 +217,15 @@ class Korean {
     */
    unichar* HCJ_to_SJ_table[256];
 
+   /* This two-level table gives the Jamo conversion of every character, as
+    * performed by Hanguls_to_Jamos with only_syllables=0. If
+    * char_to_Jamos_table[c>>8] is NULL, no character of this block is modified.
+    * Otherwise, char_to_Jamos_table[c>>8][c&0xFF] is 0 if c is not modified, or
+    * the position in 'jamo_pool' of its conversion, stored as its length
+    * followed by its letters. */
+   unsigned int* char_to_Jamos_table[256];
+   unichar* jamo_pool;
+
    Alphabet* alphabet;
 
 
@@ -225,7 +234,7 @@ public:
    /* This is used to optimize Hangul->Jamo conversions */
    struct hash_table* table;
 
-   Korean(Alphabet* alph) : alphabet(NULL), table(NULL) {
+   Korean(Alphabet* alph) : jamo_pool(NULL), alphabet(NULL), table(NULL) {
 	   if (alph==NULL) {
 		   fatal_error("Unexpected NULL alphabet in Korean()\n");
 	   }
@@ -235,9 +244,11 @@ public:
       for(int i=0;i<256;i++) {
          jamo_table[i]=NULL;
          HCJ_to_SJ_table[i]=NULL;
+         char_to_Jamos_table[i]=NULL;
       }
       initJamoMap();
       alphabet=alph;
+      initCharToJamosTable();
       table=new_hash_table(1024,0.75f,(HASH_FUNCTION)hash_unichar,(EQUAL_FUNCTION)u_equal,
     		  (FREE_FUNCTION)free,(FREE_FUNCTION)free,(KEYCOPY_FUNCTION)keycopy);
    };
@@ -248,6 +259,10 @@ public:
             delete [] jamo_table[i];
          }
       }
+      for(int i=0;i<256;i++) {
+         free(char_to_Jamos_table[i]);
+      }
+      free(jamo_pool);
       free_hash_table(table);
    };
 
@@ -256,12 +271,33 @@ public:
    int Jamos_to_Hangul(unichar* input,unichar* output);
    void Hanguls_to_Jamos(unichar* src,unichar* dest,int only_syllables);
 
+   /**
+    * Stores in 'dest' the Jamo conversion of the given character, the same
+    * as Hanguls_to_Jamos with only_syllables=0 would produce, and returns its
+    * length. 'dest' is not '\0'-terminated.
+    */
+   int char_to_Jamos(unichar c,unichar* dest) const {
+      const unsigned int* block=char_to_Jamos_table[c>>8];
+      if (block==NULL || block[c&0xFF]==0) {
+         dest[0]=c;
+         return 1;
+      }
+      const unichar* ptr=jamo_pool+block[c&0xFF];
+      int length=ptr[0];
+      for (int i=0;i<length;i++) {
+         dest[i]=ptr[i+1];
+      }
+      return length;
+   }
+
 private:
    void initJamoMap();
+   void initCharToJamosTable();
+   void convert_Hanguls_to_Jamos(unichar* src,unichar* dest,int only_syllables);
    int Hanguls_to_Jamos_internal(unichar* input,unichar* output,int only_syllables);
 
    /* prevent GCC warning */
-   Korean(const Korean&) : alphabet(NULL), table(NULL) {
+   Korean(const Korean&) : jamo_pool(NULL), alphabet(NULL), table(NULL) {
 			fatal_error("Unexpected copy constructor for Korean\n");
 		}
    Korean& operator =(const Korean&) {
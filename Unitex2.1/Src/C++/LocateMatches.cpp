@@ -21,6 +21,7 @@
 
 #include "LocateMatches.h"
 #include "Error.h"
+#include "Pipeline.h"
 
 
 
@@ -131,3 +132,80 @@ return l;
 }
 
 
+/**
+ * Allocates and returns an empty list of saved matches.
+ */
+struct saved_matches* new_saved_matches(OutputPolicy policy) {
+struct saved_matches* s=(struct saved_matches*)malloc(sizeof(struct saved_matches));
+if (s==NULL) {
+   fatal_alloc_error("new_saved_matches");
+}
+s->policy=policy;
+s->list=NULL;
+s->end=NULL;
+return s;
+}
+
+
+/**
+ * Adds at the end of the list the match that has just been written in the
+ * concord.ind file, as load_match_list would read it.
+ */
+void add_saved_match(struct saved_matches* s,int start,int end,int end_char,unichar* output) {
+struct match_list* l=new_match(start,end,0,end_char,0,0,(s->policy!=IGNORE_OUTPUTS)?output:NULL,NULL);
+if (s->list==NULL) {
+   s->list=l;
+} else {
+   s->end->next=l;
+}
+s->end=l;
+}
+
+
+void free_saved_matches(void* saved) {
+struct saved_matches* s=(struct saved_matches*)saved;
+if (s==NULL) return;
+free_match_list(s->list);
+free(s);
+}
+
+
+/**
+ * Loads the match list of the given concord.ind file into '*list', and its
+ * output policy into '*output_policy' if not NULL. If the matches have
+ * been saved by Locate in the current pipeline, they are copied instead of
+ * being parsed again. Returns 0 if the file cannot be opened.
+ */
+int load_concord_ind(const char* name,int mask_encoding_compatibility_input,
+                     struct match_list** list,OutputPolicy* output_policy) {
+struct saved_matches* saved=(struct saved_matches*)get_pipeline_resource(name,PIPELINE_MATCHES);
+if (saved!=NULL) {
+   struct match_list* l=NULL;
+   struct match_list* end=NULL;
+   for (struct match_list* m=saved->list;m!=NULL;m=m->next) {
+      struct match_list* copy=new_match(m->m.start_pos_in_token,m->m.end_pos_in_token,
+                                         m->m.start_pos_in_char,m->m.end_pos_in_char,
+                                         m->m.start_pos_in_letter,m->m.end_pos_in_letter,
+                                         m->output,NULL);
+      if (l==NULL) {
+         l=copy;
+      } else {
+         end->next=copy;
+      }
+      end=copy;
+   }
+   if (output_policy!=NULL) {
+      (*output_policy)=saved->policy;
+   }
+   unuse_pipeline_resource(saved);
+   (*list)=l;
+   return 1;
+}
+U_FILE* f=u_fopen_existing_versatile_encoding(mask_encoding_compatibility_input,name,U_READ);
+if (f==NULL) {
+   return 0;
+}
+(*list)=load_match_list(f,output_policy);
+u_fclose(f);
+return 1;
+}
@@ -45,4 +45,21 @@ void free_match_list_element(struct match_list*,Abstract_allocator prv_alloc=NUL
 void free_match_list(struct match_list*,Abstract_allocator prv_alloc=NULL);
 struct match_list* load_match_list(U_FILE*,OutputPolicy*,Abstract_allocator prv_alloc=NULL);
 
+
+/**
+ * The matches that Locate has saved in a concord.ind file, in the same order,
+ * with the output policy written in its header. In a pipeline, they are kept
+ * so that the next tools do not have to parse the file again.
+ */
+struct saved_matches {
+   OutputPolicy policy;
+   struct match_list* list;
+   struct match_list* end;
+};
+
+struct saved_matches* new_saved_matches(OutputPolicy);
+void add_saved_match(struct saved_matches*,int,int,int,unichar*);
+void free_saved_matches(void*);
+int load_concord_ind(const char*,int,struct match_list**,OutputPolicy*);
+
 #endif
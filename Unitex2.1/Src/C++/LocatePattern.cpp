@@ -30,6 +30,8 @@
 #include "File.h"
 #include "UserCancelling.h"
 #include "LocateTrace.h"
+#include "Pipeline.h"
+#include "Fst2Check_lib.h"
 
 
 void load_dic_for_locate(const char*,int,Alphabet*,int,int,int,struct lemma_node*,struct locate_parameters*);
@@ -63,6 +65,8 @@ p->filter_match_index=NULL;
 #endif
 p->DLC_tree=NULL;
 p->optimized_states=NULL;
+p->graph_first_tokens=NULL;
+p->n_graph_first_tokens=NULL;
 p->fst2=NULL;
 p->tokens=NULL;
 p->current_origin=-1;
@@ -77,6 +81,7 @@ p->output_policy=IGNORE_OUTPUTS;
 p->ambiguous_output_policy=ALLOW_AMBIGUOUS_OUTPUTS;
 p->variable_error_policy=IGNORE_VARIABLE_ERRORS;
 p->match_list=NULL;
+p->saved_matches=NULL;
 p->number_of_matches=0;
 p->number_of_outputs=0;
 p->start_position_last_printed_match=-1;
@@ -99,6 +104,7 @@ p->protect_dic_chars=0;
 p->graph_depth=0;
 p->korean=NULL;
 p->jamo_tags=NULL;
+p->jamo_fst2_tags=NULL;
 p->mask_encoding_compatibility_input = DEFAULT_MASK_ENCODING_COMPATIBILITY_INPUT;
 p->recyclable_wchart_buffer=(wchar_t*)malloc(sizeof(wchar_t)*SIZE_RECYCLABLE_WCHAR_T_BUFFER);
 if (p->recyclable_wchart_buffer==NULL) {
@@ -169,6 +175,127 @@ return res;
 }
 
 
+/**
+ * Returns an array containing the jamo versions of the tokens of the given
+ * fst2's tags, as they are matched in morphological mode. For a tag like
+ * {eats,eat.V:P3s}, only the inflected form is considered. The cell of
+ * a tag that is not a token pattern is NULL.
+ */
+static unichar** create_jamo_fst2_tags(Korean* korean,Fst2* fst2) {
+unichar** res=(unichar**)malloc(fst2->number_of_tags*sizeof(unichar*));
+if (res==NULL) {
+   fatal_alloc_error("create_jamo_fst2_tags");
+}
+unichar token[1024];
+unichar foo[1024];
+for (int i=0;i<fst2->number_of_tags;i++) {
+   res[i]=NULL;
+   Fst2Tag tag=fst2->tags[i];
+   if (tag->pattern==NULL || tag->pattern->type!=TOKEN_PATTERN) {
+      continue;
+   }
+   unichar* src=tag->pattern->inflected;
+   if (src[0]=='{' && u_strcmp(src,"{") && u_strcmp(src,"{S}")) {
+      src++;
+   }
+   int j;
+   for (j=0;src[j]!='\0' && j<1023;j++) {
+      if (src[j]==',' && src!=tag->pattern->inflected) break;
+      token[j]=src[j];
+   }
+   token[j]='\0';
+   if (token[0]==KR_SYLLABLE_BOUND && token[1]=='\0') {
+      u_strcpy(foo,token);
+   } else {
+      Hanguls_to_Jamos(token,foo,korean,0);
+   }
+   res[i]=u_strdup(foo);
+}
+return res;
+}
+
+
+static int compare_ints(const void* a,const void* b) {
+return *(const int*)a-*(const int*)b;
+}
+
+
+/**
+ * Computes, for each graph, the sorted array of the tokens that can start one
+ * of its matches, so that Locate does not call a graph from a token where it
+ * cannot match. We can only do that when the graph cannot match <E> and when
+ * all the tags that can be tried from its beginning are token lists or marks
+ * that do not consume anything. Otherwise, n_graph_first_tokens[i] is set to -1.
+ */
+static void compute_graph_first_tokens(struct locate_parameters* p,const struct fst2_analysis* a) {
+Fst2* fst2=p->fst2;
+int n=fst2->number_of_graphs;
+p->graph_first_tokens=(int**)calloc(n+1,sizeof(int*));
+p->n_graph_first_tokens=(int*)malloc((n+1)*sizeof(int));
+if (p->graph_first_tokens==NULL || p->n_graph_first_tokens==NULL) {
+   fatal_alloc_error("compute_graph_first_tokens");
+}
+vector_int* tokens=new_vector_int();
+for (int i=0;i<=n;i++) {
+   p->n_graph_first_tokens[i]=-1;
+   if (i==0 || a->nullable[i] || a->left_recursive[i]) continue;
+   tokens->nbelems=0;
+   int ok=1;
+   for (int j=0;ok && j<a->n_first_tags[i];j++) {
+      Fst2Tag tag=fst2->tags[a->first_tags[i][j]];
+      switch (tag->type) {
+         case BEGIN_VAR_TAG: case END_VAR_TAG:
+         case BEGIN_OUTPUT_VAR_TAG: case END_OUTPUT_VAR_TAG: break;
+         case META_TAG: ok=(tag->meta==META_EPSILON); break;
+         case TOKEN_LIST_TAG: {
+            if (tag->compound_pattern!=NO_COMPOUND_PATTERN
+                || is_bit_mask_set(tag->control,NEGATION_TAG_BIT_MASK)) {
+               ok=0;
+               break;
+            }
+            for (struct list_int* l=tag->matching_tokens;l!=NULL;l=l->next) {
+               vector_int_add(tokens,l->n);
+            }
+            break;
+         }
+         default: ok=0; break;
+      }
+   }
+   if (!ok) continue;
+   qsort(tokens->tab,tokens->nbelems,sizeof(int),compare_ints);
+   int size=0;
+   for (int j=0;j<tokens->nbelems;j++) {
+      if (size==0 || tokens->tab[j]!=tokens->tab[size-1]) {
+         tokens->tab[size++]=tokens->tab[j];
+      }
+   }
+   p->graph_first_tokens[i]=(int*)malloc(sizeof(int)*(size>0?size:1));
+   if (p->graph_first_tokens[i]==NULL) {
+      fatal_alloc_error("compute_graph_first_tokens");
+   }
+   memcpy(p->graph_first_tokens[i],tokens->tab,sizeof(int)*size);
+   p->n_graph_first_tokens[i]=size;
+}
+free_vector_int(tokens);
+}
+
+
+static void free_graph_first_tokens(struct locate_parameters* p) {
+if (p->graph_first_tokens==NULL) return;
+for (int i=0;i<=p->fst2->number_of_graphs;i++) {
+   free(p->graph_first_tokens[i]);
+}
+free(p->graph_first_tokens);
+free(p->n_graph_first_tokens);
+p->graph_first_tokens=NULL;
+p->n_graph_first_tokens=NULL;
+}
+
+
+static void release_locate_fst2(void* fst2) {
+free_Fst2((Fst2*)fst2);
+}
+
 
 int locate_pattern(const char* text_cod,const char* tokens,const char* fst2_name,const char* dlf,const char* dlc,const char* err,
                    const char* alphabet,MatchPolicy match_policy,OutputPolicy output_policy,
@@ -183,9 +310,9 @@ int locate_pattern(const char* text_cod,const char* tokens,const char* fst2_name
 U_FILE* out;
 U_FILE* info;
 struct locate_parameters* p=new_locate_parameters();
-p->text_cod=af_open_mapfile(text_cod,MAPFILE_OPTION_READ,0);
-p->buffer=(int*)af_get_mapfile_pointer(p->text_cod);
-long text_size=(long)af_get_mapfile_size(p->text_cod)/sizeof(int);
+p->text_cod=map_pipeline_file(text_cod);
+p->buffer=(p->text_cod!=NULL)?(const int*)p->text_cod->buffer:NULL;
+long text_size=(p->text_cod!=NULL)?(long)(p->text_cod->size/sizeof(int)):0;
 p->buffer_size=(int)text_size;
 p->tilde_negation_operator=tilde_negation_operator;
 p->useLocateCache=useLocateCache;
@@ -225,8 +352,7 @@ if (arabic_rules!=NULL && arabic_rules[0]!='\0') {
 out=u_fopen_versatile_encoding(encoding_output,bom_output,mask_encoding_compatibility_input,concord,U_WRITE);
 if (out==NULL) {
    error("Cannot write %s\n",concord);
-   af_release_mapfile_pointer(p->text_cod,p->buffer);
-   af_close_mapfile(p->text_cod);
+   unmap_pipeline_file(p->text_cod);
    free_stack_unichar(p->stack);
    free_locate_parameters(p);
    u_fclose(out);
@@ -246,8 +372,7 @@ if (alphabet!=NULL && alphabet[0]!='\0') {
    p->alphabet=load_alphabet(alphabet,is_korean);
    if (p->alphabet==NULL) {
       error("Cannot load alphabet file %s\n",alphabet);
-      af_release_mapfile_pointer(p->text_cod,p->buffer);
-      af_close_mapfile(p->text_cod);
+      unmap_pipeline_file(p->text_cod);
       free_stack_unichar(p->stack);
       free_locate_parameters(p);
       if (info!=NULL) u_fclose(info);
@@ -263,8 +388,7 @@ if (is_cancelling_requested() != 0) {
 	   error("user cancel request.\n");
 	   free_alphabet(p->alphabet);
 	   free_string_hash(semantic_codes);
-       af_release_mapfile_pointer(p->text_cod,p->buffer);
-       af_close_mapfile(p->text_cod);
+       unmap_pipeline_file(p->text_cod);
        free_stack_unichar(p->stack);
        free_locate_parameters(p);
        if (info!=NULL) u_fclose(info);
@@ -274,13 +398,20 @@ if (is_cancelling_requested() != 0) {
 
 u_printf("Loading fst2...\n");
 struct FST2_free_info fst2load_free;
-Fst2* fst2load=load_abstract_fst2(fst2_name,1,&fst2load_free);
+/* The loaded grammar is only cloned, so that it can be shared by all the
+ * Locate of a pipeline that apply it */
+Fst2* fst2load=(Fst2*)get_pipeline_resource(fst2_name,PIPELINE_FST2);
+if (fst2load==NULL) {
+   fst2load=load_abstract_fst2(fst2_name,1,&fst2load_free);
+   if (fst2load!=NULL && fst2load_free.must_be_free && fst2load_free.func_free_fst2==NULL) {
+      keep_pipeline_resource(fst2_name,PIPELINE_FST2,fst2load,release_locate_fst2);
+   }
+}
 if (fst2load==NULL) {
    error("Cannot load grammar %s\n",fst2_name);
    free_alphabet(p->alphabet);
    free_string_hash(semantic_codes);
-   af_release_mapfile_pointer(p->text_cod,p->buffer);
-   af_close_mapfile(p->text_cod);
+   unmap_pipeline_file(p->text_cod);
    free_stack_unichar(p->stack);
    free_locate_parameters(p);
    if (info!=NULL) u_fclose(info);
@@ -292,7 +423,9 @@ Abstract_allocator locate_abstract_allocator=create_abstract_allocator("locate_p
 
 
 p->fst2=new_Fst2_clone(fst2load,locate_abstract_allocator);
-free_abstract_Fst2(fst2load,&fst2load_free);
+if (!unuse_pipeline_resource(fst2load)) {
+   free_abstract_Fst2(fst2load,&fst2load_free);
+}
 
 if (is_cancelling_requested() != 0) {
    error("User cancel request..\n");
@@ -300,8 +433,7 @@ if (is_cancelling_requested() != 0) {
    free_string_hash(semantic_codes);
    free_Fst2(p->fst2,locate_abstract_allocator);
    close_abstract_allocator(locate_abstract_allocator);
-   af_release_mapfile_pointer(p->text_cod,p->buffer);
-   af_close_mapfile(p->text_cod);
+   unmap_pipeline_file(p->text_cod);
    free_stack_unichar(p->stack);
    free_locate_parameters(p);
    if (info!=NULL) u_fclose(info);
@@ -319,9 +451,8 @@ if (p->filters==NULL) {
    free_Fst2(p->fst2,locate_abstract_allocator);
    close_abstract_allocator(locate_abstract_allocator);
    free_stack_unichar(p->stack);
+   unmap_pipeline_file(p->text_cod);
    free_locate_parameters(p);
-   af_release_mapfile_pointer(p->text_cod,p->buffer);
-   af_close_mapfile(p->text_cod);
    if (info!=NULL) u_fclose(info);
    u_fclose(out);
    return 0;
@@ -337,9 +468,8 @@ if (p->tokens==NULL) {
    free_string_hash(semantic_codes);
    free_Fst2(p->fst2,locate_abstract_allocator);
    close_abstract_allocator(locate_abstract_allocator);
+   unmap_pipeline_file(p->text_cod);
    free_locate_parameters(p);
-   af_release_mapfile_pointer(p->text_cod,p->buffer);
-   af_close_mapfile(p->text_cod);
    if (info!=NULL) u_fclose(info);
    u_fclose(out);
    return 0;
@@ -360,9 +490,8 @@ if (p->filter_match_index==NULL) {
    free_string_hash(semantic_codes);
    free_string_hash(p->tokens);
    close_abstract_allocator(locate_abstract_allocator);
+   unmap_pipeline_file(p->text_cod);
    free_locate_parameters(p);
-   af_release_mapfile_pointer(p->text_cod,p->buffer);
-   af_close_mapfile(p->text_cod);
    if (info!=NULL) u_fclose(info);
    u_fclose(out);
    return 0;
@@ -419,13 +548,25 @@ locate_recycle_abstract_allocator=create_abstract_allocator("locate_pattern_recy
 
 u_printf("Optimizing fst2...\n");
 p->optimized_states=build_optimized_fst2_states(p->input_variables,p->output_variables,p->fst2,locate_abstract_allocator);
+/* The analysis of the graph calls is taken from the .fst2a if Fst2Check
+ * has saved it, and computed otherwise */
+struct fst2_analysis* fst2_analysis=load_fst2_analysis(fst2_name,p->fst2);
+if (fst2_analysis==NULL) {
+   fst2_analysis=analyse_fst2(p->fst2);
+}
+compute_graph_first_tokens(p,fst2_analysis);
+free_fst2_analysis(fst2_analysis);
 if (is_korean) {
 	p->korean=new Korean(p->alphabet);
 	p->jamo_tags=create_jamo_tags(p->korean,p->tokens);
+	p->jamo_fst2_tags=create_jamo_fst2_tags(p->korean,p->fst2);
 }
 p->failfast=new_bit_array(n_text_tokens,ONE_BIT);
 
 u_printf("Working...\n");
+if (IsPipelineActive()) {
+   p->saved_matches=new_saved_matches(output_policy);
+}
 p->prv_alloc=locate_work_abstract_allocator;
 p->prv_alloc_recycle=locate_recycle_abstract_allocator;
 launch_locate(out,text_size,info,p);
@@ -433,12 +574,19 @@ if (allow_trace!=0) {
    close_locate_trace(p,p->fnc_locate_trace_step,p->private_param_locate_trace);
 }
 free_bit_array(p->failfast);
+free_graph_first_tokens(p);
 free_Variables(p->input_variables);
 free_OutputVariables(p->output_variables);
-af_release_mapfile_pointer(p->text_cod,p->buffer);
-af_close_mapfile(p->text_cod);
+unmap_pipeline_file(p->text_cod);
 if (info!=NULL) u_fclose(info);
 u_fclose(out);
+if (p->saved_matches!=NULL) {
+   /* The next tools of the pipeline will take the matches from memory */
+   if (!share_pipeline_resource(concord,PIPELINE_MATCHES,p->saved_matches,free_saved_matches)) {
+      free_saved_matches(p->saved_matches);
+   }
+   p->saved_matches=NULL;
+}
 
 if (p->match_cache!=NULL) {
 	for (int i=0;i<p->tokens->size;i++) {
@@ -455,6 +603,12 @@ free_stack_unichar(p->stack);
 /** Too long to free the DLC tree if it is big
  * free_DLC_tree(p->DLC_tree);
  */
+if (p->jamo_fst2_tags!=NULL) {
+	for (int i=0;i<p->fst2->number_of_tags;i++) {
+		free(p->jamo_fst2_tags[i]);
+	}
+	free(p->jamo_fst2_tags);
+}
 if (free_abstract_allocator_item) {
   free_pattern_node(p->pattern_tree_root,locate_abstract_allocator);
   free_Fst2(p->fst2,locate_abstract_allocator);
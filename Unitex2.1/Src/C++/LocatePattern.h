@@ -47,6 +47,7 @@
 #include "Vector.h"
 #include "MappedFileHelper.h"
 #include "Arabic.h"
+#include "Pipeline.h"
 
 struct counting_step_st
 {
@@ -198,8 +199,8 @@ struct locate_parameters {
    int buffer_size;
    const int* buffer;
 
-   /* A system-dependent object that represents the mapped' text.cod' file */
-   ABSTRACTMAPFILE* text_cod;
+   /* The mapped 'text.cod' file, which may be shared by the tools of a pipeline */
+   struct pipeline_mapped_file* text_cod;
 
 
    /* Indicates if we work char by char or not */
@@ -226,6 +227,10 @@ struct locate_parameters {
    /* The match list associated to the current Locate operation */
    struct match_list* match_list;
 
+   /* In a pipeline, a copy of the matches written in concord.ind, so that
+    * the next tools do not have to parse the file again */
+   struct saved_matches* saved_matches;
+
 
    /* The total number of outputs. It may be different from the number
     * of matches if ambiguous outputs are allowed. */
@@ -283,6 +288,9 @@ struct locate_parameters {
    /* This is useful for Korean */
    Korean* korean;
    unichar** jamo_tags;
+   /* jamo versions of the fst2 token tags, indexed by tag number, so that
+    * morphological mode does not convert them at each matching attempt */
+   unichar** jamo_fst2_tags;
 
    /* a recyclable buffer to be given to string_match_filter function.
     *   To avoid stack or heap allocation at each call */
@@ -299,6 +307,11 @@ struct locate_parameters {
    int last_matched_position;
    /* This structure is used to mark tokens that cannot start any match */
    struct bit_array* failfast;
+   /* graph_first_tokens[i] is the sorted array of the tokens that can start
+    * a match of the graph #i, and n_graph_first_tokens[i] is its size, or -1 if
+    * the graph must always be tried (see compute_graph_first_tokens) */
+   int** graph_first_tokens;
+   int* n_graph_first_tokens;
    /* Those two fields are used to store matches while exploring from a given
     * position. Once the exploration is complete, we deal with the matches,
     * caching them if possible. We need two pointers because we have to insert
@@ -74,6 +74,9 @@ const char* usage_LocateTfst =
          "  -Y/--ignore_variable_errors: acts as if the variable has an empty content (default)\n"
          "  -Z/--backtrack_on_variable_errors: stop exploring the current path of the grammar\n"
          "\n"
+         "  --threads=N: looks for matches in N sentences at the same time (default=1).\n"
+         "               If N is 0, one thread is used per processor\n"
+         "\n"
          "  -h/--help: this help\n"
          "\n"
          "Applies a grammar to a text automaton, and saves the matching sequence index in a\n"
@@ -108,6 +111,7 @@ const struct option_TS lopts_LocateTfst[]= {
      {"output_encoding",required_argument_TS,NULL,'q'},
      {"help",no_argument_TS,NULL,'h'},
      {"negation_operator",required_argument_TS,NULL,'g'},
+     {"threads",required_argument_TS,NULL,1},
      {NULL,no_argument_TS,NULL,0}
 };
 
@@ -137,6 +141,7 @@ OutputPolicy output_policy=IGNORE_OUTPUTS;
 AmbiguousOutputPolicy ambiguous_output_policy=ALLOW_AMBIGUOUS_OUTPUTS;
 VariableErrorPolicy variable_error_policy=IGNORE_VARIABLE_ERRORS;
 int search_limit=NO_MATCH_LIMIT;
+int n_threads=1;
 struct OptVars* vars=new_OptVars();
 char foo;
 while (EOF!=(val=getopt_long_TS(argc,argv,optstring_LocateTfst,lopts_LocateTfst,&index,vars))) {
@@ -173,6 +178,10 @@ while (EOF!=(val=getopt_long_TS(argc,argv,optstring_LocateTfst,lopts_LocateTfst,
                 fatal_error("Invalid search limit argument: %s\n",vars->optarg);
              }
              break;
+   case 1: if (1!=sscanf(vars->optarg,"%d%c",&n_threads,&foo) || n_threads<0) {
+                fatal_error("Invalid number of threads: %s\n",vars->optarg);
+             }
+             break;
    case 'S': match_policy=SHORTEST_MATCHES; break;
    case 'L': match_policy=LONGEST_MATCHES; break;
    case 'A': match_policy=ALL_MATCHES; break;
@@ -218,7 +227,7 @@ strcat(output,"concord.ind");
 int OK=locate_tfst(text,grammar,alphabet,output,
                    encoding_output,bom_output,
                    match_policy,output_policy,
-                   ambiguous_output_policy,variable_error_policy,search_limit,is_korean,tilde_negation_operator);
+                   ambiguous_output_policy,variable_error_policy,search_limit,is_korean,tilde_negation_operator,n_threads);
 
 free_OptVars(vars);
 return (!OK);
@@ -19,6 +19,7 @@
  *
  */
 
+#include <string.h>
 #include "UnusedParameter.h"
 #include "Fst2.h"
 #include "AbstractFst2Load.h"
@@ -29,13 +30,8 @@
 #include "Korean.h"
 #include "Contexts.h"
 #include "List_int.h"
-
-
-/* see http://en.wikipedia.org/wiki/Variable_Length_Array . MSVC did not support it 
-   see http://msdn.microsoft.com/en-us/library/zb1574zs(VS.80).aspx */
-#if defined(_MSC_VER) && (!(defined(NO_C99_VARIABLE_LENGTH_ARRAY)))
-#define NO_C99_VARIABLE_LENGTH_ARRAY 1
-#endif
+#include "AbstractCallbackFuncModifier.h"
+#include "logger/SyncLogger.h"
 
 
 /* During a locate operation starting on a given tfst state, we consider that
@@ -43,8 +39,44 @@
  * a combinatorial explosion */
 #define MAX_VISITS_PER_TFST_STATE 128
 
+/* When several threads are used, sentences are processed by batches of
+ * LOCATE_TFST_SENTENCES_PER_THREAD sentences per thread, so that the matches
+ * can be saved in sentence order between two batches */
+#define LOCATE_TFST_SENTENCES_PER_THREAD 64
+
+
+/**
+ * count[i] is the number of visits of the tfst state #i since the exploration
+ * started from the current start state. Instead of clearing 'count' for each
+ * start state, we give a new value to 'current_epoch', and count[i] is only
+ * meaningful if epoch[i]==current_epoch.
+ */
+struct tfst_visits {
+   int* count;
+   int* epoch;
+   int current_epoch;
+};
+
 
-void explore_tfst(int* visits,Tfst* tfst,int current_state_in_tfst,
+/**
+ * This structure describes the work of one thread: it processes the sentences
+ * first, first+step, first+2*step, ... <=last with its own copy of the
+ * locate information, and stores the matches of sentence i in
+ * results[i-batch_first]. The fst2, the alphabet, the filters and the
+ * contexts are shared with the other threads, since they are only read.
+ */
+struct locate_tfst_job {
+   struct locate_tfst_infos infos;
+   int tilde_negation_operator;
+   int first;
+   int last;
+   int step;
+   int batch_first;
+   struct tfst_simple_match_list** results;
+};
+
+
+void explore_tfst(struct tfst_visits* visits,Tfst* tfst,int current_state_in_tfst,
 		          int current_state_in_fst2,int graph_depth,
 		          struct tfst_match* match_element_list,
                 struct tfst_match_list** LIST,
@@ -55,6 +87,12 @@ void explore_tfst(int* visits,Tfst* tfst,int current_state_in_tfst,
                 Transition* current_pending_tfst_transition,
                 struct list_int* ctx, int tilde_negation_operator);
 void init_Korean_stuffs(struct locate_tfst_infos* infos,int is_korean);
+static void compute_initial_grammar_tags(struct locate_tfst_infos* infos);
+static int may_start_a_match(struct locate_tfst_infos* infos,int tfst_state,char* tag_status,
+                             int tilde_negation_operator);
+static void init_compiled_grammar_tags(struct locate_tfst_infos* infos);
+static void compile_grammar_tag(struct locate_tfst_infos* infos,int fst2_tag_index,int tilde_negation_operator);
+static void free_compiled_grammar_tags(struct locate_tfst_infos* infos);
 void free_Korean_stuffs(struct locate_tfst_infos* infos);
 void compute_jamo_tfst_tags(struct locate_tfst_infos* infos);
 int match_between_text_and_grammar_tags(Tfst* tfst,TfstTag* text_tag,Fst2Tag grammar_tag,
@@ -68,17 +106,23 @@ int real_match_between_text_and_grammar_tags(Tfst* tfst,TfstTag* text_tag,Fst2Ta
 struct pattern* tokenize_grammar_tag(unichar* tag,int *negation,int tilde_negation_operator);
 int is_space_on_the_left_in_tfst(Tfst* tfst,TfstTag* tag);
 int morphological_filter_is_ok(const unichar* content,Fst2Tag grammar_tag,const struct locate_tfst_infos* infos);
+static void locate_tfst_in_sentence(struct locate_tfst_infos* infos,int n,int tilde_negation_operator);
+static void locate_tfst_with_threads(struct locate_tfst_infos* infos,char* text,int is_korean,
+                                     int tilde_negation_operator,int n_threads);
 
 
 /**
  * This function applies the given grammar to the given text automaton.
+ * Sentences are processed on n_threads threads (one per processor if
+ * n_threads<=0), which gives the same concord.ind as a single thread.
  * It returns 1 in case of success; 0 otherwise.
  */
 int locate_tfst(char* text,char* grammar,char* alphabet,char* output,
                 Encoding encoding_output,int bom_output,
                 MatchPolicy match_policy,
 		          OutputPolicy output_policy,AmbiguousOutputPolicy ambiguous_output_policy,
-		          VariableErrorPolicy variable_error_policy,int search_limit,int is_korean,int tilde_negation_operator) {
+		          VariableErrorPolicy variable_error_policy,int search_limit,int is_korean,int tilde_negation_operator,
+		          int n_threads) {
 Tfst* tfst=open_text_automaton(text);
 if (tfst==NULL) {
 	return 0;
@@ -147,37 +191,28 @@ infos.end_position_last_printed_match_letter=-1;
 
 infos.search_limit=search_limit;
 init_Korean_stuffs(&infos,is_korean);
+init_compiled_grammar_tags(&infos);
+compute_initial_grammar_tags(&infos);
 infos.cache=new_LocateTfstTagMatchingCache(tfst->N,infos.fst2->number_of_tags);
 infos.contexts=compute_contexts(infos.fst2);
-/* We launch the matching for each sentence */
-for (int i=1;i<=tfst->N && infos.number_of_matches!=infos.search_limit;i++) {
-   if (i%100==0) {
-		u_printf("\rSentence %d/%d...",i,tfst->N);
-	}
-   load_sentence(tfst,i);
-	compute_token_contents(tfst);
-	if (infos.korean!=NULL) {
-	   compute_jamo_tfst_tags(&infos);
-	}
-	infos.matches=NULL;
-	prepare_cache_for_new_sentence(infos.cache,tfst->tags->nbelems);
-#ifdef NO_C99_VARIABLE_LENGTH_ARRAY
-	int* visits=(int*)malloc(sizeof(int)*(1+tfst->automaton->number_of_states));
-#else
-	int visits[tfst->automaton->number_of_states];
-#endif
-	/* Within a sentence graph, we try to match from any state */
-	for (int j=0;j<tfst->automaton->number_of_states;j++) {
-	   for (int k=0;k<tfst->automaton->number_of_states;k++) {
-	      visits[k]=0;
-	   }
-	   explore_tfst(visits,tfst,j,infos.fst2->initial_states[1],0,NULL,NULL,&infos,-1,-1,NULL,NULL,NULL,tilde_negation_operator);
-	}
-#ifdef NO_C99_VARIABLE_LENGTH_ARRAY
-	free(visits);
-#endif
-	save_tfst_matches(&infos);
-	clear_dic_variable_list(&(infos.dic_variables));
+if (n_threads<=0) {
+   n_threads=(int)SyncGetNumberOfProcessors();
+}
+if (n_threads>tfst->N) {
+   n_threads=tfst->N;
+}
+if (n_threads>1 && IsSeveralThreadsPossible()) {
+   locate_tfst_with_threads(&infos,text,is_korean,tilde_negation_operator,n_threads);
+} else {
+   /* We launch the matching for each sentence */
+   for (int i=1;i<=tfst->N && infos.number_of_matches!=infos.search_limit;i++) {
+      if (i%100==0) {
+         u_printf("\rSentence %d/%d...",i,tfst->N);
+      }
+      locate_tfst_in_sentence(&infos,i,tilde_negation_operator);
+      save_tfst_matches(&infos);
+      clear_dic_variable_list(&(infos.dic_variables));
+   }
 }
 u_printf("\rDone.                                    \n");
 /* We save some infos */
@@ -213,6 +248,10 @@ free_alphabet(infos.alphabet);
 free_Variables(infos.input_variables);
 free_OutputVariables(infos.output_variables);
 free_Korean_stuffs(&infos);
+free_compiled_grammar_tags(&infos);
+if (infos.initial_fst2_tags!=NULL) {
+   free_vector_int(infos.initial_fst2_tags);
+}
 free_LocateTfstTagMatchingCache(infos.cache);
 for (int i=0;i<infos.fst2->number_of_states;i++) {
    free_opt_contexts(infos.contexts[i]);
@@ -224,6 +263,405 @@ return 1;
 }
 
 
+/**
+ * Loads the given sentence and looks for the matches that it contains. The
+ * matches are left in infos->matches.
+ */
+static void locate_tfst_in_sentence(struct locate_tfst_infos* infos,int n,int tilde_negation_operator) {
+Tfst* tfst=infos->tfst;
+load_sentence(tfst,n);
+compute_token_contents(tfst);
+if (infos->korean!=NULL) {
+   compute_jamo_tfst_tags(infos);
+}
+infos->matches=NULL;
+prepare_cache_for_new_sentence(infos->cache,tfst->tags->nbelems);
+int n_states=tfst->automaton->number_of_states;
+struct tfst_visits visits;
+visits.count=(int*)malloc(sizeof(int)*(1+n_states));
+visits.epoch=(int*)calloc(1+n_states,sizeof(int));
+/* tag_status[i] tells if the tfst tag #i can be matched by a grammar initial tag:
+ * -1=not known yet, 0=no, 1=yes */
+char* tag_status=(char*)malloc(sizeof(char)*(1+tfst->tags->nbelems));
+if (visits.count==NULL || visits.epoch==NULL || tag_status==NULL) {
+   fatal_alloc_error("locate_tfst_in_sentence");
+}
+memset(tag_status,-1,sizeof(char)*(1+tfst->tags->nbelems));
+/* Within a sentence graph, we try to match from any state */
+for (int j=0;j<n_states;j++) {
+   if (!may_start_a_match(infos,j,tag_status,tilde_negation_operator)) {
+      continue;
+   }
+   visits.current_epoch=j+1;
+   explore_tfst(&visits,tfst,j,infos->fst2->initial_states[1],0,NULL,NULL,infos,-1,-1,NULL,NULL,NULL,tilde_negation_operator);
+}
+free(visits.count);
+free(visits.epoch);
+free(tag_status);
+}
+
+
+/**
+ * Processes the sentences of the given job.
+ */
+static void SYNC_CALLBACK_UNITEX locate_tfst_job_func(void* privateDataPtr,unsigned int /*iNbThread*/) {
+struct locate_tfst_job* job=(struct locate_tfst_job*)privateDataPtr;
+for (int i=job->first;i<=job->last;i=i+job->step) {
+   locate_tfst_in_sentence(&(job->infos),i,job->tilde_negation_operator);
+   /* The matches are saved later by the main thread, so we release here the
+    * partial matches they point to, as free_tfst_simple_match_list would do */
+   for (struct tfst_simple_match_list* l=job->infos.matches;l!=NULL;l=l->next) {
+      if (l->match!=NULL) {
+         (l->match->pointed_by)--;
+         l->match=NULL;
+      }
+   }
+   job->results[i-job->batch_first]=job->infos.matches;
+   job->infos.matches=NULL;
+   clear_dic_variable_list(&(job->infos.dic_variables));
+}
+}
+
+
+/**
+ * Looks for matches in all the sentences on n_threads threads. Each thread has its
+ * own text automaton, variables, tag matching cache and Korean buffers. The matches
+ * are saved by batches in sentence order, so that the number of matches and the
+ * search limit are handled exactly as with a single thread.
+ */
+static void locate_tfst_with_threads(struct locate_tfst_infos* infos,char* text,int is_korean,
+                                     int tilde_negation_operator,int n_threads) {
+int N=infos->tfst->N;
+int batch_size=n_threads*LOCATE_TFST_SENTENCES_PER_THREAD;
+struct locate_tfst_job* jobs=(struct locate_tfst_job*)malloc(n_threads*sizeof(struct locate_tfst_job));
+void** job_ptrs=(void**)malloc(n_threads*sizeof(void*));
+struct tfst_simple_match_list** results=(struct tfst_simple_match_list**)malloc(batch_size*sizeof(struct tfst_simple_match_list*));
+if (jobs==NULL || job_ptrs==NULL || results==NULL) {
+   fatal_alloc_error("locate_tfst_with_threads");
+}
+for (int t=0;t<n_threads;t++) {
+   struct locate_tfst_job* job=&(jobs[t]);
+   job->infos=*infos;
+   job->infos.tfst=open_text_automaton(text);
+   if (job->infos.tfst==NULL) {
+      fatal_error("Cannot open %s\n",text);
+   }
+   job->infos.output=NULL;
+   job->infos.matches=NULL;
+   job->infos.input_variables=new_Variables(infos->fst2->input_variables);
+   job->infos.output_variables=new_OutputVariables(infos->fst2->output_variables,NULL);
+   job->infos.dic_variables=NULL;
+   init_Korean_stuffs(&(job->infos),is_korean);
+   job->infos.cache=new_LocateTfstTagMatchingCache(N,infos->fst2->number_of_tags);
+   job->tilde_negation_operator=tilde_negation_operator;
+   job->step=n_threads;
+   job->results=results;
+   job_ptrs[t]=job;
+}
+for (int first=1;first<=N && infos->number_of_matches!=infos->search_limit;first=first+batch_size) {
+   int last=first+batch_size-1;
+   if (last>N) {
+      last=N;
+   }
+   for (int t=0;t<n_threads;t++) {
+      jobs[t].first=first+t;
+      jobs[t].last=last;
+      jobs[t].batch_first=first;
+   }
+   SyncDoRunThreads(n_threads,locate_tfst_job_func,job_ptrs);
+   for (int i=first;i<=last;i++) {
+      if (i%100==0) {
+         u_printf("\rSentence %d/%d...",i,N);
+      }
+      /* Once the search limit is reached, save_tfst_matches frees the matches */
+      infos->matches=results[i-first];
+      save_tfst_matches(infos);
+   }
+}
+for (int t=0;t<n_threads;t++) {
+   struct locate_tfst_job* job=&(jobs[t]);
+   close_text_automaton(job->infos.tfst);
+   free_Variables(job->infos.input_variables);
+   free_OutputVariables(job->infos.output_variables);
+   free_Korean_stuffs(&(job->infos));
+   free_LocateTfstTagMatchingCache(job->infos.cache);
+}
+free(results);
+free(job_ptrs);
+free(jobs);
+}
+
+
+/**
+ * Returns 1 if the given grammar tag is matched without consuming any text
+ * in 'match_between_text_and_grammar_tags'.
+ */
+static int is_text_independent_grammar_tag(Fst2Tag tag) {
+return tag->type==BEGIN_VAR_TAG || tag->type==END_VAR_TAG
+       || tag->type==BEGIN_OUTPUT_VAR_TAG || tag->type==END_OUTPUT_VAR_TAG
+       || tag->type==LEFT_CONTEXT_TAG || !u_strcmp(tag->input,"<E>");
+}
+
+
+/**
+ * Returns 1 if the grammar tag is a " " or a # tag. Such tags are matched without
+ * consuming any text, but only in some contexts.
+ */
+static int is_space_grammar_tag(Fst2Tag tag) {
+return tag->type==UNDEFINED_TAG && (!u_strcmp(tag->input," ") || !u_strcmp(tag->input,"#"));
+}
+
+
+/**
+ * Returns 1 if the final state of the given graph can be reached without consuming
+ * any text, according to the graphs that are already known to be so. Contexts
+ * are considered as empty, which is harmless since we only want to be sure that
+ * no other graph is empty.
+ */
+static int is_empty_graph(Fst2* fst2,int graph,char* empty_graphs,vector_int* stack,
+                          int* stamps,int stamp) {
+stack->nbelems=0;
+vector_int_add(stack,fst2->initial_states[graph]);
+stamps[fst2->initial_states[graph]]=stamp;
+while (stack->nbelems!=0) {
+   int state=stack->tab[--(stack->nbelems)];
+   if (is_final_state(fst2->states[state])) {
+      return 1;
+   }
+   for (Transition* t=fst2->states[state]->transitions;t!=NULL;t=t->next) {
+      int e=t->tag_number;
+      if ((e<0 && !empty_graphs[-e])
+          || (e>=0 && fst2->tags[e]->type==UNDEFINED_TAG && !is_space_grammar_tag(fst2->tags[e])
+              && u_strcmp(fst2->tags[e]->input,"<E>"))) {
+         /* If the transition must consume some text */
+         continue;
+      }
+      if (stamps[t->state_number]!=stamp) {
+         stamps[t->state_number]=stamp;
+         vector_int_add(stack,t->state_number);
+      }
+   }
+}
+return 0;
+}
+
+
+/**
+ * Computes the set of the grammar tags that can match the first text tag of a
+ * match, so that we can skip the tfst states from which no match can start.
+ * If the grammar can match without consuming text, or if it starts with a
+ * context, infos->initial_fst2_tags is set to NULL and all states are tried.
+ */
+static void compute_initial_grammar_tags(struct locate_tfst_infos* infos) {
+Fst2* fst2=infos->fst2;
+infos->initial_fst2_tags=NULL;
+char* empty_graphs=(char*)calloc(fst2->number_of_graphs+1,sizeof(char));
+int* stamps=(int*)calloc(fst2->number_of_states,sizeof(int));
+char* initial_tags=(char*)calloc(fst2->number_of_tags+1,sizeof(char));
+if (empty_graphs==NULL || stamps==NULL || initial_tags==NULL) {
+   fatal_alloc_error("compute_initial_grammar_tags");
+}
+vector_int* stack=new_vector_int();
+/* We look for the graphs that can be empty, until there is no more */
+int stamp=0;
+int modified;
+do {
+   modified=0;
+   for (int i=1;i<=fst2->number_of_graphs;i++) {
+      if (!empty_graphs[i] && is_empty_graph(fst2,i,empty_graphs,stack,stamps,++stamp)) {
+         empty_graphs[i]=1;
+         modified=1;
+      }
+   }
+} while (modified);
+/* Then, we explore the main graph from its initial state without consuming any text.
+ * The stack contains pairs (state, 1 if in main graph). Since the main graph
+ * may also be called as a subgraph, a state may be visited twice: visited[i]
+ * is a combination of 1 (visited in the main graph) and 2 (visited in a subgraph) */
+char* visited=(char*)calloc(fst2->number_of_states,sizeof(char));
+if (visited==NULL) {
+   fatal_alloc_error("compute_initial_grammar_tags");
+}
+infos->initial_fst2_tags=new_vector_int();
+stack->nbelems=0;
+vector_int_add(stack,fst2->initial_states[1]);
+vector_int_add(stack,1);
+visited[fst2->initial_states[1]]=1;
+while (stack->nbelems!=0) {
+   int main_graph=stack->tab[--(stack->nbelems)];
+   int state=stack->tab[--(stack->nbelems)];
+   if (main_graph && is_final_state(fst2->states[state])) {
+      /* A match could be empty */
+      free_vector_int(infos->initial_fst2_tags);
+      infos->initial_fst2_tags=NULL;
+      break;
+   }
+   int stop=0;
+   for (Transition* t=fst2->states[state]->transitions;t!=NULL && !stop;t=t->next) {
+      int e=t->tag_number;
+      int next[2]={-1,-1};
+      if (e<0) {
+         /* We look at the beginning of the subgraph, and after the call if it can be empty */
+         next[0]=fst2->initial_states[-e];
+         if (empty_graphs[-e]) {
+            next[1]=t->state_number;
+         }
+      } else if (fst2->tags[e]->type!=UNDEFINED_TAG && !is_text_independent_grammar_tag(fst2->tags[e])) {
+         /* Contexts are not handled */
+         stop=1;
+         continue;
+      } else if (is_text_independent_grammar_tag(fst2->tags[e])) {
+         next[1]=t->state_number;
+      } else {
+         initial_tags[e]=1;
+         if (is_space_grammar_tag(fst2->tags[e])) {
+            next[1]=t->state_number;
+         }
+      }
+      /* next[0] is in a subgraph, next[1] is in the same graph as 'state' */
+      for (int k=0;k<2;k++) {
+         if (next[k]==-1) continue;
+         int in_main_graph=(k==0)?0:main_graph;
+         char mask=in_main_graph?1:2;
+         if (visited[next[k]] & mask) continue;
+         visited[next[k]]=(char)(visited[next[k]] | mask);
+         vector_int_add(stack,next[k]);
+         vector_int_add(stack,in_main_graph);
+      }
+   }
+   if (stop) {
+      free_vector_int(infos->initial_fst2_tags);
+      infos->initial_fst2_tags=NULL;
+      break;
+   }
+}
+if (infos->initial_fst2_tags!=NULL) {
+   for (int i=0;i<fst2->number_of_tags;i++) {
+      if (initial_tags[i]) {
+         vector_int_add(infos->initial_fst2_tags,i);
+      }
+   }
+}
+free_vector_int(stack);
+free(visited);
+free(initial_tags);
+free(stamps);
+free(empty_graphs);
+}
+
+
+/**
+ * Returns 0 if we are sure that no match can start from the given tfst state,
+ * because none of its outgoing tags can be matched by a grammar initial tag.
+ * tag_status is used to remember the tags that have already been tested.
+ */
+static int may_start_a_match(struct locate_tfst_infos* infos,int tfst_state,char* tag_status,
+                             int tilde_negation_operator) {
+if (infos->initial_fst2_tags==NULL) {
+   return 1;
+}
+Tfst* tfst=infos->tfst;
+for (Transition* t=tfst->automaton->states[tfst_state]->outgoing_transitions;t!=NULL;t=t->next) {
+   int tag=t->tag_number;
+   if (tag_status[tag]==-1) {
+      tag_status[tag]=0;
+      for (int i=0;i<infos->initial_fst2_tags->nbelems;i++) {
+         int fst2_tag=infos->initial_fst2_tags->tab[i];
+         int pos_pending_fst2=-1;
+         int pos_pending_tfst=-1;
+         if (NO_MATCH_STATUS!=match_between_text_and_grammar_tags(tfst,(TfstTag*)(tfst->tags->tab[tag]),
+                                          infos->fst2->tags[fst2_tag],tag,fst2_tag,infos,
+                                          &pos_pending_fst2,&pos_pending_tfst,tilde_negation_operator)) {
+            tag_status[tag]=1;
+            break;
+         }
+      }
+   }
+   if (tag_status[tag]==1) {
+      return 1;
+   }
+}
+return 0;
+}
+
+
+/* Tags like <MOT> that are handled in 'real_match_between_text_and_grammar_tags'
+ * without any pattern */
+static const char* meta_grammar_tags[]={"<MOT>","<!MOT>","<MIN>","<!MIN>","<MAJ>","<!MAJ>",
+                                        "<PRE>","<!PRE>","<TOKEN>","<DIC>","<TDIC>","<!DIC>",
+                                        "<SDIC>","<CDIC>","<NB>",NULL};
+
+
+/**
+ * Prepares the arrays where the grammar tags like <be.V> and {tutu,toto.XXX}
+ * are kept once tokenized, so that they are not tokenized again each time they
+ * are compared to a text tag. The tags are tokenized by 'compile_grammar_tag'
+ * the first time they are used, so that a malformed tag that is never compared
+ * to a text tag does not stop the program.
+ */
+static void init_compiled_grammar_tags(struct locate_tfst_infos* infos) {
+int n=infos->fst2->number_of_tags;
+infos->fst2_tag_patterns=(struct pattern**)calloc(n,sizeof(struct pattern*));
+infos->fst2_tag_negations=(char*)calloc(n,sizeof(char));
+infos->fst2_tag_entries=(struct dela_entry**)calloc(n,sizeof(struct dela_entry*));
+infos->fst2_tag_compiled=(char*)calloc(n,sizeof(char));
+if (n>0 && (infos->fst2_tag_patterns==NULL || infos->fst2_tag_negations==NULL
+            || infos->fst2_tag_entries==NULL || infos->fst2_tag_compiled==NULL)) {
+   fatal_alloc_error("init_compiled_grammar_tags");
+}
+infos->fst2_tag_mutex=SyncBuildMutex();
+}
+
+
+/**
+ * Tokenizes the grammar tag #fst2_tag_index if it has not been done yet. As the
+ * tokenized tags are shared by all the threads, this is done under a lock.
+ */
+static void compile_grammar_tag(struct locate_tfst_infos* infos,int fst2_tag_index,int tilde_negation_operator) {
+SyncGetMutex(infos->fst2_tag_mutex);
+if (infos->fst2_tag_compiled[fst2_tag_index]) {
+   SyncReleaseMutex(infos->fst2_tag_mutex);
+   return;
+}
+unichar* input=infos->fst2->tags[fst2_tag_index]->input;
+int l=u_strlen(input);
+if (input[0]=='{' && input[1]!='\0' && u_strcmp(input,"{S}")) {
+   infos->fst2_tag_entries[fst2_tag_index]=tokenize_tag_token(input);
+} else if (input[0]=='<' && l>=3 && input[l-1]=='>' && u_strcmp(input,"<E>")) {
+   int meta=0;
+   for (int j=0;meta_grammar_tags[j]!=NULL;j++) {
+      if (!u_strcmp(input,meta_grammar_tags[j])) {
+         meta=1;
+         break;
+      }
+   }
+   if (!meta) {
+      int negation;
+      infos->fst2_tag_patterns[fst2_tag_index]=tokenize_grammar_tag(input,&negation,tilde_negation_operator);
+      infos->fst2_tag_negations[fst2_tag_index]=(char)negation;
+   }
+}
+infos->fst2_tag_compiled[fst2_tag_index]=1;
+SyncReleaseMutex(infos->fst2_tag_mutex);
+}
+
+
+/**
+ * Frees the patterns and the entries built by 'compile_grammar_tag'.
+ */
+static void free_compiled_grammar_tags(struct locate_tfst_infos* infos) {
+for (int i=0;i<infos->fst2->number_of_tags;i++) {
+   free_pattern(infos->fst2_tag_patterns[i]);
+   free_dela_entry(infos->fst2_tag_entries[i]);
+}
+free(infos->fst2_tag_patterns);
+free(infos->fst2_tag_negations);
+free(infos->fst2_tag_entries);
+free(infos->fst2_tag_compiled);
+SyncDeleteMutex(infos->fst2_tag_mutex);
+}
+
+
 /**
  * If we must deal with a Korean .tfst, we compute the jamo version of all fst2 tags.
  */
@@ -357,7 +795,7 @@ for (int i=0;i<infos->n_jamo_tfst_tags;i++) {
 /**
  * Explores in parallel the tfst and the fst2.
  */
-void explore_tfst(int* visits,Tfst* tfst,int current_state_in_tfst,
+void explore_tfst(struct tfst_visits* visits,Tfst* tfst,int current_state_in_tfst,
 		          int current_state_in_fst2,int graph_depth,
 		          struct tfst_match* match_element_list,
                 struct tfst_match_list* *LIST,
@@ -373,12 +811,17 @@ void explore_tfst(int* visits,Tfst* tfst,int current_state_in_tfst,
                 Transition* current_pending_tfst_transition,
                 struct list_int* ctx /* information about the current context, if any */,
                 int tilde_negation_operator) {
-//error("visits for current state=%d  tfst state=%d  fst2 state=%d\n",visits[current_state_in_tfst],current_state_in_tfst,current_state_in_fst2);
-if (visits[current_state_in_tfst]>MAX_VISITS_PER_TFST_STATE) {
+if (visits->epoch[current_state_in_tfst]!=visits->current_epoch) {
+   /* First visit of this state since the exploration started from the current start state */
+   visits->epoch[current_state_in_tfst]=visits->current_epoch;
+   visits->count[current_state_in_tfst]=0;
+}
+//error("visits for current state=%d  tfst state=%d  fst2 state=%d\n",visits->count[current_state_in_tfst],current_state_in_tfst,current_state_in_fst2);
+if (visits->count[current_state_in_tfst]>MAX_VISITS_PER_TFST_STATE) {
    /* If there are too much recursive calls */
    return;
 }
-visits[current_state_in_tfst]++;
+visits->count[current_state_in_tfst]++;
 if (current_pending_fst2_transition!=NULL && current_pending_tfst_transition!=NULL) {
    fatal_error("Internal error in explore_tfst: cannot have two non NULL pending transitions\n");
 }
@@ -835,7 +1278,7 @@ if (/*infos->korean &&*/ (*pos_pending_fst2_tag!=-1 || (grammar_tag->input[0]!='
    } else {
 	   if (text_tag->content[0]=='{' && text_tag->content[1]!='\0') {
 	         /* text={toto,tutu.XXX} */
-		  my_entry=tokenize_tag_token(text_tag->content);
+		  my_entry=get_cached_tfst_tag_entry(infos->cache,tfst_tag_index);
 	   	  if (my_entry==NULL) {
 	   		  fatal_error("NULL text_entry error in match_between_text_and_grammar_tags\n");
 	   	  }
@@ -860,7 +1303,6 @@ if (/*infos->korean &&*/ (*pos_pending_fst2_tag!=-1 || (grammar_tag->input[0]!='
       if (jamo_fst2[k]!=jamo_tfst[j]) {
          /* If a character doesn't match */
          //error("match failed between tfst=%S and fst2=%S\n",jamo_tfst,jamo_fst2);
-    	 if (my_entry!=NULL) free_dela_entry(my_entry);
          return NO_MATCH_STATUS;
       }
       k++;
@@ -870,7 +1312,6 @@ if (/*infos->korean &&*/ (*pos_pending_fst2_tag!=-1 || (grammar_tag->input[0]!='
       /* If we are at both ends of strings, it's a full match */
       (*pos_pending_fst2_tag)=-1;
       //error("XX full match between tfst=%S and fst2=%S\n",jamo_tfst,jamo_fst2);
-      if (my_entry!=NULL) free_dela_entry(my_entry);
       return OK_MATCH_STATUS;
    }
    if (jamo_fst2[k]=='\0') {
@@ -879,17 +1320,17 @@ if (/*infos->korean &&*/ (*pos_pending_fst2_tag!=-1 || (grammar_tag->input[0]!='
       (*pos_pending_fst2_tag)=-1;
       (*pos_pending_tfst_tag)=j;
       //error("ZZ partial match between tfst=%S and fst2=%S\n",jamo_tfst,jamo_fst2);
-      if (my_entry!=NULL) free_dela_entry(my_entry);
       return PARTIAL_MATCH_STATUS;
    }
    /* If we have consumed all the tfst tag, but not all th fst2 one, it's a partial match */
    (*pos_pending_fst2_tag)=k;
    (*pos_pending_tfst_tag)=-1;
    //error("YY partial match #2 between tfst=%S and fst2=%S\n",jamo_tfst,jamo_fst2);
-   if (my_entry!=NULL) free_dela_entry(my_entry);
    return OK_MATCH_STATUS;
 }
 
+/* These entries belong to the compiled grammar tags and to the cache, so
+ * they must not be freed */
 struct dela_entry* grammar_entry=NULL;
 struct dela_entry* text_entry=NULL;
 /**************************************************
@@ -908,7 +1349,7 @@ if (is_letter(grammar_tag->input[0],infos->alphabet)) {
       }
    } else if (text_tag->content[0]=='{' && text_tag->content[1]!='\0') {
       /* text={toto,tutu.XXX} */
-	  text_entry=tokenize_tag_token(text_tag->content);
+	  text_entry=get_cached_tfst_tag_entry(infos->cache,tfst_tag_index);
 	  if (text_entry==NULL) {
 		  fatal_error("NULL text_entry error in match_between_text_and_grammar_tags\n");
 	  }
@@ -938,8 +1379,15 @@ if (grammar_tag->input[0]=='{' && u_strcmp(grammar_tag->input,"{S}")) {
       /* If the text tag is not of the form "{tutu,toto.XXX}" */
       return NO_MATCH_STATUS;
    }
-   grammar_entry=tokenize_tag_token(grammar_tag->input);
-   text_entry=tokenize_tag_token(text_tag->content);
+   if (!infos->fst2_tag_compiled[fst2_tag_index]) {
+      compile_grammar_tag(infos,fst2_tag_index,tilde_negation_operator);
+   }
+   grammar_entry=infos->fst2_tag_entries[fst2_tag_index];
+   text_entry=get_cached_tfst_tag_entry(infos->cache,tfst_tag_index);
+   if (grammar_entry==NULL || text_entry==NULL) {
+      /* If one of the tags is not a valid {tutu,toto.XXX} tag */
+      goto no_match;
+   }
    if (!is_equal_or_uppercase(grammar_entry->inflected,text_entry->inflected,infos->alphabet)) {
       /* We allow case variations on the inflected form :
        * if there is "{tutu,toto.XXX}" in the grammar, we want it
@@ -964,7 +1412,7 @@ if (grammar_tag->input[0]=='{' && u_strcmp(grammar_tag->input,"{S}")) {
 if (grammar_tag->input[0]=='<' && grammar_tag->input[1]!='\0') {
 	/* We tokenize the text tag, if we have one */
 	if (text_tag->content[0]=='{' && text_tag->content[1]!='\0') {
-	   text_entry=tokenize_tag_token(text_tag->content);
+	   text_entry=get_cached_tfst_tag_entry(infos->cache,tfst_tag_index);
 	}
    if (!u_strcmp(grammar_tag->input,"<MOT>")) {
       /* <MOT> matches a sequence of letters or a tag like {tutu,toto.XXX}, even
@@ -1104,11 +1552,19 @@ if (grammar_tag->input[0]=='<' && grammar_tag->input[1]!='\0') {
    if (text_entry==NULL) {
       goto no_match;
    }
-   /* First, we tokenize the grammar pattern tag */
-   int negation;
-   struct pattern* pattern=tokenize_grammar_tag(grammar_tag->input,&negation,tilde_negation_operator);
+   /* The grammar pattern tag is tokenized the first time it is used */
+   if (!infos->fst2_tag_compiled[fst2_tag_index]) {
+      compile_grammar_tag(infos,fst2_tag_index,tilde_negation_operator);
+   }
+   struct pattern* pattern=infos->fst2_tag_patterns[fst2_tag_index];
+   int negation=infos->fst2_tag_negations[fst2_tag_index];
+   if (pattern==NULL) {
+      /* If the tag was not tokenized, tokenize_grammar_tag will tell why */
+      pattern=tokenize_grammar_tag(grammar_tag->input,&negation,tilde_negation_operator);
+      free_pattern(pattern);
+      fatal_error("Unexpected pattern %S in real_match_between_text_and_grammar_tags\n",grammar_tag->input);
+   }
    int ok=is_entry_compatible_with_pattern(text_entry,pattern);
-   free_pattern(pattern);
    if ((ok && !negation) || (!ok && negation)) {
 	   goto ok_match;
    }
@@ -1122,27 +1578,15 @@ if (!u_strcmp(grammar_tag->input,text_tag->content)) {
 }
 return NO_MATCH_STATUS;
 
-/* We arrive here when we have used dela_entry variables */
-int ret_value;
-
+/* We arrive here when the morphological filter, if any, must be tested */
 ok_match:
-/* We test the morphological filter, if any */
 if (!morphological_filter_is_ok((text_entry!=NULL)?text_entry->inflected:text_tag->content,grammar_tag,infos)) {
 	goto no_match;
 }
-ret_value=OK_MATCH_STATUS;
-goto clean;
+return OK_MATCH_STATUS;
 
 no_match:
-ret_value=NO_MATCH_STATUS;
-/* This goto is useless, but there because if one day someone inserts something here...
- * Note that our friend compiler certainly removes it */
-goto clean;
-
-clean:
-free_dela_entry(grammar_entry);
-free_dela_entry(text_entry);
-return ret_value;
+return NO_MATCH_STATUS;
 }
 
 
@@ -1163,9 +1607,12 @@ if (tag[l-1]!='>') {
 }
 if (tag[1]=='!') {(*negation)=1;}
 else {(*negation)=0;}
-tag[l-1]='\0';
-struct pattern* pattern=build_pattern(&(tag[1+(*negation)]),NULL,tilde_negation_operator);
-tag[l-1]='>';
+/* We work on a copy, because the tag belongs to the fst2 that is
+ * shared by all the threads */
+unichar* content=u_strdup(&(tag[1+(*negation)]));
+content[l-2-(*negation)]='\0';
+struct pattern* pattern=build_pattern(content,NULL,tilde_negation_operator);
+free(content);
 return pattern;
 }
 
@@ -33,6 +33,8 @@
 #include "DicVariables.h"
 #include "TransductionVariables.h"
 #include "OutputTransductionVariables.h"
+#include "Pattern.h"
+#include "logger/SyncLogger.h"
 
 /* Following values must be !=-1, because -1 is used in
  * OptimizedTfstTagMatching to indicate that the result of a match
@@ -102,13 +104,28 @@ struct locate_tfst_infos {
 	int n_jamo_tfst_tags;
 	unichar** jamo_tfst_tags;
 	
+	/* Grammar tags like <be.V> and {tutu,toto.XXX} are tokenized once, the
+	 * first time they are used: fst2_tag_compiled[i] tells if it has been done
+	 * for the tag #i, under the lock fst2_tag_mutex. Then, fst2_tag_patterns[i]
+	 * (with its negation flag) and fst2_tag_entries[i] are NULL if the tag #i
+	 * is not of such a form */
+	struct pattern** fst2_tag_patterns;
+	char* fst2_tag_negations;
+	struct dela_entry** fst2_tag_entries;
+	char* fst2_tag_compiled;
+	SYNC_Mutex_OBJECT fst2_tag_mutex;
+
+	/* The grammar tags that can match the first text tag of a match, or NULL
+	 * if the text automaton states that cannot start a match are not known */
+	vector_int* initial_fst2_tags;
+
 	LocateTfstTagMatchingCache* cache;
 	struct opt_contexts** contexts;
 };
 
 
 int locate_tfst(char*,char*,char*,char*,Encoding,int,MatchPolicy,OutputPolicy,AmbiguousOutputPolicy,
-                VariableErrorPolicy,int,int,int);
+                VariableErrorPolicy,int,int,int,int);
 
 
 #endif
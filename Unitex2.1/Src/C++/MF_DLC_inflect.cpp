@@ -34,6 +34,7 @@
 #include "MF_DicoMorpho.h"
 #include "Error.h"
 #include "DELA.h"
+#include "Ustring.h"
 
 //Alphabet of the current language
 //extern Alphabet* alph;
@@ -48,6 +49,164 @@ int DLC_format_form(struct l_morpho_t* pL_MORPHO,unichar* entry, int max, MU_f_T
 		d_class_equiv_T* D_CLASS_EQUIV);
 void DLC_delete_entry(DLC_entry_T* entry);
 
+/////////////////////////////////////////////////////////////////////////////////
+// Inflects the simple word 'DELAS_entry' and appends the resulting DELAF lines
+// to 'out'.
+static void inflect_simple_word(MultiFlex_ctx* p_multiFlex_ctx, struct l_morpho_t* pL_MORPHO,
+		struct dela_entry* DELAS_entry, Ustring* out,
+		Encoding encoding_output, int bom_output, int mask_encoding_compatibility_input,
+		Korean* korean,const char* pkgdir) {
+	SU_forms_T forms;
+	SU_init_forms(&forms); //Allocate the space for forms and initialize it to null values
+	char inflection_code[1024];
+	unichar code_gramm[1024];
+	int semitic;
+	/* We take the first grammatical code, and we extract from it the name
+	 * of the inflection transducer to use */
+	get_inflection_code(DELAS_entry->semantic_codes[0],
+			inflection_code, code_gramm, &semitic);
+	/* And we inflect the word */
+	//   err=SU_inflect(DELAS_entry->lemma,inflection_code,&forms,semitic);
+	SU_inflect(p_multiFlex_ctx,pL_MORPHO,encoding_output,bom_output,mask_encoding_compatibility_input,DELAS_entry->lemma, inflection_code,
+			DELAS_entry->filters, &forms, semitic, korean,pkgdir);
+#ifdef __GNUC__
+#warning mettre toutes les entrees sur une meme ligne
+#elif ((defined(__VISUALC__)) || defined(_MSC_VER))
+#pragma message("warning : mettre toutes les entrees sur une meme ligne")
+#endif
+	/* Then, we print its inflected forms to the output */
+	for (int i = 0; i < forms.no_forms; i++) {
+	   
+	   unichar foo[1024];   
+	   if (korean!=NULL) {
+	      Hanguls_to_Jamos(forms.forms[i].form,foo,korean,1);
+	   } else {
+	      u_strcpy(foo,forms.forms[i].form);
+	   }
+	   
+	   u_strcat(out, foo/*forms.forms[i].form*/);
+	   u_strcat(out, ",");
+	   u_strcat(out, DELAS_entry->lemma);
+	   u_strcat(out, ".");
+	   u_strcat(out, code_gramm);
+		/* We add the semantic codes, if any */
+		for (int j = 1; j < DELAS_entry->n_semantic_codes; j++) {
+			u_strcat(out, "+");
+			u_strcat(out, DELAS_entry->semantic_codes[j]);
+		}
+		if (forms.forms[i].local_semantic_code != NULL) {
+			u_strcat(out, forms.forms[i].local_semantic_code);
+		}
+		if (forms.forms[i].raw_features != NULL
+				&& forms.forms[i].raw_features[0] != '\0') {
+			u_strcat(out, ":");
+			u_strcat(out, forms.forms[i].raw_features);
+		}
+		u_strcat(out, "\n");
+	}
+	SU_delete_inflection(&forms);
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// Inflects the DELAS/DELAC line 'input_line' and prints the result to 'dlcf'.
+// If 'DELAS_entry' is not NULL, it is the simple word already read from the line.
+// 'flag' is used to print only once the warning about configuration files.
+static void inflect_line(unichar* input_line, struct dela_entry* DELAS_entry, U_FILE* dlcf,
+		MultiFlex_ctx* p_multiFlex_ctx, struct l_morpho_t* pL_MORPHO, Alphabet* alph,
+		Encoding encoding_output, int bom_output, int mask_encoding_compatibility_input,
+		int config_files_status,
+		d_class_equiv_T* D_CLASS_EQUIV, int error_check_status,
+		Korean* korean,const char* pkgdir,Ustring* out,int* flag) {
+	unichar output_line[DIC_LINE_SIZE]; //current DELAF/DELACF line
+	DLC_entry_T* dlc_entry;
+	MU_forms_T MU_forms; //inflected forms of the MWU
+	int err;
+	if (DELAS_entry != NULL) {
+		/* If we have a strict DELAS line, that is to say, one with
+		 * a simple word */
+		if (error_check_status==ONLY_COMPOUND_WORDS) {
+			error("Unexpected simple word forbidden by -c:\n%S\n",input_line);
+			return;
+		}
+		empty(out);
+		inflect_simple_word(p_multiFlex_ctx,pL_MORPHO,DELAS_entry,out,encoding_output,
+				bom_output,mask_encoding_compatibility_input,korean,pkgdir);
+		u_fprintf(dlcf, "%S", out->str);
+		/* End of simple word case */
+	} else {
+		/* If we have not a simple word DELAS line, we try to analyse it
+		 * as a compound word DELAC line */
+		if (error_check_status==ONLY_SIMPLE_WORDS) {
+			error("Unexpected compound word forbidden by -s:\n%S\n",input_line);
+			return;
+		}
+		if (config_files_status != CONFIG_FILES_ERROR) {
+			/* If this is a compound word, we process it if and only if the
+			 * configuration files have been correctly loaded */
+			dlc_entry = (DLC_entry_T*) malloc(sizeof(DLC_entry_T));
+			if (!dlc_entry) {
+				fatal_alloc_error("inflect");
+			}
+			/* Convert a DELAC entry into the internal multi-word format */
+			err = DLC_line2entry(alph,pL_MORPHO,input_line, dlc_entry, D_CLASS_EQUIV);
+			if (!err) {
+				//Inflect the entry
+				MU_init_forms(&MU_forms);
+				err = MU_inflect(p_multiFlex_ctx,pL_MORPHO,encoding_output,bom_output,
+						mask_encoding_compatibility_input,dlc_entry->lemma, &MU_forms,pkgdir);
+				if (!err) {
+					int f; //index of the current inflected form
+					//Inform the user if no form generated
+					if (MU_forms.no_forms == 0) {
+						error("No inflected form could be generated for ");
+						DLC_print_entry(pL_MORPHO,dlc_entry);
+					}
+					//Print inflected forms
+					for (f = 0; f < MU_forms.no_forms; f++) {
+						//Format the inflected form to the DELACF format
+						err = DLC_format_form(pL_MORPHO,output_line, DIC_LINE_SIZE
+								- 1, MU_forms.forms[f], dlc_entry,
+								D_CLASS_EQUIV);
+						if (!err) {
+							//Print one inflected form at a time to the DELACF file
+							u_fprintf(dlcf, "%S\n", output_line);
+						}
+					}
+				}
+				MU_delete_inflection(&MU_forms);
+				DLC_delete_entry(dlc_entry);
+			}
+		} else {
+			/* We try to inflect a compound word whereas the "Morphology.txt" and/or
+			 * "Equivalences.txt" file(s) has/have not been loaded */
+			if (!(*flag)) {
+				/* We use a flag to print the error message only once */
+				error(
+						"WARNING: Compound words won't be inflected because configuration files\n");
+				error("         have not been correctly loaded.\n");
+				(*flag) = 1;
+			}
+		}
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// Reads the next DELAS/DELAC line to be inflected into 'input_line', without
+// its final newline. The first line is always returned, even if it is empty;
+// the following empty lines are skipped. Returns EOF at the end of the file.
+static int read_line(U_FILE* dlc, unichar* input_line, int first) {
+	int l;
+	do {
+		l = u_fgets(input_line, DIC_LINE_SIZE - 1, dlc);
+		if (l == EOF) {
+			return EOF;
+		}
+		//Omit the final newline
+		u_chomp_new_line(input_line);
+	} while (!first && input_line[0] == '\0');
+	return l;
+}
+
 /////////////////////////////////////////////////////////////////////////////////
 // Inflect a DELAS/DELAC into a DELAF/DELACF.
 // On error returns 1, 0 otherwise.
@@ -59,11 +218,6 @@ int inflect(char* DLC, char* DLCF,
 		    Korean* korean,const char* pkgdir) {
 	U_FILE *dlc, *dlcf; //DELAS/DELAC and DELAF/DELACF files
 	unichar input_line[DIC_LINE_SIZE]; //current DELAS/DELAC line
-	unichar output_line[DIC_LINE_SIZE]; //current DELAF/DELACF line
-	int l; //length of the line scanned
-	DLC_entry_T* dlc_entry;
-	MU_forms_T MU_forms; //inflected forms of the MWU
-	int err;
 
 	//Open DELAS/DELAC
 	dlc = u_fopen_existing_versatile_encoding(mask_encoding_compatibility_input, DLC, U_READ);
@@ -76,139 +230,23 @@ int inflect(char* DLC, char* DLCF,
 		error("Unable to open file: '%s' !\n", DLCF);
 		return 1;
 	}
+	Ustring* out=new_Ustring(DIC_LINE_SIZE);
 	//Inflect one entry at a time
-	l = u_fgets(input_line, DIC_LINE_SIZE - 1, dlc);
-	//Omit the final newline
-	u_chomp_new_line(input_line);
-	int flag = 0;
 	//If a line is empty the file is not necessarily finished.
 	//If the last entry has no newline, we should not skip this entry
-	struct dela_entry* DELAS_entry;
-	int semitic;
-	int current_line=0;
-	while (l != EOF) {
-	   current_line++;
-		DELAS_entry = is_strict_DELAS_line(input_line, alph);
+	int flag = 0;
+	int first = 1;
+	while (EOF != read_line(dlc, input_line, first)) {
+		first = 0;
+		struct dela_entry* DELAS_entry = is_strict_DELAS_line(input_line, alph);
+		inflect_line(input_line,DELAS_entry,dlcf,p_multiFlex_ctx,pL_MORPHO,alph,encoding_output,
+				bom_output,mask_encoding_compatibility_input,config_files_status,D_CLASS_EQUIV,
+				error_check_status,korean,pkgdir,out,&flag);
 		if (DELAS_entry != NULL) {
-			/* If we have a strict DELAS line, that is to say, one with
-			 * a simple word */
-			if (error_check_status==ONLY_COMPOUND_WORDS) {
-				error("Unexpected simple word forbidden by -c:\n%S\n",input_line);
-				free_dela_entry(DELAS_entry);
-				goto next_line;
-			}
-			SU_forms_T forms;
-			SU_init_forms(&forms); //Allocate the space for forms and initialize it to null values
-			char inflection_code[1024];
-			unichar code_gramm[1024];
-			/* We take the first grammatical code, and we extract from it the name
-			 * of the inflection transducer to use */
-			get_inflection_code(DELAS_entry->semantic_codes[0],
-					inflection_code, code_gramm, &semitic);
-			/* And we inflect the word */
-			//   err=SU_inflect(DELAS_entry->lemma,inflection_code,&forms,semitic);
-			err = SU_inflect(p_multiFlex_ctx,pL_MORPHO,encoding_output,bom_output,mask_encoding_compatibility_input,DELAS_entry->lemma, inflection_code,
-					DELAS_entry->filters, &forms, semitic, korean,pkgdir);
-#ifdef __GNUC__
-#warning mettre toutes les entrees sur une meme ligne
-#elif ((defined(__VISUALC__)) || defined(_MSC_VER))
-#pragma message("warning : mettre toutes les entrees sur une meme ligne")
-#endif
-			/* Then, we print its inflected forms to the output */
-			for (int i = 0; i < forms.no_forms; i++) {
-			   
-			   unichar foo[1024];   
-			   if (korean!=NULL) {
-			      Hanguls_to_Jamos(forms.forms[i].form,foo,korean,1);
-			   } else {
-			      u_strcpy(foo,forms.forms[i].form);
-			   }
-			   
-			   u_fprintf(dlcf, "%S,%S.%S", foo/*forms.forms[i].form*/,
-						DELAS_entry->lemma, code_gramm);
-				/* We add the semantic codes, if any */
-				for (int j = 1; j < DELAS_entry->n_semantic_codes; j++) {
-					u_fprintf(dlcf, "+%S", DELAS_entry->semantic_codes[j]);
-				}
-				if (forms.forms[i].local_semantic_code != NULL) {
-					u_fprintf(dlcf, "%S", forms.forms[i].local_semantic_code);
-				}
-				if (forms.forms[i].raw_features != NULL
-						&& forms.forms[i].raw_features[0] != '\0') {
-					u_fprintf(dlcf, ":%S", forms.forms[i].raw_features);
-				}
-				u_fprintf(dlcf, "\n");
-			}
-			SU_delete_inflection(&forms);
 			free_dela_entry(DELAS_entry);
-			/* End of simple word case */
-		} else {
-			/* If we have not a simple word DELAS line, we try to analyse it
-			 * as a compound word DELAC line */
-			if (error_check_status==ONLY_SIMPLE_WORDS) {
-				error("Unexpected compound word forbidden by -s:\n%S\n",input_line);
-				goto next_line;
-			}
-			if (config_files_status != CONFIG_FILES_ERROR) {
-				/* If this is a compound word, we process it if and only if the
-				 * configuration files have been correctly loaded */
-				dlc_entry = (DLC_entry_T*) malloc(sizeof(DLC_entry_T));
-				if (!dlc_entry) {
-					fatal_alloc_error("inflect");
-				}
-				/* Convert a DELAC entry into the internal multi-word format */
-				err = DLC_line2entry(alph,pL_MORPHO,input_line, dlc_entry, D_CLASS_EQUIV);
-				if (!err) {
-					//Inflect the entry
-					MU_init_forms(&MU_forms);
-					err = MU_inflect(p_multiFlex_ctx,pL_MORPHO,encoding_output,bom_output,
-							mask_encoding_compatibility_input,dlc_entry->lemma, &MU_forms,pkgdir);
-					if (!err) {
-						int f; //index of the current inflected form
-						//Inform the user if no form generated
-						if (MU_forms.no_forms == 0) {
-							error("No inflected form could be generated for ");
-							DLC_print_entry(pL_MORPHO,dlc_entry);
-						}
-						//Print inflected forms
-						for (f = 0; f < MU_forms.no_forms; f++) {
-							//Format the inflected form to the DELACF format
-							err = DLC_format_form(pL_MORPHO,output_line, DIC_LINE_SIZE
-									- 1, MU_forms.forms[f], dlc_entry,
-									D_CLASS_EQUIV);
-							if (!err) {
-								//Print one inflected form at a time to the DELACF file
-								u_fprintf(dlcf, "%S\n", output_line);
-							}
-						}
-					}
-					MU_delete_inflection(&MU_forms);
-					DLC_delete_entry(dlc_entry);
-				}
-			} else {
-				/* We try to inflect a compound word whereas the "Morphology.txt" and/or
-				 * "Equivalences.txt" file(s) has/have not been loaded */
-				if (!flag) {
-					/* We use a flag to print the error message only once */
-					error(
-							"WARNING: Compound words won't be inflected because configuration files\n");
-					error("         have not been correctly loaded.\n");
-					flag = 1;
-				}
-			}
-		}
-		next_line:
-		//Get next entry
-		l = u_fgets(input_line, DIC_LINE_SIZE - 1, dlc);
-		if (l!=EOF) {
-			//Omit the final newline
-			u_chomp_new_line(input_line);
-			if (input_line[0]=='\0') {
-				/* If we find an empty line, then we go on */
-				goto next_line;
-			}
 		}
 	}
+	free_Ustring(out);
 	u_fclose(dlc);
 	u_fclose(dlcf);
 	return 0;
@@ -467,8 +505,10 @@ int DLC_scan_comment(unichar** comment, unichar* line) {
 		if (l) {
 			*comment = u_strdup(tmp);
 		}
-	} else
+	} else {
 		*comment = NULL;
+		return 0;
+	}
 	return l + 1; //Length od the comment plus '/'
 }
 /**************************************************************************************/
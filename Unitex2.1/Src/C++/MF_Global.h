@@ -31,6 +31,8 @@
 #include "MF_MU_morphoBase.h"
 #include "MF_UnifBase.h"
 
+struct SU_memo;
+
 typedef struct {
 
 // GLOBAL VARIABLES
@@ -62,6 +64,11 @@ unichar Variables_op[22][100];
 int save_pos;
 
 unif_vars_T UNIF_VARS;
+
+////////////////////////////////////////////
+// Inflected forms of simple words already computed for each
+// inflection transducer (see SU_inflect)
+struct SU_memo* SU_memo;
 } MultiFlex_ctx;
 
 #endif
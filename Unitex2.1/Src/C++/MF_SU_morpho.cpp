@@ -141,6 +141,152 @@ int SU_inflect(MultiFlex_ctx* p_multiFlex_ctx,struct l_morpho_t* pL_MORPHO,Encod
 	return err;
 }
 
+/**
+ * When an inflection transducer only uses operators that work on letter
+ * positions, the forms it produces for a lemma only depend on the length
+ * of this lemma. In that case, we explore the transducer once per lemma
+ * length with a lemma made of placeholders, one private use character per
+ * position, and we get the forms of any other lemma of the same length
+ * by replacing the placeholders by its letters.
+ */
+#define SU_MEMO_PLACEHOLDER 0xE000
+#define SU_MEMO_MAX_LEMMA_LENGTH 128
+
+struct SU_memo_transducer {
+	/* 1 if the transducer only uses position operators, 0 otherwise */
+	int memoizable;
+	/* forms[n] is the result for a lemma of length n, or NULL if it
+	 * has not been computed yet */
+	SU_forms_T* forms[SU_MEMO_MAX_LEMMA_LENGTH + 1];
+};
+
+struct SU_memo {
+	struct SU_memo_transducer* transducers[N_FST2];
+};
+
+/**
+ * Returns 1 if the result of the exploration of the given transducer
+ * does not depend on the letters of the lemma; 0 otherwise.
+ */
+static int is_memoizable_transducer(Fst2* a) {
+	for (int i = 0; i < a->number_of_tags; i++) {
+		Fst2Tag t = a->tags[i];
+		if (t == NULL || t->input == NULL) {
+			return 0;
+		}
+		unichar* tag = t->input;
+		for (int j = 0; tag[j] != '\0'; j++) {
+			if (tag[j] >= SU_MEMO_PLACEHOLDER
+					&& tag[j] < SU_MEMO_PLACEHOLDER + SU_MEMO_MAX_LEMMA_LENGTH) {
+				/* Such a letter would be taken for a placeholder */
+				return 0;
+			}
+		}
+		if (t->control & RESPECT_CASE_TAG_BIT_MASK || !u_strcmp(tag, "<E>")
+				|| !u_strcmp(tag, "<!>")) {
+			continue;
+		}
+		unichar foo;
+		int val;
+		if (u_starts_with(tag, "<R=") || u_starts_with(tag, "<I=")
+				|| 1 == u_sscanf(tag, "<X=%d>%C", &val, &foo)) {
+			continue;
+		}
+		for (int j = 0; tag[j] != '\0'; j++) {
+			switch (tag[j]) {
+			case '<':
+			case '$':
+			case (unichar) POUND:
+			case 'U':
+			case 'W':
+			case 'P':
+			case 'J':
+			case '.':
+				/* Operators that look at the letters themselves */
+				return 0;
+			default:
+				break;
+			}
+		}
+	}
+	return 1;
+}
+
+/**
+ * Returns the forms produced by the transducer #T for a lemma of the given
+ * length, computing them if needed, or NULL if they cannot be memoized.
+ */
+static SU_forms_T* get_memoized_forms(MultiFlex_ctx* p_multiFlex_ctx,
+		struct l_morpho_t* pL_MORPHO, int T, int length) {
+	if (length > SU_MEMO_MAX_LEMMA_LENGTH) {
+		return NULL;
+	}
+	if (p_multiFlex_ctx->SU_memo == NULL) {
+		p_multiFlex_ctx->SU_memo = (struct SU_memo*) calloc(1, sizeof(struct SU_memo));
+		if (p_multiFlex_ctx->SU_memo == NULL) {
+			fatal_alloc_error("get_memoized_forms");
+		}
+	}
+	struct SU_memo_transducer* m = p_multiFlex_ctx->SU_memo->transducers[T];
+	if (m == NULL) {
+		m = (struct SU_memo_transducer*) calloc(1, sizeof(struct SU_memo_transducer));
+		if (m == NULL) {
+			fatal_alloc_error("get_memoized_forms");
+		}
+		m->memoizable = is_memoizable_transducer(p_multiFlex_ctx->fst2[T]);
+		p_multiFlex_ctx->SU_memo->transducers[T] = m;
+	}
+	if (!m->memoizable) {
+		return NULL;
+	}
+	if (m->forms[length] == NULL) {
+		unichar inflected[MAX_CHARS_IN_STACK];
+		unichar inflection_codes[MAX_CHARS_IN_STACK];
+		unichar local_semantic_code[MAX_CHARS_IN_STACK];
+		unichar var_name[100];
+		for (int i = 0; i < length; i++) {
+			inflected[i] = (unichar) (SU_MEMO_PLACEHOLDER + i);
+		}
+		inflected[length] = '\0';
+		inflection_codes[0] = '\0';
+		local_semantic_code[0] = '\0';
+		m->forms[length] = (SU_forms_T*) malloc(sizeof(SU_forms_T));
+		if (m->forms[length] == NULL) {
+			fatal_alloc_error("get_memoized_forms");
+		}
+		SU_init_forms(m->forms[length]);
+		SU_explore_state(p_multiFlex_ctx, pL_MORPHO, inflected, inflected,
+				inflection_codes, p_multiFlex_ctx->fst2[T], 0, NULL,
+				m->forms[length], 0, 0, var_name, 0, NULL, local_semantic_code,
+				NULL);
+	}
+	return m->forms[length];
+}
+
+/**
+ * Frees the forms memoized in the given context.
+ */
+void SU_free_memo(MultiFlex_ctx* p_multiFlex_ctx) {
+	if (p_multiFlex_ctx->SU_memo == NULL) {
+		return;
+	}
+	for (int T = 0; T < N_FST2; T++) {
+		struct SU_memo_transducer* m = p_multiFlex_ctx->SU_memo->transducers[T];
+		if (m == NULL) {
+			continue;
+		}
+		for (int n = 0; n <= SU_MEMO_MAX_LEMMA_LENGTH; n++) {
+			if (m->forms[n] != NULL) {
+				SU_delete_inflection(m->forms[n]);
+				free(m->forms[n]);
+			}
+		}
+		free(m);
+	}
+	free(p_multiFlex_ctx->SU_memo);
+	p_multiFlex_ctx->SU_memo = NULL;
+}
+
 /**
  * This function inflects a simple word. 'lemma' is the lemma as found in
  * the DELAS, 'inflection_code' is the name of the inflection transducer without
@@ -163,6 +309,35 @@ int SU_inflect(MultiFlex_ctx* p_multiFlex_ctx,struct l_morpho_t* pL_MORPHO,Encod
 		// if the automaton has not been loaded
 		return 1;
 	}
+	SU_forms_T* memo = NULL;
+	if (!semitic && korean == NULL
+			&& (filters == NULL || (filters[0] == NULL && filters[1] == NULL))) {
+		memo = get_memoized_forms(p_multiFlex_ctx, pL_MORPHO, T, u_strlen(lemma));
+	}
+	if (memo != NULL) {
+		/* We replace the placeholders of the memoized forms by the letters of the lemma */
+		forms->forms = (SU_f_T*) realloc(forms->forms,
+				(forms->no_forms + memo->no_forms) * sizeof(SU_f_T));
+		if (memo->no_forms != 0 && !forms->forms) {
+			fatal_alloc_error("SU_inflect");
+		}
+		for (int f = 0; f < memo->no_forms; f++) {
+			unichar* form = u_strdup(memo->forms[f].form);
+			for (int i = 0; form[i] != '\0'; i++) {
+				if (form[i] >= SU_MEMO_PLACEHOLDER
+						&& form[i] < SU_MEMO_PLACEHOLDER + SU_MEMO_MAX_LEMMA_LENGTH) {
+					form[i] = lemma[form[i] - SU_MEMO_PLACEHOLDER];
+				}
+			}
+			forms->forms[forms->no_forms].form = form;
+			forms->forms[forms->no_forms].local_semantic_code
+					= u_strdup(memo->forms[f].local_semantic_code);
+			forms->forms[forms->no_forms].raw_features
+					= u_strdup(memo->forms[f].raw_features);
+			forms->no_forms++;
+		}
+		return 0;
+	}
 	u_strcpy(inflected, semitic ? U_EMPTY : lemma);
 	local_semantic_code[0] = '\0';
     unichar var_name[100];
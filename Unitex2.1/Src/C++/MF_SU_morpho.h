@@ -56,6 +56,10 @@ int SU_inflect(MultiFlex_ctx* p_multiFlex_ctx,struct l_morpho_t* pL_MORPHO,Encod
 // Liberates the memory allocated for a set of forms
 void SU_delete_inflection(SU_forms_T* forms);
 
+////////////////////////////////////////////
+// Liberates the inflected forms memoized by SU_inflect in the given context
+void SU_free_memo(MultiFlex_ctx* p_multiFlex_ctx);
+
 ////////////////////////////////////////////
 // Returns in 'feat' a copy of the inflection features of the given form.
 // Initially 'feat' has its space allocated but is empty.
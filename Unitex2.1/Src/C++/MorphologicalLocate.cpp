@@ -93,83 +93,83 @@ static int is_morpho_variable_output(unichar* s, unichar* var_name) {
 }
 
 /**
- * Tries to match all the given tag token against the given jamo sequence. Return values:
+ * Tries to match all the given tag token against the given jamo sequence. 'tag_jamo' is
+ * the jamo version of the tag token, as precomputed by create_jamo_fst2_tags or
+ * get_jamo_of_char. Return values:
  * 0=failed
  * 1=the tag matches the whole jamo sequence (i.e. we will have to go on the next text token
  * 2=the tag matches a part of the jamo sequence
  */
 static int get_jamo_longest_prefix(unichar* jamo, int *new_pos_in_jamo,
-		int *new_pos_in_token, unichar* tag_token, struct locate_parameters* p,
-		unichar* token) {
-	unichar tmp[128];
-	if (tag_token[0] == KR_SYLLABLE_BOUND && tag_token[1] == '\0') {
-		u_strcpy(tmp, tag_token);
-	} else {
-		Hanguls_to_Jamos(tag_token, tmp, p->korean, 0);
-		/*error("conversion depuis <%S> vers <%S><",tag_token,tmp);
-		for (int i=0;tmp[i]!='\0';i++) {
-			error("%X ",tmp[i]);
-		}
-		error(">\n");*/
-	}
+		int *new_pos_in_token, const unichar* tag_jamo) {
 	int i = 0;
-	if (token == NULL) {
-		token = tag_token;
-	}
 	//set_debug(0 && token[0]==0xB2A5);
-	//error("on compare text=_%S/%S_ et tag=_%S/%S\n",token,jamo/*+(*new_pos_in_jamo)*/,tag_token,tmp);
-	/*error("on compare text=<%S><",token);
+	//error("on compare text=_%S_ et tag=_%S_\n",jamo/*+(*new_pos_in_jamo)*/,tag_jamo);
+	/*error("on compare text=<");
 	for (int i=(*new_pos_in_jamo);jamo[i]!='\0';i++) {
 		error("(%C) ",jamo[i]);
 	}
-	error("> et tag=<%S><",tag_token);
-	for (int i=0;tmp[i]!='\0';i++) {
-		error("(%C) ",tmp[i]);
+	error("> et tag=<");
+	for (int i=0;tag_jamo[i]!='\0';i++) {
+		error("(%C) ",tag_jamo[i]);
 	}
 	error(">\n");*/
-	while (tmp[i] != '\0' && jamo[(*new_pos_in_jamo)] != '\0') {
+	while (tag_jamo[i] != '\0' && jamo[(*new_pos_in_jamo)] != '\0') {
 #if 2
 		/* We ignore syllable bounds in both tfst and fst2 tags */
-		if (tmp[i] == KR_SYLLABLE_BOUND && jamo[(*new_pos_in_jamo)] != KR_SYLLABLE_BOUND) {
+		if (tag_jamo[i] == KR_SYLLABLE_BOUND && jamo[(*new_pos_in_jamo)] != KR_SYLLABLE_BOUND) {
 			i++;
-			//debug("ignoring . in tag: %S\n",tmp+i);
+			//debug("ignoring . in tag: %S\n",tag_jamo+i);
 			continue;
 		}
 #endif
 		if (jamo[(*new_pos_in_jamo)] == KR_SYLLABLE_BOUND) {
-			if (tmp[i] != KR_SYLLABLE_BOUND) return 0;
+			if (tag_jamo[i] != KR_SYLLABLE_BOUND) return 0;
 			i++;
 			(*new_pos_in_jamo)++;
 			(*new_pos_in_token)++;
 			//debug("ignoring . in text: %S\n",jamo+((*new_pos_in_jamo)));
 			continue;
 		}
-		if (tmp[i] != jamo[(*new_pos_in_jamo)]) {
+		if (tag_jamo[i] != jamo[(*new_pos_in_jamo)]) {
 			/* If a character doesn't match */
-			//debug("match failed between text=%S and fst2=%S\n",jamo,tmp);
+			//debug("match failed between text=%S and fst2=%S\n",jamo,tag_jamo);
 			return 0;
 		}
 		i++;
 		(*new_pos_in_jamo)++;
-		//debug("moving in tag: %S\n",tmp+i);
+		//debug("moving in tag: %S\n",tag_jamo+i);
 		//debug("moving in text: %S\n",jamo+((*new_pos_in_jamo)));
 	}
-	if (tmp[i] == '\0' && jamo[(*new_pos_in_jamo)] == '\0') {
+	if (tag_jamo[i] == '\0' && jamo[(*new_pos_in_jamo)] == '\0') {
 		/* If we are at both ends of strings, it's a full match */
-		//debug("XX full match between text=%S and fst2=%S\n",jamo,tmp);
+		//debug("XX full match between text=%S and fst2=%S\n",jamo,tag_jamo);
 		return 1;
 	}
-	if (tmp[i] == '\0') {
+	if (tag_jamo[i] == '\0') {
 		/* If the tag has not consumed all the jamo sequence, it's a partial match */
-		//debug("XX partial match between text=%S and fst2=%S\n",jamo,tmp);
+		//debug("XX partial match between text=%S and fst2=%S\n",jamo,tag_jamo);
 		return 2;
 	}
 	/* If we are at the end of the jamo sequence, but not at the end of the tag, it's a failure */
-	//debug("match failed #2 between text=%S and fst2=%S\n",jamo,tmp);
+	//debug("match failed #2 between text=%S and fst2=%S\n",jamo,tag_jamo);
 	//set_debug(0);
 	return 0;
 }
 
+/**
+ * Stores in 'dest' the jamo version of the given dictionary character, as
+ * expected by get_jamo_longest_prefix.
+ */
+static inline void get_jamo_of_char(unichar c, unichar* dest, Korean* korean) {
+	if (c == KR_SYLLABLE_BOUND) {
+		dest[0] = c;
+		dest[1] = '\0';
+		return;
+	}
+	dest[korean->char_to_Jamos(c, dest)] = '\0';
+}
+
 static void update_last_position(struct locate_parameters* p, int pos) {
 	if (pos > p->last_tested_position) {
 		p->last_tested_position = pos;
@@ -1003,8 +1003,8 @@ unichar* content_buffer /* reusable unichar 4096 buffer for content */
 					int new_pos_in_jamo = pos_in_jamo;
 					int new_pos_in_token = pos_in_chars;
 					int result = get_jamo_longest_prefix(jamo,
-							&new_pos_in_jamo, &new_pos_in_token, tag_token, p,
-							current_token);
+							&new_pos_in_jamo, &new_pos_in_token,
+							p->jamo_fst2_tags[trans->tag_number]);
 					if (comma != -1) {
 						/* If necessary, we restore the tag */
 						tag_token[comma] = ',';
@@ -1476,9 +1476,7 @@ static void explore_dic_in_morpho_mode_standard(struct locate_parameters* p,
 			//error("la: jamo du text<%S>=%C (%04X)   char du dico=%C (%04X)\n",jamo,jamo[pos_in_jamo],jamo[pos_in_jamo],c,c);
 			/* Korean mode: we may match just the current jamo, or also the current hangul, but only if we are
 			 * after a syllable bound */
-			unichar c2[2];
-			c2[0] = c;
-			c2[1] = '\0';
+			unichar c2[16];
 			int syllable_bounds=0;
 			/* We try to match all the jamo sequence found in the dictionary */
 			if (jamo[pos_in_jamo]==KR_SYLLABLE_BOUND) {
@@ -1495,8 +1493,9 @@ static void explore_dic_in_morpho_mode_standard(struct locate_parameters* p,
 			int new_pos_in_jamo = pos_in_jamo;
 			int result=0;
 			if (!syllable_bounds) {
+				get_jamo_of_char(c, c2, p->korean);
 				result = get_jamo_longest_prefix(jamo, &new_pos_in_jamo,
-					&new_pos_in_current_token, c2, p, current_token);
+					&new_pos_in_current_token, c2);
 			}
 			if (result != 0 || syllable_bounds) {
 				if (syllable_bounds) {
@@ -38,6 +38,7 @@
 #include "UnitexGetOpt.h"
 #include "MultiFlex.h"
 #include "MF_Global.h"
+#include "MF_SU_morpho.h"
 
 
 // Directory containing the inflection tranducers and the 'Morphology' file
@@ -160,6 +161,7 @@ p_multiFlex_ctx = (MultiFlex_ctx*)malloc(sizeof(MultiFlex_ctx));
 if (p_multiFlex_ctx == NULL) {
    fatal_alloc_error("main_MultiFlex");
 }
+p_multiFlex_ctx->SU_memo=NULL;
 int err;  //0 if a function completes with no error
 //Load morphology description
 char morphology[FILENAME_MAX];
@@ -215,6 +217,7 @@ if (is_korean) {
 err=inflect(argv[vars->optind],output,p_multiFlex_ctx,pL_MORPHO,alph,encoding_output, bom_output, mask_encoding_compatibility_input,
             config_files_status,&D_CLASS_EQUIV,
 		      error_check_status,korean,pkgdir);
+SU_free_memo(p_multiFlex_ctx);
 MU_graph_free_graphs(p_multiFlex_ctx);
 for (int count_free_fst2=0;count_free_fst2<p_multiFlex_ctx->n_fst2;count_free_fst2++) {
     free_abstract_Fst2(p_multiFlex_ctx->fst2[count_free_fst2],&(p_multiFlex_ctx->fst2_free[count_free_fst2]));
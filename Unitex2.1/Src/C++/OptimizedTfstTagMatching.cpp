@@ -73,6 +73,7 @@ cache->n_fst2_tags=n_fst2_tags;
 cache->table=new_hash_table(size,0.75f,(HASH_FUNCTION)hash_unichar,(EQUAL_FUNCTION)u_equal,
       (FREE_FUNCTION)free,NULL,(KEYCOPY_FUNCTION)keycopy);
 cache->elements=new_vector_ptr(size);
+cache->entries=new_vector_ptr(size);
 cache->cached_tfst_tags_index=NULL;
 return cache;
 }
@@ -101,6 +102,10 @@ for (int i=0;i<cache->elements->nbelems;i++) {
    free_element_array((struct element**)(cache->elements->tab[i]),cache->n_fst2_tags);
 }
 free_vector_ptr(cache->elements,NULL);
+for (int i=0;i<cache->entries->nbelems;i++) {
+   free_dela_entry((struct dela_entry*)(cache->entries->tab[i]));
+}
+free_vector_ptr(cache->entries,NULL);
 free(cache->cached_tfst_tags_index);
 free(cache);
 }
@@ -178,6 +183,18 @@ free(array);
 }
 
 
+/**
+ * Returns the dela_entry corresponding to the given tfst tag content if it
+ * is of the form {tutu,toto.XXX}, or NULL otherwise.
+ */
+static struct dela_entry* tokenize_tfst_tag(const unichar* s) {
+if (s[0]!='{' || s[1]=='\0' || !u_strcmp(s,"{S}") || !u_strcmp(s,"{STOP}")) {
+   return NULL;
+}
+return tokenize_tag_token(s);
+}
+
+
 /**
  * Returns the index of the given tag in the cache.
  */
@@ -188,6 +205,7 @@ if (ret==HT_KEY_ADDED) {
    /* If we had not already this tag, we insert it */ 
    value->_int=cache->elements->nbelems;
    vector_ptr_add(cache->elements,new_element_array(cache->n_fst2_tags));
+   vector_ptr_add(cache->entries,tokenize_tfst_tag(s));
 }
 return value->_int;
 }
@@ -243,3 +261,18 @@ if (array==NULL) {
 }
 array[fst2_tag_index]=new_element(result,old_pos_fst2,old_pos_tfst,new_pos_fst2,new_pos_tfst,array[fst2_tag_index]);
 }
+
+
+/**
+ * Returns the dela_entry of the given tfst tag of the current sentence, or NULL
+ * if the tag is not of the form {tutu,toto.XXX}. The entry belongs to the cache
+ * and must not be freed. This function must be called after 'get_cached_result'
+ * has been called for this tag.
+ */
+struct dela_entry* get_cached_tfst_tag_entry(LocateTfstTagMatchingCache* cache,int tfst_tag_index) {
+int tfst_tag_cache_index=cache->cached_tfst_tags_index[tfst_tag_index];
+if (tfst_tag_cache_index==-1) {
+   fatal_error("Unexpected -1 tfst tag cache index in get_cached_tfst_tag_entry\n");
+}
+return (struct dela_entry*)(cache->entries->tab[tfst_tag_cache_index]);
+}
@@ -24,10 +24,13 @@
 
 #include "HashTable.h"
 #include "Vector.h"
+#include "DELA.h"
 
 /**
  * This library provides a data structure to optimize TfstTag/Fst2Tag matching,
- * using a cache.
+ * using a cache. Each distinct tfst tag content gets an index in the cache,
+ * and tags like {tutu,toto.XXX} are tokenized only once, when their content
+ * is seen for the first time.
  */
 
 /* See comment in LocateTfst_lib.h */
@@ -36,6 +39,9 @@
 typedef struct {
    struct hash_table* table;
    vector_ptr* elements;
+   /* entries->tab[i] is the dela_entry of the tfst tag #i, or NULL if this tag
+    * is not of the form {tutu,toto.XXX} */
+   vector_ptr* entries;
    int n_fst2_tags;
    int* cached_tfst_tags_index;
 } LocateTfstTagMatchingCache;
@@ -52,6 +58,7 @@ int get_cached_result(LocateTfstTagMatchingCache* cache,
 void set_cached_result(LocateTfstTagMatchingCache* cache,
                       int tfst_tag_index,int fst2_tag_index,
                       int old_pos_fst2,int old_pos_tfst,int new_pos_fst2,int new_pos_tfst,int result);
+struct dela_entry* get_cached_tfst_tag_entry(LocateTfstTagMatchingCache* cache,int tfst_tag_index);
 
 
 #endif
@@ -0,0 +1,519 @@
+/*
+ * Unitex
+ *
+ * Copyright (C) 2001-2011 Université Paris-Est Marne-la-Vallée <unitex@univ-mlv.fr>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "Error.h"
+#include "File.h"
+#include "Pipeline.h"
+#include "DirHelper.h"
+#include "ActivityLoggerPlugCallback.h"
+#include "logger/SyncLogger.h"
+
+
+/**
+ * A structure loaded from a file and shared by all the tools of the pipeline.
+ * 'filename' is the normalized name of the file (see normalize_filename).
+ * 'obsolete' is set when the file has been modified since the structure
+ * was loaded. A file that has only been loaded once is recorded with a
+ * NULL 'resource'. 'users' is the number of tools that are using the
+ * structure, and 'size' is what it counts in pipeline_memory. A structure
+ * given by provide_pipeline_resource has a NULL 'release', since it belongs
+ * to the caller.
+ */
+struct pipeline_resource {
+   char* filename;
+   PipelineResourceType type;
+   void* resource;
+   release_pipeline_resource release;
+   int obsolete;
+   int users;
+   long size;
+   struct pipeline_resource* next;
+};
+
+
+static int pipeline_depth=0;
+static struct pipeline_resource* pipeline_resources=NULL;
+/* The tools of the pipeline may run several threads, like Locate, which
+ * all load and free the shared structures, so that the list is always
+ * used with this mutex. It exists while the pipeline is active */
+static SYNC_Mutex_OBJECT pipeline_mutex=NULL;
+static long pipeline_memory=0;
+static long pipeline_memory_limit=PIPELINE_MEMORY_LIMIT;
+
+
+/**
+ * Returns a new string with a name that is the same for all the spellings of
+ * the given file name, like "t_snt/concord.ind", "./t_snt/concord.ind" or
+ * "/home/me/t_snt//concord.ind" run from /home/me: a relative name is made
+ * absolute, the separators are unified and the "." and ".." components are
+ * removed. The names of an abstract file space are only cleaned up, since they
+ * do not depend on the current directory. Symbolic links are not resolved,
+ * since the file may not exist yet.
+ */
+static char* normalize_filename(const char* filename) {
+char cwd[FILENAME_MAX];
+size_t length=strlen(filename);
+char* name=(char*)malloc(sizeof(cwd)+1+length+1);
+if (name==NULL) {
+   fatal_alloc_error("normalize_filename");
+}
+strcpy(name,filename);
+#ifndef _NOT_UNDER_WINDOWS
+for (char* c=name;*c!='\0';c++) {
+   if (*c=='/') *c=PATH_SEPARATOR_CHAR;
+}
+#endif
+if (!is_filename_in_abstract_file_space(filename) && !is_absolute_path(name)
+    && getCurrentDirPortable(cwd,sizeof(cwd))==0) {
+   size_t l_cwd=strlen(cwd);
+   memmove(name+l_cwd+1,name,length+1);
+   memcpy(name,cwd,l_cwd);
+   name[l_cwd]=PATH_SEPARATOR_CHAR;
+}
+/* 'root' is the length of what we must leave as is: the separator of a Unix
+ * absolute name or the drive of a Windows one */
+size_t root=0;
+if (name[0]==PATH_SEPARATOR_CHAR) {
+   root=1;
+} else if (name[0]!='\0' && name[1]==':' && name[2]==PATH_SEPARATOR_CHAR) {
+   root=3;
+}
+/* We copy the components one by one at the end of the result, which is never
+ * longer than the source */
+size_t dest=root;
+const char* src=name+root;
+while (*src!='\0') {
+   const char* end=strchr(src,PATH_SEPARATOR_CHAR);
+   length=(end!=NULL)?(size_t)(end-src):strlen(src);
+   /* 'last' is the start of the last component copied */
+   size_t last=dest;
+   while (last>root && name[last-1]!=PATH_SEPARATOR_CHAR) last--;
+   int parent=(length==2 && src[0]=='.' && src[1]=='.');
+   if (length==0 || (length==1 && src[0]=='.')) {
+      /* Nothing to do for "//" and "/./" */
+   } else if (parent && dest>root && !(dest-last==2 && name[last]=='.' && name[last+1]=='.')) {
+      /* We remove the last component */
+      dest=(last>root)?last-1:root;
+   } else if (parent && dest==root && root!=0) {
+      /* ".." of the root is the root */
+   } else {
+      if (dest>root) name[dest++]=PATH_SEPARATOR_CHAR;
+      memmove(name+dest,src,length);
+      dest=dest+length;
+   }
+   src=src+length;
+   if (*src==PATH_SEPARATOR_CHAR) src++;
+}
+name[dest]='\0';
+return name;
+}
+
+
+/**
+ * Takes the given resource out of the list and returns it. Its size is no
+ * longer counted. The pipeline mutex must be held.
+ */
+static struct pipeline_resource* remove_resource(struct pipeline_resource** previous) {
+struct pipeline_resource* r=*previous;
+*previous=r->next;
+pipeline_memory=pipeline_memory-r->size;
+return r;
+}
+
+
+/**
+ * Frees a resource taken out of the list, and its structure if it belongs
+ * to the pipeline. The pipeline mutex must not be held, since the free
+ * function of the structure calls unuse_pipeline_resource.
+ */
+static void free_resource(struct pipeline_resource* r) {
+if (r->resource!=NULL && r->release!=NULL) (*(r->release))(r->resource);
+free(r->filename);
+free(r);
+}
+
+
+/**
+ * Marks as obsolete all the resources loaded from the given file. Since they
+ * will never be given again to a tool, the structures that no tool uses are
+ * freed at once, and so are the records of the files loaded only once. This
+ * also closes the unused mappings of the file, since a mapped file cannot
+ * be written on all systems.
+ */
+static void file_modified(const char* filename) {
+if (pipeline_mutex==NULL) return;
+char* name=normalize_filename(filename);
+struct pipeline_resource* unused=NULL;
+SyncGetMutex(pipeline_mutex);
+struct pipeline_resource** previous=&pipeline_resources;
+while (*previous!=NULL) {
+   struct pipeline_resource* r=*previous;
+   if (!strcmp(r->filename,name)) {
+      r->obsolete=1;
+      if (r->release!=NULL && r->users<=0) {
+         remove_resource(previous);
+         r->next=unused;
+         unused=r;
+         continue;
+      }
+   }
+   previous=&(r->next);
+}
+SyncReleaseMutex(pipeline_mutex);
+free(name);
+while (unused!=NULL) {
+   struct pipeline_resource* r=unused;
+   unused=r->next;
+   free_resource(r);
+}
+}
+
+
+/**
+ * Tells that the structures loaded from the given file will not be needed
+ * anymore, as if the file had been modified. A tool that has consumed a
+ * file, like Cassys with the concord.ind of a stage, can so give its
+ * memory back before the file is written again.
+ */
+static void pipeline_drop_file(const char* filename) {
+file_modified(filename);
+}
+
+
+static void ABSTRACT_CALLBACK_UNITEX pipeline_before_af_fopen(const char* name,const char* MODE,void*) {
+if (strcmp(MODE,"rb")) {
+   file_modified(name);
+}
+}
+
+
+static void ABSTRACT_CALLBACK_UNITEX pipeline_after_af_rename(const char* name1,const char* name2,int,void*) {
+file_modified(name1);
+file_modified(name2);
+}
+
+
+static void ABSTRACT_CALLBACK_UNITEX pipeline_after_af_copy(const char*,const char* name2,int,void*) {
+file_modified(name2);
+}
+
+
+static void ABSTRACT_CALLBACK_UNITEX pipeline_after_af_remove(const char* name,int,void*) {
+file_modified(name);
+}
+
+
+/* We use the logger callbacks to be told about the files that are modified */
+static const t_logger_func_array pipeline_func_array={
+   sizeof(t_logger_func_array),
+   NULL,
+   NULL,
+   pipeline_before_af_fopen,
+   NULL,
+   NULL,
+   NULL,
+   NULL,
+   pipeline_after_af_rename,
+   NULL,
+   pipeline_after_af_copy,
+   NULL,
+   pipeline_after_af_remove,
+   NULL,
+   NULL,
+   NULL,
+   NULL
+};
+
+
+static int pipeline_begin() {
+if (pipeline_depth==0) {
+   pipeline_mutex=SyncBuildMutex();
+   if (pipeline_mutex==NULL) {
+      return 0;
+   }
+   if (!AddLoggerInfo(&pipeline_func_array,NULL)) {
+      SyncDeleteMutex(pipeline_mutex);
+      pipeline_mutex=NULL;
+      return 0;
+   }
+   pipeline_memory=0;
+   pipeline_memory_limit=PIPELINE_MEMORY_LIMIT;
+}
+pipeline_depth++;
+return 1;
+}
+
+
+static int pipeline_end() {
+if (pipeline_depth==0) return 0;
+pipeline_depth--;
+if (pipeline_depth>0) return 1;
+RemoveLoggerInfo(&pipeline_func_array,NULL);
+for (;;) {
+   SyncGetMutex(pipeline_mutex);
+   struct pipeline_resource* r=pipeline_resources;
+   /* We take the resource out of the list before releasing it, so that
+    * the free function of the structure really frees it */
+   if (r!=NULL) pipeline_resources=r->next;
+   SyncReleaseMutex(pipeline_mutex);
+   if (r==NULL) break;
+   free_resource(r);
+}
+SyncDeleteMutex(pipeline_mutex);
+pipeline_mutex=NULL;
+pipeline_memory=0;
+return 1;
+}
+
+
+static int pipeline_is_active() {
+return (pipeline_depth>0);
+}
+
+
+static void pipeline_set_memory_limit(long limit) {
+if (pipeline_mutex==NULL) return;
+SyncGetMutex(pipeline_mutex);
+pipeline_memory_limit=limit;
+SyncReleaseMutex(pipeline_mutex);
+}
+
+
+/**
+ * Returns the structure of the given type that was loaded from the given
+ * file in the current pipeline, or NULL if there is none or if the file
+ * has been modified since. The caller must give it back with
+ * unuse_pipeline_resource when it does not use it anymore.
+ */
+static void* pipeline_get_resource(const char* filename,PipelineResourceType type) {
+if (pipeline_mutex==NULL) return NULL;
+char* name=normalize_filename(filename);
+void* resource=NULL;
+SyncGetMutex(pipeline_mutex);
+for (struct pipeline_resource* r=pipeline_resources;r!=NULL;r=r->next) {
+   if (r->type==type && !r->obsolete && r->resource!=NULL && !strcmp(r->filename,name)) {
+      (r->users)++;
+      resource=r->resource;
+      break;
+   }
+}
+SyncReleaseMutex(pipeline_mutex);
+free(name);
+return resource;
+}
+
+
+/**
+ * Adds a resource record for the given file, with a NULL resource.
+ * 'name' must be normalized, and is kept by the record. The pipeline
+ * mutex must be held.
+ */
+static struct pipeline_resource* new_pipeline_resource(char* name,PipelineResourceType type,
+                                                       release_pipeline_resource release) {
+struct pipeline_resource* r=(struct pipeline_resource*)malloc(sizeof(struct pipeline_resource));
+if (r==NULL) {
+   fatal_alloc_error("new_pipeline_resource");
+}
+r->filename=name;
+r->type=type;
+r->resource=NULL;
+r->release=release;
+r->obsolete=0;
+r->users=0;
+r->size=0;
+r->next=pipeline_resources;
+pipeline_resources=r;
+return r;
+}
+
+
+/**
+ * Keeps the given resource of the given file, if the limit is not reached.
+ * 'first_load' tells whether it is kept even if its file has not been
+ * loaded before in the pipeline. 'users' is the number of tools that are
+ * using the structure. Returns 1 if the structure is kept, 0 otherwise.
+ */
+static int keep_resource(const char* filename,PipelineResourceType type,void* resource,
+                         release_pipeline_resource release,int first_load,int users) {
+if (pipeline_mutex==NULL || resource==NULL) return 0;
+long size=get_file_size(filename);
+char* name=normalize_filename(filename);
+SyncGetMutex(pipeline_mutex);
+struct pipeline_resource* r;
+for (r=pipeline_resources;r!=NULL;r=r->next) {
+   if (r->type==type && !r->obsolete && r->resource==NULL && !strcmp(r->filename,name)) {
+      break;
+   }
+}
+if (r==NULL) {
+   r=new_pipeline_resource(name,type,release);
+   if (!first_load) {
+      /* First load of this file: we only remember it */
+      SyncReleaseMutex(pipeline_mutex);
+      return 0;
+   }
+} else {
+   free(name);
+}
+int kept=0;
+if (size>=0 && pipeline_memory+size<=pipeline_memory_limit) {
+   pipeline_memory=pipeline_memory+size;
+   r->resource=resource;
+   r->users=users;
+   r->size=size;
+   kept=1;
+}
+SyncReleaseMutex(pipeline_mutex);
+return kept;
+}
+
+
+/**
+ * If a pipeline is active, the given structure may be kept until its file
+ * is modified or the pipeline ends, and will then be freed with 'release'.
+ * It is kept if its file has already been loaded in the pipeline, and if the
+ * limit is not reached. Returns 1 if the structure is kept, and 0 if the
+ * caller must free it as usual. In both cases, the caller frees it through
+ * a function that calls unuse_pipeline_resource first.
+ */
+static int pipeline_keep_resource(const char* filename,PipelineResourceType type,void* resource,release_pipeline_resource release) {
+return keep_resource(filename,type,resource,release,0,1);
+}
+
+
+/**
+ * The same as keep_pipeline_resource, but the structure is kept even if its
+ * file has not been loaded before, and the caller does not use it anymore.
+ * This is used for a structure built by the tool that has just saved the
+ * file, like the matches of Locate, which the next tool is about to read.
+ */
+static int pipeline_share_resource(const char* filename,PipelineResourceType type,void* resource,release_pipeline_resource release) {
+return keep_resource(filename,type,resource,release,1,0);
+}
+
+
+/**
+ * Tells that a tool does not use anymore a structure given by
+ * get_pipeline_resource or kept by keep_pipeline_resource. Returns 1 if the
+ * structure belongs to the pipeline, which means that the tool must not free
+ * it, and 0 otherwise. The structure is freed here if its file has been
+ * modified and no other tool uses it.
+ */
+static int pipeline_unuse_resource(const void* resource) {
+if (pipeline_mutex==NULL || resource==NULL) return 0;
+int found=0;
+struct pipeline_resource* unused=NULL;
+SyncGetMutex(pipeline_mutex);
+for (struct pipeline_resource** previous=&pipeline_resources;*previous!=NULL;previous=&((*previous)->next)) {
+   struct pipeline_resource* r=*previous;
+   if (r->resource==resource) {
+      found=1;
+      (r->users)--;
+      if (r->obsolete && r->users<=0 && r->release!=NULL) {
+         unused=remove_resource(previous);
+      }
+      break;
+   }
+}
+SyncReleaseMutex(pipeline_mutex);
+if (unused!=NULL) {
+   /* The structure is no longer in the list, so that its free
+    * function really frees it */
+   free_resource(unused);
+}
+return found;
+}
+
+
+/**
+ * Gives to the tools of the pipeline a structure built in memory, as if it
+ * had been loaded from the given file, which does not need to exist. The
+ * structure still belongs to the caller: it may modify it between two tools,
+ * and must call withdraw_pipeline_resource before freeing it. It does not
+ * count in the memory limit. Returns 1 if the structure is given, and 0 if no
+ * pipeline is active.
+ */
+static int pipeline_provide_resource(const char* filename,PipelineResourceType type,void* resource) {
+if (pipeline_mutex==NULL || resource==NULL) return 0;
+char* name=normalize_filename(filename);
+SyncGetMutex(pipeline_mutex);
+struct pipeline_resource* r=new_pipeline_resource(name,type,NULL);
+r->resource=resource;
+SyncReleaseMutex(pipeline_mutex);
+return 1;
+}
+
+
+/**
+ * Removes from the pipeline a structure given by provide_pipeline_resource.
+ */
+static void pipeline_withdraw_resource(const void* resource) {
+if (pipeline_mutex==NULL || resource==NULL) return;
+SyncGetMutex(pipeline_mutex);
+struct pipeline_resource** previous=&pipeline_resources;
+while (*previous!=NULL) {
+   struct pipeline_resource* r=*previous;
+   if (r->resource==resource && r->release==NULL) {
+      *previous=r->next;
+      free(r->filename);
+      free(r);
+   } else {
+      previous=&(r->next);
+   }
+}
+SyncReleaseMutex(pipeline_mutex);
+}
+
+
+static const t_pipeline_func_array pipeline_space_func_array={
+   pipeline_begin,
+   pipeline_end,
+   pipeline_is_active,
+   pipeline_set_memory_limit,
+   pipeline_get_resource,
+   pipeline_keep_resource,
+   pipeline_share_resource,
+   pipeline_unuse_resource,
+   pipeline_provide_resource,
+   pipeline_withdraw_resource,
+   pipeline_drop_file
+};
+
+
+/**
+ * The tools only see the functions of Pipeline.h through Af_stdio, so that
+ * the pipeline exists as soon as this file is linked, like the virtual
+ * file space.
+ */
+class AutoInstallPipelineSpace {
+public:
+   AutoInstallPipelineSpace() {
+      AddPipelineSpace(&pipeline_space_func_array);
+   }
+   ~AutoInstallPipelineSpace() {
+      RemovePipelineSpace(&pipeline_space_func_array);
+   }
+};
+
+static AutoInstallPipelineSpace auto_install_pipeline_space;
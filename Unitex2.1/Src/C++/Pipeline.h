@@ -0,0 +1,152 @@
+/*
+ * Unitex
+ *
+ * Copyright (C) 2001-2011 Université Paris-Est Marne-la-Vallée <unitex@univ-mlv.fr>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ *
+ */
+
+#ifndef PipelineH
+#define PipelineH
+
+#include "AbstractCallbackFuncModifier.h"
+#include "Af_stdio.h"
+
+/**
+ * When several tools are called in the same process (UnitexTool --pipeline { ... } { ... },
+ * or Dico calling Locate), they all load again the same alphabet, the same
+ * tokens.txt and the same dictionaries. Between BeginPipeline and EndPipeline,
+ * the structures loaded from these files are kept in memory and shared
+ * by all the tools, which do not free them anymore.
+ *
+ * A resource is no longer given to tools as soon as its file is written, renamed,
+ * copied over or removed through the af_ functions, so that a tool never sees
+ * an obsolete structure. The pipeline counts the tools that use each structure,
+ * which give it back with unuse_pipeline_resource (free_alphabet, free_text_tokens,
+ * ... do it), so that an obsolete structure is freed as soon as no tool uses it,
+ * and no longer counts in the memory limit. The files are identified by their
+ * absolute name, so that "./t_snt/concord.ind" and "t_snt/concord.ind" are the
+ * same file.
+ *
+ * A structure is only kept the second time its file is loaded, so that the
+ * files read once, like most of the dictionaries applied by Dico, do not stay
+ * in memory. The kept structures are also limited by the total size of their
+ * files, PIPELINE_MEMORY_LIMIT by default; beyond, the tools load and free
+ * them as usual.
+ *
+ * Two kinds of resources are shared in another way:
+ * - the matches that Locate saves in concord.ind are kept as soon as they are
+ *   saved, and Concord, Dico and Stats take a copy of them instead of parsing
+ *   the file again (see load_concord_ind). Since no tool keeps them, they are
+ *   freed as soon as concord.ind is written again;
+ * - the files mapped with map_pipeline_file, like text.cod, are mapped once
+ *   for all the tools. Since a mapped file cannot always be written, such
+ *   a mapping is closed as soon as its file is modified and no tool uses it.
+ *
+ * A tool that runs other tools, like Cassys, can also give them structures
+ * that it has built in memory with provide_pipeline_resource, as if they had
+ * been loaded from files that do not need to exist. These structures belong
+ * to the caller, which must withdraw them before freeing them. It can also
+ * free at once the structures of a file that it has consumed, like the matches
+ * of a concord.ind, with drop_pipeline_file.
+ *
+ * The pipeline must be started and ended in the main thread, but the
+ * resources can be looked for, kept and freed by several threads.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* BeginPipeline and EndPipeline can be nested. The resources are freed
+   by the EndPipeline that matches the first BeginPipeline.
+   They return 1 if successful and 0 otherwise */
+UNITEX_FUNC int UNITEX_CALL BeginPipeline();
+UNITEX_FUNC int UNITEX_CALL EndPipeline();
+UNITEX_FUNC int UNITEX_CALL IsPipelineActive();
+/* Sets the maximum total size in bytes of the files whose structures
+   are kept, for the current pipeline */
+UNITEX_FUNC void UNITEX_CALL SetPipelineMemoryLimit(long limit);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#define PIPELINE_MEMORY_LIMIT (256L*1024*1024)
+
+typedef enum {
+   PIPELINE_ALPHABET,
+   PIPELINE_KOREAN_ALPHABET,
+   PIPELINE_TEXT_TOKENS,
+   PIPELINE_INF_CODES,
+   PIPELINE_FST2,
+   PIPELINE_MATCHES,
+   PIPELINE_MAPPED_FILE
+} PipelineResourceType;
+
+typedef void (*release_pipeline_resource)(void*);
+
+void* get_pipeline_resource(const char* filename,PipelineResourceType type);
+int keep_pipeline_resource(const char* filename,PipelineResourceType type,void* resource,release_pipeline_resource release);
+int share_pipeline_resource(const char* filename,PipelineResourceType type,void* resource,release_pipeline_resource release);
+int unuse_pipeline_resource(const void* resource);
+int provide_pipeline_resource(const char* filename,PipelineResourceType type,void* resource);
+void withdraw_pipeline_resource(const void* resource);
+void drop_pipeline_file(const char* filename);
+
+
+/**
+ * The functions above are called by the loading functions of all the tools,
+ * but the pipeline itself is only linked in the programs that chain tools,
+ * like UnitexTool and Cassys. So, they are implemented in Af_stdio.cpp, which
+ * calls the functions installed by Pipeline.cpp at startup. When no pipeline
+ * is installed, there is never any active pipeline: BeginPipeline returns 0,
+ * nothing is shared and map_pipeline_file only maps the file.
+ */
+typedef struct {
+   int (*fnc_begin_pipeline)();
+   int (*fnc_end_pipeline)();
+   int (*fnc_is_pipeline_active)();
+   void (*fnc_set_pipeline_memory_limit)(long);
+   void* (*fnc_get_resource)(const char*,PipelineResourceType);
+   int (*fnc_keep_resource)(const char*,PipelineResourceType,void*,release_pipeline_resource);
+   int (*fnc_share_resource)(const char*,PipelineResourceType,void*,release_pipeline_resource);
+   int (*fnc_unuse_resource)(const void*);
+   int (*fnc_provide_resource)(const char*,PipelineResourceType,void*);
+   void (*fnc_withdraw_resource)(const void*);
+   void (*fnc_drop_file)(const char*);
+} t_pipeline_func_array;
+
+int AddPipelineSpace(const t_pipeline_func_array* func_array);
+int RemovePipelineSpace(const t_pipeline_func_array* func_array);
+
+
+/**
+ * A file mapped in memory with map_pipeline_file. 'buffer' is the content of
+ * the file, and 'size' its size in bytes. 'amf' is NULL for a buffer given
+ * with provide_pipeline_resource.
+ */
+struct pipeline_mapped_file {
+   ABSTRACTMAPFILE* amf;
+   const void* buffer;
+   size_t size;
+};
+
+struct pipeline_mapped_file* map_pipeline_file(const char* filename);
+void unmap_pipeline_file(struct pipeline_mapped_file* mapped_file);
+
+#endif
@@ -37,6 +37,7 @@
 #include "Error.h"
 #include "UnitexGetOpt.h"
 #include "PolyLex.h"
+#include "logger/SyncLogger.h"
 
 
 enum {DUTCH,GERMAN,NORWEGIAN,RUSSIAN};
@@ -55,6 +56,8 @@ const char* usage_PolyLex =
          "  -i INFO/--info=INFO: if this optional parameter is precised, it is taken as\n"
          "                       the name of a file which will contain information about\n"
          "                       the analysis\n"
+         "  --threads=N: uses N threads to analyse the words (default=1). If N is 0,\n"
+         "               one thread is used per processor. Not available for Russian\n"
          "  -h/--help: this help\n"
          "\n"
          "Language options:\n"
@@ -88,6 +91,7 @@ const struct option_TS lopts_PolyLex[]= {
       {"info",required_argument_TS,NULL,'i'},
       {"input_encoding",required_argument_TS,NULL,'k'},
       {"output_encoding",required_argument_TS,NULL,'q'},
+      {"threads",required_argument_TS,NULL,1},
       {"help",no_argument_TS,NULL,'h'},
       {NULL,no_argument_TS,NULL,0}
 };
@@ -108,6 +112,8 @@ char info[FILENAME_MAX]="";
 Encoding encoding_output = DEFAULT_ENCODING_OUTPUT;
 int bom_output = DEFAULT_BOM_OUTPUT;
 int mask_encoding_compatibility_input = DEFAULT_MASK_ENCODING_COMPATIBILITY_INPUT;
+int n_threads=1;
+char foo;
 int val,index=-1;
 struct OptVars* vars=new_OptVars();
 while (EOF!=(val=getopt_long_TS(argc,argv,optstring_PolyLex,lopts_PolyLex,&index,vars))) {
@@ -146,6 +152,10 @@ while (EOF!=(val=getopt_long_TS(argc,argv,optstring_PolyLex,lopts_PolyLex,&index
              }
              decode_writing_encoding_parameter(&encoding_output,&bom_output,vars->optarg);
              break;
+   case 1: if (1!=sscanf(vars->optarg,"%d%c",&n_threads,&foo) || n_threads<0) {
+                fatal_error("Invalid number of threads: %s\n",vars->optarg);
+             }
+             break;
    case 'h': usage(); return 0;
    case ':': if (index==-1) fatal_error("Missing argument for option -%c\n",vars->optopt);
              else fatal_error("Missing argument for option --%s\n",lopts_PolyLex[index].name);
@@ -169,6 +179,15 @@ if (output[0]=='\0') {
 if (language==-1) {
    fatal_error("You must specify the language\n");
 }
+if (language==RUSSIAN && n_threads!=1) {
+   fatal_error("The --threads option is not available for Russian\n");
+}
+if (n_threads<=0) {
+   n_threads=(int)SyncGetNumberOfProcessors();
+}
+if (n_threads>1 && !IsSeveralThreadsPossible()) {
+   n_threads=1;
+}
 
 Alphabet* alph=NULL;
 if (alphabet[0]!='\0') {
@@ -254,9 +273,9 @@ if (info!=NULL) {
 struct utags UTAG;
 
 switch(language) {
-case DUTCH: analyse_dutch_unknown_words(alph,bin,inf,words,res,debug,new_unknown_words,forbiddenWords); break;
-case GERMAN: analyse_german_compounds(alph,bin,inf,words,res,debug,new_unknown_words); break;
-case NORWEGIAN: analyse_norwegian_unknown_words(alph,bin,inf,words,res,debug,new_unknown_words,forbiddenWords); break;
+case DUTCH: analyse_dutch_unknown_words(alph,bin,inf,words,res,debug,new_unknown_words,forbiddenWords,n_threads); break;
+case GERMAN: analyse_german_compounds(alph,bin,inf,words,res,debug,new_unknown_words,n_threads); break;
+case NORWEGIAN: analyse_norwegian_unknown_words(alph,bin,inf,words,res,debug,new_unknown_words,forbiddenWords,n_threads); break;
 case RUSSIAN:
    init_russian(&UTAG);
    analyse_compounds(alph,bin,inf,words,res,debug,new_unknown_words,UTAG);
@@ -131,6 +131,10 @@ char output_tfst[FILENAME_MAX];
 sprintf(output_tfst, "%s.new.tfst",input_tfst);
 char output_tind[FILENAME_MAX];
 sprintf(output_tind, "%s.new.tind",input_tfst);
+char input_tfstb[FILENAME_MAX];
+get_tfst_binary_name(input_tfst,input_tfstb);
+char output_tfstb[FILENAME_MAX];
+sprintf(output_tfstb, "%s.new.tfstb",input_tfst);
 
 U_FILE* f_tfst;
 if ((f_tfst = u_fopen_creating_unitex_text_format(encoding_output,bom_output,output_tfst,U_WRITE)) == NULL) {
@@ -141,6 +145,7 @@ if ((f_tind = u_fopen(BINARY,output_tind,U_WRITE)) == NULL) {
    u_fclose(f_tfst);
    fatal_error("Unable to open %s for writing\n", output_tind);
 }
+struct tfst_binary_writer* f_tfstb=new_tfst_binary_writer(output_tfstb);
 /* We use this hash table to rebuild files tfst_tags_by_freq/alph.txt */
 struct hash_table* form_frequencies=new_hash_table((HASH_FUNCTION)hash_unichar,(EQUAL_FUNCTION)u_equal,
         (FREE_FUNCTION)free,NULL,(KEYCOPY_FUNCTION)keycopy);
@@ -175,7 +180,7 @@ for (int i = 1; i <= tfst->N; i++) {
          error("Error: %s is not a valid sentence automaton\n",grfname);
       }
    }
-   save_current_sentence(tfst,f_tfst,f_tind,tags,n_tags,form_frequencies);
+   save_current_sentence(tfst,f_tfst,f_tind,f_tfstb,tags,n_tags,form_frequencies);
    if (tags!=NULL) {
       /* If necessary, we free the tags we created */
       for (int count_tags=0;count_tags<n_tags;count_tags++) {
@@ -188,6 +193,7 @@ u_printf("Text automaton rebuilt.\n");
 close_text_automaton(tfst);
 u_fclose(f_tfst);
 u_fclose(f_tind);
+close_tfst_binary_writer(f_tfstb,output_tfst);
 
 /* Finally, we save statistics */
 char tfst_tags_by_freq[FILENAME_MAX];
@@ -221,6 +227,11 @@ af_rename(input_tfst,backup_tfst);
 af_rename(input_tind,backup_tind);
 af_rename(output_tfst,input_tfst);
 af_rename(output_tind,input_tind);
+/* The .tfstb is not backed up, since it can only be used with its .tfst */
+af_remove(input_tfstb);
+if (f_tfstb!=NULL) {
+   af_rename(output_tfstb,input_tfstb);
+}
 u_printf("\nYou can find a backup of the original files in:\n    %s\nand %s\n",
          backup_tfst,backup_tind);
 free_OptVars(vars);
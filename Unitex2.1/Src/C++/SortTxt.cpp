@@ -30,6 +30,8 @@
 #include "UnitexGetOpt.h"
 #include "SortTxt.h"
 #include "ProgramInvoker.h"
+#include "AbstractCallbackFuncModifier.h"
+#include "logger/SyncLogger.h"
 
 
 #define DEFAULT 0
@@ -832,3 +834,219 @@ couple->next=insert_string_thai(line,couple->next,inf);
 return couple;
 }
 
+
+
+/**
+ * A line to be sorted in memory, with its precomputed collation key. The key
+ * contains one weight per character, followed by 0. A weight is the character
+ * code for a non letter, and 0x10000+class number for a letter, so that comparing
+ * weights gives the same order as walking down the sort tree.
+ */
+struct sort_record {
+   unichar* line;
+   unsigned int* key;
+};
+
+
+/**
+ * Information shared by the threads that sort parts of the lines.
+ */
+struct sort_chunk {
+   struct sort_record* records;
+   struct sort_record* tmp;
+   int n;
+   int thai;
+   struct sort_infos* inf;
+};
+
+
+static unsigned int* compute_collation_key(const unichar* line,int thai,const struct sort_infos* inf) {
+unichar thai_line[LINE_LENGTH];
+if (thai) {
+   convert_thai((unichar*)line,thai_line);
+   line=thai_line;
+}
+int length=u_strlen(line);
+unsigned int* key=(unsigned int*)malloc((length+1)*sizeof(unsigned int));
+if (key==NULL) {
+   fatal_alloc_error("compute_collation_key");
+}
+for (int i=0;i<length;i++) {
+   unichar c=line[i];
+   key[i]=(inf->class_numbers[c]!=0)?(0x10000+inf->class_numbers[c]):c;
+}
+key[length]=0;
+return key;
+}
+
+
+/**
+ * Compares two records like the sort tree does: first on the keys, a line that
+ * is a prefix of the other one coming first, then on the actual characters
+ * when the keys are equal. Returns 0 only if the lines are identical.
+ */
+static int compare_records(const struct sort_record* a,const struct sort_record* b,int thai,const struct sort_infos* inf) {
+const unsigned int* ka=a->key;
+const unsigned int* kb=b->key;
+int i=0;
+while (ka[i]!=0 && ka[i]==kb[i]) i++;
+if (ka[i]!=kb[i]) {
+   if (ka[i]==0) return -1;
+   if (kb[i]==0) return 1;
+   return (ka[i]<kb[i])?-(inf->REVERSE):inf->REVERSE;
+}
+if (thai) {
+   return inf->REVERSE*u_strcmp(a->line,b->line);
+}
+i=0;
+while (a->line[i] && a->line[i]==b->line[i]) i++;
+return inf->REVERSE*(inf->priority[a->line[i]]-inf->priority[b->line[i]]);
+}
+
+
+/**
+ * Merges the sorted arrays src[0..middle[ and src[middle..n[ into dest.
+ */
+static void merge_records(struct sort_record* src,int middle,int n,struct sort_record* dest,int thai,const struct sort_infos* inf) {
+int i=0,j=middle,k=0;
+while (i<middle && j<n) {
+   if (compare_records(&(src[j]),&(src[i]),thai,inf)<0) dest[k++]=src[j++];
+   else dest[k++]=src[i++];
+}
+while (i<middle) dest[k++]=src[i++];
+while (j<n) dest[k++]=src[j++];
+}
+
+
+/**
+ * Merge sort of the given records, using 'tmp' as a work area of the same size.
+ */
+static void merge_sort_records(struct sort_record* t,struct sort_record* tmp,int n,int thai,const struct sort_infos* inf) {
+if (n<16) {
+   /* Insertion sort for small arrays */
+   for (int i=1;i<n;i++) {
+      struct sort_record r=t[i];
+      int j=i-1;
+      while (j>=0 && compare_records(&r,&(t[j]),thai,inf)<0) {
+         t[j+1]=t[j];
+         j--;
+      }
+      t[j+1]=r;
+   }
+   return;
+}
+int middle=n/2;
+merge_sort_records(t,tmp,middle,thai,inf);
+merge_sort_records(t+middle,tmp+middle,n-middle,thai,inf);
+merge_records(t,middle,n,tmp,thai,inf);
+memcpy(t,tmp,n*sizeof(struct sort_record));
+}
+
+
+static void SYNC_CALLBACK_UNITEX sort_chunk_thread(void* privateDataPtr,unsigned int /*iNbThread*/) {
+struct sort_chunk* chunk=(struct sort_chunk*)privateDataPtr;
+for (int i=0;i<chunk->n;i++) {
+   chunk->records[i].key=compute_collation_key(chunk->records[i].line,chunk->thai,chunk->inf);
+}
+merge_sort_records(chunk->records,chunk->tmp,chunk->n,chunk->thai,chunk->inf);
+}
+
+
+/* Under this number of lines, it's not worth starting threads */
+#define MIN_LINES_PER_SORT_THREAD 20000
+
+
+/**
+ * Sorts the given lines in memory with the same order as the SortTxt program:
+ * 'lines' is sorted in place, and the number of remaining lines is returned.
+ * Empty lines and lines that are too long are ignored, as well as duplicates
+ * if 'remove_duplicates' is non null. Ignored lines are freed.
+ *
+ * The lines are split into chunks that are sorted by 'n_threads' threads
+ * and then merged.
+ */
+int sort_lines_in_memory(unichar** lines,int n,int remove_duplicates,int reverse,char* sort_order,
+                         int mask_encoding_compatibility_input,int thai,unsigned int n_threads) {
+struct sort_infos* inf=new_sort_infos();
+/* We don't use the sort tree */
+free_sort_tree_node(inf->root);
+inf->root=NULL;
+if (reverse) inf->REVERSE=-1;
+if (sort_order!=NULL && sort_order[0]!='\0') {
+   read_char_order(sort_order,mask_encoding_compatibility_input,inf);
+}
+struct sort_record* records=(struct sort_record*)malloc((n+1)*sizeof(struct sort_record));
+struct sort_record* tmp=(struct sort_record*)malloc((n+1)*sizeof(struct sort_record));
+if (records==NULL || tmp==NULL) {
+   fatal_alloc_error("sort_lines_in_memory");
+}
+int N=0;
+for (int i=0;i<n;i++) {
+   int length=u_strlen(lines[i]);
+   if (length==0 || length>=LINE_LENGTH) {
+      if (length!=0) {
+         error("Line %d: line too long\n",i+1);
+      }
+      free(lines[i]);
+      continue;
+   }
+   records[N].line=lines[i];
+   records[N].key=NULL;
+   N++;
+}
+if (n_threads<1 || !IsSeveralThreadsPossible()) {
+   n_threads=1;
+}
+if ((unsigned int)N<n_threads*MIN_LINES_PER_SORT_THREAD) {
+   n_threads=1+N/MIN_LINES_PER_SORT_THREAD;
+}
+struct sort_chunk* chunks=(struct sort_chunk*)malloc(n_threads*sizeof(struct sort_chunk));
+void** chunk_ptrs=(void**)malloc(n_threads*sizeof(void*));
+if (chunks==NULL || chunk_ptrs==NULL) {
+   fatal_alloc_error("sort_lines_in_memory");
+}
+int start=0;
+for (unsigned int i=0;i<n_threads;i++) {
+   int end=(int)(((long long)N*(i+1))/n_threads);
+   chunks[i].records=records+start;
+   chunks[i].tmp=tmp+start;
+   chunks[i].n=end-start;
+   chunks[i].thai=thai;
+   chunks[i].inf=inf;
+   chunk_ptrs[i]=&(chunks[i]);
+   start=end;
+}
+if (n_threads==1) {
+   sort_chunk_thread(chunk_ptrs[0],0);
+} else {
+   SyncDoRunThreads(n_threads,sort_chunk_thread,chunk_ptrs);
+}
+/* Then we merge the sorted chunks two by two */
+for (unsigned int step=1;step<n_threads;step=step*2) {
+   for (unsigned int i=0;i+step<n_threads;i=i+2*step) {
+      unsigned int last=(i+2*step<n_threads)?(i+2*step):n_threads;
+      int first_n=(int)(chunks[i+step].records-chunks[i].records);
+      int total=(int)(chunks[last-1].records+chunks[last-1].n-chunks[i].records);
+      merge_records(chunks[i].records,first_n,total,chunks[i].tmp,thai,inf);
+      memcpy(chunks[i].records,chunks[i].tmp,total*sizeof(struct sort_record));
+   }
+}
+free(chunk_ptrs);
+free(chunks);
+/* Finally, we copy back the lines, removing duplicates if needed */
+int result=0;
+for (int i=0;i<N;i++) {
+   if (remove_duplicates && result>0 && !compare_records(&(records[i]),&(records[i-1]),thai,inf)) {
+      free(records[i].line);
+   } else {
+      lines[result++]=records[i].line;
+   }
+}
+for (int i=0;i<N;i++) {
+   free(records[i].key);
+}
+free(records);
+free(tmp);
+free_sort_infos(inf);
+return result;
+}
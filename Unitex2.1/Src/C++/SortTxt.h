@@ -22,6 +22,7 @@
 #ifndef SortTxtH
 #define SortTxtH
 
+#include "Unicode.h"
 #include "FileEncoding.h"
 
 extern const char* optstring_SortTxt;
@@ -31,6 +32,8 @@ extern const char* usage_SortTxt;
 int main_SortTxt(int argc,char* const argv[]);
 int pseudo_main_SortTxt(Encoding encoding_output,int bom_output,int mask_encoding_compatibility_input,
                         int duplicates,int reverse,char* sort_alphabet,char* line_info,int thai,char*);
+int sort_lines_in_memory(unichar** lines,int n,int remove_duplicates,int reverse,char* sort_order,
+                         int mask_encoding_compatibility_input,int thai,unsigned int n_threads);
 
 #endif
 
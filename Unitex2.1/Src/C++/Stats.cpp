@@ -24,18 +24,21 @@
 #include "Copyright.h"
 #include "Text_tokens.h"
 #include "LocateMatches.h"
+#include "Pipeline.h"
 #include "HashTable.h"
 #include "Vector.h"
 #include "Alphabet.h"
 #include "UnitexGetOpt.h"
+#include "AbstractCallbackFuncModifier.h"
+#include "logger/SyncLogger.h"
 
 #include "Stats.h"
 
 // main work functions
 
 void concord_stats(const char* , int , const char *, const char* , const char* , const char*, Encoding, int, int, int , int, int );
-void build_counted_concord(match_list* , text_tokens* , U_FILE* , Alphabet*, int , int , int, vector_ptr** , hash_table** );
-void build_counted_collocates(match_list* , text_tokens* , U_FILE* , Alphabet*, int , int , int, vector_int** , hash_table** , hash_table** , hash_table** );
+void build_counted_concord(match_list* , const struct stats_context* , vector_ptr** , hash_table** );
+void build_counted_collocates(match_list* , const struct stats_context* , vector_int** , hash_table** , hash_table** , hash_table** );
 
 // ...main work functions
 
@@ -64,6 +67,45 @@ struct counted_match_descriptor
 	int rightStartsAt;
 };
 
+// data shared by all the threads: text.cod is mapped in memory
+
+struct stats_context
+{
+	const int* cod;
+	long codSize;
+	text_tokens* tokens;
+	Alphabet* alphabet;
+	int leftContext;
+	int rightContext;
+	int caseSensitive;
+};
+
+// a part of the matches, counted by one thread into its own hash table
+
+struct stats_job
+{
+	const stats_context* context;
+	match_list* firstMatch;
+	int nbMatches;
+	int withWindow;
+	vector_ptr* concordMatches;
+	vector_int* collocates;
+	hash_table* counts;
+	int totalWindow;
+	int wordsTakenByMatches;
+};
+
+// a part of text.cod, counted by one thread
+
+struct corpus_job
+{
+	const stats_context* context;
+	long start;
+	long end;
+	int* countPerToken;
+	int corporaLength;
+};
+
 // ... structs
 
 
@@ -72,10 +114,9 @@ inline int min_int(int, int);
 inline int max_int(int, int);
 inline long min_long(long, long);
 inline long max_long(long, long);
-vector_int* get_string_in_context_as_token_list(match_list*, int, int, int**, long*, long*, long, text_tokens*, U_FILE*, int, counted_match_descriptor*);
+vector_int* get_string_in_context_as_token_list(match_list*, int, int, const stats_context*, int, counted_match_descriptor*);
 void print_string_token_list_with_count(U_FILE*,vector_int*, text_tokens*, counted_match_descriptor*);
-void get_buffer_around_token(U_FILE*, int**, long, long, long, long*, long*);
-void count_collocates(U_FILE* , text_tokens* , Alphabet*, int, hash_table* , hash_table** , int* );
+void count_collocates(const stats_context*, hash_table* , hash_table** , int* );
 int is_appropriate_token(int tokenID, text_tokens* tokens);
 
  // sort helper functions
@@ -113,7 +154,9 @@ int is_appropriate_token(int tokenID, text_tokens* tokens);
 // ...local helper functions
 
 
-#define STATS_BUFFER_LENGTH 4096
+// below these sizes, it is not worth starting more threads
+#define STATS_MIN_MATCHES_PER_THREAD 1000
+#define STATS_MIN_TOKENS_PER_THREAD 1000000
 
 
 const char* usage_Stats =
@@ -253,17 +296,28 @@ return 0;
  * leftContext and rightContext are number of non-space tokens to look to the left and right from the
  * match to build string for counting. The function is_appropriate_token makes distinction between
  * "space"-like and "regular" tokens to include.
+ *
+ * text.cod is mapped in memory, and matches are counted by several threads
+ * whose partial results are merged.
  */
 void concord_stats(const char* outfilename,int mode, const char *concordfname, const char* tokens_path, const char* codname,
 				   const char* alphabetName, 
                    Encoding encoding_output,int bom_output,int mask_encoding_compatibility_input,
                    int leftContext, int rightContext, int caseSensitive)
 {
-	U_FILE* concord = u_fopen_existing_versatile_encoding(mask_encoding_compatibility_input, concordfname, U_READ);
 	U_FILE* outfile = (outfilename == NULL) ? U_STDOUT : u_fopen_creating_versatile_encoding(encoding_output,bom_output, outfilename, U_WRITE);
-	U_FILE* cod = u_fopen(BINARY, codname, U_READ);
-	match_list* matches = load_match_list(concord, NULL);
-	u_fclose(concord);
+	/* In a pipeline, text.cod may already be mapped, and the matches
+	 * that Locate has just saved are taken from memory */
+	struct pipeline_mapped_file* cod = map_pipeline_file(codname);
+	if (cod == NULL)
+	{
+		fatal_error("Cannot open %s\n", codname);
+	}
+	match_list* matches;
+	if (!load_concord_ind(concordfname, mask_encoding_compatibility_input, &matches, NULL))
+	{
+		fatal_error("Cannot open %s\n", concordfname);
+	}
 
 
 	text_tokens* tokens = load_text_tokens(tokens_path,mask_encoding_compatibility_input);
@@ -281,6 +335,15 @@ void concord_stats(const char* outfilename,int mode, const char *concordfname, c
 	   }
 	}
 
+	stats_context context;
+	context.cod = (const int*)cod->buffer;
+	context.codSize = (long)(cod->size / sizeof(int));
+	context.tokens = tokens;
+	context.alphabet = alphabet;
+	context.leftContext = leftContext;
+	context.rightContext = rightContext;
+	context.caseSensitive = caseSensitive;
+
 	int i;
 	any* hash_val;
 	counted_match_descriptor* descriptor;
@@ -290,7 +353,8 @@ void concord_stats(const char* outfilename,int mode, const char *concordfname, c
 		vector_ptr* allMatches;
 		hash_table* countsPerMatch;
 
-		build_counted_concord(matches, tokens, cod, alphabet, leftContext, rightContext, caseSensitive, &allMatches, &countsPerMatch);
+		build_counted_concord(matches, &context, &allMatches, &countsPerMatch);
+
 		// now we sort
 		sort_matches_ptr(allMatches->tab, 0, allMatches->nbelems-1, swap_ptr, compare_ptr, countsPerMatch, NULL, -1);
 		// and then print
@@ -314,7 +378,7 @@ void concord_stats(const char* outfilename,int mode, const char *concordfname, c
 		vector_int* allMatches;
 		hash_table* countsPerMatch;
 
-		build_counted_collocates(matches, tokens, cod, alphabet, leftContext, rightContext, caseSensitive, &allMatches, &countsPerMatch, NULL, NULL);
+		build_counted_collocates(matches, &context, &allMatches, &countsPerMatch, NULL, NULL);
 
 		// now we sort
 
@@ -350,7 +414,7 @@ void concord_stats(const char* outfilename,int mode, const char *concordfname, c
 		hash_table* z_score;
 		hash_table* countInCorpora;
 
-		build_counted_collocates(matches, tokens, cod, alphabet, leftContext, rightContext, caseSensitive, &allMatches, &countsPerMatch, &z_score, &countInCorpora);
+		build_counted_collocates(matches, &context, &allMatches, &countsPerMatch, &z_score, &countInCorpora);
 
 		// now we sort
 
@@ -401,7 +465,7 @@ void concord_stats(const char* outfilename,int mode, const char *concordfname, c
 	}
 
 
-	u_fclose(cod);
+	unmap_pipeline_file(cod);
 	if (outfilename != NULL)
 		u_fclose(outfile);
 	free_text_tokens(tokens);
@@ -418,54 +482,125 @@ void concord_stats(const char* outfilename,int mode, const char *concordfname, c
 }
 
 /**
- * This function builds all strings that are based on matches found in original text surrounded with
- * left and right context. It outputs a vector and a hash table - vector contains distinct strings
- * found, and these strings are key to the hash table containing count per string in corpora. Strings
- * are represented by integer vector containing token IDs.
+ * Returns the number of threads to use for the given amount of work, so that
+ * each thread has at least minPerThread items to process.
  */
-void build_counted_concord(match_list* matches, text_tokens* tokens, U_FILE* cod, Alphabet* alphabet, int leftContext, int rightContext, int caseSensitive, vector_ptr** ret_vector, hash_table** ret_hash)
+unsigned int get_stats_thread_count(long work, long minPerThread)
 {
-	if (ret_vector == NULL)
+	unsigned int n = SyncGetNumberOfProcessors();
+
+	if (n < 1 || !IsSeveralThreadsPossible())
 	{
-		fatal_error("Fatal error in build_counted_concord, ret_vector cannot be NULL!");
+		n = 1;
 	}
 
-	if (ret_hash == NULL)
+	if (work < (long)n * minPerThread)
 	{
-		fatal_error("Fatal error in build_counted_concord, ret_hash cannot be NULL!");
+		n = (unsigned int)(1 + work / minPerThread);
 	}
+	return n;
+}
 
-	long codSize = get_file_size(cod) / sizeof(int);
-	int *buffer = NULL;
+/**
+ * This function splits the match list into parts of consecutive matches, and runs
+ * thread_func on each of them. It returns the array of jobs, whose size is stored
+ * in nbJobs. Since parts are consecutive, merging the partial results in job order
+ * gives the same result as a single pass on the whole list.
+ *
+ * In case-insensitive mode, keys are not an equivalence relation (with "a" and "à"
+ * both equal to "A", the key that counts "A" depends on which one was met first),
+ * so that we stay with a single pass to get the same results in any case.
+ */
+stats_job* run_stats_jobs(match_list* matches, const stats_context* context, t_thread_func thread_func, int withWindow, unsigned int* nbJobs)
+{
+	int nbMatches = 0;
+	match_list* current_match;
+
+	for (current_match = matches ; current_match != NULL ; current_match = current_match->next)
+	{
+		nbMatches++;
+	}
+
+	unsigned int n = context->caseSensitive ? get_stats_thread_count(nbMatches, STATS_MIN_MATCHES_PER_THREAD) : 1;
+
+	stats_job* jobs = (stats_job*)malloc(n * sizeof(stats_job));
+	void** jobPtrs = (void**)malloc(n * sizeof(void*));
+
+	if (jobs == NULL || jobPtrs == NULL)
+	{
+		fatal_alloc_error("run_stats_jobs");
+	}
+
+	unsigned int j;
+	int i, done = 0;
+	current_match = matches;
+
+	for (j = 0 ; j < n ; j++)
+	{
+		int end = (int)(((long long)nbMatches * (j + 1)) / n);
+		jobs[j].context = context;
+		jobs[j].firstMatch = current_match;
+		jobs[j].nbMatches = end - done;
+		jobs[j].withWindow = withWindow;
+		jobs[j].concordMatches = NULL;
+		jobs[j].collocates = NULL;
+		jobs[j].counts = NULL;
+		jobs[j].totalWindow = 0;
+		jobs[j].wordsTakenByMatches = 0;
+		jobPtrs[j] = &(jobs[j]);
+
+		for (i = done ; i < end ; i++)
+		{
+			current_match = current_match->next;
+		}
+		done = end;
+	}
+
+	if (n == 1)
+	{
+		thread_func(jobPtrs[0], 0);
+	}
+	else
+	{
+		SyncDoRunThreads(n, thread_func, jobPtrs);
+	}
 
-	long buff_start, buff_end;
+	free(jobPtrs);
+	*nbJobs = n;
+	return jobs;
+}
 
-	// we initialize buffer to encompass 4096 tokens from starting position
-	get_buffer_around_token(cod, &buffer, 0, 0, STATS_BUFFER_LENGTH, &buff_start, &buff_end);
+/**
+ * Counts the strings built from a part of the matches (see build_counted_concord).
+ */
+void SYNC_CALLBACK_UNITEX count_concord_job(void* privateDataPtr, unsigned int /*iNbThread*/)
+{
+	stats_job* job = (stats_job*)privateDataPtr;
+	const stats_context* context = job->context;
 
 	any* hash_val;
 	int hash_ret;
 
-	vector_ptr* allMatches = new_vector_ptr();
-	hash_table* countPerMatch = new_hash_table(hash_vector_int, vectors_equal, free_vec, free,copy_vec);
+	job->concordMatches = new_vector_ptr();
+	job->counts = new_hash_table(hash_vector_int, vectors_equal, free_vec, free,copy_vec);
 	vector_int* currentMatchList;
 	vec_CS_tag* currentKey;
 
-	match_list* current_match = matches;
+	match_list* current_match = job->firstMatch;
 
 	counted_match_descriptor* descriptor;
 	counted_match_descriptor tmpDescriptor;
 
-	int i = 0;
+	int i;
 
 	// for all matches, we form list of token IDs and check it against hash table
-	while(current_match != NULL)
+	for (i = 0 ; i < job->nbMatches ; i++)
 	{
-		currentMatchList = get_string_in_context_as_token_list(current_match, leftContext, rightContext, &buffer, &buff_start, &buff_end, codSize, tokens, cod, 1, &tmpDescriptor);
+		currentMatchList = get_string_in_context_as_token_list(current_match, context->leftContext, context->rightContext, context, 1, &tmpDescriptor);
 
-		currentKey = new_vec_CS_tag(currentMatchList, caseSensitive, tokens, alphabet);
+		currentKey = new_vec_CS_tag(currentMatchList, context->caseSensitive, context->tokens, context->alphabet);
 
-		hash_val = get_value(countPerMatch, currentKey, HT_INSERT_IF_NEEDED, &hash_ret);
+		hash_val = get_value(job->counts, currentKey, HT_INSERT_IF_NEEDED, &hash_ret);
 
 		if (hash_ret == HT_KEY_ADDED)
 		{
@@ -478,7 +613,7 @@ void build_counted_concord(match_list* matches, text_tokens* tokens, U_FILE* cod
 			descriptor->rightStartsAt = tmpDescriptor.rightStartsAt;
 			hash_val->_ptr = descriptor;
 
-			vector_ptr_add(allMatches, currentKey);
+			vector_ptr_add(job->concordMatches, currentKey);
 		}
 		else
 		{
@@ -489,68 +624,114 @@ void build_counted_concord(match_list* matches, text_tokens* tokens, U_FILE* cod
 		}
 
 		current_match = current_match->next;
-		i++;
 	}
+}
 
-	free(buffer);
+/**
+ * Merges the results of all jobs into the first one. A string that is new for the
+ * first job keeps the descriptor of its first occurrence, and is added at the end of
+ * the vector, so that the order is the one of a single pass on all matches.
+ */
+void merge_counted_concord(stats_job* jobs, unsigned int nbJobs)
+{
+	unsigned int j;
+	int i, hash_ret;
+	any* hash_val;
+	any* partial_val;
+	vec_CS_tag* currentKey;
+	counted_match_descriptor* descriptor;
 
-	*ret_vector = allMatches;
-	*ret_hash = countPerMatch;
+	for (j = 1 ; j < nbJobs ; j++)
+	{
+		for (i = 0 ; i < jobs[j].concordMatches->nbelems ; i++)
+		{
+			currentKey = (vec_CS_tag*)jobs[j].concordMatches->tab[i];
+			partial_val = get_value(jobs[j].counts, currentKey, HT_DONT_INSERT);
+			descriptor = (counted_match_descriptor*)partial_val->_ptr;
+
+			hash_val = get_value(jobs[0].counts, currentKey, HT_INSERT_IF_NEEDED, &hash_ret);
+
+			if (hash_ret == HT_KEY_ADDED)
+			{
+				// the descriptor and the key now belong to the first job
+				hash_val->_ptr = descriptor;
+				partial_val->_ptr = NULL;
+				vector_ptr_add(jobs[0].concordMatches, currentKey);
+			}
+			else
+			{
+				((counted_match_descriptor*)hash_val->_ptr)->countOfMatch += descriptor->countOfMatch;
+				free_vec_CS_tag(currentKey);
+			}
+		}
+
+		free_vector_ptr(jobs[j].concordMatches, NULL);
+		free_hash_table(jobs[j].counts);
+	}
 }
 
 /**
- * This function performs collocates count. It has two modes of operation, corresponding to modes 1 and
- * 2 of main program. In mode 1, it only looks at tokens in left and right context and counts them
- * each time they appear in the context of a match. In this mode, it returns an int vector containing
- * all possible tokens found in left and right context of a match, as well as hash table containing
- * counts per tokens in context. In mode 2, it returns additional 2 hash tables, z_score hash table which
- * represents z-score of a collocate and countsInCorpora hash table which returns total count of a token
- * found in context of a match in the whole corpora.
+ * This function builds all strings that are based on matches found in original text surrounded with
+ * left and right context. It outputs a vector and a hash table - vector contains distinct strings
+ * found, and these strings are key to the hash table containing count per string in corpora. Strings
+ * are represented by integer vector containing token IDs.
  */
-void build_counted_collocates(match_list* matches, text_tokens* tokens, U_FILE* cod, Alphabet* alphabet, int leftContext, int rightContext, int caseSensitive, vector_int** ret_vector, hash_table** ret_hash, hash_table** z_score, hash_table** countsInCorpora)
+void build_counted_concord(match_list* matches, const stats_context* context, vector_ptr** ret_vector, hash_table** ret_hash)
 {
 	if (ret_vector == NULL)
 	{
-		fatal_error("Fatal error in build_counted_collocates, ret_vector cannot be NULL!");
+		fatal_error("Fatal error in build_counted_concord, ret_vector cannot be NULL!");
 	}
 
 	if (ret_hash == NULL)
 	{
-		fatal_error("Fatal error in build_counted_collocates, ret_hash cannot be NULL!");
+		fatal_error("Fatal error in build_counted_concord, ret_hash cannot be NULL!");
 	}
 
-	long codSize = get_file_size(cod) / sizeof(int);
-	int *buffer = NULL;
+	unsigned int nbJobs;
+	stats_job* jobs = run_stats_jobs(matches, context, count_concord_job, 0, &nbJobs);
+
+	merge_counted_concord(jobs, nbJobs);
+
+	*ret_vector = jobs[0].concordMatches;
+	*ret_hash = jobs[0].counts;
 
-	long buff_start, buff_end;
+	free(jobs);
+}
 
-	// we initialize buffer to encompass 4096 tokens from starting position
-	get_buffer_around_token(cod, &buffer, 0, 0, STATS_BUFFER_LENGTH, &buff_start, &buff_end);
+/**
+ * Counts the collocates found in the context of a part of the matches
+ * (see build_counted_collocates).
+ */
+void SYNC_CALLBACK_UNITEX count_collocates_job(void* privateDataPtr, unsigned int /*iNbThread*/)
+{
+	stats_job* job = (stats_job*)privateDataPtr;
+	const stats_context* context = job->context;
+	text_tokens* tokens = context->tokens;
 
 	any* hash_val;
 	int hash_ret;
 
-	int i;
+	int i, j;
 
-	vector_int* allMatches = new_vector_int();
-	hash_table* countPerCollocate = new_hash_table(hash_token_as_int, tokens_as_int_equal,
+	job->collocates = new_vector_int();
+	job->counts = new_hash_table(hash_token_as_int, tokens_as_int_equal,
 					free_token_as_int, NULL, copy_token_as_int);
 	vector_int* currentMatchList;
 	vector_int* tmpMatchList;
 
-	match_list* current_match = matches;
+	match_list* current_match = job->firstMatch;
 
-	hash_table* collocateCountInCorpora;
-	int totalMatches = 0;
-	int corporaLength;
-	int wordsTakenByMatches = 0;
-	int totalWindow = 0;
-	int_CS_tag* currentKey;
+	// the key is copied by the hash table when it is inserted
+	int_CS_tag currentKey;
+	currentKey.CStag = context->caseSensitive;
+	currentKey.tokens = context->tokens;
+	currentKey.alphabet = context->alphabet;
 
 	// for all matches, we form list of token IDs and check it against hash table
-	while(current_match != NULL)
+	for (j = 0 ; j < job->nbMatches ; j++)
 	{
-		currentMatchList = get_string_in_context_as_token_list(current_match, leftContext, rightContext, &buffer, &buff_start, &buff_end, codSize, tokens, cod, 0, NULL);
+		currentMatchList = get_string_in_context_as_token_list(current_match, context->leftContext, context->rightContext, context, 0, NULL);
 
 		// now we don't just insert the whole match as we did in build_counted_concord, but
 		// for each token in the left and right context we treat it as a possible entry to a hash
@@ -565,38 +746,37 @@ void build_counted_collocates(match_list* matches, text_tokens* tokens, U_FILE*
 				continue;
 			}
 
-			currentKey = new_int_CS_tag(currentMatchList->tab[i], caseSensitive, tokens, alphabet);
+			currentKey.tokenID = currentMatchList->tab[i];
 
-			hash_val = get_value(countPerCollocate, currentKey, HT_INSERT_IF_NEEDED, &hash_ret);
+			hash_val = get_value(job->counts, &currentKey, HT_INSERT_IF_NEEDED, &hash_ret);
 
 			if (hash_ret == HT_KEY_ADDED)
 			{
 				// new value, we need to set count to 1
 				hash_val->_int = 1;
-				vector_int_add(allMatches, currentMatchList->tab[i]);
+				vector_int_add(job->collocates, currentMatchList->tab[i]);
 			}
 			else
 			{
 				hash_val->_int++;
 			}
-			free_int_CS_tag(currentKey);
 		}
 
 		// if we're calculating z-score as well, we have to account for totalWindow score
 		// which represents total space in non-space tokens taken by matches and their
 		// left and right contexts
 
-		if (z_score != NULL && countsInCorpora != NULL)
+		if (job->withWindow)
 		{
 			// first we account for number of non-space tokens taken by the match itself
-			tmpMatchList = get_string_in_context_as_token_list(current_match, 0, 0, &buffer, &buff_start, &buff_end, codSize, tokens, cod, 1, NULL);
+			tmpMatchList = get_string_in_context_as_token_list(current_match, 0, 0, context, 1, NULL);
 
 			for (i = 0 ; i < tmpMatchList->nbelems ; i++)
 			{
 				if (is_appropriate_token(tmpMatchList->tab[i], tokens))
 				{
-					totalWindow++;
-					wordsTakenByMatches++;
+					job->totalWindow++;
+					job->wordsTakenByMatches++;
 				}
 			}
 
@@ -607,7 +787,7 @@ void build_counted_collocates(match_list* matches, text_tokens* tokens, U_FILE*
 			{
 				if (is_appropriate_token(currentMatchList->tab[i], tokens))
 				{
-					totalWindow++;
+					job->totalWindow++;
 				}
 			}
 		}
@@ -615,10 +795,93 @@ void build_counted_collocates(match_list* matches, text_tokens* tokens, U_FILE*
 		// in this method, we free anyway, since this is no longer needed
 		free_vector_int(currentMatchList);
 		current_match = current_match->next;
-		totalMatches++;
+	}
+}
+
+/**
+ * Merges the collocate counts of all jobs into the first one, keeping the
+ * collocates in the order of their first occurrence.
+ */
+void merge_counted_collocates(stats_job* jobs, unsigned int nbJobs)
+{
+	unsigned int j;
+	int i, hash_ret;
+	any* hash_val;
+	any* partial_val;
+
+	int_CS_tag currentKey;
+	currentKey.CStag = jobs[0].context->caseSensitive;
+	currentKey.tokens = jobs[0].context->tokens;
+	currentKey.alphabet = jobs[0].context->alphabet;
+
+	for (j = 1 ; j < nbJobs ; j++)
+	{
+		for (i = 0 ; i < jobs[j].collocates->nbelems ; i++)
+		{
+			currentKey.tokenID = jobs[j].collocates->tab[i];
+			partial_val = get_value(jobs[j].counts, &currentKey, HT_DONT_INSERT);
+
+			hash_val = get_value(jobs[0].counts, &currentKey, HT_INSERT_IF_NEEDED, &hash_ret);
+
+			if (hash_ret == HT_KEY_ADDED)
+			{
+				hash_val->_int = partial_val->_int;
+				vector_int_add(jobs[0].collocates, currentKey.tokenID);
+			}
+			else
+			{
+				hash_val->_int += partial_val->_int;
+			}
+		}
+
+		jobs[0].totalWindow += jobs[j].totalWindow;
+		jobs[0].wordsTakenByMatches += jobs[j].wordsTakenByMatches;
+
+		free_vector_int(jobs[j].collocates);
+		free_hash_table(jobs[j].counts);
+	}
+}
+
+/**
+ * This function performs collocates count. It has two modes of operation, corresponding to modes 1 and
+ * 2 of main program. In mode 1, it only looks at tokens in left and right context and counts them
+ * each time they appear in the context of a match. In this mode, it returns an int vector containing
+ * all possible tokens found in left and right context of a match, as well as hash table containing
+ * counts per tokens in context. In mode 2, it returns additional 2 hash tables, z_score hash table which
+ * represents z-score of a collocate and countsInCorpora hash table which returns total count of a token
+ * found in context of a match in the whole corpora.
+ */
+void build_counted_collocates(match_list* matches, const stats_context* context, vector_int** ret_vector, hash_table** ret_hash, hash_table** z_score, hash_table** countsInCorpora)
+{
+	if (ret_vector == NULL)
+	{
+		fatal_error("Fatal error in build_counted_collocates, ret_vector cannot be NULL!");
+	}
+
+	if (ret_hash == NULL)
+	{
+		fatal_error("Fatal error in build_counted_collocates, ret_hash cannot be NULL!");
 	}
 
-	free(buffer);
+	any* hash_val;
+
+	int i;
+
+	unsigned int nbJobs;
+	stats_job* jobs = run_stats_jobs(matches, context, count_collocates_job, (z_score != NULL && countsInCorpora != NULL), &nbJobs);
+
+	merge_counted_collocates(jobs, nbJobs);
+
+	vector_int* allMatches = jobs[0].collocates;
+	hash_table* countPerCollocate = jobs[0].counts;
+	int wordsTakenByMatches = jobs[0].wordsTakenByMatches;
+	int totalWindow = jobs[0].totalWindow;
+
+	free(jobs);
+
+	hash_table* collocateCountInCorpora;
+	int corporaLength;
+
 	*ret_vector = allMatches;
 	*ret_hash = countPerCollocate;
 
@@ -631,7 +894,7 @@ void build_counted_collocates(match_list* matches, text_tokens* tokens, U_FILE*
 
 	// now we count all collocates in corpus
 
-	count_collocates(cod, tokens, alphabet, caseSensitive, countPerCollocate, &collocateCountInCorpora, &corporaLength);
+	count_collocates(context, countPerCollocate, &collocateCountInCorpora, &corporaLength);
 
 	// now we build z_score hash per collocate
 
@@ -642,14 +905,19 @@ void build_counted_collocates(match_list* matches, text_tokens* tokens, U_FILE*
 	double p;
 	double E;
 
+	int_CS_tag currentKey;
+	currentKey.CStag = context->caseSensitive;
+	currentKey.tokens = context->tokens;
+	currentKey.alphabet = context->alphabet;
+
 	for (i = 0 ; i < allMatches->nbelems ; i++)
 	{
-		currentKey = new_int_CS_tag(allMatches->tab[i], caseSensitive, tokens, alphabet);
-		hash_val = get_value(countPerCollocate, currentKey, HT_DONT_INSERT);
+		currentKey.tokenID = allMatches->tab[i];
+		hash_val = get_value(countPerCollocate, &currentKey, HT_DONT_INSERT);
 
 		K = hash_val->_int;
 
-		hash_val = get_value(collocateCountInCorpora, currentKey, HT_DONT_INSERT);
+		hash_val = get_value(collocateCountInCorpora, &currentKey, HT_DONT_INSERT);
 
 		Fc = hash_val->_int;
 
@@ -665,10 +933,8 @@ void build_counted_collocates(match_list* matches, text_tokens* tokens, U_FILE*
 
 		*tmpZScore = (K - E) / sqrt(E * (1 - p));
 
-		hash_val = get_value(zret, currentKey, HT_INSERT_IF_NEEDED);
+		hash_val = get_value(zret, &currentKey, HT_INSERT_IF_NEEDED);
 		hash_val->_ptr = tmpZScore;
-
-		free_int_CS_tag(currentKey);
 	}
 
 	*countsInCorpora = collocateCountInCorpora;
@@ -676,57 +942,164 @@ void build_counted_collocates(match_list* matches, text_tokens* tokens, U_FILE*
 
 }
 
+/**
+ * Counts the occurrences of each token in a part of text.cod.
+ */
+void SYNC_CALLBACK_UNITEX count_corpus_job(void* privateDataPtr, unsigned int /*iNbThread*/)
+{
+	corpus_job* job = (corpus_job*)privateDataPtr;
+	const stats_context* context = job->context;
+
+	job->countPerToken = (int*)calloc(context->tokens->N, sizeof(int));
+
+	if (job->countPerToken == NULL)
+	{
+		fatal_alloc_error("count_corpus_job");
+	}
+
+	job->corporaLength = 0;
+
+	long i;
+	int tokenID;
+
+	for (i = job->start ; i < job->end ; i++)
+	{
+		tokenID = context->cod[i];
+
+		if (is_appropriate_token(tokenID, context->tokens))
+		{
+			job->corporaLength++;
+		}
+
+		job->countPerToken[tokenID]++;
+	}
+}
+
 /**
  * This is a helper function for build_counted_collocates. It counts all collocates found for a specific
  * match list in corpora and returns the result as a hash table. Additional result - corpora_length, returns
  * total length of corpora in non-space tokens. Non-space tokens are determined by the result
  * of is_appropriate_token function.
+ *
+ * Parts of the text are counted by several threads into per-token arrays, which are
+ * summed before looking up each distinct token in the collocates hash table.
+ * In case-insensitive mode, the collocates are then counted in text order
+ * (see run_stats_jobs), but only at the positions of tokens that are collocates.
  */
-void count_collocates(U_FILE* cod, text_tokens* tokens, Alphabet* alphabet, int caseSensitive, hash_table* collocates, hash_table** ret_hash, int* corpora_length)
+void count_collocates(const stats_context* context, hash_table* collocates, hash_table** ret_hash, int* corpora_length)
 {
 	if (ret_hash == NULL)
 	{
 		fatal_error("Error in count_collocates, ret_hash cannot be null!");
 	}
 
+	unsigned int n = get_stats_thread_count(context->codSize, STATS_MIN_TOKENS_PER_THREAD);
+
+	corpus_job* jobs = (corpus_job*)malloc(n * sizeof(corpus_job));
+	void** jobPtrs = (void**)malloc(n * sizeof(void*));
+
+	if (jobs == NULL || jobPtrs == NULL)
+	{
+		fatal_alloc_error("count_collocates");
+	}
+
+	unsigned int j;
+	int i;
+
+	for (j = 0 ; j < n ; j++)
+	{
+		jobs[j].context = context;
+		jobs[j].start = (long)(((long long)context->codSize * j) / n);
+		jobs[j].end = (long)(((long long)context->codSize * (j + 1)) / n);
+		jobPtrs[j] = &(jobs[j]);
+	}
+
+	if (n == 1)
+	{
+		count_corpus_job(jobPtrs[0], 0);
+	}
+	else
+	{
+		SyncDoRunThreads(n, count_corpus_job, jobPtrs);
+	}
+
+	// we sum the partial counts into the first job
+
+	int* countPerToken = jobs[0].countPerToken;
+	*corpora_length = jobs[0].corporaLength;
+
+	for (j = 1 ; j < n ; j++)
+	{
+		for (i = 0 ; i < context->tokens->N ; i++)
+		{
+			countPerToken[i] += jobs[j].countPerToken[i];
+		}
+		*corpora_length += jobs[j].corporaLength;
+		free(jobs[j].countPerToken);
+	}
+
+	free(jobPtrs);
+	free(jobs);
+
 	hash_table* ret = new_hash_table(hash_token_as_int, tokens_as_int_equal, free_token_as_int, NULL,
 						copy_token_as_int);
-	int* buffer = NULL;
-	long bufferStart, bufferEnd;
-	long codSize = get_file_size(cod) / sizeof(int);
 	any* hash_val;
 	int hash_ret;
-	int_CS_tag* currentKey;
 
-	get_buffer_around_token(cod, &buffer, 0, 0, STATS_BUFFER_LENGTH, &bufferStart, &bufferEnd);
+	int_CS_tag currentKey;
+	currentKey.CStag = context->caseSensitive;
+	currentKey.tokens = context->tokens;
+	currentKey.alphabet = context->alphabet;
 
-	int i ;
+	for (i = 0 ; i < context->tokens->N ; i++)
+	{
+		if (countPerToken[i] == 0)
+		{
+			continue;
+		}
 
-	*corpora_length = 0;
+		currentKey.tokenID = i;
 
-	for (i = 0 ; i < codSize ; i++)
-	{
-		if (i < bufferStart || i > bufferEnd)
+		if (get_value(collocates, &currentKey, HT_DONT_INSERT) == NULL)
 		{
-			get_buffer_around_token(cod, &buffer, i, 0, STATS_BUFFER_LENGTH, &bufferStart, &bufferEnd);
+			// we mark tokens that are not collocates
+			countPerToken[i] = 0;
+			continue;
 		}
 
-		if (is_appropriate_token(buffer[i - bufferStart], tokens))
+		if (!context->caseSensitive)
 		{
-			(*corpora_length)++;
+			continue;
 		}
 
-		currentKey = new_int_CS_tag(buffer[i - bufferStart], caseSensitive, tokens, alphabet);
+		// this means that we can count this collocate in another hash
+
+		hash_val = get_value(ret, &currentKey, HT_INSERT_IF_NEEDED, &hash_ret);
+
+		if (hash_ret == HT_KEY_ADDED)
+		{
+			hash_val->_int = countPerToken[i];
+		}
+		else
+		{
+			hash_val->_int += countPerToken[i];
+		}
+	}
 
-		hash_val = get_value(collocates, currentKey, HT_DONT_INSERT, &hash_ret);
+	if (!context->caseSensitive)
+	{
+		long pos;
 
-		if (hash_val!=NULL && hash_ret == HT_KEY_ALREADY_THERE)
+		for (pos = 0 ; pos < context->codSize ; pos++)
 		{
-			// this means that we can count this collocate in another hash
+			if (countPerToken[context->cod[pos]] == 0)
+			{
+				continue;
+			}
 
-			int_CS_tag* insertKey = new_int_CS_tag(buffer[i - bufferStart], caseSensitive, tokens, alphabet);
+			currentKey.tokenID = context->cod[pos];
 
-			hash_val = get_value(ret, insertKey, HT_INSERT_IF_NEEDED, &hash_ret);
+			hash_val = get_value(ret, &currentKey, HT_INSERT_IF_NEEDED, &hash_ret);
 
 			if (hash_ret == HT_KEY_ADDED)
 			{
@@ -736,15 +1109,12 @@ void count_collocates(U_FILE* cod, text_tokens* tokens, Alphabet* alphabet, int
 			{
 				hash_val->_int++;
 			}
-			free_int_CS_tag(insertKey);
 		}
-
-		free_int_CS_tag(currentKey);
 	}
 
 	*ret_hash = ret;
 
-	free(buffer);
+	free(countPerToken);
 }
 
 
@@ -773,7 +1143,7 @@ inline long max_long(long a, long b)
  * as an int vector. It expands match to the left and right by number of "appropriate" non-space tokens.
  * These tokens are determined by is_appropriate_token function.
  */
-vector_int* get_string_in_context_as_token_list(match_list* match, int leftContext, int rightContext, int** buffer, long* bufferStart, long* bufferEnd, long totalSize, text_tokens* tokens, U_FILE* source, int includeMatch, counted_match_descriptor* descriptor)
+vector_int* get_string_in_context_as_token_list(match_list* match, int leftContext, int rightContext, const stats_context* context, int includeMatch, counted_match_descriptor* descriptor)
 {
 	long i;
 
@@ -783,17 +1153,9 @@ vector_int* get_string_in_context_as_token_list(match_list* match, int leftConte
 		return NULL;
 	}
 
-	if (buffer == NULL)
-	{
-		fatal_error("Error in get_string_as_token_list, buffer cannot be NULL");
-		return NULL;
-	}
-
-	if (*bufferStart > *bufferEnd)
-	{
-		fatal_error("Error in get_string_as_token_list, bufferStart must be <= bufferEnd!");
-		return NULL;
-	}
+	const int* cod = context->cod;
+	long totalSize = context->codSize;
+	text_tokens* tokens = context->tokens;
 
 	vector_int* res = new_vector_int();
 
@@ -807,13 +1169,7 @@ vector_int* get_string_in_context_as_token_list(match_list* match, int leftConte
 
 	while(startFrom >= 0 && foundLeft < leftContext)
 	{
-		if (startFrom < *bufferStart || startFrom > *bufferEnd)
-		{
-			// request new buffer
-			get_buffer_around_token(source, buffer, startFrom, STATS_BUFFER_LENGTH, 0, bufferStart, bufferEnd);
-		}
-
-		if (is_appropriate_token((*buffer)[startFrom - *bufferStart], tokens))
+		if (is_appropriate_token(cod[startFrom], tokens))
 		{
 			foundLeft++;
 		}
@@ -830,19 +1186,18 @@ vector_int* get_string_in_context_as_token_list(match_list* match, int leftConte
 
 	while(endAt <= totalSize-1 && foundRight < rightContext)
 	{
-		if (endAt > *bufferEnd || endAt < *bufferStart)
-		{
-			// request new buffer
-			get_buffer_around_token(source, buffer, endAt, 0, STATS_BUFFER_LENGTH, bufferStart, bufferEnd);
-		}
-
-		if (is_appropriate_token((*buffer)[endAt - *bufferStart], tokens))
+		if (is_appropriate_token(cod[endAt], tokens))
 		{
 			foundRight++;
 		}
 		endAt++;
 	}
 
+	if (endAt > totalSize)
+	{
+		fatal_error("Error in get_string_as_token_list, match is out of text.cod!");
+	}
+
 	for (i = startFrom + 1 ; i <= endAt - 1 ; i++)
 	{
 		if (!includeMatch && i >= match->m.start_pos_in_token && i <= match->m.end_pos_in_token)
@@ -851,12 +1206,7 @@ vector_int* get_string_in_context_as_token_list(match_list* match, int leftConte
 			continue;
 		}
 
-		if (i < *bufferStart || i > *bufferEnd)
-		{
-			get_buffer_around_token(source, buffer, i, 0, STATS_BUFFER_LENGTH, bufferStart, bufferEnd);
-		}
-
-		vector_int_add(res, (*buffer)[i - *bufferStart]);
+		vector_int_add(res, cod[i]);
 	}
 	return res;
 }
@@ -938,45 +1288,6 @@ void print_string_token_list_with_count(U_FILE* outfile,vector_int* list, text_t
 	u_fprintf(outfile,"\n");
 }
 
-/**
- * This function fills a buffer of token IDs starting from a particular token to the left and/or right.
- */
-void get_buffer_around_token(U_FILE* inputFile, int** buffer, long tokenPosition, long leftSize, long rightSize, long* buffer_start_from, long* buffer_ends_at)
-{
-	// free old buffer first
-	if (*buffer != NULL)
-	{
-		free(*buffer);
-		*buffer_start_from = -1;
-		*buffer_ends_at = -1;
-	}
-
-	long fileSize = get_file_size(inputFile);
-	long seekTo = max_long(0, tokenPosition - leftSize);
-	long endReadingAt = min_long(fileSize/sizeof(int) - 1, tokenPosition + rightSize);
-
-	int bufferSize = (int)(endReadingAt - seekTo + 1);
-
-	*buffer = (int*)malloc(sizeof(int) * bufferSize);
-
-	if (*buffer == NULL)
-	{
-		fatal_alloc_error("get_buffer_around_token");
-	}
-
-	fseek(inputFile, seekTo * sizeof(int), SEEK_SET);
-
-	long numRead = (long)fread(*buffer, sizeof(int), bufferSize, inputFile);
-
-	if (numRead != bufferSize)
-	{
-		fatal_error("Error reading file in get_buffer_around_token!");
-	}
-
-	*buffer_start_from = seekTo;
-	*buffer_ends_at = endReadingAt;
-}
-
 int vectors_equal(const void* v1, const void* v2)
 {
 	int cs = ((const vec_CS_tag*)v1)->CStag;
@@ -32,7 +32,7 @@
 #include "Tfst.h"
 #include "File.h"
 #include "DELA.h"
-#include "AbstractDelaLoad.h"
+#include "TaggingModel.h"
 #include "Unicode.h"
 #include "TfstStats.h"
 
@@ -44,7 +44,11 @@ const char* usage_Tagger =
          "OPTIONS:\n"
 		   "  -a ALPH/--alphabet=ALPH: the alphabet file\n"
 		   "  -d DATA/--data=DATA: use the .bin tagger data file containing tuples (unigrams,bigrams and trigrams)"
-		   " with frequencies\n"
+		   " with frequencies. If the .tgm model that TrainingTagger has built along with DATA exists next to it,"
+		   " it is used instead. The Tagger checks the hash of DATA and its .inf against the ones recorded"
+		   " in the .tgm, and stops if they do not match\n"
+		   "  -r/--rebuild_model: if the .tgm does not match DATA and its .inf, the model is built again"
+		   " from them instead of stopping, which is slower\n"
 		   "  -t TAGSET/--tagset=TAGSET: use the TAGSET ELAG tagset file to normalize the dictionary entries\n"
 		   "\n"
 		   "Output options:\n"
@@ -62,10 +66,11 @@ u_printf(usage_Tagger);
 }
 
 
-const char* optstring_Tagger=":a:d:t:o:k:q:h";
+const char* optstring_Tagger=":a:d:rt:o:k:q:h";
 const struct option_TS lopts_Tagger[]= {
 	  {"alphabet", required_argument_TS, NULL, 'a'},
 	  {"data", required_argument_TS, NULL, 'd'},
+	  {"rebuild_model", no_argument_TS, NULL, 'r'},
 	  {"tagset", required_argument_TS, NULL, 't'},
 	  {"output",required_argument_TS,NULL,'o'},
 	  {"input_encoding",required_argument_TS,NULL,'k'},
@@ -87,12 +92,16 @@ char tfst[FILENAME_MAX]="";
 char tind[FILENAME_MAX]="";
 char tmp_tind[FILENAME_MAX]="";
 char output_tind[FILENAME_MAX];
+char tfstb[FILENAME_MAX];
+char tmp_tfstb[FILENAME_MAX];
+char output_tfstb[FILENAME_MAX];
 char tmp_tfst[FILENAME_MAX]="";
 char output[FILENAME_MAX]="";
 char temp[FILENAME_MAX]="";
 char data[FILENAME_MAX]="";
 char alphabet[FILENAME_MAX]="";
 char tagset[FILENAME_MAX]="";
+int rebuild_model=0;
 Encoding enc = DEFAULT_ENCODING_OUTPUT;
 int bom_output = DEFAULT_BOM_OUTPUT;
 int mask_encoding_compatibility_input = DEFAULT_MASK_ENCODING_COMPATIBILITY_INPUT;
@@ -108,6 +117,7 @@ while (EOF!=(val=getopt_long_TS(argc,argv,optstring_Tagger,lopts_Tagger,&index,v
 			   }
 			   strcpy(data,vars->optarg);
 			   break;
+   case 'r': rebuild_model=1; break;
    case 't': if (vars->optarg[0]=='\0') {
                    fatal_error("You must specify a non empty tagset file name\n");
                 }
@@ -151,27 +161,23 @@ strcpy(tfst,argv[vars->optind]);
 strcpy(tind,tfst);
 remove_extension(tind);
 strcat(tind,".tind");
+get_tfst_binary_name(tfst,tfstb);
 
 Alphabet* alpha = load_alphabet(alphabet);
 
 get_path(tfst,temp);
 strcat(temp,"temp.tfst");
 
-struct BIN_free_info bin_free;
-const unsigned char* bin=load_abstract_BIN_file(data,&bin_free);
-if (bin==NULL) {
-	fatal_error("Cannot open .bin data file.");
-}
-remove_extension(data);
-strcat(data,".inf");
-struct INF_free_info inf_free;
-const struct INF_codes* inf=load_abstract_INF_file(data,&inf_free);
-if (inf==NULL) {
-	fatal_error("Cannot open .inf data file");
+struct tagging_model* model=load_tagging_model(data,rebuild_model);
+if (model==NULL) {
+	fatal_error("Cannot load tagger data file %s\n",data);
 }
 
 char* current_tfst = tfst;
-int form_type = get_form_type(bin,inf,alpha);
+int form_type = model->form_type;
+if(form_type == -1){
+	fatal_error("No CODE\tFEATURES entry in tagger data file %s\n",data);
+}
 if(form_type == 1){
 	if(tagset[0] == '\0'){
 		fatal_error("No tagset file specified\n");
@@ -210,6 +216,8 @@ if (out_tind==NULL) {
 	fatal_error("Cannot create output .tind\n");
 }
 Tfst* result=new_Tfst(out_tfst,out_tind,input_tfst->N);
+get_tfst_binary_name(temp,tmp_tfstb);
+struct tfst_binary_writer* out_tfstb=new_tfst_binary_writer(tmp_tfstb);
 
 u_printf("Tagging...\n");
 
@@ -218,10 +226,11 @@ struct hash_table* form_frequencies=new_hash_table((HASH_FUNCTION)hash_unichar,(
         (FREE_FUNCTION)free,NULL,(KEYCOPY_FUNCTION)keycopy);
 
 /* launches tagging process on the input tfst file */
-do_tagging(input_tfst,result,bin,inf,alpha,form_type,form_frequencies);
+do_tagging(input_tfst,result,out_tfstb,model,form_type,form_frequencies);
 
 close_text_automaton(input_tfst);
 close_text_automaton(result);
+close_tfst_binary_writer(out_tfstb,temp);
 
 /* We save statistics */
 char tfst_tags_by_freq[FILENAME_MAX];
@@ -256,6 +265,10 @@ if(output[0]=='\0'){
 	af_remove(tind);
 	af_rename(temp,tfst);
 	af_rename(tmp_tind,tind);
+	af_remove(tfstb);
+	if (out_tfstb!=NULL) {
+		af_rename(tmp_tfstb,tfstb);
+	}
 }
 else {
 	af_rename(temp,output);
@@ -263,10 +276,13 @@ else {
 	remove_extension(output_tind);
 	strcat(output_tind,".tind");
 	af_rename(tmp_tind,output_tind);
+	if (out_tfstb!=NULL) {
+		get_tfst_binary_name(output,output_tfstb);
+		af_rename(tmp_tfstb,output_tfstb);
+	}
 }
 free_alphabet(alpha);
-free_abstract_BIN(bin,&bin_free);
-free_abstract_INF(inf,&inf_free);
+free_tagging_model(model);
 free_OptVars(vars);
 u_printf("Done.\n");
 return 0;
@@ -0,0 +1,601 @@
+/*
+ * Unitex
+ *
+ * Copyright (C) 2001-2011 Université Paris-Est Marne-la-Vallée <unitex@univ-mlv.fr>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "TaggingModel.h"
+#include "TaggingProcess.h"
+#include "AbstractDelaLoad.h"
+#include "String_hash.h"
+#include "Vector.h"
+#include "Error.h"
+#include "File.h"
+#include "DELA.h"
+
+/**
+ * This structure is used to collect the entries of a tagger data file
+ * before building the model.
+ */
+struct tagging_model_builder {
+   struct string_hash* symbols;
+   vector_int* symbol_count;
+   /* (a,b,frequency) */
+   vector_int* pairs;
+   /* (a,b,c,frequency) */
+   vector_int* triples;
+   /* Buffer used to cut entries */
+   unichar entry[DIC_LINE_SIZE];
+};
+
+
+static unsigned int hash_symbol(const unichar* s) {
+unsigned int h=0;
+while (*s!='\0') {
+   h=h*31+*s;
+   s++;
+}
+return h;
+}
+
+
+static unsigned int hash_symbols(int a,int b,int c) {
+unsigned int h=(unsigned int)a;
+h=h*31+(unsigned int)b;
+h=h*31+(unsigned int)c;
+return h^(h>>16);
+}
+
+
+/**
+ * Returns the smallest power of 2 that is >=n.
+ */
+static int get_hash_size(int n) {
+int size=1;
+while (size<n) {
+   size=size*2;
+}
+return size;
+}
+
+
+/**
+ * Returns the size in bytes of a model whose header is given.
+ */
+static size_t get_tagging_model_size(const int* header) {
+return TAGGING_MODEL_HEADER_INTS*sizeof(int)
+       +(size_t)(header[5]+header[7])*sizeof(double)
+       +(size_t)(3*header[3]+header[4]+4*header[5]+header[6]+4*header[7]+header[8])*sizeof(int)
+       +(size_t)header[9]*sizeof(unichar);
+}
+
+
+/**
+ * Makes the fields of the model point into the given data.
+ */
+static void set_tagging_model_pointers(struct tagging_model* model,const void* data) {
+const int* header=(const int*)data;
+model->data=data;
+model->form_type=header[2];
+model->n_symbols=header[3];
+model->symbol_hash_size=header[4];
+model->n_pairs=header[5];
+model->pair_hash_size=header[6];
+model->n_triples=header[7];
+model->triple_hash_size=header[8];
+model->emit_probability=(const double*)(header+TAGGING_MODEL_HEADER_INTS);
+model->transition_probability=model->emit_probability+model->n_pairs;
+model->symbol_offset=(const int*)(model->transition_probability+model->n_triples);
+model->symbol_count=model->symbol_offset+model->n_symbols;
+model->symbol_next=model->symbol_count+model->n_symbols;
+model->symbol_first=model->symbol_next+model->n_symbols;
+model->pairs=model->symbol_first+model->symbol_hash_size;
+model->pair_first=model->pairs+4*model->n_pairs;
+model->triples=model->pair_first+model->pair_hash_size;
+model->triple_first=model->triples+4*model->n_triples;
+model->text=(const unichar*)(model->triple_first+model->triple_hash_size);
+}
+
+
+/**
+ * Allocates, initializes and returns a new model builder.
+ */
+struct tagging_model_builder* new_tagging_model_builder() {
+struct tagging_model_builder* builder=(struct tagging_model_builder*)malloc(sizeof(struct tagging_model_builder));
+if (builder==NULL) {
+   fatal_alloc_error("new_tagging_model_builder");
+}
+builder->symbols=new_string_hash(1024,ENLARGE_IF_NEEDED);
+builder->symbol_count=new_vector_int(1024);
+builder->pairs=new_vector_int(1024);
+builder->triples=new_vector_int(1024);
+return builder;
+}
+
+
+void free_tagging_model_builder(struct tagging_model_builder* builder) {
+if (builder==NULL) return;
+free_string_hash(builder->symbols);
+free_vector_int(builder->symbol_count);
+free_vector_int(builder->pairs);
+free_vector_int(builder->triples);
+free(builder);
+}
+
+
+/**
+ * Adds the given .bin entry with its frequency to the builder. The entry is
+ * cut on tabulations and modified by this function.
+ */
+static void add_tagger_data_entry(unichar* entry,int frequency,struct tagging_model_builder* builder) {
+int ids[3];
+int n=0;
+unichar* part=entry;
+for (;;) {
+   unichar* end=part;
+   while (*end!='\0' && *end!='\t') {
+      end++;
+   }
+   int last=(*end=='\0');
+   if (n==3) {
+      /* Not an n-gram we know about */
+      return;
+   }
+   *end='\0';
+   ids[n++]=get_value_index(part,builder->symbols,INSERT_IF_NEEDED);
+   if (last) break;
+   part=end+1;
+}
+while (builder->symbol_count->nbelems<builder->symbols->size) {
+   vector_int_add(builder->symbol_count,-1);
+}
+switch (n) {
+   case 1: builder->symbol_count->tab[ids[0]]=frequency; break;
+   case 2: vector_int_add(builder->pairs,ids[0]);
+           vector_int_add(builder->pairs,ids[1]);
+           vector_int_add(builder->pairs,frequency);
+           break;
+   case 3: vector_int_add(builder->triples,ids[0]);
+           vector_int_add(builder->triples,ids[1]);
+           vector_int_add(builder->triples,ids[2]);
+           vector_int_add(builder->triples,frequency);
+           break;
+}
+}
+
+
+/**
+ * Adds the given entry, like "N\tword_chat", with its frequency to the builder.
+ * Entries are expected only once.
+ */
+void add_tagging_model_entry(struct tagging_model_builder* builder,const unichar* entry,int frequency) {
+if (u_strlen(entry)>=DIC_LINE_SIZE) {
+   fatal_error("Too long tagger data entry: %S\n",entry);
+}
+u_strcpy(builder->entry,entry);
+add_tagger_data_entry(builder->entry,frequency,builder);
+}
+
+
+/**
+ * Explores the given .bin, in the same format as the one read by get_INF_code,
+ * and adds all its entries to the builder.
+ */
+static void explore_tagger_data(const unsigned char* bin,int offset,unichar* entry,int pos,
+                                const struct INF_codes* inf,struct tagging_model_builder* builder) {
+int n_transitions=((unsigned char)bin[offset])*256+(unsigned char)bin[offset+1];
+offset=offset+2;
+if (!(n_transitions & 32768)) {
+   /* If the node is final */
+   int inf_index=((unsigned char)bin[offset])*256*256+((unsigned char)bin[offset+1])*256+(unsigned char)bin[offset+2];
+   offset=offset+3;
+   u_strcpy(builder->entry,entry);
+   add_tagger_data_entry(builder->entry,(int)get_inf_value(inf,inf_index),builder);
+} else {
+   n_transitions=n_transitions-32768;
+}
+if (n_transitions>0 && pos==DIC_LINE_SIZE-1) {
+   fatal_error("Too long entry in tagger data file\n");
+}
+for (int i=0;i<n_transitions;i++) {
+   entry[pos]=(unichar)(((unsigned char)bin[offset])*256+(unsigned char)bin[offset+1]);
+   offset=offset+2;
+   int offset_dest=((unsigned char)bin[offset])*256*256+((unsigned char)bin[offset+1])*256+(unsigned char)bin[offset+2];
+   offset=offset+3;
+   entry[pos+1]='\0';
+   explore_tagger_data(bin,offset_dest,entry,pos+1,inf,builder);
+}
+}
+
+
+/**
+ * Builds in memory the model of the entries collected by the given builder.
+ */
+struct tagging_model* build_tagging_model(struct tagging_model_builder* builder) {
+while (builder->symbol_count->nbelems<builder->symbols->size) {
+   vector_int_add(builder->symbol_count,-1);
+}
+int header[TAGGING_MODEL_HEADER_INTS];
+header[0]=TAGGING_MODEL_MAGIC;
+header[1]=TAGGING_MODEL_VERSION;
+header[2]=-1;
+header[3]=builder->symbols->size;
+header[4]=get_hash_size(header[3]);
+header[5]=builder->pairs->nbelems/3;
+header[6]=get_hash_size(header[5]);
+header[7]=builder->triples->nbelems/4;
+header[8]=get_hash_size(header[7]);
+header[9]=0;
+header[10]=0;
+header[11]=0;
+for (int i=0;i<builder->symbols->size;i++) {
+   header[9]=header[9]+u_strlen(builder->symbols->value[i])+1;
+}
+size_t size=get_tagging_model_size(header);
+void* data=malloc(size);
+if (data==NULL) {
+   fatal_alloc_error("build_tagging_model");
+}
+memcpy(data,header,sizeof(header));
+struct tagging_model* model=(struct tagging_model*)malloc(sizeof(struct tagging_model));
+if (model==NULL) {
+   fatal_alloc_error("build_tagging_model");
+}
+model->amf=NULL;
+set_tagging_model_pointers(model,data);
+/* Symbols */
+int* symbol_offset=(int*)model->symbol_offset;
+int* symbol_count=(int*)model->symbol_count;
+int* symbol_next=(int*)model->symbol_next;
+int* symbol_first=(int*)model->symbol_first;
+unichar* text=(unichar*)model->text;
+for (int i=0;i<model->symbol_hash_size;i++) {
+   symbol_first[i]=-1;
+}
+int pos=0;
+for (int i=0;i<model->n_symbols;i++) {
+   symbol_offset[i]=pos;
+   u_strcpy(text+pos,builder->symbols->value[i]);
+   pos=pos+u_strlen(builder->symbols->value[i])+1;
+   symbol_count[i]=builder->symbol_count->tab[i];
+   unsigned int h=hash_symbol(builder->symbols->value[i])&(model->symbol_hash_size-1);
+   symbol_next[i]=symbol_first[h];
+   symbol_first[h]=i;
+}
+/* Pairs, with the emit probability computed as in the Tagger:
+ * N(tag,form)/(1+N(form)) */
+int* pairs=(int*)model->pairs;
+int* pair_first=(int*)model->pair_first;
+double* emit_probability=(double*)model->emit_probability;
+for (int i=0;i<model->pair_hash_size;i++) {
+   pair_first[i]=-1;
+}
+for (int i=0;i<model->n_pairs;i++) {
+   int a=builder->pairs->tab[3*i];
+   int b=builder->pairs->tab[3*i+1];
+   long int N2=builder->pairs->tab[3*i+2];
+   long int N1=symbol_count[b];
+   if (N1==-1) {
+      N1=0;
+   }
+   pairs[4*i]=a;
+   pairs[4*i+1]=b;
+   pairs[4*i+2]=(int)N2;
+   unsigned int h=hash_symbols(a,b,0)&(model->pair_hash_size-1);
+   pairs[4*i+3]=pair_first[h];
+   pair_first[h]=i;
+   emit_probability[i]=(double)(((double)N2)/(1+((double)(N1))));
+}
+/* Triples, with the transition probability N(a,b,c)/N(a,b) */
+int* triples=(int*)model->triples;
+int* triple_first=(int*)model->triple_first;
+double* transition_probability=(double*)model->transition_probability;
+for (int i=0;i<model->triple_hash_size;i++) {
+   triple_first[i]=-1;
+}
+for (int i=0;i<model->n_triples;i++) {
+   int a=builder->triples->tab[4*i];
+   int b=builder->triples->tab[4*i+1];
+   int c=builder->triples->tab[4*i+2];
+   long int C1=builder->triples->tab[4*i+3];
+   long int C2=get_pair_frequency(model,a,b);
+   if (C2==-1) {
+      C2=1;
+   }
+   triples[4*i]=a;
+   triples[4*i+1]=b;
+   triples[4*i+2]=c;
+   unsigned int h=hash_symbols(a,b,c)&(model->triple_hash_size-1);
+   triples[4*i+3]=triple_first[h];
+   triple_first[h]=i;
+   transition_probability[i]=(double)(((double)C1)/((double)(C2)));
+}
+/* The data file tells whether it contains inflected forms or not
+ * with a special "CODE\tFEATURES" entry */
+unichar code[DIC_LINE_SIZE];
+unichar features[DIC_LINE_SIZE];
+u_strcpy(code,"CODE");
+u_strcpy(features,"FEATURES");
+int form_type=get_pair_frequency(model,get_tagging_symbol(model,code),get_tagging_symbol(model,features));
+((int*)data)[2]=form_type;
+model->form_type=form_type;
+return model;
+}
+
+
+/**
+ * Builds the model of the given .bin tagger data file, whose .inf file
+ * has the same name. Returns NULL on error.
+ */
+static struct tagging_model* build_tagging_model(const char* data_file) {
+struct BIN_free_info bin_free;
+const unsigned char* bin=load_abstract_BIN_file(data_file,&bin_free);
+if (bin==NULL) {
+   error("Cannot open %s\n",data_file);
+   return NULL;
+}
+char inf_file[FILENAME_MAX];
+remove_extension(data_file,inf_file);
+strcat(inf_file,".inf");
+struct INF_free_info inf_free;
+const struct INF_codes* inf=load_abstract_INF_file(inf_file,&inf_free);
+if (inf==NULL) {
+   error("Cannot open %s\n",inf_file);
+   free_abstract_BIN(bin,&bin_free);
+   return NULL;
+}
+struct tagging_model_builder* builder=new_tagging_model_builder();
+unichar entry[DIC_LINE_SIZE];
+entry[0]='\0';
+explore_tagger_data(bin,4,entry,0,inf,builder);
+struct tagging_model* model=build_tagging_model(builder);
+free_tagging_model_builder(builder);
+free_abstract_BIN(bin,&bin_free);
+free_abstract_INF(inf,&inf_free);
+return model;
+}
+
+
+/**
+ * Computes in 'model_file' the name of the model associated to the
+ * given tagger data file.
+ */
+void get_tagging_model_name(const char* data_file,char* model_file) {
+remove_extension(data_file,model_file);
+strcat(model_file,TAGGING_MODEL_EXTENSION);
+}
+
+
+/**
+ * Returns a hash of the contents of the given file, that is never 0,
+ * or 0 if the file cannot be read.
+ */
+static int get_file_hash(const char* name) {
+if (!fexists(name)) {
+   return 0;
+}
+ABSTRACTMAPFILE* amf=af_open_mapfile(name,MAPFILE_OPTION_READ,0);
+if (amf==NULL) {
+   return 0;
+}
+const unsigned char* data=(const unsigned char*)af_get_mapfile_pointer(amf);
+size_t size=af_get_mapfile_size(amf);
+unsigned int h=2166136261u;
+for (size_t i=0;data!=NULL && i<size;i++) {
+   h=(h^data[i])*16777619u;
+}
+if (data!=NULL) af_release_mapfile_pointer(amf,data);
+af_close_mapfile(amf);
+return (h==0)?1:(int)h;
+}
+
+
+/**
+ * Computes in 'hashes' the hashes of the given .bin data file and of its .inf.
+ */
+static void get_data_file_hashes(const char* data_file,int* hashes) {
+char inf_file[FILENAME_MAX];
+remove_extension(data_file,inf_file);
+strcat(inf_file,".inf");
+hashes[0]=get_file_hash(data_file);
+hashes[1]=get_file_hash(inf_file);
+}
+
+
+/**
+ * Records in the given model file the hashes of the .bin data file and of
+ * its .inf, that have been built from the same corpus. Returns 1 if
+ * successful and 0 otherwise.
+ */
+int bind_tagging_model(const char* model_file,const char* data_file) {
+int hashes[2];
+get_data_file_hashes(data_file,hashes);
+if (hashes[0]==0 || hashes[1]==0) {
+   error("Cannot read %s and its .inf file\n",data_file);
+   return 0;
+}
+U_FILE* f=u_fopen(BINARY,model_file,U_MODIFY);
+if (f==NULL) {
+   error("Cannot open %s\n",model_file);
+   return 0;
+}
+int ok=(fseek(f,10*sizeof(int),SEEK_SET)==0 && fwrite(hashes,sizeof(int),2,f)==2);
+u_fclose(f);
+if (!ok) {
+   error("Cannot write %s\n",model_file);
+}
+return ok;
+}
+
+
+/**
+ * Loads the model of the given tagger data file. If the .tgm model saved by
+ * TrainingTagger along with this .bin and its .inf exists, it is mapped in
+ * memory; if there is no .tgm, the model is built from the .bin and .inf
+ * files, which is slower. If the .tgm was saved with another .bin or .inf,
+ * the model is only built from them if 'rebuild' is set; otherwise, this
+ * is an error. Returns NULL on error.
+ */
+struct tagging_model* load_tagging_model(const char* data_file,int rebuild) {
+char model_file[FILENAME_MAX];
+get_tagging_model_name(data_file,model_file);
+if (!fexists(model_file)) {
+   return build_tagging_model(data_file);
+}
+ABSTRACTMAPFILE* amf=af_open_mapfile(model_file,MAPFILE_OPTION_READ,0);
+if (amf==NULL) {
+   error("Cannot open %s\n",model_file);
+   return NULL;
+}
+const int* header=(const int*)af_get_mapfile_pointer(amf);
+size_t size=af_get_mapfile_size(amf);
+if (size<TAGGING_MODEL_HEADER_INTS*sizeof(int) || header[0]!=TAGGING_MODEL_MAGIC
+    || header[1]!=TAGGING_MODEL_VERSION || size!=get_tagging_model_size(header)) {
+   error("%s is not a valid tagging model: rebuild it with TrainingTagger\n",model_file);
+   af_release_mapfile_pointer(amf,header);
+   af_close_mapfile(amf);
+   return NULL;
+}
+struct tagging_model* model=(struct tagging_model*)malloc(sizeof(struct tagging_model));
+if (model==NULL) {
+   fatal_alloc_error("load_tagging_model");
+}
+model->amf=amf;
+int hashes[2];
+get_data_file_hashes(data_file,hashes);
+if (header[10]!=hashes[0] || header[11]!=hashes[1]) {
+   /* The .bin or the .inf is not the one the model was saved with */
+   af_release_mapfile_pointer(amf,header);
+   af_close_mapfile(amf);
+   free(model);
+   if (!rebuild) {
+      error("%s does not match %s and its .inf: rebuild it with TrainingTagger\n",model_file,data_file);
+      return NULL;
+   }
+   u_printf("%s does not match %s: the model is built from the data file\n",model_file,data_file);
+   return build_tagging_model(data_file);
+}
+set_tagging_model_pointers(model,header);
+return model;
+}
+
+
+/**
+ * Saves the given model in 'model_file'. Returns 1 if successful and 0 otherwise.
+ */
+int save_tagging_model(const struct tagging_model* model,const char* model_file) {
+U_FILE* f=u_fopen(BINARY,model_file,U_WRITE);
+if (f==NULL) {
+   error("Cannot create %s\n",model_file);
+   return 0;
+}
+size_t size=get_tagging_model_size((const int*)model->data);
+int ok=(fwrite(model->data,1,size,f)==size);
+u_fclose(f);
+if (!ok) {
+   error("Cannot write %s\n",model_file);
+}
+return ok;
+}
+
+
+void free_tagging_model(struct tagging_model* model) {
+if (model==NULL) return;
+if (model->amf!=NULL) {
+   af_release_mapfile_pointer(model->amf,model->data);
+   af_close_mapfile(model->amf);
+} else {
+   free((void*)model->data);
+}
+free(model);
+}
+
+
+/**
+ * Returns the number of the given symbol, or -1 if it does not
+ * occur in the model.
+ */
+int get_tagging_symbol(const struct tagging_model* model,const unichar* s) {
+unsigned int h=hash_symbol(s)&(model->symbol_hash_size-1);
+for (int i=model->symbol_first[h];i!=-1;i=model->symbol_next[i]) {
+   if (!u_strcmp(model->text+model->symbol_offset[i],s)) {
+      return i;
+   }
+}
+return -1;
+}
+
+
+static int get_pair_index(const struct tagging_model* model,int a,int b) {
+if (a==-1 || b==-1) {
+   return -1;
+}
+unsigned int h=hash_symbols(a,b,0)&(model->pair_hash_size-1);
+for (int i=model->pair_first[h];i!=-1;i=model->pairs[4*i+3]) {
+   if (model->pairs[4*i]==a && model->pairs[4*i+1]==b) {
+      return i;
+   }
+}
+return -1;
+}
+
+
+/**
+ * Returns the frequency of the pair (a,b), or -1 if it does not
+ * occur in the model.
+ */
+int get_pair_frequency(const struct tagging_model* model,int a,int b) {
+int i=get_pair_index(model,a,b);
+if (i==-1) {
+   return -1;
+}
+return model->pairs[4*i+2];
+}
+
+
+/**
+ * Returns the probability that the given tag emits the given form,
+ * 0 if the pair is unknown.
+ */
+double get_emit_probability(const struct tagging_model* model,int tag,int form) {
+int i=get_pair_index(model,tag,form);
+if (i==-1) {
+   return 0;
+}
+return model->emit_probability[i];
+}
+
+
+/**
+ * Returns the probability of the tag c after the tags a and b,
+ * 0 if the triple is unknown.
+ */
+double get_transition_probability(const struct tagging_model* model,int a,int b,int c) {
+if (a==-1 || b==-1 || c==-1) {
+   return 0;
+}
+unsigned int h=hash_symbols(a,b,c)&(model->triple_hash_size-1);
+for (int i=model->triple_first[h];i!=-1;i=model->triples[4*i+3]) {
+   if (model->triples[4*i]==a && model->triples[4*i+1]==b && model->triples[4*i+2]==c) {
+      return model->transition_probability[i];
+   }
+}
+return 0;
+}
@@ -0,0 +1,112 @@
+/*
+ * Unitex
+ *
+ * Copyright (C) 2001-2011 Université Paris-Est Marne-la-Vallée <unitex@univ-mlv.fr>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ *
+ */
+
+#ifndef TaggingModelH
+#define TaggingModelH
+
+#include "Unicode.h"
+
+/**
+ * A tagging model is the hashed form of a tagger data file (.bin/.inf) built
+ * by TrainingTagger. Every tab-separated part of the .bin entries ("N:ms",
+ * "word_chat", "suff_ment", ...) is interned once as a symbol, so that the
+ * Viterbi algorithm of the Tagger can work on integers:
+ *
+ * - symbol_count[s] is the frequency of the unigram s, or -1 if s never
+ *   occurs alone in the data file
+ * - a pair (a,b) gives the frequency of "a\tb" and the emit probability
+ *   of the form b with the tag a, that is N(a,b)/(1+N(b))
+ * - a triple (a,b,c) gives the transition probability N(a,b,c)/N(a,b)
+ *
+ * The probabilities are computed exactly as the Tagger used to compute them
+ * from the .bin, so that the tagging is unchanged. The model is saved by
+ * TrainingTagger as a .tgm file next to the .bin one, directly from the
+ * counts of the corpus. All values are in native byte order, so that the
+ * file can be mapped in memory:
+ *
+ * header[TAGGING_MODEL_HEADER_INTS], emit_probability[n_pairs] (double),
+ * transition_probability[n_triples] (double), symbol_offset[n_symbols],
+ * symbol_count[n_symbols], symbol_next[n_symbols], symbol_first[symbol_hash_size],
+ * pairs[4*n_pairs] (a,b,frequency,next), pair_first[pair_hash_size],
+ * triples[4*n_triples] (a,b,c,next), triple_first[triple_hash_size],
+ * text[text_length] (the \0 terminated symbols)
+ *
+ * The hash sizes are powers of 2. The last two ints of the header are hashes
+ * of the .bin and .inf files that TrainingTagger has compressed along with the
+ * model, or 0 if it has not. The model is only used with these files, since
+ * it would silently replace a .bin that has been rebuilt otherwise: for
+ * other files, the model is built again from them if the caller asks for it,
+ * and it is an error otherwise.
+ */
+
+#define TAGGING_MODEL_MAGIC 0x4D675454
+#define TAGGING_MODEL_VERSION 2
+#define TAGGING_MODEL_HEADER_INTS 12
+#define TAGGING_MODEL_EXTENSION ".tgm"
+
+
+struct tagging_model {
+   /* NULL if the model was built in memory from a .bin */
+   ABSTRACTMAPFILE* amf;
+   const void* data;
+   /* 1 if the data file contains inflected forms, 0 if it only contains
+    * categories, -1 if the data file does not say it */
+   int form_type;
+   int n_symbols;
+   int symbol_hash_size;
+   int n_pairs;
+   int pair_hash_size;
+   int n_triples;
+   int triple_hash_size;
+   const double* emit_probability;
+   const double* transition_probability;
+   const int* symbol_offset;
+   const int* symbol_count;
+   const int* symbol_next;
+   const int* symbol_first;
+   const int* pairs;
+   const int* pair_first;
+   const int* triples;
+   const int* triple_first;
+   const unichar* text;
+};
+
+
+/* Collects the entries of a model before it is built */
+struct tagging_model_builder;
+
+struct tagging_model_builder* new_tagging_model_builder();
+void add_tagging_model_entry(struct tagging_model_builder*,const unichar*,int);
+struct tagging_model* build_tagging_model(struct tagging_model_builder*);
+void free_tagging_model_builder(struct tagging_model_builder*);
+
+void get_tagging_model_name(const char*,char*);
+struct tagging_model* load_tagging_model(const char*,int);
+int save_tagging_model(const struct tagging_model*,const char*);
+int bind_tagging_model(const char*,const char*);
+void free_tagging_model(struct tagging_model*);
+
+int get_tagging_symbol(const struct tagging_model*,const unichar*);
+int get_pair_frequency(const struct tagging_model*,int,int);
+double get_emit_probability(const struct tagging_model*,int,int);
+double get_transition_probability(const struct tagging_model*,int,int,int);
+
+#endif
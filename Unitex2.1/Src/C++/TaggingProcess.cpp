@@ -96,6 +96,12 @@ if(mx == NULL){
 (*mx)->partial_prob = (double)0.0;
 (*mx)->tag_number = tag_number;
 (*mx)->state_number = state_number;
+(*mx)->tag_id = -1;
+(*mx)->form_id = -1;
+(*mx)->n_parts = 0;
+(*mx)->part_tag_ids = NULL;
+(*mx)->part_form_ids = NULL;
+(*mx)->has_underscore = 0;
 int verbose = 0;
 struct dela_entry* tmp = tokenize_DELAF_line(tag,1,0,&verbose);
 free_dela_entry(tmp);
@@ -144,7 +150,7 @@ return matrix;
  * Initializes a matrix by determining its size (number of transitions
  * in the automata.
  */
-struct matrix_entry** initialize_viterbi_matrix(SingleGraph automaton,int form_type){
+struct matrix_entry** initialize_viterbi_matrix(const struct tagging_model* model,SingleGraph automaton,int form_type){
 int nb_transitions = 0;
 for(int i=0;i<automaton->number_of_states;i++){
 	SingleGraphState state = automaton->states[i];
@@ -164,6 +170,7 @@ for(int i=0;i<2;i++){
 	}
 	u_sprintf(token,"{#,#.#}");
 	create_matrix_entry(token,&matrix[i],form_type,-1,i);
+	set_matrix_entry_symbols(model,matrix[i]);
 	free(token);
 }
 /* the second # points on the first entry */
@@ -177,6 +184,8 @@ return matrix;
 void free_matrix_entry(struct matrix_entry* entry){
 	free_dela_entry(entry->tag);
 	free(entry->tag_code);
+	free(entry->part_tag_ids);
+	free(entry->part_form_ids);
 	free(entry);
 }
 
@@ -191,63 +200,19 @@ void free_viterbi_matrix(struct matrix_entry** matrix,int size){
 }
 
 /**
- * Return the index of the tag in matrix.
+ * Return the index of the tag in matrix. The entries of the transitions
+ * that start from the state 'state_number' are between 'first' and 'last'.
  */
-int search_matrix_predecessor(struct matrix_entry** matrix,unichar* tag,int start,
+int search_matrix_predecessor(struct matrix_entry** matrix,const struct dela_entry* entry,int first,int last,
 		                      int tag_number,int state_number){
-struct dela_entry* entry = tokenize_tag_token(tag);
-for(int i=start;i>=0;i--){
-	if(equal(entry,matrix[i]->tag) == 1 && matrix[i]->tag_number == tag_number && matrix[i]->state_number == state_number){
-		free_dela_entry(entry);
+for(int i=last;i>=first;i--){
+	if(matrix[i]->tag_number == tag_number && matrix[i]->state_number == state_number && equal(entry,matrix[i]->tag) == 1){
 		return i;
 	}
 }
-free_dela_entry(entry);
 return -1;
 }
 
-/**
- * Extracts INF_code of a given token in the dictionnary.
- */
-void get_INF_code(const unsigned char* bin,const unichar* token,
-				  int case_sensitive,int index,int offset,
-				  const Alphabet* alphabet,int* inf_index){
-int n_transitions=((unsigned char)bin[offset])*256+(unsigned char)bin[offset+1];
-offset=offset+2;
-if (token[index]=='\0') {
-   /* If we are at end of the token */
-   if (!(n_transitions & 32768)) {
-	  /* If the node is final */
-	   *inf_index=((unsigned char)bin[offset])*256*256+((unsigned char)bin[offset+1])*256+(unsigned char)bin[offset+2];
-   }
-   return;
-}
-if((n_transitions & 32768)){
-   /* If we are in a normal node, we remove the control bit to
-	* have the good number of transitions */
-   n_transitions=n_transitions-32768;
-}
-else {
-   /* If we are in a final node, we must jump after the reference to the INF
-	* line number */
-   offset=offset+3;
-}
-for(int i=0;i<n_transitions;i++) {
-   /* For each outgoing transition, we look if the transition character is
-	* compatible with the token's one */
-   unichar c=(unichar)(((unsigned char)bin[offset])*256+(unsigned char)bin[offset+1]);
-   offset=offset+2;
-   int offset_dest=((unsigned char)bin[offset])*256*256+((unsigned char)bin[offset+1])*256+(unsigned char)bin[offset+2];
-   offset=offset+3;
-   if(case_sensitive == 1 && c == token[index]){
-	   get_INF_code(bin,token,case_sensitive,index+1,offset_dest,alphabet,inf_index);
-   }
-   else if(case_sensitive == 0 && is_equal_ignore_case(token[index],c,alphabet)){
-	   get_INF_code(bin,token,case_sensitive,index+1,offset_dest,alphabet,inf_index);
-   }
-}
-}
-
 /*
  * Returns the value pointed by inf_code in the INF_codes structure.
  */
@@ -269,21 +234,6 @@ free(code);
 return value;
 }
 
-/*
- * Returns the long integer value of a string in the dictionnary
- * according to the extracted INF_codes index.
- * Returns -1 if the string is not in the dictionnary.
- */
-long int get_sequence_integer(const unichar* sequence,const unsigned char* bin,const struct INF_codes* inf,const Alphabet* alphabet){
-int inf_index = -1;
-get_INF_code(bin,sequence,1,0,4,alphabet,&inf_index);
-if(inf_index == -1){
-	/* sequence is not in the dictionary */
-	return -1;
-}
-return get_inf_value(inf,inf_index);
-}
-
 /**
  * Creates a new sequence token based on the combining of two tokens.
  * In our case, the tokens could be "N" and "dog". The result is a
@@ -313,24 +263,6 @@ free(tmp_first);
 return sequence;
 }
 
-/**
- * Creates a new sequence token based on the combining of three tokens.
- * In our case, the tokens could be "N", "A" and "blue". The result is a
- * new unichar "N\tA\tblue".
- */
-unichar* create_trigram_sequence(const unichar* first_token,const unichar* second_token,const unichar* third_token){
-unichar* bigram = create_bigram_sequence(first_token,second_token,1);
-unichar* sequence = (unichar*)malloc(sizeof(unichar)*(2+u_strlen(bigram)+u_strlen(third_token)));
-if(sequence == NULL){
-	fatal_alloc_error("create_trigram_sequence");
-}
-unichar* tmp = u_strcpy_sized(sequence,u_strlen(bigram)+1,bigram);
-free(bigram);
-tmp = u_strcat(tmp,"\t");
-u_strcat(tmp,third_token);
-return sequence;
-}
-
 /**
  * Computes the suffix of size n of a token.
  */
@@ -346,70 +278,36 @@ return suffix;
 }
 
 /**
- * Compute emit probability according to an inflected token associated
- * with a code (semantic and sometimes inflectional codes).
- * This probability is a double value between 0 and 1.
+ * Returns the symbol of the model that gives the emit probability of an
+ * inflected token: "word_XXX" if the token is known, or else "suff_YYY"
+ * where YYY is its suffix. Returns -1 if the emit probability is 0 whatever
+ * the tag is.
  */
-double compute_emit_probability(const unsigned char* bin,const struct INF_codes* inf,const Alphabet* alphabet,
-		const unichar* tag,const unichar* inflected){
+int get_emit_form(const struct tagging_model* model,const unichar* inflected){
 const char prefix1[] = "word_";
 unichar* new_inflected = create_bigram_sequence(prefix1,inflected,0);
-unichar* sequence1 = create_bigram_sequence(tag,new_inflected,1);
-long int N1 = get_sequence_integer(new_inflected,bin,inf,alphabet);
-long int N2 = get_sequence_integer(sequence1,bin,inf,alphabet);
-free(sequence1);
+int form = get_tagging_symbol(model,new_inflected);
 free(new_inflected);
-if(N1 == -1){
-	/* current inflected token is unknown, we apply
-	 * a suffix-based algorithm to determine its part of speech tag*/
-	if(u_strlen(inflected) < 3){
-		/* the word is too short to be treated */
-		return 0;
-	}
-	int suffix_length = 4;
-	if(u_strlen(inflected) < 6){
-		suffix_length = u_strlen(inflected) - 2;
-	}
-	unichar* suffix = u_strnsuffix(inflected,suffix_length);
-	const char prefix2[] = "suff_";
-	unichar* seq_suff = create_bigram_sequence(prefix2,suffix,0);
-	N1 = get_sequence_integer(seq_suff,bin,inf,alphabet);
-	unichar* sequence2 = create_bigram_sequence(tag,seq_suff,1);
-	N2 = get_sequence_integer(sequence2,bin,inf,alphabet);
-	free(sequence2);
-	free(suffix);
-	free(seq_suff);
+if(form != -1 && model->symbol_count[form] != -1){
+	return form;
 }
-if(N1 == -1){
-	N1 = 0;
-}
-if(N2 == -1){
-	N2 = 0;
+/* current inflected token is unknown, we apply
+ * a suffix-based algorithm to determine its part of speech tag*/
+if(u_strlen(inflected) < 3){
+	/* the word is too short to be treated */
+	return -1;
 }
-/* we compute the emit probability thanks to this smoothed formula */
-return (double)(((double)N2)/(1+((double)(N1))));
+int suffix_length = 4;
+if(u_strlen(inflected) < 6){
+	suffix_length = u_strlen(inflected) - 2;
 }
-
-/**
- * Compute transition probability according to three following codes
- * (semantic and sometimes inflectional codes). This probability is
- * a double value between 0 and 1.
- */
-double compute_transition_probability(const unsigned char* bin,const struct INF_codes* inf,const Alphabet* alphabet,
-									 const unichar* ancestor,const unichar* predecessor,const unichar* current){
-unichar* tri_sequence = create_trigram_sequence(ancestor,predecessor,current);
-unichar* bi_sequence = create_bigram_sequence(ancestor,predecessor,1);
-long int C1 = get_sequence_integer(tri_sequence,bin,inf,alphabet);
-long int C2 = get_sequence_integer(bi_sequence,bin,inf,alphabet);
-free(bi_sequence);
-free(tri_sequence);
-if(C1 == -1){
-	C1 = 0;
-}
-if(C2 == -1){
-	C2 = 1;
-}
-return (double)(((double)C1)/((double)(C2)));
+unichar* suffix = u_strnsuffix(inflected,suffix_length);
+const char prefix2[] = "suff_";
+unichar* seq_suff = create_bigram_sequence(prefix2,suffix,0);
+form = get_tagging_symbol(model,seq_suff);
+free(suffix);
+free(seq_suff);
+return form;
 }
 
 /**
@@ -425,95 +323,107 @@ void check_compound(unichar* inflected){
 }
 
 /**
- * Computes partial probability of a outgoing transition of a state (for compounds words only).
- * The system used here is BIO.
+ * Computes the symbols of the simple words of a compound word, which are
+ * tagged with the BIO system: the first word gets the tag code followed
+ * by "+B" and the other ones get the tag code followed by "+I".
  */
-double compute_partial_probability_compounds(const unsigned char* bin,const struct INF_codes* inf,const Alphabet* alphabet,
-		  unichar* ancestor,unichar* predecessor,unichar* tag_code,unichar* inflected){
-	check_compound(inflected);
-	unichar* word = u_strchr(inflected,'_');
-	int old_value=0,nb_words=0;
-	double score = 0.0;
-	while(word != NULL) {
-		unichar* simple_word = u_strdup(inflected+old_value,u_strlen(inflected)-old_value-u_strlen(word));
-		unichar* new_tag_code = (unichar*)malloc(sizeof(unichar)*(u_strlen(tag_code)+3));
-		unichar* tmp = u_strcpy_sized(new_tag_code,u_strlen(tag_code)+1,tag_code);
-		if(nb_words == 0){
-			u_strcat(tmp,"+B\0");
-		}
-		else{
-			u_strcat(tmp,"+I\0");
-		}
-		score += compute_emit_probability(bin,inf,alphabet,new_tag_code,simple_word);
-		score += compute_transition_probability(bin,inf,alphabet,ancestor,predecessor,new_tag_code);
-		nb_words+=1;
-		old_value += u_strlen(simple_word)+1;
-		word = u_strchr(inflected+old_value,'_');
-		if(nb_words>2){
-			free(ancestor);
-		}
-		ancestor = predecessor;
-		predecessor = new_tag_code;
-		free(simple_word);
-		if(word == NULL){
-			if(u_strlen(inflected)-old_value != 0){
-				word = inflected+old_value;
-				unichar* new_tag_code = (unichar*)malloc(sizeof(unichar)*(u_strlen(tag_code)+3));
-				unichar* tmp = u_strcpy_sized(new_tag_code,u_strlen(tag_code)+1,tag_code);
-				u_strcat(tmp,"+I\0");
-				score += compute_emit_probability(bin,inf,alphabet,new_tag_code,word);
-				score += compute_transition_probability(bin,inf,alphabet,ancestor,predecessor,new_tag_code);
-				free(new_tag_code);
-			}
-			if(nb_words>=2){
-				free(ancestor);
-			}
-			if(nb_words>=1){
-				free(predecessor);
-			}
-			break;
-		}
+void set_compound_symbols(const struct tagging_model* model,struct matrix_entry* mx,unichar* inflected){
+check_compound(inflected);
+/* every '_' ends a simple word, and the last one is kept if it is not empty */
+int n_parts = 0;
+int length = u_strlen(inflected);
+for(int i=0;i<length;i++){
+	if(inflected[i] == '_'){
+		n_parts++;
 	}
-	free(inflected);
-	return score;
+}
+if(inflected[length-1] != '_'){
+	n_parts++;
+}
+mx->part_tag_ids = (int*)malloc(sizeof(int)*n_parts);
+mx->part_form_ids = (int*)malloc(sizeof(int)*n_parts);
+unichar* new_tag_code = (unichar*)malloc(sizeof(unichar)*(u_strlen(mx->tag_code)+3));
+if(mx->part_tag_ids == NULL || mx->part_form_ids == NULL || new_tag_code == NULL){
+	fatal_alloc_error("set_compound_symbols");
+}
+unichar* simple_word = inflected;
+for(int i=0;i<n_parts;i++){
+	unichar* end = u_strchr(simple_word,'_');
+	if(end != NULL){
+		*end = '\0';
+	}
+	unichar* tmp = u_strcpy_sized(new_tag_code,u_strlen(mx->tag_code)+1,mx->tag_code);
+	u_strcat(tmp,i == 0 ? "+B" : "+I");
+	mx->part_tag_ids[i] = get_tagging_symbol(model,new_tag_code);
+	mx->part_form_ids[i] = get_emit_form(model,simple_word);
+	if(end != NULL){
+		simple_word = end+1;
+	}
+}
+mx->n_parts = n_parts;
+free(new_tag_code);
+}
+
+int u_find_char(const unichar* s,unichar t){
+for(int i=u_strlen(s)-1;i>0;i--){
+	if(s[i]==t){
+		return i;
+	}
+}
+return -1;
 }
 
 /**
- * Computes partial probability of a outgoing transition of a state.
- * This probability is the product of emit and transition probabilities.
+ * Looks up once for all in the model the symbols needed to compute
+ * the probabilities of a matrix entry.
  */
-double compute_partial_probability(const unsigned char* bin,const struct INF_codes* inf,const Alphabet* alphabet,
-								  struct matrix_entry* ancestor,struct matrix_entry* predecessor,
-								  struct matrix_entry* current){
-unichar* inflected = compound_to_simple(current->tag->inflected);
+void set_matrix_entry_symbols(const struct tagging_model* model,struct matrix_entry* mx){
+mx->tag_id = get_tagging_symbol(model,mx->tag_code);
+mx->has_underscore = (u_find_char(mx->tag->inflected,'_') != -1);
+unichar* inflected = compound_to_simple(mx->tag->inflected);
 /* case : a transition tagged by a compound */
 if((u_strchr(inflected,'_') != NULL || (u_strchr(inflected,'-') != NULL && inflected[0]!='-'))&& u_strlen(inflected)>2){
-	return compute_partial_probability_compounds(bin,inf,alphabet,ancestor->tag_code,predecessor->tag_code,current->tag_code,inflected);
+	set_compound_symbols(model,mx,inflected);
+}
+else{
+	mx->form_id = get_emit_form(model,inflected);
 }
-double emit_prob = compute_emit_probability(bin,inf,alphabet,current->tag_code,inflected);
-double trans_prob = compute_transition_probability(bin,inf,alphabet,ancestor->tag_code,predecessor->tag_code,current->tag_code);
 free(inflected);
-return emit_prob+trans_prob;
 }
 
-int u_find_char(const unichar* s,unichar t){
-for(int i=u_strlen(s)-1;i>0;i--){
-	if(s[i]==t){
-		return i;
+/**
+ * Computes partial probability of a outgoing transition of a state.
+ * This probability is the sum of emit and transition probabilities.
+ * For compound words, we sum the probabilities of their simple words.
+ */
+double compute_partial_probability(const struct tagging_model* model,struct matrix_entry* ancestor,
+								  struct matrix_entry* predecessor,struct matrix_entry* current){
+if(current->n_parts > 0){
+	double score = 0.0;
+	int ancestor_id = ancestor->tag_id;
+	int predecessor_id = predecessor->tag_id;
+	for(int i=0;i<current->n_parts;i++){
+		score += get_emit_probability(model,current->part_tag_ids[i],current->part_form_ids[i]);
+		score += get_transition_probability(model,ancestor_id,predecessor_id,current->part_tag_ids[i]);
+		ancestor_id = predecessor_id;
+		predecessor_id = current->part_tag_ids[i];
 	}
+	return score;
 }
-return -1;
+double emit_prob = get_emit_probability(model,current->tag_id,current->form_id);
+double trans_prob = get_transition_probability(model,ancestor->tag_id,predecessor->tag_id,current->tag_id);
+return emit_prob+trans_prob;
 }
 
 /**
  * Calculates partial probability for a transition and if this probability
  * is better than the previous best transition, we replace this one by the new.
  */
-void compute_best_probability(const unsigned char* bin,const struct INF_codes* inf,const Alphabet* alphabet,
-							  struct matrix_entry** matrix,int index_matrix,int indexI,int cover_span){
-double score = cover_span==1?0:compute_partial_probability(bin,inf,alphabet,matrix[matrix[indexI]->predecessor],
+void compute_best_probability(const struct tagging_model* model,struct matrix_entry** matrix,
+							  int index_matrix,int indexI,int cover_span){
+double score = cover_span==1?0:compute_partial_probability(model,matrix[matrix[indexI]->predecessor],
 										  matrix[indexI],matrix[index_matrix])+matrix[indexI]->partial_prob;
-if(score > 0 && u_find_char(matrix[index_matrix]->tag->inflected,'_') != -1){
+if(score > 0 && matrix[index_matrix]->has_underscore){
 	score +=2;
 }
 /* best predecessor is saved for the current output transition*/
@@ -529,10 +439,12 @@ if(score >= matrix[index_matrix]->partial_prob){
  */
 int* get_state_sequence(struct matrix_entry** matrix,int index){
 /* the sequence is just a table of matrix index */
-int* state_sequence = (int*)malloc(index*sizeof(int));
+int* state_sequence = (int*)malloc((index+1)*sizeof(int));
 if(state_sequence == NULL){
 	fatal_alloc_error("get_state_sequence");
 }
+/* the last entry has no successor, so that the backtracking stops there */
+state_sequence[index] = index+1;
 for(int i=index;;){
 	matrix_entry* me = matrix[i];
 	if(me->predecessor == -1){
@@ -658,13 +570,26 @@ return new_tags;
  * Computes the Viterbi Path algorithm to find the best path in
  * the automata and then this path is used to prune transitions.
  */
-vector_ptr* do_viterbi(const unsigned char* bin,const struct INF_codes* inf,const Alphabet* alphabet,Tfst* input_tfst,int form_type){
+vector_ptr* do_viterbi(const struct tagging_model* model,Tfst* input_tfst,int form_type){
 SingleGraph automaton = input_tfst->automaton;
 int index_matrix = 2;
 topological_sort(automaton,NULL);
 compute_reverse_transitions(automaton);
-struct matrix_entry** matrix = initialize_viterbi_matrix(automaton,form_type);
+struct matrix_entry** matrix = initialize_viterbi_matrix(model,automaton,form_type);
+/* the entries of the outgoing transitions of the state i are between
+ * first_entry[i] and first_entry[i+1]-1. As states are sorted, incoming
+ * transitions always come from states whose entries are already known. */
+int* first_entry = (int*)malloc(sizeof(int)*automaton->number_of_states);
+/* tokenized tags of the incoming transitions, computed once per tag */
+struct dela_entry** entries = (struct dela_entry**)malloc(sizeof(struct dela_entry*)*input_tfst->tags->nbelems);
+if(first_entry == NULL || entries == NULL){
+	fatal_alloc_error("do_viterbi");
+}
+for(int i=0;i<input_tfst->tags->nbelems;i++){
+	entries[i] = NULL;
+}
 for(int i=0;i<automaton->number_of_states;i++){
+	first_entry[i] = index_matrix;
 	SingleGraphState state = automaton->states[i];
 	for(Transition* transO=state->outgoing_transitions;transO!=NULL;transO=transO->next){
 		TfstTag* tag = (TfstTag*)input_tfst->tags->tab[transO->tag_number];
@@ -679,25 +604,36 @@ for(int i=0;i<automaton->number_of_states;i++){
 			}
 			build_tag(matrix[index_matrix]->tag,NULL,tag->content);
 		}
+		set_matrix_entry_symbols(model,matrix[index_matrix]);
 		if(is_initial_state(state) != 0){
 			/* initial state has no incoming transitions so we
 			 * calculate probabilities in a separate process */
-			compute_best_probability(bin,inf,alphabet,matrix,index_matrix,1,0);
+			compute_best_probability(model,matrix,index_matrix,1,0);
 		}
 		int initial = 1;
 		for(Transition* transI=state->reverted_incoming_transitions;transI!=NULL;transI=transI->next){
 			TfstTag* tagI = (TfstTag*)input_tfst->tags->tab[transI->tag_number];
-			unichar* content = compound_to_simple(tagI->content);
-			int indexI = search_matrix_predecessor(matrix,content,index_matrix-1,
-						 transI->tag_number,transI->state_number);
-			free(content);
+			if(entries[transI->tag_number] == NULL){
+				unichar* content = compound_to_simple(tagI->content);
+				entries[transI->tag_number] = tokenize_tag_token(content);
+				free(content);
+			}
+			int indexI = search_matrix_predecessor(matrix,entries[transI->tag_number],first_entry[transI->state_number],
+						 first_entry[transI->state_number+1]-1,transI->tag_number,transI->state_number);
 			int cover_span = same_positions(&tagI->m,&tag->m);
-			compute_best_probability(bin,inf,alphabet,matrix,index_matrix,indexI,cover_span);
+			compute_best_probability(model,matrix,index_matrix,indexI,cover_span);
 			initial = 0;
 		}
 		index_matrix++;
 	}
 }
+for(int i=0;i<input_tfst->tags->nbelems;i++){
+	if(entries[i] != NULL){
+		free_dela_entry(entries[i]);
+	}
+}
+free(entries);
+free(first_entry);
 /* we compute the backtracking part of the process to prune the automata */
 vector_ptr* new_tags = do_backtracking(matrix,index_matrix-1,automaton,input_tfst->tags,form_type);
 /* we liberate all structures allocated during the process */
@@ -705,36 +641,20 @@ free_viterbi_matrix(matrix,index_matrix);
 return new_tags;
 }
 
-/*
- * Returns 1 if the data file contains 'inflected' forms;
- * this information is encoded in the dictionary
- * at the line "CODE\tFEATURES";returns 0 otherwise.
- */
-int get_form_type(const unsigned char* bin,const struct INF_codes* inf,const Alphabet* alphabet){
-unichar code_type[DIC_LINE_SIZE];
-u_sprintf(code_type,"CODE\tFEATURES");
-long int value = get_sequence_integer(code_type,bin,inf,alphabet);
-if(value == -1){
-	fatal_error("Bad value in get_form_type\n");
-}
-return (int)value;
-}
-
 /**
  * Computes Viterbi Path algorithm on each sentence of the tfst.
  * This algorithm aims at pruning tokens of the automata in order to
  * obtain a linear path (the most probable path).
  */
-void do_tagging(Tfst* input_tfst,Tfst* result_tfst,const unsigned char* bin,
-				const struct INF_codes* inf,const Alphabet* alphabet,int form_type,
-				struct hash_table* form_frequencies){
+void do_tagging(Tfst* input_tfst,Tfst* result_tfst,struct tfst_binary_writer* result_tfstb,
+				const struct tagging_model* model,int form_type,struct hash_table* form_frequencies){
 /* we write the number of sentences in the result tfst file */
 u_fprintf(result_tfst->tfst,"%010d\n",input_tfst->N);
 /* for each sentence we compute Viterbi Path algorithm */
 for(int i=1;i<=input_tfst->N;i++){
 	load_sentence(input_tfst,i);
-	vector_ptr* new_tags = do_viterbi(bin,inf,alphabet,input_tfst,form_type);
-	save_current_sentence(input_tfst,result_tfst->tfst,result_tfst->tind,
+	vector_ptr* new_tags = do_viterbi(model,input_tfst,form_type);
+	save_current_sentence(input_tfst,result_tfst->tfst,result_tfst->tind,result_tfstb,
 			(unichar**)new_tags->tab,new_tags->nbelems,form_frequencies);
 	free_vector_ptr(new_tags,free);
 	if(i%100 == 0){
@@ -40,6 +40,7 @@
 #include "ElagFunctions.h"
 #include "Match.h"
 #include "HashTable.h"
+#include "TaggingModel.h"
 
 /**
  * This structure corresponds to a entry in the viterbi
@@ -52,6 +53,10 @@
  * transition in the automata), state_number (the number of the state
  * where the transition gets away) and a partial_prob (partial probability
  * of the best predecessor).
+ * The other fields are the symbols of the tagging model that are used to
+ * compute the probabilities: tag_id is the one of tag_code and form_id the
+ * one of the form. For compound words, n_parts>0 and there is one tag
+ * symbol and one form symbol per simple word.
  */
 struct matrix_entry {
 	struct dela_entry* tag;
@@ -60,39 +65,41 @@ struct matrix_entry {
 	int tag_number;
 	int state_number;
 	float partial_prob;
+	int tag_id;
+	int form_id;
+	int n_parts;
+	int* part_tag_ids;
+	int* part_form_ids;
+	int has_underscore;
 };
 
 void compute_tag_code(struct dela_entry*,unichar*,int);
 int create_matrix_entry(const unichar*,struct matrix_entry**,int,int,int);
 struct matrix_entry** allocate_matrix(int);
-struct matrix_entry** initialize_viterbi_matrix(SingleGraph,int);
+struct matrix_entry** initialize_viterbi_matrix(const struct tagging_model*,SingleGraph,int);
 void free_matrix_entry(struct matrix_entry*);
 void free_viterbi_matrix(struct matrix_entry**,int);
 
 unichar* get_pos_unknown(const unichar*);
-int search_matrix_predecessor(struct matrix_entry**,unichar*,int,int,int);
-void get_INF_code(unsigned char*,const unichar*,int,int,int,const Alphabet*,int*);
+int search_matrix_predecessor(struct matrix_entry**,const struct dela_entry*,int,int,int,int);
 long int get_inf_value(const struct INF_codes*,int);
-long int get_sequence_integer(const unichar*,const unsigned char*,const struct INF_codes*,const Alphabet*);
 
 unichar* create_bigram_sequence(const unichar*,const unichar*,int);
 unichar* create_bigram_sequence(const char*,const unichar*,int);
-unichar* create_trigram_sequence(const unichar*,const unichar*,const unichar*);
 unichar* u_strnsuffix(const unichar*,int);
 
-double compute_emit_probability(const unsigned char*,const struct INF_codes*,const Alphabet*,const unichar*,const unichar*);
-double compute_transition_probability(const unsigned char*,const struct INF_codes*,const Alphabet*,const unichar*,const unichar*,const unichar*);
-double compute_partial_probability(const unsigned char*,const struct INF_codes*,const Alphabet*,struct matrix_entry*,struct matrix_entry*,struct matrix_entry*);
+int get_emit_form(const struct tagging_model*,const unichar*);
+void set_compound_symbols(const struct tagging_model*,struct matrix_entry*,unichar*);
+void set_matrix_entry_symbols(const struct tagging_model*,struct matrix_entry*);
+double compute_partial_probability(const struct tagging_model*,struct matrix_entry*,struct matrix_entry*,struct matrix_entry*);
 int* get_state_sequence(struct matrix_entry**,int);
 int is_compound_word(const unichar*);
 unichar* compound_to_simple(const unichar*);
 vector_ptr* do_backtracking(struct matrix_entry**,int,SingleGraph,vector_ptr*,int);
-void compute_best_probability(const unsigned char*,const struct INF_codes*,const Alphabet*,struct matrix_entry**,int,int,int);
+void compute_best_probability(const struct tagging_model*,struct matrix_entry**,int,int,int);
 
-vector_ptr* do_viterbi(unsigned char*,const struct INF_codes*,const Alphabet*,Tfst*,int);
-int get_form_type(const unsigned char*,const struct INF_codes*,const Alphabet*);
-void do_tagging(Tfst*,Tfst*,const unsigned char*,const struct INF_codes*,const Alphabet*,int,
-					struct hash_table*);
+vector_ptr* do_viterbi(const struct tagging_model*,Tfst*,int);
+void do_tagging(Tfst*,Tfst*,struct tfst_binary_writer*,const struct tagging_model*,int,struct hash_table*);
 
 #endif
 
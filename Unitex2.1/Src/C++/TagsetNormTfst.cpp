@@ -97,6 +97,8 @@ char tfst[FILENAME_MAX]="";
 char tind[FILENAME_MAX]="";
 char output_tfst[FILENAME_MAX]="";
 char output_tind[FILENAME_MAX]="";
+char tfstb[FILENAME_MAX]="";
+char output_tfstb[FILENAME_MAX]="";
 char tagset[FILENAME_MAX]="";
 Encoding encoding_output = DEFAULT_ENCODING_OUTPUT;
 int bom_output = DEFAULT_BOM_OUTPUT;
@@ -111,6 +113,7 @@ while (EOF!=(val=getopt_long_TS(argc,argv,optstring_TagsetNormTfst,lopts_TagsetN
              strcpy(output_tfst,vars->optarg);
              remove_extension(output_tfst,output_tind);
              strcat(output_tind,".tind");
+             get_tfst_binary_name(output_tfst,output_tfstb);
              break;
    case 't': if (vars->optarg[0]=='\0') {
                 fatal_error("You must specify a non empty tagset file name\n");
@@ -147,6 +150,7 @@ if (tagset[0]=='\0') {
 strcpy(tfst,argv[vars->optind]);
 remove_extension(argv[vars->optind],tind);
 strcat(tind,".tind");
+get_tfst_binary_name(tfst,tfstb);
 int no_explicit_output=0;
 char foo2[FILENAME_MAX];
 remove_path(tfst,foo2);
@@ -155,6 +159,7 @@ if (output_tfst[0]=='\0') {
    no_explicit_output=1;
    sprintf(output_tfst,"%s.new",tfst);
    sprintf(output_tind,"%s.new",tind);
+   sprintf(output_tfstb,"%s.new",tfstb);
 }
 
 u_printf("Loading tagset...\n");
@@ -178,6 +183,7 @@ U_FILE* out_tind=u_fopen(BINARY,output_tind,U_WRITE);
 if (out_tind==NULL) {
    fatal_error("Unable to open text automaton index '%s'\n",output_tind);
 }
+struct tfst_binary_writer* out_tfstb=new_tfst_binary_writer(output_tfstb);
 
 u_printf("Cleaning text automaton...\n");
 unichar foo[4096];
@@ -308,9 +314,9 @@ for (int current_sentence=1;current_sentence<=txtin->tfst->N;current_sentence++)
       free_vector_ptr(txtin->tfst->tags,(void (*)(void*))free_TfstTag);
       txtin->tfst->tags=new_vector_ptr(1);
       vector_ptr_add(txtin->tfst->tags,new_TfstTag(T_EPSILON));
-      save_current_sentence(txtin->tfst,out_tfst,out_tind,NULL,0,form_frequencies);
+      save_current_sentence(txtin->tfst,out_tfst,out_tind,out_tfstb,NULL,0,form_frequencies);
    } else {
-      save_current_sentence(txtin->tfst,out_tfst,out_tind,(unichar**)tmp_tags->value,tmp_tags->size,form_frequencies);
+      save_current_sentence(txtin->tfst,out_tfst,out_tind,out_tfstb,(unichar**)tmp_tags->value,tmp_tags->size,form_frequencies);
    }
    free_string_hash(tmp_tags);
    if (current_sentence%100==0) {
@@ -324,6 +330,7 @@ u_printf("Sentence %d/%d.\nDone: text automaton is normalized.\n",txtin->tfst->N
 tfst_file_close_in(txtin);
 u_fclose(out_tfst);
 u_fclose(out_tind);
+close_tfst_binary_writer(out_tfstb,output_tfst);
 
 /* We save statistics */
 char tfst_tags_by_freq[FILENAME_MAX];
@@ -359,6 +366,10 @@ if (no_explicit_output) {
    af_remove(tind);
    af_rename(output_tfst,tfst);
    af_rename(output_tind,tind);
+   af_remove(tfstb);
+   if (out_tfstb!=NULL) {
+      af_rename(output_tfstb,tfstb);
+   }
 }
 free_language_t(language);
 free_OptVars(vars);
@@ -0,0 +1,244 @@
+/*
+ * Unitex
+ *
+ * Copyright (C) 2001-2011 Université Paris-Est Marne-la-Vallée <unitex@univ-mlv.fr>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ *
+ */
+
+#include <stdlib.h>
+#include "TextOffsets.h"
+#include "Text_tokens.h"
+#include "Error.h"
+#include "Vector.h"
+#include "File.h"
+
+#define N_HEADER_INTS 6
+
+
+/**
+ * Builds the text.ofs file for the given text.cod and tokens.txt.
+ * Returns 1 if successful and 0 otherwise.
+ */
+int build_text_offsets(const char* text_cod,const char* tokens_txt,const char* text_ofs,
+                       int mask_encoding_compatibility_input) {
+struct text_tokens* tokens=load_text_tokens(tokens_txt,mask_encoding_compatibility_input);
+if (tokens==NULL) {
+   error("Cannot load %s\n",tokens_txt);
+   return 0;
+}
+ABSTRACTMAPFILE* amf=af_open_mapfile(text_cod,MAPFILE_OPTION_READ,0);
+if (amf==NULL) {
+   error("Cannot open %s\n",text_cod);
+   free_text_tokens(tokens);
+   return 0;
+}
+const int* text=(const int*)af_get_mapfile_pointer(amf);
+int n_tokens=(int)(af_get_mapfile_size(amf)/sizeof(int));
+int n_blocks=(n_tokens+TEXT_OFFSETS_BLOCK_SIZE-1)/TEXT_OFFSETS_BLOCK_SIZE;
+int* token_length=(int*)malloc(sizeof(int)*(tokens->N+1));
+int* char_offset=(int*)malloc(sizeof(int)*(n_blocks+1));
+int* sentence_count=(int*)malloc(sizeof(int)*(n_blocks+1));
+vector_int* sentence_start=new_vector_int(1024);
+if (token_length==NULL || char_offset==NULL || sentence_count==NULL) {
+   fatal_alloc_error("build_text_offsets");
+}
+for (int i=0;i<tokens->N;i++) {
+   token_length[i]=u_strlen(tokens->token[i]);
+}
+int chars=0;
+int markers=0;
+if (n_tokens>0) {
+   vector_int_add(sentence_start,0);
+}
+for (int i=0;i<n_tokens;i++) {
+   if (i%TEXT_OFFSETS_BLOCK_SIZE==0) {
+      char_offset[i/TEXT_OFFSETS_BLOCK_SIZE]=chars;
+      sentence_count[i/TEXT_OFFSETS_BLOCK_SIZE]=markers;
+   }
+   if (text[i]<0 || text[i]>=tokens->N) {
+      error("Invalid token number %d in %s\n",text[i],text_cod);
+      af_release_mapfile_pointer(amf,text);
+      af_close_mapfile(amf);
+      free(token_length);
+      free(char_offset);
+      free(sentence_count);
+      free_vector_int(sentence_start);
+      free_text_tokens(tokens);
+      return 0;
+   }
+   chars=chars+token_length[text[i]];
+   if (text[i]==tokens->SENTENCE_MARKER) {
+      markers++;
+      if (i+1<n_tokens) {
+         vector_int_add(sentence_start,i+1);
+      }
+   }
+}
+char_offset[n_blocks]=chars;
+sentence_count[n_blocks]=markers;
+int sentence_marker=tokens->SENTENCE_MARKER;
+af_release_mapfile_pointer(amf,text);
+af_close_mapfile(amf);
+free(token_length);
+free_text_tokens(tokens);
+int ok=0;
+U_FILE* f=u_fopen(BINARY,text_ofs,U_WRITE);
+if (f==NULL) {
+   error("Cannot create %s\n",text_ofs);
+} else {
+   int header[N_HEADER_INTS];
+   header[0]=TEXT_OFFSETS_MAGIC;
+   header[1]=TEXT_OFFSETS_VERSION;
+   header[2]=n_tokens;
+   header[3]=TEXT_OFFSETS_BLOCK_SIZE;
+   header[4]=sentence_marker;
+   header[5]=sentence_start->nbelems;
+   ok=(fwrite(header,sizeof(int),N_HEADER_INTS,f)==N_HEADER_INTS
+       && fwrite(char_offset,sizeof(int),n_blocks+1,f)==(size_t)(n_blocks+1)
+       && fwrite(sentence_count,sizeof(int),n_blocks+1,f)==(size_t)(n_blocks+1)
+       && fwrite(sentence_start->tab,sizeof(int),sentence_start->nbelems,f)==(size_t)sentence_start->nbelems);
+   u_fclose(f);
+   if (!ok) {
+      error("Cannot write %s\n",text_ofs);
+   }
+}
+free(char_offset);
+free(sentence_count);
+free_vector_int(sentence_start);
+return ok;
+}
+
+
+/**
+ * Maps the given text.ofs file. Returns NULL if the file does not exist, or
+ * if it does not match the text.cod that contains 'n_tokens' tokens, whose
+ * sentence marker is 'sentence_marker'. In that case, the caller is
+ * supposed to scan text.cod as usual.
+ */
+struct text_offsets* load_text_offsets(const char* text_ofs,int n_tokens,int sentence_marker) {
+if (!fexists(text_ofs)) {
+   return NULL;
+}
+ABSTRACTMAPFILE* amf=af_open_mapfile(text_ofs,MAPFILE_OPTION_READ,0);
+if (amf==NULL) {
+   return NULL;
+}
+const int* data=(const int*)af_get_mapfile_pointer(amf);
+size_t size=af_get_mapfile_size(amf)/sizeof(int);
+if (size<N_HEADER_INTS || data[0]!=TEXT_OFFSETS_MAGIC || data[1]!=TEXT_OFFSETS_VERSION
+    || data[2]!=n_tokens || data[3]<=0 || data[4]!=sentence_marker || data[5]<0) {
+   af_release_mapfile_pointer(amf,data);
+   af_close_mapfile(amf);
+   return NULL;
+}
+int n_blocks=(n_tokens+data[3]-1)/data[3];
+if (size!=N_HEADER_INTS+2*(size_t)(n_blocks+1)+(size_t)data[5]) {
+   af_release_mapfile_pointer(amf,data);
+   af_close_mapfile(amf);
+   return NULL;
+}
+struct text_offsets* offsets=(struct text_offsets*)malloc(sizeof(struct text_offsets));
+if (offsets==NULL) {
+   fatal_alloc_error("load_text_offsets");
+}
+offsets->amf=amf;
+offsets->data=data;
+offsets->n_tokens=n_tokens;
+offsets->block_size=data[3];
+offsets->sentence_marker=sentence_marker;
+offsets->n_sentences=data[5];
+offsets->char_offset=data+N_HEADER_INTS;
+offsets->sentence_count=offsets->char_offset+n_blocks+1;
+offsets->sentence_start=offsets->sentence_count+n_blocks+1;
+return offsets;
+}
+
+
+void free_text_offsets(struct text_offsets* offsets) {
+if (offsets==NULL) return;
+af_release_mapfile_pointer(offsets->amf,offsets->data);
+af_close_mapfile(offsets->amf);
+free(offsets);
+}
+
+
+/**
+ * Returns the number of characters that occur in the text before the token
+ * at position 'pos', according to the given token lengths. If
+ * 'n_sentence_markers' is not NULL, it receives the number of sentence
+ * markers before 'pos', which is also the number of the sentence that
+ * contains 'pos', starting from 0.
+ */
+int get_text_offset(const struct text_offsets* offsets,const int* text,const int* token_length,
+                    int pos,int* n_sentence_markers) {
+int block=pos/offsets->block_size;
+int chars=offsets->char_offset[block];
+int markers=offsets->sentence_count[block];
+for (int i=block*offsets->block_size;i<pos;i++) {
+   chars=chars+token_length[text[i]];
+   if (text[i]==offsets->sentence_marker) {
+      markers++;
+   }
+}
+if (n_sentence_markers!=NULL) {
+   (*n_sentence_markers)=markers;
+}
+return chars;
+}
+
+
+/**
+ * Returns the number of the sentence that contains the token at position 'pos',
+ * starting from 0.
+ */
+int get_sentence_number(const struct text_offsets* offsets,const int* text,int pos) {
+int block=pos/offsets->block_size;
+int markers=offsets->sentence_count[block];
+for (int i=block*offsets->block_size;i<pos;i++) {
+   if (text[i]==offsets->sentence_marker) {
+      markers++;
+   }
+}
+return markers;
+}
+
+
+/**
+ * Returns the position of the first token of the given sentence,
+ * numbered from 0.
+ */
+int get_sentence_start(const struct text_offsets* offsets,int sentence) {
+if (sentence<0 || sentence>=offsets->n_sentences) {
+   fatal_error("Invalid sentence number %d in get_sentence_start\n",sentence);
+}
+return offsets->sentence_start[sentence];
+}
+
+
+/**
+ * Returns the position that follows the last token of the given sentence,
+ * numbered from 0.
+ */
+int get_sentence_end(const struct text_offsets* offsets,int sentence) {
+if (sentence<0 || sentence>=offsets->n_sentences) {
+   fatal_error("Invalid sentence number %d in get_sentence_end\n",sentence);
+}
+if (sentence+1==offsets->n_sentences) {
+   return offsets->n_tokens;
+}
+return offsets->sentence_start[sentence+1];
+}
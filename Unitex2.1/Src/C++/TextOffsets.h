@@ -0,0 +1,73 @@
+/*
+ * Unitex
+ *
+ * Copyright (C) 2001-2011 Université Paris-Est Marne-la-Vallée <unitex@univ-mlv.fr>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ *
+ */
+
+#ifndef TextOffsetsH
+#define TextOffsetsH
+
+#include "Unicode.h"
+
+/**
+ * A text.ofs file is an optional index over text.cod, built by Tokenize --offsets.
+ * It gives in constant time the position in characters of any token and the
+ * number of the sentence it belongs to, so that Concord and Extract can jump
+ * to a match instead of scanning text.cod from its beginning.
+ *
+ * For every block of 'block_size' tokens, the file stores the number of characters
+ * and the number of sentence markers {S} that occur before the block. The values
+ * for a token inside a block are obtained by adding the few tokens of text.cod
+ * that precede it in the block. The file also stores the position of the first
+ * token of each sentence. All values are ints in the same byte order as text.cod,
+ * so that the file can be mapped in memory:
+ *
+ * TEXT_OFFSETS_MAGIC, TEXT_OFFSETS_VERSION, n_tokens, block_size, sentence_marker,
+ * n_sentences, char_offset[n_blocks+1], sentence_count[n_blocks+1],
+ * sentence_start[n_sentences]
+ */
+
+#define TEXT_OFFSETS_MAGIC 0x7346664F
+#define TEXT_OFFSETS_VERSION 1
+#define TEXT_OFFSETS_BLOCK_SIZE 64
+
+
+struct text_offsets {
+   ABSTRACTMAPFILE* amf;
+   const int* data;
+   int n_tokens;
+   int block_size;
+   int sentence_marker;
+   int n_sentences;
+   const int* char_offset;
+   const int* sentence_count;
+   const int* sentence_start;
+};
+
+
+int build_text_offsets(const char* text_cod,const char* tokens_txt,const char* text_ofs,
+                       int mask_encoding_compatibility_input);
+struct text_offsets* load_text_offsets(const char* text_ofs,int n_tokens,int sentence_marker);
+void free_text_offsets(struct text_offsets*);
+int get_text_offset(const struct text_offsets*,const int* text,const int* token_length,
+                    int pos,int* n_sentence_markers);
+int get_sentence_number(const struct text_offsets*,const int* text,int pos);
+int get_sentence_start(const struct text_offsets*,int sentence);
+int get_sentence_end(const struct text_offsets*,int sentence);
+
+#endif
@@ -613,6 +613,17 @@ struct locate_parameters* p /* miscellaneous parameters needed by the function *
 		}
 
 		do {
+			int n_first_tokens = p->n_graph_first_tokens[graph_call_list->graph_number];
+			if (n_first_tokens != -1 && token2 != -1) {
+				/* If we know the tokens that can start a match of the graph, we
+				 * don't call it when the current one is not among them. We
+				 * behave as if the graph had tested this token. */
+				update_last_tested_position(p, pos2);
+				if (binary_search(token2, p->graph_first_tokens[graph_call_list->graph_number],
+						n_first_tokens) == -1) {
+					continue;
+				}
+			}
 			/* For each graph call, we look all the reachable states */
 			t1 = graph_call_list->transition;
 			while (t1 != NULL) {
@@ -2026,14 +2037,19 @@ if (l == NULL)
 		 *   1) offset in token
 		 *   2) offset in char inside the token
 		 *   3) offset in logical letter inside the current char (for Korean) */
+		int end_pos_in_char = u_strlen(
+				p->tokens->value[p->buffer[l->m.end_pos_in_token]]) - 1;
 		u_fprintf(f, "%d.0.0 %d.%d.0", l->m.start_pos_in_token,
-				l->m.end_pos_in_token, u_strlen(
-						p->tokens->value[p->buffer[l->m.end_pos_in_token]]) - 1);
+				l->m.end_pos_in_token, end_pos_in_char);
 		if (l->output != NULL) {
 			/* If there is an output */
 			u_fprintf(f, " %S", l->output);
 		}
 		u_fprintf(f, "\n");
+		if (p->saved_matches != NULL) {
+			add_saved_match(p->saved_matches, l->m.start_pos_in_token,
+					l->m.end_pos_in_token, end_pos_in_char, l->output);
+		}
 		if (p->ambiguous_output_policy == ALLOW_AMBIGUOUS_OUTPUTS) {
 			(p->number_of_outputs)++;
 			/* If we allow different outputs for ambiguous transducers,
@@ -22,6 +22,7 @@
 #include "Text_tokens.h"
 #include "Error.h"
 #include "Token.h"
+#include "Pipeline.h"
 
 
 struct text_tokens* new_text_tokens(Abstract_allocator prv_alloc) {
@@ -37,7 +38,19 @@ return tmp;
 }
 
 
+static void release_text_tokens(void* tok) {
+free_text_tokens((struct text_tokens*)tok);
+}
+
+
 struct text_tokens* load_text_tokens(const char* nom,int mask_encoding_compatibility_input,Abstract_allocator prv_alloc) {
+if (prv_alloc==STANDARD_ALLOCATOR) {
+   /* Only tokens allocated in the standard way can be shared */
+   struct text_tokens* tok=(struct text_tokens*)get_pipeline_resource(nom,PIPELINE_TEXT_TOKENS);
+   if (tok!=NULL) {
+      return tok;
+   }
+}
 U_FILE* f;
 f=u_fopen_existing_versatile_encoding(mask_encoding_compatibility_input,nom,U_READ);
 if (f==NULL) {
@@ -77,6 +90,9 @@ while (EOF!=(size_gets=u_fgets(tmp,MAX_TAG_LENGTH,f))) {
   }
 }
 u_fclose(f);
+if (prv_alloc==STANDARD_ALLOCATOR) {
+   keep_pipeline_resource(nom,PIPELINE_TEXT_TOKENS,res,release_text_tokens);
+}
 return res;
 }
 
@@ -85,6 +101,23 @@ struct string_hash* load_text_tokens_hash(const char* nom,int mask_encoding_comp
                                           int *SENTENCE_MARKER,
                                           int* STOP_MARKER,
                                           int *NUMBER_OF_TEXT_TOKENS,Abstract_allocator /* prv_alloc */) {
+/* In a pipeline, the tokens may have been loaded or given by another tool */
+struct text_tokens* tok=(struct text_tokens*)get_pipeline_resource(nom,PIPELINE_TEXT_TOKENS);
+if (tok!=NULL) {
+   (*SENTENCE_MARKER)=-1;
+   (*NUMBER_OF_TEXT_TOKENS)=tok->N;
+   struct string_hash* res=new_string_hash(tok->N);
+   for (int i=0;i<tok->N;i++) {
+      int x=get_value_index(tok->token[i],res);
+      if (!u_strcmp(tok->token[i],"{S}")) {
+         *SENTENCE_MARKER=x;
+      } else if (!u_strcmp(tok->token[i],"{STOP}")) {
+         *STOP_MARKER=i;
+      }
+   }
+   unuse_pipeline_resource(tok);
+   return res;
+}
 U_FILE* f;
 f=u_fopen_existing_versatile_encoding(mask_encoding_compatibility_input,nom,U_READ);
 if (f==NULL) {
@@ -125,6 +158,7 @@ return res;
 
 
 void free_text_tokens(struct text_tokens* tok,Abstract_allocator prv_alloc) {
+if (unuse_pipeline_resource(tok)) return;
 for (int i=0;i<tok->N;i++) {
    free_cb(tok->token[i],prv_alloc);
 }
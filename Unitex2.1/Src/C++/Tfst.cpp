@@ -26,7 +26,8 @@
 #include "TfstStats.h"
 
 
-void free_current_sentence(Tfst*);
+void open_tfst_binary(Tfst*,const char*);
+void load_binary_sentence(Tfst*,int);
 
 
 
@@ -50,6 +51,9 @@ t->offset_in_tokens=-1;
 t->offset_in_chars=-1;
 t->automaton=NULL;
 t->tags=NULL;
+t->tfstb=NULL;
+t->tfstb_data=NULL;
+t->tfstb_size=0;
 return t;
 }
 
@@ -61,6 +65,10 @@ void close_text_automaton(Tfst* t) {
 if (t==NULL) return;
 if (t->tfst!=NULL) u_fclose(t->tfst);
 if (t->tind!=NULL) u_fclose(t->tind);
+if (t->tfstb!=NULL) {
+   af_release_mapfile_pointer(t->tfstb,t->tfstb_data);
+   af_close_mapfile(t->tfstb);
+}
 free_current_sentence(t);
 free(t);
 }
@@ -99,7 +107,78 @@ if (1!=u_fscanf(f,"%d",&N) || N<=0 || N*4!=size) {
    error("Bad number of sentence: %d\n",N);
    return NULL;
 }
-return new_Tfst(f,f2,N);
+Tfst* t=new_Tfst(f,f2,N);
+open_tfst_binary(t,tfst);
+return t;
+}
+
+
+/**
+ * Returns a hash of the bytes of the given .tfst from 'start' to 'end', or -1
+ * if the file cannot be read or is not that long.
+ */
+static int get_tfst_hash(const char* tfst,long start,long end) {
+ABSTRACTMAPFILE* amf=af_open_mapfile(tfst,MAPFILE_OPTION_READ,0);
+if (amf==NULL) {
+   return -1;
+}
+const unsigned char* data=(const unsigned char*)af_get_mapfile_pointer(amf);
+size_t size=af_get_mapfile_size(amf);
+int hash=-1;
+if (data!=NULL && start>=0 && start<=end && (size_t)end<=size) {
+   unsigned int h=2166136261u;
+   for (long i=start;i<end;i++) {
+      h=(h^data[i])*16777619u;
+   }
+   hash=(int)(h&0x7FFFFFFF);
+}
+if (data!=NULL) af_release_mapfile_pointer(amf,data);
+af_close_mapfile(amf);
+return hash;
+}
+
+
+/**
+ * Maps the .tfstb file that goes with the given .tfst, if any. The file is
+ * ignored if it is not valid or if it does not match the .tfst.
+ */
+void open_tfst_binary(Tfst* t,const char* tfst) {
+char tfstb[FILENAME_MAX];
+get_tfst_binary_name(tfst,tfstb);
+if (!fexists(tfstb)) {
+   return;
+}
+ABSTRACTMAPFILE* amf=af_open_mapfile(tfstb,MAPFILE_OPTION_READ,0);
+if (amf==NULL) {
+   return;
+}
+const int* data=(const int*)af_get_mapfile_pointer(amf);
+size_t size=af_get_mapfile_size(amf);
+size_t n_ints=size/sizeof(int);
+int ok=(data!=NULL && n_ints>=TFSTB_HEADER_SIZE
+        && data[0]==TFSTB_MAGIC && data[1]==TFSTB_VERSION && data[2]==t->N
+        && data[3]==(int)get_file_size(tfst) && data[4]>=0
+        && data[5]>0 && data[5]%sizeof(int)==0 && data[6]>0 && data[6]%sizeof(int)==0
+        && data[7]>=0 && data[7]<=data[3] && data[8]>=0);
+if (ok) {
+   /* The sizes may match while the contents differ */
+   ok=(data[8]==get_tfst_hash(tfst,data[7],data[3]));
+}
+if (ok) {
+   /* The content table and the sentence index must fit in the file */
+   size_t contents=data[5]/sizeof(int);
+   size_t index=data[6]/sizeof(int);
+   ok=(contents+data[4]+1<=n_ints && index+t->N<=n_ints
+       && (size_t)data[contents+data[4]]*sizeof(unichar)<=size-sizeof(int)*(contents+data[4]+1));
+}
+if (!ok) {
+   if (data!=NULL) af_release_mapfile_pointer(amf,data);
+   af_close_mapfile(amf);
+   return;
+}
+t->tfstb=amf;
+t->tfstb_data=data;
+t->tfstb_size=size;
 }
 
 
@@ -133,6 +212,39 @@ tfst->tags=NULL;
 }
 
 
+/**
+ * Moves the current sentence of 'src' into 'dest', so that 'dest' can be
+ * kept while other sentences are loaded in 'src'. If 'dest' already had a
+ * sentence, it is freed first.
+ */
+void move_current_sentence(Tfst* src,Tfst* dest) {
+if (src==NULL || dest==NULL) {
+   fatal_error("NULL error in move_current_sentence\n");
+}
+if (dest->current_sentence!=NO_SENTENCE_LOADED) {
+   free_current_sentence(dest);
+}
+dest->current_sentence=src->current_sentence;
+dest->text=src->text;
+dest->tokens=src->tokens;
+dest->token_sizes=src->token_sizes;
+dest->token_content=src->token_content;
+dest->offset_in_tokens=src->offset_in_tokens;
+dest->offset_in_chars=src->offset_in_chars;
+dest->automaton=src->automaton;
+dest->tags=src->tags;
+src->current_sentence=NO_SENTENCE_LOADED;
+src->text=NULL;
+src->tokens=NULL;
+src->token_sizes=NULL;
+src->token_content=NULL;
+src->offset_in_tokens=-1;
+src->offset_in_chars=-1;
+src->automaton=NULL;
+src->tags=NULL;
+}
+
+
 /**
  * Returns the offset of the given sentence in the .tfst of the
  * given text automaton. Remember that sentences are numbered from 1.
@@ -236,6 +348,10 @@ if (tfst->current_sentence!=NO_SENTENCE_LOADED) {
    free_current_sentence(tfst);
 }
 tfst->current_sentence=n;
+if (tfst->tfstb!=NULL) {
+   load_binary_sentence(tfst,n);
+   return;
+}
 long offset=get_sentence_offset(tfst,n);
 fseek(tfst->tfst,offset,SEEK_SET);
 /* Now we can read the sentence */
@@ -314,6 +430,95 @@ free_Ustring(foo);
 }
 
 
+/**
+ * Loads the given sentence from the .tfstb mapped in memory. The
+ * structures built are the same as the ones built from the .tfst.
+ */
+void load_binary_sentence(Tfst* tfst,int n) {
+const int* data=tfst->tfstb_data;
+size_t n_ints=tfst->tfstb_size/sizeof(int);
+int offset=data[data[6]/sizeof(int)+n-1];
+if (offset<=0 || offset%sizeof(int)!=0 || offset/sizeof(int)+TFSTB_SENTENCE_HEADER_SIZE>n_ints) {
+   fatal_error("load_binary_sentence: invalid offset for sentence %d\n",n);
+}
+const int* h=data+offset/sizeof(int);
+int text_length=h[3];
+int n_tokens=h[4];
+int n_states=h[5];
+int n_transitions=h[6];
+int n_tags=h[7];
+if (h[0]!=n || text_length<0 || n_tokens<0 || n_states<0 || n_transitions<0 || n_tags<=0) {
+   fatal_error("load_binary_sentence: invalid header for sentence %d\n",n);
+}
+size_t record_size=TFSTB_SENTENCE_HEADER_SIZE+2*(size_t)n_tokens+2*(size_t)n_states+1
+                   +2*(size_t)n_transitions+TFSTB_TAG_SIZE*(size_t)n_tags
+                   +(text_length*sizeof(unichar)+sizeof(int)-1)/sizeof(int);
+if (offset/sizeof(int)+record_size>n_ints) {
+   fatal_error("load_binary_sentence: sentence %d is truncated\n",n);
+}
+tfst->offset_in_tokens=h[1];
+tfst->offset_in_chars=h[2];
+const int* tokens=h+TFSTB_SENTENCE_HEADER_SIZE;
+const int* token_sizes=tokens+n_tokens;
+const int* first_transition=token_sizes+n_tokens;
+const int* is_final=first_transition+n_states+1;
+const int* transitions=is_final+n_states;
+const int* tags=transitions+2*n_transitions;
+const unichar* text=(const unichar*)(tags+TFSTB_TAG_SIZE*n_tags);
+tfst->text=(unichar*)malloc((text_length+1)*sizeof(unichar));
+if (tfst->text==NULL) {
+   fatal_alloc_error("load_binary_sentence");
+}
+memcpy(tfst->text,text,text_length*sizeof(unichar));
+tfst->text[text_length]='\0';
+tfst->tokens=new_vector_int(n_tokens);
+tfst->token_sizes=new_vector_int(n_tokens);
+memcpy(tfst->tokens->tab,tokens,n_tokens*sizeof(int));
+memcpy(tfst->token_sizes->tab,token_sizes,n_tokens*sizeof(int));
+tfst->tokens->nbelems=n_tokens;
+tfst->token_sizes->nbelems=n_tokens;
+tfst->automaton=new_SingleGraph(n_states,INT_TAGS);
+for (int i=0;i<n_states;i++) {
+   SingleGraphState s=add_state(tfst->automaton);
+   if (i==0) {
+      /* By convention, the first state is initial */
+      set_initial_state(s);
+   }
+   if (is_final[i]) {
+      set_final_state(s);
+   }
+   if (first_transition[i]<0 || first_transition[i]>first_transition[i+1] || first_transition[i+1]>n_transitions) {
+      fatal_error("load_binary_sentence: invalid transitions for sentence %d\n",n);
+   }
+   for (int j=first_transition[i];j<first_transition[i+1];j++) {
+      add_outgoing_transition(s,transitions[2*j],transitions[2*j+1]);
+   }
+}
+const int* contents=data+data[5]/sizeof(int);
+const unichar* pool=(const unichar*)(contents+data[4]+1);
+tfst->tags=new_vector_ptr(n_tags);
+for (int i=0;i<n_tags;i++) {
+   const int* t=tags+TFSTB_TAG_SIZE*i;
+   if (t[0]==-1) {
+      vector_ptr_add(tfst->tags,new_TfstTag(T_EPSILON));
+      continue;
+   }
+   if (t[0]<0 || t[0]>=data[4]) {
+      fatal_error("load_binary_sentence: invalid tag content in sentence %d\n",n);
+   }
+   TfstTag* tag=new_TfstTag(T_STD);
+   tag->content=u_strdup(pool+contents[t[0]]);
+   tag->m.start_pos_in_token=t[1];
+   tag->m.start_pos_in_char=t[2];
+   tag->m.start_pos_in_letter=t[3];
+   tag->m.end_pos_in_token=t[4];
+   tag->m.end_pos_in_char=t[5];
+   tag->m.end_pos_in_letter=t[6];
+   vector_ptr_add(tfst->tags,tag);
+}
+}
+
+
 /**
  * Allocates, initializes and returns a TfstTag
  */
@@ -368,8 +573,213 @@ if (4!=fwrite(t,1,4,tind)) {
 }
 
 
+/**
+ * Adds the given tag to the sentence record being built.
+ */
+static void add_binary_tag(struct tfst_binary_writer* w,int content,const Match* m) {
+vector_int_add(w->record,content);
+vector_int_add(w->record,m->start_pos_in_token);
+vector_int_add(w->record,m->start_pos_in_char);
+vector_int_add(w->record,m->start_pos_in_letter);
+vector_int_add(w->record,m->end_pos_in_token);
+vector_int_add(w->record,m->end_pos_in_char);
+vector_int_add(w->record,m->end_pos_in_letter);
+}
+
+
+/**
+ * Adds to the sentence record a tag given as a ready-to-dump label
+ * like "@STD\n@{de,.PREP}\n@2.0.0-2.1.0\n.\n"
+ */
+static void add_binary_tag_label(struct tfst_binary_writer* w,unichar* label) {
+Match m;
+m.start_pos_in_token=m.start_pos_in_char=m.start_pos_in_letter=-1;
+m.end_pos_in_token=m.end_pos_in_char=m.end_pos_in_letter=-1;
+if (!u_strcmp(label,"@<E>\n.\n")) {
+   add_binary_tag(w,-1,&m);
+   return;
+}
+if (!u_starts_with(label,"@STD\n@")) {
+   fatal_error("save_current_sentence: invalid tag label %S\n",label);
+}
+unichar* content=label+6;
+int length=0;
+while (content[length]!='\n' && content[length]!='\0') length++;
+if (content[length]!='\n' || content[length+1]!='@' ||
+    6!=u_sscanf(content+length+2,"%d.%d.%d-%d.%d.%d",&(m.start_pos_in_token),&(m.start_pos_in_char),
+                &(m.start_pos_in_letter),&(m.end_pos_in_token),&(m.end_pos_in_char),&(m.end_pos_in_letter))) {
+   fatal_error("save_current_sentence: invalid tag label %S\n",label);
+}
+unichar* tmp=(unichar*)malloc((length+1)*sizeof(unichar));
+if (tmp==NULL) {
+   fatal_alloc_error("add_binary_tag_label");
+}
+u_strncpy(tmp,content,length);
+tmp[length]='\0';
+add_binary_tag(w,get_value_index(tmp,w->contents),&m);
+free(tmp);
+}
+
+
+/**
+ * Writes the given ints to the given binary file.
+ */
+static void write_ints(const int* t,int n,U_FILE* f) {
+if (n>0 && (size_t)n!=fwrite(t,sizeof(int),n,f)) {
+   fatal_error("Write error on .tfstb file\n");
+}
+}
+
+
+/**
+ * Saves the current sentence of the given tfst in the given .tfstb.
+ */
+static void save_binary_sentence(Tfst* tfst,struct tfst_binary_writer* w,unichar** tags,int n_tags) {
+vector_int_add(w->index,(int)ftell(w->f));
+SingleGraph g=tfst->automaton;
+int n_tokens=tfst->tokens->nbelems;
+int text_length=u_strlen(tfst->text);
+w->record->nbelems=0;
+vector_int_add(w->record,tfst->current_sentence);
+vector_int_add(w->record,tfst->offset_in_tokens);
+vector_int_add(w->record,tfst->offset_in_chars);
+vector_int_add(w->record,text_length);
+vector_int_add(w->record,n_tokens);
+vector_int_add(w->record,g->number_of_states);
+int n_transitions_pos=vector_int_add(w->record,0);
+vector_int_add(w->record,(tags!=NULL)?n_tags:tfst->tags->nbelems);
+for (int i=0;i<n_tokens;i++) {
+   vector_int_add(w->record,tfst->tokens->tab[i]);
+}
+for (int i=0;i<n_tokens;i++) {
+   vector_int_add(w->record,tfst->token_sizes->tab[i]);
+}
+int n_transitions=0;
+for (int i=0;i<g->number_of_states;i++) {
+   vector_int_add(w->record,n_transitions);
+   for (Transition* trans=g->states[i]->outgoing_transitions;trans!=NULL;trans=trans->next) {
+      n_transitions++;
+   }
+}
+vector_int_add(w->record,n_transitions);
+w->record->tab[n_transitions_pos]=n_transitions;
+for (int i=0;i<g->number_of_states;i++) {
+   vector_int_add(w->record,is_final_state(g->states[i]));
+}
+for (int i=0;i<g->number_of_states;i++) {
+   for (Transition* trans=g->states[i]->outgoing_transitions;trans!=NULL;trans=trans->next) {
+      vector_int_add(w->record,trans->tag_number);
+      vector_int_add(w->record,trans->state_number);
+   }
+}
+if (tags!=NULL) {
+   for (int i=0;i<n_tags;i++) {
+      add_binary_tag_label(w,tags[i]);
+   }
+} else {
+   for (int i=0;i<tfst->tags->nbelems;i++) {
+      TfstTag* t=(TfstTag*)(tfst->tags->tab[i]);
+      add_binary_tag(w,(t->type==T_EPSILON)?-1:get_value_index(t->content,w->contents),&(t->m));
+   }
+}
+/* The text is padded with \0 up to the next int */
+int n_text_ints=(int)((text_length*sizeof(unichar)+sizeof(int)-1)/sizeof(int));
+int text_pos=w->record->nbelems;
+for (int i=0;i<n_text_ints;i++) {
+   vector_int_add(w->record,0);
+}
+memcpy(w->record->tab+text_pos,tfst->text,text_length*sizeof(unichar));
+write_ints(w->record->tab,w->record->nbelems,w->f);
+}
+
+
+/**
+ * Builds the name of the .tfstb that goes with the given .tfst.
+ */
+void get_tfst_binary_name(const char* tfst,char* tfstb) {
+remove_extension(tfst,tfstb);
+strcat(tfstb,".tfstb");
+}
+
+
+/**
+ * Creates the given .tfstb file. Returns NULL if the file cannot be
+ * created, which is not an error since the .tfstb is only an optional
+ * companion of the .tfst.
+ */
+struct tfst_binary_writer* new_tfst_binary_writer(const char* tfstb) {
+U_FILE* f=u_fopen(BINARY,tfstb,U_WRITE);
+if (f==NULL) {
+   error("Cannot create %s\n",tfstb);
+   return NULL;
+}
+struct tfst_binary_writer* w=(struct tfst_binary_writer*)malloc(sizeof(struct tfst_binary_writer));
+if (w==NULL) {
+   fatal_alloc_error("new_tfst_binary_writer");
+}
+w->f=f;
+w->index=new_vector_int();
+w->contents=new_string_hash();
+w->tfst_start=-1;
+w->tfst_size=-1;
+w->record=new_vector_int(1024);
+/* The header will be filled when closing the file */
+int header[TFSTB_HEADER_SIZE];
+memset(header,0,sizeof(header));
+write_ints(header,TFSTB_HEADER_SIZE,f);
+return w;
+}
+
+
+/**
+ * Writes the tag content table, the sentence index and the header of
+ * the given .tfstb, and frees the writer. 'tfst' is the .tfst that has
+ * been written with it, which must have been closed.
+ */
+void close_tfst_binary_writer(struct tfst_binary_writer* w,const char* tfst) {
+if (w==NULL) return;
+int header[TFSTB_HEADER_SIZE];
+header[0]=TFSTB_MAGIC;
+header[1]=TFSTB_VERSION;
+header[2]=w->index->nbelems;
+header[3]=(int)w->tfst_size;
+header[4]=w->contents->size;
+header[5]=(int)ftell(w->f);
+header[7]=(w->tfst_start<0)?0:(int)w->tfst_start;
+header[8]=get_tfst_hash(tfst,header[7],w->tfst_size);
+w->record->nbelems=0;
+int pos=0;
+for (int i=0;i<w->contents->size;i++) {
+   vector_int_add(w->record,pos);
+   pos=pos+u_strlen(w->contents->value[i])+1;
+}
+vector_int_add(w->record,pos);
+write_ints(w->record->tab,w->record->nbelems,w->f);
+for (int i=0;i<w->contents->size;i++) {
+   int length=u_strlen(w->contents->value[i])+1;
+   if ((size_t)length!=fwrite(w->contents->value[i],sizeof(unichar),length,w->f)) {
+      fatal_error("Write error on .tfstb file\n");
+   }
+}
+if (pos%2!=0) {
+   unichar padding='\0';
+   fwrite(&padding,sizeof(unichar),1,w->f);
+}
+header[6]=(int)ftell(w->f);
+write_ints(w->index->tab,w->index->nbelems,w->f);
+fseek(w->f,0,SEEK_SET);
+write_ints(header,TFSTB_HEADER_SIZE,w->f);
+u_fclose(w->f);
+free_vector_int(w->index);
+free_vector_int(w->record);
+free_string_hash(w->contents);
+free(w);
+}
+
+
 /**
  * Saves the current sentence of the given tfst.
+ * If 'out_tfstb' is not NULL, the sentence is also saved in this .tfstb.
  * If 'tags' is not NULL, it is supposed to contain ready-to-dump tag labels that
  * will be used; otherwise, the function saves each TfstTag.
  *
@@ -377,8 +787,8 @@ if (4!=fwrite(t,1,4,tind)) {
  *
  * WARNING: if tags are provided, they are supposed to be \n terminated !
  */
-void save_current_sentence(Tfst* tfst,U_FILE* out_tfst,U_FILE* out_tind,unichar** tags,int n_tags,
-							struct hash_table* form_frequencies) {
+void save_current_sentence(Tfst* tfst,U_FILE* out_tfst,U_FILE* out_tind,struct tfst_binary_writer* out_tfstb,
+                           unichar** tags,int n_tags,struct hash_table* form_frequencies) {
 if (tfst==NULL) {
    fatal_error("NULL tfst in save_current_sentence\n");
 }
@@ -413,6 +823,9 @@ if (form_frequencies!=NULL) {
 /* First, we update the offset index in the .tind file */
 long offset=ftell(out_tfst);
 dump_offset(offset,out_tind);
+if (out_tfstb!=NULL && out_tfstb->tfst_start<0) {
+   out_tfstb->tfst_start=offset;
+}
 
 /* Then we save the sentence automaton */
 u_fprintf(out_tfst,"$%d\n",tfst->current_sentence);
@@ -457,6 +870,10 @@ if (tags!=NULL) {
    }
 }
 u_fprintf(out_tfst,"f\n");
+if (out_tfstb!=NULL) {
+   save_binary_sentence(tfst,out_tfstb,tags,n_tags);
+   out_tfstb->tfst_size=ftell(out_tfst);
+}
 }
 
 
@@ -32,6 +32,7 @@
 #include "SingleGraph.h"
 #include "Match.h"
 #include "HashTable.h"
+#include "String_hash.h"
 
 #define NO_SENTENCE_LOADED -1
 
@@ -71,9 +72,65 @@ typedef struct {
    /* The tags of the current sentence automaton */
    vector_ptr* tags;
 
+   /* The .tfstb file, if any, mapped in memory. When it is present,
+    * sentences are loaded from it instead of being parsed from the .tfst */
+   ABSTRACTMAPFILE* tfstb;
+   const int* tfstb_data;
+   size_t tfstb_size;
+
 } Tfst;
 
 
+/**
+ * A .tfstb file is a binary companion of a .tfst file. It describes the same
+ * sentence automata, but with packed int arrays that can be mapped in memory,
+ * so that loading a sentence does not require any text parsing. All values
+ * are ints in the byte order of the machine that wrote the file:
+ *
+ * header: TFSTB_MAGIC, TFSTB_VERSION, N, size of the .tfst in bytes, number of
+ *         tag contents, offset of the tag content table, offset of the sentence
+ *         index, offset of the first sentence in the .tfst, hash of the .tfst
+ *         from this offset
+ *
+ * sentence: number, offset_in_tokens, offset_in_chars, text length,
+ *           n_tokens, n_states, n_transitions, n_tags,
+ *           tokens[n_tokens], token_sizes[n_tokens],
+ *           first_transition[n_states+1], is_final[n_states],
+ *           (tag,destination)[n_transitions],
+ *           (content,a,b,c,d,e,f)[n_tags], the text as unichars padded to an int
+ *
+ * The content of a tag is an index in the content table (-1 for the epsilon
+ * tag), that is shared by all the sentences; a,b,...,f are the bounds of the
+ * tag as in the .tfst. The content table is made of n+1 offsets in unichars
+ * followed by the \0-terminated contents, and the sentence index gives the
+ * offset in bytes of each sentence.
+ *
+ * The file is only used when its number of sentences, and the size and the
+ * hash of the .tfst it was written with match the .tfst, so that a stale .tfstb
+ * is ignored. The hash does not cover the first line of the .tfst, since the
+ * number of sentences may be written there after the .tfstb.
+ */
+#define TFSTB_MAGIC 0x62747354
+#define TFSTB_VERSION 2
+#define TFSTB_HEADER_SIZE 9
+#define TFSTB_SENTENCE_HEADER_SIZE 8
+#define TFSTB_TAG_SIZE 7
+
+struct tfst_binary_writer {
+   U_FILE* f;
+   /* Offset in bytes of each sentence already written */
+   vector_int* index;
+   /* The tag contents used in all the sentences */
+   struct string_hash* contents;
+   /* Offset of the first saved sentence in the .tfst, and size of the .tfst
+    * after the last one */
+   long tfst_start;
+   long tfst_size;
+   /* Buffer used to build a sentence record */
+   vector_int* record;
+};
+
+
 
 /**
  * Here are the types of transitions supported in a Tfst.
@@ -123,8 +180,14 @@ Tfst* new_Tfst(U_FILE* tfst,U_FILE* tind,int N);
 Tfst* open_text_automaton(char* tfst);
 void close_text_automaton(Tfst* tfst);
 void load_sentence(Tfst* tfst,int n);
-void save_current_sentence(Tfst* tfst,U_FILE* out_tfst,U_FILE* tind,unichar** tags,int n_tags,
-							struct hash_table* form_frequencies);
+void move_current_sentence(Tfst* src,Tfst* dest);
+void free_current_sentence(Tfst* tfst);
+void save_current_sentence(Tfst* tfst,U_FILE* out_tfst,U_FILE* tind,struct tfst_binary_writer* out_tfstb,
+                           unichar** tags,int n_tags,struct hash_table* form_frequencies);
+
+void get_tfst_binary_name(const char* tfst,char* tfstb);
+struct tfst_binary_writer* new_tfst_binary_writer(const char* tfstb);
+void close_tfst_binary_writer(struct tfst_binary_writer*,const char* tfst);
 
 TfstTag* new_TfstTag(TfstTagType);
 void free_TfstTag(TfstTag*);
@@ -34,6 +34,7 @@
 #include "UnitexGetOpt.h"
 #include "Tokenize.h"
 #include "Token.h"
+#include "TextOffsets.h"
 
 
 #define NORMAL 0
@@ -87,6 +88,8 @@ const char* usage_Tokenize =
          "  -w/--word_by_word: word by word tokenization (default);\n"
          "  -t TOKENS/--tokens=TOKENS: specifies a tokens.txt file to load and modify, instead of\n"
          "                             creating a new one from scratch;\n"
+         "  -o/--offsets: also builds the \"text.ofs\" index that gives the position in characters\n"
+         "                and the sentence of any token, used by Concord and Extract on big texts;\n"
          "  -h/--help: this help\n"
          "\n"
          "Tokenizes the text. The token list is stored into \"tokens.txt\" and\n"
@@ -104,12 +107,13 @@ u_printf(usage_Tokenize);
 }
 
 
-const char* optstring_Tokenize=":a:cwt:hk:q:";
+const char* optstring_Tokenize=":a:cwt:ohk:q:";
 const struct option_TS lopts_Tokenize[]={
    {"alphabet", required_argument_TS, NULL, 'a'},
    {"char_by_char", no_argument_TS, NULL, 'c'},
    {"word_by_word", no_argument_TS, NULL, 'w'},
    {"tokens", required_argument_TS, NULL, 't'},
+   {"offsets", no_argument_TS, NULL, 'o'},
    {"input_encoding",required_argument_TS,NULL,'k'},
    {"output_encoding",required_argument_TS,NULL,'q'},
    {"help", no_argument_TS, NULL, 'h'},
@@ -131,6 +135,7 @@ int bom_output = DEFAULT_BOM_OUTPUT;
 int mask_encoding_compatibility_input = DEFAULT_MASK_ENCODING_COMPATIBILITY_INPUT;
 int val,index=-1;
 int mode=NORMAL;
+int offsets=0;
 struct OptVars* vars=new_OptVars();
 while (EOF!=(val=getopt_long_TS(argc,argv,optstring_Tokenize,lopts_Tokenize,&index,vars))) {
    switch(val) {
@@ -146,6 +151,7 @@ while (EOF!=(val=getopt_long_TS(argc,argv,optstring_Tokenize,lopts_Tokenize,&ind
              }
              strcpy(token_file,vars->optarg);
              break;
+   case 'o': offsets=1; break;
    case 'k': if (vars->optarg[0]=='\0') {
                 fatal_error("Empty input_encoding argument\n");
              }
@@ -265,6 +271,16 @@ u_fclose(text);
 u_fclose(out);
 u_fclose(output);
 write_number_of_tokens(tokens_txt,encoding_output,bom_output,tokens->nbelems);
+/* We build the offset index if needed. Otherwise, we remove any previous one,
+ * since it does not match the new text.cod */
+char text_ofs[FILENAME_MAX];
+get_snt_path(argv[vars->optind],text_ofs);
+strcat(text_ofs,"text.ofs");
+if (offsets) {
+   build_text_offsets(text_cod,tokens_txt,text_ofs,mask_encoding_compatibility_input);
+} else if (fexists(text_ofs)) {
+   af_remove(text_ofs);
+}
 // we compute some statistics
 get_snt_path(argv[vars->optind],tokens_txt);
 strcat(tokens_txt,"stats.n");
@@ -24,6 +24,50 @@
  */
 
 #include "TrainingProcess.h"
+#include "Ustring.h"
+#include "logger/SyncLogger.h"
+
+/* Sentences are read by batches of TRAINING_SENTENCES_PER_THREAD sentences
+ * per thread */
+#define TRAINING_SENTENCES_PER_THREAD 256
+
+/* Approximate size of a count table entry, not including its key */
+#define TRAINING_ENTRY_SIZE (sizeof(struct hash_list)+4*sizeof(void*))
+
+
+/**
+ * A sorted source of (key,count) entries to merge: either an array of
+ * entries in memory or a run file.
+ */
+struct training_source {
+	struct training_entry* entries;
+	int n;
+	int pos;
+	U_FILE* run;
+	unichar* buffer;
+	int capacity;
+	/* The current entry */
+	const unichar* key;
+	int count;
+};
+
+
+/**
+ * This structure describes the work of one thread: it counts the sentences
+ * first, first+step, first+2*step, ... of the batch in its own count tables.
+ * Sentence #i is made of the lines sentences[i] to sentences[i+1]-1.
+ */
+struct training_job {
+	vector_ptr* lines;
+	vector_int* sentences;
+	int n_sentences;
+	int first;
+	int step;
+	struct corpus_entry** context;
+	struct training_counts* rforms_table;
+	struct training_counts* iforms_table;
+};
+
 
 /**
  * Creates a Disclaimer text file for each one of the training dictionaries.
@@ -177,25 +221,50 @@ return matrix;
 }
 
 /**
- * Adds a new pair (key,value) in the hash table.
+ * Allocates, initializes and returns a new count table.
  */
-void add_key_table(const unichar* key,struct string_hash_ptr* table){
-void* value = get_value(key,table);
-if(value != NULL){
-	table->value[get_value_index(key,table)] = (void*)(((char*)value)+1);
+struct training_counts* new_training_counts(){
+struct training_counts* counts = (struct training_counts*)malloc(sizeof(struct training_counts));
+if(counts == NULL){
+	fatal_alloc_error("new_training_counts");
 }
-else{
-	get_value_index(key,table,INSERT_IF_NEEDED,(void*)1);
+counts->table = new_hash_table((HASH_FUNCTION)hash_unichar,(EQUAL_FUNCTION)u_equal,
+		(FREE_FUNCTION)free,NULL,(KEYCOPY_FUNCTION)keycopy);
+counts->memory = 0;
+return counts;
+}
+
+/**
+ * Frees all the memory associated to the given count table.
+ */
+void free_training_counts(struct training_counts* counts){
+if(counts == NULL){
+	return;
+}
+free_hash_table(counts->table);
+free(counts);
+}
+
+/**
+ * Raises by one the count of the given key.
+ */
+void add_key_table(const unichar* key,struct training_counts* counts){
+int ret;
+struct any* value = get_value(counts->table,(void*)key,HT_INSERT_IF_NEEDED,&ret);
+if(ret == HT_KEY_ADDED){
+	value->_int = 0;
+	counts->memory += TRAINING_ENTRY_SIZE+(u_strlen(key)+1)*sizeof(unichar);
 }
+value->_int++;
 }
 
 /**
- * Adds a new pair (key,value) in the hash table.
+ * Raises by one the count of the given key.
  * Here the key is a string (char*).
  */
-void add_key_table(const char* key,struct string_hash_ptr* table){
+void add_key_table(const char* key,struct training_counts* counts){
 unichar* str = u_strdup(key);
-add_key_table(str,table);
+add_key_table(str,counts);
 free(str);
 }
 
@@ -229,8 +298,8 @@ return line;
 /**
  * Computes lexical and contextual entries to put into the file containing statistics.
  */
-void add_statistics(struct corpus_entry** context,struct string_hash_ptr* rforms_table,
-		            struct string_hash_ptr* iforms_table){
+void add_statistics(struct corpus_entry** context,struct training_counts* rforms_table,
+		            struct training_counts* iforms_table){
 char prefix[] = "word_";
 /* we first raise the number of time current word occurs in the corpus (unigrams) */
 struct corpus_entry* current = context[MAX_CONTEXT-1];
@@ -269,21 +338,6 @@ if(iforms_table != NULL){
 free(word);
 }
 
-/**
- * Writes pairs (key,value) into the file containing statistics.
- */
-void write_keys_values(struct string_hash_ptr* table,struct string_hash_tree_node* node,const unichar* str,U_FILE* file){
-if(node->value_index != NO_VALUE_INDEX){
-	u_fprintf(file,"%S,.%d\n",str,table->value[node->value_index]);
-}
-for(struct string_hash_tree_transition* trans=node->trans;trans!=NULL;trans=trans->next){
-	unichar* new_str = (unichar*)malloc(DIC_LINE_SIZE);
-	u_sprintf(new_str,"%S%C",str,trans->letter);
-	write_keys_values(table,trans->node,new_str,file);
-	free(new_str);
-}
-}
-
 corpus_entry* new_simple_word_entry(const unichar* word,corpus_entry* entry,int start){
 	corpus_entry* wentry = (corpus_entry*)malloc(sizeof(corpus_entry));
 	wentry->word = u_strdup(word);
@@ -303,7 +357,7 @@ corpus_entry* new_simple_word_entry(const unichar* word,corpus_entry* entry,int
 }
 
 /**
- * Extract simple words contained into compound words.
+ * Extract simple words contained into compound words.
  */
 corpus_entry** extract_simple_words(corpus_entry* entry){
 	corpus_entry** words = (corpus_entry**)malloc(sizeof(corpus_entry)*100);
@@ -339,57 +393,376 @@ corpus_entry** extract_simple_words(corpus_entry* entry){
 	return words;
 }
 
+/**
+ * Adds to the count tables the statistics of the given corpus line.
+ */
+void add_corpus_line(const unichar* line,struct corpus_entry** context,struct training_counts* rforms_table,
+		            struct training_counts* iforms_table){
+corpus_entry* entry = new_corpus_entry(line);
+if(u_strchr(line,'_')!=NULL && line[0]!='_'){
+	corpus_entry** entries = extract_simple_words(entry);
+	free_corpus_entry(entry);
+	for(int i=0;entries[i]!=NULL;i++){
+		push_corpus_entry(entries[i],context);
+		add_statistics(context,rforms_table,iforms_table);
+	}
+	free(entries);
+}
+else {
+	push_corpus_entry(entry,context);
+	add_statistics(context,rforms_table,iforms_table);
+}
+}
+
+/**
+ * Compares two keys as the lines "key,.count" of the .dic file are compared
+ * by SortTxt, so that the .dic file is written in the same order.
+ */
+int compare_training_keys(const unichar* a,const unichar* b){
+int i=0;
+while(a[i]!='\0' && a[i]==b[i]){
+	i++;
+}
+if(a[i] == b[i]){
+	return 0;
+}
+unichar ca = (a[i]=='\0' && b[i]!='\0') ? ',' : a[i];
+unichar cb = (b[i]=='\0' && a[i]!='\0') ? ',' : b[i];
+if(ca == cb){
+	/* One key is the other one followed by a comma */
+	return (a[i]=='\0') ? -1 : 1;
+}
+return ca-cb;
+}
+
+static int compare_training_entries(const void* a,const void* b){
+return compare_training_keys(((const struct training_entry*)a)->key,((const struct training_entry*)b)->key);
+}
+
+/**
+ * Returns the entries of the given count table sorted by key. The keys
+ * belong to the table.
+ */
+struct training_entry* get_sorted_entries(struct training_counts* counts,int* n){
+struct training_entry* entries = (struct training_entry*)malloc((counts->table->number_of_elements+1)*sizeof(struct training_entry));
+if(entries == NULL){
+	fatal_alloc_error("get_sorted_entries");
+}
+*n = 0;
+for(unsigned int i=0;i<counts->table->capacity;i++){
+	for(struct hash_list* l=counts->table->table[i];l!=NULL;l=l->next){
+		entries[*n].key = (unichar*)l->ptr_key;
+		entries[*n].count = l->value._int;
+		(*n)++;
+	}
+}
+qsort(entries,*n,sizeof(struct training_entry),compare_training_entries);
+return entries;
+}
+
+/**
+ * Saves the given count table as a sorted run file of the given output,
+ * and empties the table. Each entry is saved as the length of its key,
+ * the key and its count.
+ */
+void save_training_run(struct training_counts* counts,struct training_output* output){
+char name[FILENAME_MAX];
+sprintf(name,"%s.%d.run",output->dic_name,output->runs->nbelems);
+U_FILE* f = u_fopen(BINARY,name,U_WRITE);
+if(f == NULL){
+	fatal_error("Cannot create %s\n",name);
+}
+int n;
+struct training_entry* entries = get_sorted_entries(counts,&n);
+for(int i=0;i<n;i++){
+	int length = u_strlen(entries[i].key);
+	if(fwrite(&length,sizeof(int),1,f)!=1 || fwrite(entries[i].key,sizeof(unichar),length,f)!=(size_t)length
+			|| fwrite(&(entries[i].count),sizeof(int),1,f)!=1){
+		fatal_error("Cannot write %s\n",name);
+	}
+}
+u_fclose(f);
+free(entries);
+vector_ptr_add(output->runs,strdup(name));
+clear_hash_table(counts->table);
+counts->memory = 0;
+}
+
+/**
+ * Moves the given source to its next entry. Returns 0 if there is none.
+ */
+static int next_training_entry(struct training_source* source){
+if(source->run == NULL){
+	if(source->pos == source->n){
+		return 0;
+	}
+	source->key = source->entries[source->pos].key;
+	source->count = source->entries[source->pos].count;
+	source->pos++;
+	return 1;
+}
+int length;
+if(fread(&length,sizeof(int),1,source->run) != 1){
+	return 0;
+}
+if(length >= source->capacity){
+	source->capacity = length+1;
+	source->buffer = (unichar*)realloc(source->buffer,source->capacity*sizeof(unichar));
+	if(source->buffer == NULL){
+		fatal_alloc_error("next_training_entry");
+	}
+}
+if(fread(source->buffer,sizeof(unichar),length,source->run) != (size_t)length
+		|| fread(&(source->count),sizeof(int),1,source->run) != 1){
+	fatal_error("Corrupted run file\n");
+}
+source->buffer[length] = '\0';
+source->key = source->buffer;
+return 1;
+}
+
+/**
+ * Restores the heap order of the sources from the position 'i'.
+ */
+static void sift_down_training_sources(struct training_source** heap,int n,int i){
+for(;;){
+	int min = i;
+	int left = 2*i+1,right = 2*i+2;
+	if(left < n && compare_training_keys(heap[left]->key,heap[min]->key) < 0){
+		min = left;
+	}
+	if(right < n && compare_training_keys(heap[right]->key,heap[min]->key) < 0){
+		min = right;
+	}
+	if(min == i){
+		return;
+	}
+	struct training_source* tmp = heap[i];
+	heap[i] = heap[min];
+	heap[min] = tmp;
+	i = min;
+}
+}
+
+/**
+ * Merges the run files and the count tables of the given output, summing
+ * the counts of identical keys. The merged entries are written in the .dic
+ * file, already sorted, and the tagging model is built from them and saved,
+ * so that the Tagger does not depend on the .bin. The run files are removed.
+ */
+void save_training_output(struct training_output* output,struct training_counts** tables,int n_tables){
+/* we have one source per run file, one per count table and one for the
+ * special line "CODE\tFEATURES,.value" that specifies whether the dictionary
+ * contains inflected or raw form tuples */
+int n_sources = output->runs->nbelems+n_tables+1;
+struct training_source* sources = (struct training_source*)calloc(n_sources,sizeof(struct training_source));
+struct training_source** heap = (struct training_source**)malloc(n_sources*sizeof(struct training_source*));
+if(sources == NULL || heap == NULL){
+	fatal_alloc_error("save_training_output");
+}
+for(int i=0;i<output->runs->nbelems;i++){
+	sources[i].run = u_fopen(BINARY,(const char*)output->runs->tab[i],U_READ);
+	if(sources[i].run == NULL){
+		fatal_error("Cannot open %s\n",(const char*)output->runs->tab[i]);
+	}
+}
+for(int i=0;i<n_tables;i++){
+	sources[output->runs->nbelems+i].entries = get_sorted_entries(tables[i],&(sources[output->runs->nbelems+i].n));
+}
+struct training_entry code;
+code.key = u_strdup("CODE\tFEATURES");
+code.count = output->form_type;
+sources[n_sources-1].entries = &code;
+sources[n_sources-1].n = 1;
+int n_heap = 0;
+for(int i=0;i<n_sources;i++){
+	if(next_training_entry(&(sources[i]))){
+		heap[n_heap++] = &(sources[i]);
+	}
+}
+for(int i=n_heap/2-1;i>=0;i--){
+	sift_down_training_sources(heap,n_heap,i);
+}
+struct tagging_model_builder* builder = new_tagging_model_builder();
+Ustring* key = new_Ustring(DIC_LINE_SIZE);
+int count = 0,has_key = 0;
+while(n_heap > 0){
+	struct training_source* source = heap[0];
+	if(has_key && !u_strcmp(key->str,source->key)){
+		count += source->count;
+	}
+	else {
+		if(has_key){
+			u_fprintf(output->dic,"%S,.%d\n",key->str,count);
+			add_tagging_model_entry(builder,key->str,count);
+		}
+		u_strcpy(key,source->key);
+		count = source->count;
+		has_key = 1;
+	}
+	if(!next_training_entry(source)){
+		heap[0] = heap[--n_heap];
+	}
+	sift_down_training_sources(heap,n_heap,0);
+}
+if(has_key){
+	u_fprintf(output->dic,"%S,.%d\n",key->str,count);
+	add_tagging_model_entry(builder,key->str,count);
+}
+free_Ustring(key);
+for(int i=0;i<n_sources-1;i++){
+	if(sources[i].run != NULL){
+		u_fclose(sources[i].run);
+		free(sources[i].buffer);
+	}
+	else {
+		free(sources[i].entries);
+	}
+}
+free(code.key);
+free(sources);
+free(heap);
+for(int i=0;i<output->runs->nbelems;i++){
+	af_remove((const char*)output->runs->tab[i]);
+}
+u_printf("Saving tagging model %s...\n",output->model_name);
+struct tagging_model* model = build_tagging_model(builder);
+free_tagging_model_builder(builder);
+if(!save_tagging_model(model,output->model_name)){
+	fatal_error("Cannot save tagging model %s\n",output->model_name);
+}
+free_tagging_model(model);
+}
+
+/**
+ * Counts the statistics of the sentences of the given job.
+ */
+static void SYNC_CALLBACK_UNITEX count_sentences(void* privateDataPtr,unsigned int /*iNbThread*/){
+struct training_job* job = (struct training_job*)privateDataPtr;
+for(int i=job->first;i<job->n_sentences;i=i+job->step){
+	initialize_context_matrix(job->context);
+	for(int j=job->sentences->tab[i];j<job->sentences->tab[i+1];j++){
+		add_corpus_line((const unichar*)job->lines->tab[j],job->context,job->rforms_table,job->iforms_table);
+	}
+}
+}
+
 /**
  * Computes training by extracting statistics from a tagged corpus file.
+ * Sentences are counted on 'n_threads' threads, each one having its own
+ * count tables. When the count tables use more than 'max_memory' bytes,
+ * they are saved as sorted run files, that are merged at the end.
+ * 'max_memory'=0 means no limit.
  */
-void do_training(U_FILE* input_text,U_FILE* rforms_file,U_FILE* iforms_file){
-/* these two hash tables are respectively for simple and compound entries */
-struct string_hash_ptr* rforms_table = NULL, *iforms_table = NULL;
-if(rforms_file != NULL){
-	rforms_table = new_string_hash_ptr(200000);
-}
-if(iforms_file != NULL){
-	iforms_table = new_string_hash_ptr(200000);
-}
-/* we initialize a contextual matrix */
-struct corpus_entry** context = new_context_matrix();
-initialize_context_matrix(context);
+void do_training(U_FILE* input_text,struct training_output* rforms,struct training_output* iforms,
+		         int n_threads,size_t max_memory){
+if(n_threads <= 0){
+	n_threads = (int)SyncGetNumberOfProcessors();
+}
+if(n_threads > 1 && !IsSeveralThreadsPossible()){
+	n_threads = 1;
+}
+int batch_size = n_threads*TRAINING_SENTENCES_PER_THREAD;
+struct training_job* jobs = (struct training_job*)malloc(n_threads*sizeof(struct training_job));
+void** job_ptrs = (void**)malloc(n_threads*sizeof(void*));
+if(jobs == NULL || job_ptrs == NULL){
+	fatal_alloc_error("do_training");
+}
+vector_ptr* lines = new_vector_ptr(batch_size*16);
+vector_int* sentences = new_vector_int(batch_size+1);
+for(int t=0;t<n_threads;t++){
+	struct training_job* job = &(jobs[t]);
+	job->lines = lines;
+	job->sentences = sentences;
+	job->first = t;
+	job->step = n_threads;
+	/* we initialize a contextual matrix per thread */
+	job->context = new_context_matrix();
+	/* these two count tables are respectively for simple and compound entries */
+	job->rforms_table = (rforms != NULL) ? new_training_counts() : NULL;
+	job->iforms_table = (iforms != NULL) ? new_training_counts() : NULL;
+	job_ptrs[t] = job;
+}
+size_t max_table_memory = 0;
+if(max_memory > 0){
+	max_table_memory = max_memory/(n_threads*((rforms != NULL)+(iforms != NULL)));
+}
 unichar line[4096];
-while(u_fgets(line,input_text) !=EOF){
-	if(u_strlen(line) == 0){
-		initialize_context_matrix(context);
-	}
-	else{
-		corpus_entry* entry = new_corpus_entry(line);
-		if(u_strchr(line,'_')!=NULL && line[0]!='_'){
-			corpus_entry** entries = extract_simple_words(entry);
-			free_corpus_entry(entry);
-			for(int i=0;entries[i]!=NULL;i++){
-				push_corpus_entry(entries[i],context);
-				add_statistics(context,rforms_table,iforms_table);
+int more = 1;
+while(more){
+	/* We read a batch of sentences, a sentence ending with an empty line */
+	int n = 0,in_sentence = 0;
+	while(n < batch_size && (more=(u_fgets(line,input_text)!=EOF))){
+		if(u_strlen(line) == 0){
+			if(in_sentence){
+				in_sentence = 0;
+				n++;
 			}
-			free(entries);
 		}
 		else {
-			push_corpus_entry(entry,context);
-			add_statistics(context,rforms_table,iforms_table);
+			if(!in_sentence){
+				in_sentence = 1;
+				vector_int_add(sentences,lines->nbelems);
+			}
+			vector_ptr_add(lines,u_strdup(line));
+		}
+	}
+	if(in_sentence){
+		n++;
+	}
+	vector_int_add(sentences,lines->nbelems);
+	/* We count them */
+	for(int t=0;t<n_threads;t++){
+		jobs[t].n_sentences = n;
+	}
+	if(n_threads > 1){
+		SyncDoRunThreads(n_threads,count_sentences,job_ptrs);
+	}
+	else {
+		count_sentences(job_ptrs[0],0);
+	}
+	for(int i=0;i<lines->nbelems;i++){
+		free(lines->tab[i]);
+	}
+	lines->nbelems = 0;
+	sentences->nbelems = 0;
+	/* And we save the count tables that have grown too big */
+	if(max_table_memory > 0){
+		for(int t=0;t<n_threads;t++){
+			if(jobs[t].rforms_table != NULL && jobs[t].rforms_table->memory > max_table_memory){
+				save_training_run(jobs[t].rforms_table,rforms);
+			}
+			if(jobs[t].iforms_table != NULL && jobs[t].iforms_table->memory > max_table_memory){
+				save_training_run(jobs[t].iforms_table,iforms);
+			}
 		}
 	}
 }
-free_context_matrix(context);
-/* we fill dictionary files with pairs (tuple,value) and then
- * we add a special line "CODE\tFEATURES,.value" in order to
- * specify whether the dictionary contains inflected or raw form tuples*/
-unichar* str = u_strdup("");
-if(rforms_table != NULL){
-	write_keys_values(rforms_table,rforms_table->hash->root,str,rforms_file);
-	u_fprintf(rforms_file,"%s,.%d\n","CODE\tFEATURES",0);
-	free_string_hash_ptr(rforms_table,NULL);
+free_vector_ptr(lines);
+free_vector_int(sentences);
+/* we merge the counts of all threads and save them */
+struct training_counts** tables = (struct training_counts**)malloc(n_threads*sizeof(struct training_counts*));
+if(tables == NULL){
+	fatal_alloc_error("do_training");
 }
-if(iforms_table != NULL){
-	write_keys_values(iforms_table,iforms_table->hash->root,str,iforms_file);
-	u_fprintf(iforms_file,"%s,.%d\n","CODE\tFEATURES",1);
-	free_string_hash_ptr(iforms_table,NULL);
+if(rforms != NULL){
+	for(int t=0;t<n_threads;t++){
+		tables[t] = jobs[t].rforms_table;
+	}
+	save_training_output(rforms,tables,n_threads);
 }
-free(str);
+if(iforms != NULL){
+	for(int t=0;t<n_threads;t++){
+		tables[t] = jobs[t].iforms_table;
+	}
+	save_training_output(iforms,tables,n_threads);
+}
+free(tables);
+for(int t=0;t<n_threads;t++){
+	free_context_matrix(jobs[t].context);
+	free_training_counts(jobs[t].rforms_table);
+	free_training_counts(jobs[t].iforms_table);
+}
+free(job_ptrs);
+free(jobs);
 }
@@ -34,9 +34,9 @@
 #include "File.h"
 #include "DELA.h"
 #include "Unicode.h"
-#include "String_hash.h"
-#include "SortTxt.h"
-#include "Compress.h"
+#include "HashTable.h"
+#include "Vector.h"
+#include "TaggingModel.h"
 
 #define MAX_CONTEXT 3
 #define RAW_FORMS 0
@@ -48,6 +48,33 @@ struct corpus_entry{
 	unichar* overall_codes;
 };
 
+/**
+ * The n-gram counts gathered for a data file. 'memory' estimates the
+ * memory used by the table, so that the counts can be saved in a sorted
+ * run file when they grow too big.
+ */
+struct training_counts{
+	struct hash_table* table;
+	size_t memory;
+};
+
+struct training_entry{
+	unichar* key;
+	int count;
+};
+
+/**
+ * A data file to build: its .dic file, its .tgm tagging model, the value of
+ * its "CODE\tFEATURES" line and the names of the run files saved so far.
+ */
+struct training_output{
+	U_FILE* dic;
+	const char* dic_name;
+	const char* model_name;
+	int form_type;
+	vector_ptr* runs;
+};
+
 void create_disclaimer(const char* file);
 void free_corpus_entry(corpus_entry*);
 void push_corpus_entry(corpus_entry*,corpus_entry**);
@@ -58,12 +85,18 @@ struct corpus_entry* create_corpus_entry(const unichar*);
 void free_context_matrix(struct corpus_entry**);
 void initialize_context_matrix(struct corpus_entry**);
 struct corpus_entry** new_context_matrix();
-void add_key_table(const unichar*,struct string_hash_ptr*);
-void add_key_table(const char*,struct string_hash_ptr*);
+struct training_counts* new_training_counts();
+void free_training_counts(struct training_counts*);
+void add_key_table(const unichar*,struct training_counts*);
+void add_key_table(const char*,struct training_counts*);
 unichar* compute_contextual_entries(struct corpus_entry**,int,int);
-void add_statistics(struct corpus_entry**,struct string_hash_ptr*,struct string_hash_ptr*);
-void write_keys_values(struct string_hash_ptr*,struct string_hash_tree_node*,const unichar*,U_FILE*);
-void do_training(U_FILE*,U_FILE*,U_FILE*);
+void add_statistics(struct corpus_entry**,struct training_counts*,struct training_counts*);
+void add_corpus_line(const unichar*,struct corpus_entry**,struct training_counts*,struct training_counts*);
+int compare_training_keys(const unichar*,const unichar*);
+struct training_entry* get_sorted_entries(struct training_counts*,int*);
+void save_training_run(struct training_counts*,struct training_output*);
+void save_training_output(struct training_output*,struct training_counts**,int);
+void do_training(U_FILE*,struct training_output*,struct training_output*,int,size_t);
 
 #endif
 
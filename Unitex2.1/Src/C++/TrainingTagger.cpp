@@ -33,6 +33,8 @@
 #include "Unicode.h"
 #include "TrainingTagger.h"
 #include "TrainingProcess.h"
+#include "TaggingModel.h"
+#include "Compress.h"
 
 
 const char* usage_TrainingTagger =
@@ -44,18 +46,26 @@ const char* usage_TrainingTagger =
 		 "  -b/--binaries: indicates whether the program should compress data files into"
 		 " .bin files (default)\n"
 		 "  -n/--no_binaries: indicates whether the program should not compress data files into"
-		 " .bin files, in this case only .dic data files are generated\n"
+		 " .bin files, in this case only .dic data files and .tgm tagging models are generated."
+		 " A .tgm records the hashes of the .bin/.inf pair compressed along with it, and none with -n."
+		 " The Tagger checks the hash of the .bin/.inf pair it is given against the .tgm, and rebuilds"
+		 " the model from that pair when it does not match if it is run with -r/--rebuild_model;"
+		 " otherwise it stops\n"
 		 "  -a/--all: indicates whether the program should produce all data files (default)\n"
 		 "  -c/--cat: indicates whether the program should produce only data file with 'cat' tags\n"
 		 "  -m/--morph: indicates whether the program should produce only data file with 'morph' tags\n"
 		 "  -o XXX/--output=XXX: pattern used to name output tagger data files XXX_data_cat.bin"
 		 " and XXX_data_morph.bin (default=filename of text corpus without extension)\n"
 		 "  -s/--semitic: the output .bin will use the semitic compression algorithm\n"
+		 "  --threads=N: counts the statistics on N threads (default=1, 0=one per processor)\n"
+		 "  --memory=N: when the statistics use more than N megabytes, they are saved in"
+		 " temporary sorted files that are merged at the end (default=0, no limit)\n"
 		 "  -h/--help: this help\n"
 		 "\n"
          "Extract statistics from a tagged corpus and save its into a tagger data file. "
          "These statistics are necessary in the tagging process in order to compute probabilities."
-         "Tagger data files are saved in the same path as corpus file.\n\n";
+         "Tagger data files are saved in the same path as corpus file, with the .tgm"
+         " tagging models used by the Tagger.\n\n";
 
 
 
@@ -76,11 +86,25 @@ const struct option_TS lopts_TrainingTagger[]= {
 	  {"semitic",no_argument_TS,NULL,'s'},
 	  {"input_encoding",required_argument_TS,NULL,'k'},
 	  {"output_encoding",required_argument_TS,NULL,'q'},
+	  {"threads",required_argument_TS,NULL,1},
+	  {"memory",required_argument_TS,NULL,2},
 	  {"help",no_argument_TS,NULL,'h'},
       {NULL,no_argument_TS,NULL,0}
 };
 
 
+/**
+ * Records in the .tgm model the .bin and .inf files that have just been
+ * compressed from the given .dic, so that the Tagger uses the model with them.
+ */
+static void bind_model_to_binaries(const char* dic,const char* model) {
+char bin[FILENAME_MAX];
+remove_extension(dic,bin);
+strcat(bin,".bin");
+bind_tagging_model(model,bin);
+}
+
+
 int main_TrainingTagger(int argc,char* const argv[]) {
 if (argc==1) {
    usage();
@@ -89,6 +113,8 @@ if (argc==1) {
 
 int val,index=-1,binaries=1,r_forms=1,i_forms=1;
 int semitic=0;
+int n_threads=1,max_memory=0;
+char foo;
 struct OptVars* vars=new_OptVars();
 char text[FILENAME_MAX]="";
 char raw_forms[FILENAME_MAX]="";
@@ -125,6 +151,14 @@ while (EOF!=(val=getopt_long_TS(argc,argv,optstring_TrainingTagger,lopts_Trainin
              }
              decode_writing_encoding_parameter(&encoding_output,&bom_output,vars->optarg);
              break;
+   case 1: if (1!=sscanf(vars->optarg,"%d%c",&n_threads,&foo) || n_threads<0) {
+                fatal_error("Invalid number of threads: %s\n",vars->optarg);
+             }
+             break;
+   case 2: if (1!=sscanf(vars->optarg,"%d%c",&max_memory,&foo) || max_memory<0) {
+                fatal_error("Invalid memory size: %s\n",vars->optarg);
+             }
+             break;
    case 'h': usage(); return 0;
    case ':': if (index==-1) fatal_error("Missing argument for option -%c\n",vars->optopt);
              else fatal_error("Missing argument for option --%s\n",lopts_TrainingTagger[index].name);
@@ -158,35 +192,54 @@ if(strlen(path) == 0){
 	strcpy(path,".");
 }
 /* we create files which will contain statistics extracted from the tagged corpus */
-U_FILE* rforms_file = NULL, *iforms_file = NULL;
+struct training_output rforms,iforms;
+char raw_model[FILENAME_MAX],inflected_model[FILENAME_MAX];
 if(r_forms == 1){
 	sprintf(filename,"%s_data_cat.dic",output);
 	new_file(path,filename,raw_forms);
-	rforms_file=u_fopen_creating_versatile_encoding(encoding_output,bom_output,raw_forms,U_WRITE);
+	get_tagging_model_name(raw_forms,raw_model);
+	rforms.dic=u_fopen_creating_versatile_encoding(encoding_output,bom_output,raw_forms,U_WRITE);
+	if(rforms.dic == NULL){
+		fatal_error("Cannot create %s\n",raw_forms);
+	}
+	rforms.dic_name=raw_forms;
+	rforms.model_name=raw_model;
+	rforms.form_type=0;
+	rforms.runs=new_vector_ptr(16);
 }
 if(i_forms == 1){
 	sprintf(filename,"%s_data_morph.dic",output);
 	new_file(path,filename,inflected_forms);
-	iforms_file=u_fopen_creating_versatile_encoding(encoding_output,bom_output,inflected_forms,U_WRITE);
+	get_tagging_model_name(inflected_forms,inflected_model);
+	iforms.dic=u_fopen_creating_versatile_encoding(encoding_output,bom_output,inflected_forms,U_WRITE);
+	if(iforms.dic == NULL){
+		fatal_error("Cannot create %s\n",inflected_forms);
+	}
+	iforms.dic_name=inflected_forms;
+	iforms.model_name=inflected_model;
+	iforms.form_type=1;
+	iforms.runs=new_vector_ptr(16);
 }
 
+/* the text dictionaries are written already sorted, and the .tgm models
+ * that the Tagger maps in memory are saved at the same time */
 u_printf("Gathering statistics from tagged corpus...\n");
-do_training(input_text,rforms_file,iforms_file);
+do_training(input_text,(r_forms == 1)?&rforms:NULL,(i_forms == 1)?&iforms:NULL,n_threads,(size_t)max_memory*1024*1024);
 
-/* we close all files and then we sort text dictionaries */
+/* we close all files */
 u_fclose(input_text);
 char disclaimer[FILENAME_MAX];
-if(rforms_file != NULL){
-	u_fclose(rforms_file);
-	pseudo_main_SortTxt(DEFAULT_ENCODING_OUTPUT,DEFAULT_BOM_OUTPUT,ALL_ENCODING_BOM_POSSIBLE,0,0,NULL,NULL,0,raw_forms);
+if(r_forms == 1){
+	u_fclose(rforms.dic);
+	free_vector_ptr(rforms.runs,free);
 	strcpy(disclaimer,raw_forms);
 	remove_extension(disclaimer);
 	strcat(disclaimer,".txt");
 	create_disclaimer(disclaimer);
 }
-if(iforms_file != NULL){
-	u_fclose(iforms_file);
-	pseudo_main_SortTxt(DEFAULT_ENCODING_OUTPUT,DEFAULT_BOM_OUTPUT,ALL_ENCODING_BOM_POSSIBLE,0,0,NULL,NULL,0,inflected_forms);
+if(i_forms == 1){
+	u_fclose(iforms.dic);
+	free_vector_ptr(iforms.runs,free);
 	strcpy(disclaimer,inflected_forms);
 	remove_extension(disclaimer);
 	strcat(disclaimer,".txt");
@@ -198,10 +251,12 @@ if(binaries == 1){
 /* simple forms dictionary */
 if(r_forms == 1){
 	pseudo_main_Compress(DEFAULT_ENCODING_OUTPUT,DEFAULT_BOM_OUTPUT,ALL_ENCODING_BOM_POSSIBLE,0,semitic,raw_forms);
+	bind_model_to_binaries(raw_forms,raw_model);
 }
 /* compound forms dictionary */
 if(i_forms == 1){
 	pseudo_main_Compress(DEFAULT_ENCODING_OUTPUT,DEFAULT_BOM_OUTPUT,ALL_ENCODING_BOM_POSSIBLE,0,semitic,inflected_forms);
+	bind_model_to_binaries(inflected_forms,inflected_model);
 }
 }
 free_OptVars(vars);
@@ -44,45 +44,119 @@
 #include "Korean.h"
 #include "HashTable.h"
 #include "TfstStats.h"
+#include "AbstractCallbackFuncModifier.h"
+#include "logger/SyncLogger.h"
+
+
+/* Sentences are read by batches of TXT2TFST_SENTENCES_PER_THREAD sentences
+ * per thread. Each batch is built by the threads and then saved in sentence
+ * order */
+#define TXT2TFST_SENTENCES_PER_THREAD 32
+
+
+/**
+ * A sentence of the batch. 'tokens' points into the mapped text.cod. 'tag_list'
+ * contains the tag sequences of the tags.ind file that start in this sentence.
+ * 'tfst' and 'tags' are the result of 'compute_sentence_automaton'.
+ */
+struct sentence_to_build {
+   const int* tokens;
+   int length;
+   int sentence_number;
+   int offset_in_tokens;
+   int offset_in_chars;
+   struct match_list* tag_list;
+   Tfst* tfst;
+   struct string_hash* tags;
+};
+
+
+/**
+ * This structure describes the work of one thread: it builds the sentences
+ * first, first+step, first+2*step, ... of the batch. The dictionaries, the
+ * alphabet and the normalization tree are shared with the other threads, but
+ * each thread has its own tagset and Korean objects, since they are modified
+ * when they are used.
+ */
+struct txt2tfst_job {
+   const struct text_tokens* tokens;
+   const struct DELA_tree* tree;
+   const Alphabet* alph;
+   struct normalization_tree* normalization_tree;
+   int clean;
+   language_t* language;
+   Korean* korean;
+   struct sentence_to_build* sentences;
+   int n_sentences;
+   int first;
+   int step;
+   /* The current sentence followed by a {S} */
+   int buffer[MAX_TOKENS_IN_SENTENCE+1];
+};
 
 
 /**
- * This function tries to read a sentence from the given file.
- * It stops when it finds the EOF, a "{S}" or when MAX_TOKENS_IN_SENTENCE
- * tokens have been read. All the tokens that compose the sentence are stored
- * into 'buffer', except the "{S}", if any. The number of these tokens is stored
- * in '*N'. '*total' contains the whole number of integers read from the file.
+ * This function tries to read a sentence from the text.cod mapped in 'cod', that
+ * contains 'size' integers, starting at position '*pos'.
+ * It stops when it finds the end of the text, a "{S}" or when MAX_TOKENS_IN_SENTENCE
+ * tokens have been read. '*sentence' is set to the first token of the sentence,
+ * and the number of tokens of the sentence, without the "{S}", if any, is stored
+ * in '*N'. '*total' contains the whole number of integers read, and '*pos' is
+ * moved after them.
  *
  * The function returns 1 if a sentence was read; 0 otherwise.
  */
-int read_sentence(int* buffer,int *N,int *total,U_FILE* f,int SENTENCE_MARKER) {
+int read_sentence(const int* cod,long size,long *pos,const int* *sentence,int *N,int *total,
+                  int SENTENCE_MARKER) {
 *total=0;
 *N=0;
-if (1!=fread(buffer,sizeof(int),1,f)) {
+if (*pos>=size) {
    /* If we are at the end of the file */
    return 0;
 }
+long p=*pos;
 *total=1;
 int length;
-if (buffer[0]==SENTENCE_MARKER) {
+if (cod[p]==SENTENCE_MARKER) {
    /* If the text starts by a {S}, we don't want to stop there */
+   (*sentence)=cod+p+1;
    length=0;
 } else {
+   (*sentence)=cod+p;
    length=1;
 }
-int control=-1;
-while (length<MAX_TOKENS_IN_SENTENCE && 1==(control=(int)fread(buffer+length,sizeof(int),1,f)) && buffer[length]!=SENTENCE_MARKER) {
+p++;
+while (length<MAX_TOKENS_IN_SENTENCE && p<size && cod[p]!=SENTENCE_MARKER) {
    length++;
    (*total)++;
+   p++;
 }
-if (length<MAX_TOKENS_IN_SENTENCE && control==1 && buffer[length]==SENTENCE_MARKER) {
+if (length<MAX_TOKENS_IN_SENTENCE && p<size && cod[p]==SENTENCE_MARKER) {
    (*total)++;
 }
+(*pos)=(*pos)+(*total);
 if (length==0) return 0;
 *N=length;
 return 1;
 }
 
+
+/**
+ * Builds the sentence automata of the given job.
+ */
+static void SYNC_CALLBACK_UNITEX build_sentences(void* privateDataPtr,unsigned int /*iNbThread*/) {
+struct txt2tfst_job* job=(struct txt2tfst_job*)privateDataPtr;
+for (int i=job->first;i<job->n_sentences;i=i+job->step) {
+   struct sentence_to_build* s=&(job->sentences[i]);
+   /* The normalization may look at the token that follows the sentence */
+   memcpy(job->buffer,s->tokens,sizeof(int)*s->length);
+   job->buffer[s->length]=job->tokens->SENTENCE_MARKER;
+   s->tfst=compute_sentence_automaton(job->buffer,s->length,job->tokens,job->tree,job->alph,
+            s->sentence_number,job->clean,job->normalization_tree,&(s->tag_list),
+            s->offset_in_tokens,s->offset_in_chars,job->language,job->korean,&(s->tags));
+}
+}
+
 #define STR_VALUE_MACRO(x) #x
 #define STR_VALUE_MACRO_STRING(x) STR_VALUE_MACRO(x)
 
@@ -97,12 +171,15 @@ const char* usage_Txt2Tfst =
          "  -n XXX/--normalization_grammar=XXX: the .fst2 grammar used to normalize the text automaton\n"
          "  -t XXX/--tagset=XXX: use the XXX ELAG tagset file to normalize the dictionary entries\n"
          "  -K/--korean: tells Txt2Tfst that it works on Korean\n"
+         "  --threads=N: builds N sentence automata at the same time (default=1).\n"
+         "               If N is 0, one thread is used per processor\n"
          "  -h/--help: this help\n"
          "\n"
          "Constructs the text automaton. If the sentences of the text were delimited\n"
          "with the special tag {S}, the program produces one automaton per sentence.\n"
 		   "If not, the text is turned into " STR_VALUE_MACRO_STRING(MAX_TOKENS_IN_SENTENCE) " token long automata. The result files\n"
-         "named \"text.tfst\" and \"text.tind\" are stored is the text directory.\n"
+         "named \"text.tfst\" and \"text.tind\" are stored is the text directory, with\n"
+         "\"text.tfstb\", a binary copy of the automaton that is faster to load.\n"
          "\n"
          "Note that the program will also take into account the file \"tags.ind\", if any.\n";
 
@@ -124,6 +201,7 @@ const struct option_TS lopts_Txt2Tfst[]={
    {"help", no_argument_TS, NULL, 'h'},
    {"input_encoding",required_argument_TS,NULL,'k'},
    {"output_encoding",required_argument_TS,NULL,'q'},
+   {"threads",required_argument_TS,NULL,1},
    {NULL, no_argument_TS, NULL, 0}
 };
 
@@ -139,6 +217,8 @@ char norm[FILENAME_MAX]="";
 char tagset[FILENAME_MAX]="";
 int is_korean=0;
 int CLEAN=0;
+int n_threads=1;
+char foo;
 Encoding encoding_output = DEFAULT_ENCODING_OUTPUT;
 int bom_output = DEFAULT_BOM_OUTPUT;
 int mask_encoding_compatibility_input = DEFAULT_MASK_ENCODING_COMPATIBILITY_INPUT;
@@ -175,6 +255,10 @@ while (EOF!=(val=getopt_long_TS(argc,argv,optstring_Txt2Tfst,lopts_Txt2Tfst,&ind
              }
              decode_writing_encoding_parameter(&encoding_output,&bom_output,vars->optarg);
              break;
+   case 1: if (1!=sscanf(vars->optarg,"%d%c",&n_threads,&foo) || n_threads<0) {
+                fatal_error("Invalid number of threads: %s\n",vars->optarg);
+             }
+             break;
    case ':': if (index==-1) fatal_error("Missing argument for option -%c\n",vars->optopt);
              else fatal_error("Missing argument for option --%s\n",lopts_Txt2Tfst[index].name);
    case '?': if (index==-1) fatal_error("Invalid option -%c\n",vars->optopt);
@@ -200,7 +284,6 @@ if (is_korean) {
 }
 
 struct DELA_tree* tree=new_DELA_tree();
-int buffer[MAX_TOKENS_IN_SENTENCE];
 char tokens_txt[FILENAME_MAX];
 char text_cod[FILENAME_MAX];
 char dlf[FILENAME_MAX];
@@ -240,16 +323,20 @@ struct text_tokens* tokens=load_text_tokens(tokens_txt,mask_encoding_compatibili
 if (tokens==NULL) {
    fatal_error("Cannot open %s\n",tokens_txt);
 }
-U_FILE* f=u_fopen(BINARY,text_cod,U_READ);
+ABSTRACTMAPFILE* f=af_open_mapfile(text_cod,MAPFILE_OPTION_READ,0);
 if (f==NULL) {
    fatal_error("Cannot open %s\n",text_cod);
 }
+long cod_size=(long)(af_get_mapfile_size(f)/sizeof(int));
+const int* cod=(const int*)af_get_mapfile_pointer(f);
+if (cod==NULL) {
+   cod_size=0;
+}
 char text_tfst[FILENAME_MAX];
 get_snt_path(argv[vars->optind],text_tfst);
 strcat(text_tfst,"text.tfst");
 U_FILE* tfst=u_fopen_creating_unitex_text_format(encoding_output,bom_output,text_tfst,U_WRITE);
 if (tfst==NULL) {
-   u_fclose(f);
    fatal_error("Cannot create %s\n",text_tfst);
 }
 char text_tind[FILENAME_MAX];
@@ -257,10 +344,12 @@ get_snt_path(argv[vars->optind],text_tind);
 strcat(text_tind,"text.tind");
 U_FILE* tind=u_fopen(BINARY,text_tind,U_WRITE);
 if (tind==NULL) {
-   u_fclose(f);
    u_fclose(tfst);
    fatal_error("Cannot create %s\n",text_tind);
 }
+char text_tfstb[FILENAME_MAX];
+get_tfst_binary_name(text_tfst,text_tfstb);
+struct tfst_binary_writer* tfstb=new_tfst_binary_writer(text_tfstb);
 struct normalization_tree* normalization_tree=NULL;
 if (norm[0]!='\0') {
    normalization_tree=load_normalization_fst2(norm,alph,tokens);
@@ -304,22 +393,89 @@ Ustring* text=new_Ustring(2048);
 struct hash_table* form_frequencies=new_hash_table((HASH_FUNCTION)hash_unichar,(EQUAL_FUNCTION)u_equal,
         (FREE_FUNCTION)free,NULL,(KEYCOPY_FUNCTION)keycopy);
 
-while (read_sentence(buffer,&N,&total,f,tokens->SENTENCE_MARKER)) {
-   /* We compute and save the current sentence description */
-   build_sentence_automaton(buffer,N,tokens,tree,alph,tfst,tind,sentence_number,CLEAN,
-            normalization_tree,&tag_list,
-            current_global_position_in_tokens,
-            current_global_position_in_chars+get_shift(n_enter_char,enter_pos,current_global_position_in_tokens),
-            language,korean,form_frequencies);
-   if (sentence_number%100==0) u_printf("%d sentences read...        \r",sentence_number);
-   sentence_number++;
-   current_global_position_in_tokens=current_global_position_in_tokens+total;
-   for (int y=0;y<total;y++) {
-      current_global_position_in_chars=current_global_position_in_chars+u_strlen(tokens->token[buffer[y]]);
+if (n_threads<=0) {
+   n_threads=(int)SyncGetNumberOfProcessors();
+}
+if (n_threads>1 && !IsSeveralThreadsPossible()) {
+   n_threads=1;
+}
+int batch_size=n_threads*TXT2TFST_SENTENCES_PER_THREAD;
+struct sentence_to_build* sentences=(struct sentence_to_build*)malloc(batch_size*sizeof(struct sentence_to_build));
+struct txt2tfst_job* jobs=(struct txt2tfst_job*)malloc(n_threads*sizeof(struct txt2tfst_job));
+void** job_ptrs=(void**)malloc(n_threads*sizeof(void*));
+if (sentences==NULL || jobs==NULL || job_ptrs==NULL) {
+   fatal_alloc_error("main_Txt2Tfst");
+}
+for (int t=0;t<n_threads;t++) {
+   struct txt2tfst_job* job=&(jobs[t]);
+   job->tokens=tokens;
+   job->tree=tree;
+   job->alph=alph;
+   job->normalization_tree=normalization_tree;
+   job->clean=CLEAN;
+   job->language=language;
+   job->korean=korean;
+   if (t>0) {
+      if (language!=NULL) {
+         job->language=load_language_definition(tagset);
+      }
+      if (korean!=NULL) {
+         job->korean=new Korean(alph);
+      }
    }
+   job->sentences=sentences;
+   job->first=t;
+   job->step=n_threads;
+   job_ptrs[t]=job;
 }
+long pos=0;
+int more=1;
+while (more) {
+   /* We read a batch of sentences */
+   int n=0;
+   const int* sentence;
+   while (n<batch_size && (more=read_sentence(cod,cod_size,&pos,&sentence,&N,&total,tokens->SENTENCE_MARKER))) {
+      struct sentence_to_build* s=&(sentences[n++]);
+      s->tokens=sentence;
+      s->length=N;
+      s->sentence_number=sentence_number++;
+      s->offset_in_tokens=current_global_position_in_tokens;
+      s->offset_in_chars=current_global_position_in_chars+get_shift(n_enter_char,enter_pos,current_global_position_in_tokens);
+      s->tag_list=get_sentence_tag_list(&tag_list,current_global_position_in_tokens,N);
+      current_global_position_in_tokens=current_global_position_in_tokens+total;
+      for (long y=pos-total;y<pos;y++) {
+         current_global_position_in_chars=current_global_position_in_chars+u_strlen(tokens->token[cod[y]]);
+      }
+   }
+   /* We compute the sentence automata */
+   for (int t=0;t<n_threads;t++) {
+      jobs[t].n_sentences=n;
+   }
+   if (n_threads>1) {
+      SyncDoRunThreads(n_threads,build_sentences,job_ptrs);
+   } else {
+      build_sentences(job_ptrs[0],0);
+   }
+   /* And we save them in sentence order */
+   for (int i=0;i<n;i++) {
+      save_sentence_automaton(sentences[i].tfst,sentences[i].tags,tfst,tind,tfstb,form_frequencies);
+      if (sentences[i].sentence_number%100==0) u_printf("%d sentences read...        \r",sentences[i].sentence_number);
+   }
+}
+for (int t=1;t<n_threads;t++) {
+   free_language_t(jobs[t].language);
+   if (jobs[t].korean!=NULL) {
+      delete jobs[t].korean;
+   }
+}
+free(job_ptrs);
+free(jobs);
+free(sentences);
 u_printf("%d sentence%s read\n",sentence_number-1,(sentence_number-1)>1?"s":"");
-u_fclose(f);
+if (cod!=NULL) {
+   af_release_mapfile_pointer(f,cod);
+}
+af_close_mapfile(f);
 free(enter_pos);
 /* Finally, we save statistics */
 char tfst_tags_by_freq[FILENAME_MAX];
@@ -344,6 +500,7 @@ free_hash_table(form_frequencies);
 free_Ustring(text);
 u_fclose(tfst);
 u_fclose(tind);
+close_tfst_binary_writer(tfstb,text_tfst);
 if (korean!=NULL) {
    delete korean;
 }
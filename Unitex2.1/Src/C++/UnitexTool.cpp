@@ -35,6 +35,7 @@
 #include <string.h>
 
 #include "Unicode.h"
+#include "Pipeline.h"
 
 #if (((!(defined(UNITEX_ONLY_EXEC_GRAPH_TOOLS))) && (!(defined(UNITEX_ONLY_EXEC_GRAPH_TOOLS_RICH))) && (!defined(NO_TOOL_BUILDKRMWUDIC))) || defined(TOOL_BUILDKRMWUDIC))
 #include "BuildKrMwuDic.h"
@@ -513,7 +514,12 @@ void unitex_tool_usage(int several, int display_copyright)
 		u_printf(
 		   "\n"
 		   "You can chain several utility call by using\n"
-		   "UnitexTool { <Utility> [OPTIONS] } { <Utility> [OPTIONS] } ...\n");
+		   "UnitexTool { <Utility> [OPTIONS] } { <Utility> [OPTIONS] } ...\n"
+		   "\n"
+		   "With UnitexTool --pipeline { <Utility> [OPTIONS] } ..., the alphabets,\n"
+		   "text tokens, dictionary .inf files and text.cod mappings are loaded once\n"
+		   "and shared by all the utilities of the chain, and the matches saved by\n"
+		   "Locate are given to Concord, Dico and Stats without parsing concord.ind.\n");
     //list_unused_option_letter();
 }
 
@@ -576,7 +582,14 @@ int UnitexTool_several_info(int argc,char* const argv[],int* p_number_done,struc
 	u_printf("\n");
 #endif
 	
-	if (argc <= 1)
+	int pipeline = 0;
+	if ((argc > 1) && (strcmp(argv[pos],"--pipeline")==0))
+	{
+		pipeline = BeginPipeline();
+		pos++;
+	}
+
+	if (argc <= pos)
 	{
 		unitex_tool_usage(1,1);
 	}
@@ -622,8 +635,8 @@ int UnitexTool_several_info(int argc,char* const argv[],int* p_number_done,struc
 		{
 			const struct utility_item* utility_called = found_utility(argv[pos]);
 			if (utility_called != NULL) {
-				ptia->argcpos = 1;
-				ptia->nbargs = argc-1;
+				ptia->argcpos = pos;
+				ptia->nbargs = argc-pos;
 				ptia->ret = ret = CallToolLogged(utility_called->fnc,ptia->nbargs,((char**)argv)+ptia->argcpos);
 			}
 			else
@@ -638,6 +651,9 @@ int UnitexTool_several_info(int argc,char* const argv[],int* p_number_done,struc
 		}
 	}
 
+	if (pipeline)
+		EndPipeline();
+
 	return ret;
 }
 
@@ -0,0 +1,611 @@
+/*
+ * Unitex
+ *
+ * Copyright (C) 2001-2011 Université Paris-Est Marne-la-Vallée <unitex@univ-mlv.fr>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "Error.h"
+#include "AbstractCallbackFuncModifier.h"
+#include "AbstractFilePlugCallback.h"
+#include "Af_stdio.h"
+#include "VirtualFileSystem.h"
+#include "logger/SyncLogger.h"
+
+
+/* Minimum number of bytes allocated for a file that is being written */
+#define VFS_MIN_CAPACITY 4096
+
+
+/**
+ * A former content of a file that is still mapped. It is freed when
+ * its last mapping is released.
+ */
+struct vfs_buffer {
+   unsigned char* data;
+   size_t size;
+   int nb_mapped;
+   struct vfs_buffer* next;
+};
+
+
+/**
+ * This structure represents a file stored in RAM. 'nb_open' is the number
+ * of handles opened on the file. When a file is removed while it is still
+ * opened, it is taken out of the file list and marked as 'unlinked', and
+ * its content is freed when its last handle is closed.
+ *
+ * 'nb_mapped' is the number of map pointers given on 'data'. Since they
+ * point directly into it, 'data' is never modified, moved or truncated
+ * while it is mapped: the file first gets its own copy, and the mapped
+ * buffer goes to 'detached' until its mappings are released.
+ */
+struct vfs_file {
+   char* name;
+   unsigned char* data;
+   size_t size;
+   size_t capacity;
+   int nb_open;
+   int unlinked;
+   int nb_mapped;
+   struct vfs_buffer* detached;
+   struct vfs_file* next;
+};
+
+
+/**
+ * This is a handle on an opened file.
+ */
+struct vfs_handle {
+   struct vfs_file* file;
+   size_t pos;
+};
+
+
+/**
+ * The file space itself. All the operations that modify a file or the file
+ * list are done while holding the mutex, so that several threads can use
+ * the file space at the same time.
+ */
+struct virtual_file_space {
+   SYNC_Mutex_OBJECT mutex;
+   struct vfs_file* files;
+};
+
+
+static struct virtual_file_space* installed_vfs=NULL;
+
+
+/**
+ * Compares file names, considering '/' and '\' as the same character,
+ * so that names built on Windows and on other systems match.
+ */
+static int same_vfs_name(const char* a,const char* b) {
+while (*a!='\0' && *b!='\0') {
+   if (*a!=*b && !((*a=='/' || *a=='\\') && (*b=='/' || *b=='\\'))) return 0;
+   a++;
+   b++;
+}
+return (*a==*b);
+}
+
+
+static int has_filter_prefix(const char* name,const char* filter) {
+if (filter==NULL) return 1;
+return strncmp(name,filter,strlen(filter))==0;
+}
+
+
+static struct vfs_file* find_vfs_file(struct virtual_file_space* vfs,const char* name) {
+for (struct vfs_file* f=vfs->files;f!=NULL;f=f->next) {
+   if (same_vfs_name(f->name,name)) return f;
+}
+return NULL;
+}
+
+
+static void free_vfs_file(struct vfs_file* f) {
+while (f->detached!=NULL) {
+   struct vfs_buffer* next=f->detached->next;
+   free(f->detached->data);
+   free(f->detached);
+   f->detached=next;
+}
+free(f->name);
+free(f->data);
+free(f);
+}
+
+
+/**
+ * Takes the given file out of the file list. It is freed now
+ * if no handle is opened on it, later otherwise.
+ */
+static void unlink_vfs_file(struct virtual_file_space* vfs,struct vfs_file* f) {
+struct vfs_file** previous=&(vfs->files);
+while (*previous!=f) {
+   previous=&((*previous)->next);
+}
+*previous=f->next;
+f->next=NULL;
+if (f->nb_open==0) {
+   free_vfs_file(f);
+} else {
+   f->unlinked=1;
+}
+}
+
+
+/**
+ * If the content of the file is mapped, leaves it to its mappings and gives
+ * the file a new buffer of 'capacity' bytes, holding its first 'keep' bytes.
+ * This must be done before the content is modified. Returns 0 if the
+ * allocation failed.
+ */
+static int detach_mapped_vfs_data(struct vfs_file* f,size_t keep,size_t capacity) {
+if (f->nb_mapped==0) return 1;
+struct vfs_buffer* b=(struct vfs_buffer*)malloc(sizeof(struct vfs_buffer));
+unsigned char* data=(capacity==0)?NULL:(unsigned char*)malloc(capacity);
+if (b==NULL || (capacity!=0 && data==NULL)) {
+   free(b);
+   free(data);
+   return 0;
+}
+if (keep>0) {
+   memcpy(data,f->data,keep);
+}
+b->data=f->data;
+b->size=f->size;
+b->nb_mapped=f->nb_mapped;
+b->next=f->detached;
+f->detached=b;
+f->data=data;
+f->capacity=capacity;
+f->nb_mapped=0;
+return 1;
+}
+
+
+/**
+ * Ensures that the file can hold at least 'size' bytes.
+ * Returns 0 if the allocation failed.
+ */
+static int reserve_vfs_file(struct vfs_file* f,size_t size) {
+if (size<=f->capacity) return 1;
+size_t capacity=(f->capacity<VFS_MIN_CAPACITY)?VFS_MIN_CAPACITY:f->capacity;
+while (capacity<size) {
+   capacity=capacity*2;
+}
+if (f->nb_mapped!=0) {
+   /* realloc would free the mapped buffer */
+   return detach_mapped_vfs_data(f,f->size,capacity);
+}
+unsigned char* data=(unsigned char*)realloc(f->data,capacity);
+if (data==NULL) return 0;
+f->data=data;
+f->capacity=capacity;
+return 1;
+}
+
+
+static int ABSTRACT_CALLBACK_UNITEX vfs_is_filename_object(const char* name,void*) {
+return strncmp(name,VIRTUAL_FILE_SPACE_PREFIX,strlen(VIRTUAL_FILE_SPACE_PREFIX))==0;
+}
+
+
+static int ABSTRACT_CALLBACK_UNITEX vfs_init(void* privateSpacePtr) {
+struct virtual_file_space* vfs=(struct virtual_file_space*)privateSpacePtr;
+vfs->mutex=SyncBuildMutex();
+vfs->files=NULL;
+return 1;
+}
+
+
+static void ABSTRACT_CALLBACK_UNITEX vfs_uninit(void* privateSpacePtr) {
+struct virtual_file_space* vfs=(struct virtual_file_space*)privateSpacePtr;
+while (vfs->files!=NULL) {
+   struct vfs_file* next=vfs->files->next;
+   free_vfs_file(vfs->files);
+   vfs->files=next;
+}
+SyncDeleteMutex(vfs->mutex);
+vfs->mutex=NULL;
+}
+
+
+static ABSTRACTFILE_PTR ABSTRACT_CALLBACK_UNITEX vfs_open(const char* name,TYPEOPEN_MF TypeOpen,void* privateSpacePtr) {
+struct virtual_file_space* vfs=(struct virtual_file_space*)privateSpacePtr;
+struct vfs_handle* h=(struct vfs_handle*)malloc(sizeof(struct vfs_handle));
+if (h==NULL) {
+   fatal_alloc_error("vfs_open");
+}
+SyncGetMutex(vfs->mutex);
+struct vfs_file* f=find_vfs_file(vfs,name);
+if (f==NULL && TypeOpen!=OPEN_READ_MF) {
+   /* Like fopen, the "ab" mode creates the file if needed */
+   f=(struct vfs_file*)malloc(sizeof(struct vfs_file));
+   if (f==NULL) {
+      fatal_alloc_error("vfs_open");
+   }
+   f->name=strdup(name);
+   if (f->name==NULL) {
+      fatal_alloc_error("vfs_open");
+   }
+   f->data=NULL;
+   f->size=0;
+   f->capacity=0;
+   f->nb_open=0;
+   f->unlinked=0;
+   f->nb_mapped=0;
+   f->detached=NULL;
+   f->next=vfs->files;
+   vfs->files=f;
+}
+if (f==NULL) {
+   SyncReleaseMutex(vfs->mutex);
+   free(h);
+   return NULL;
+}
+if (TypeOpen==OPEN_CREATE_MF) {
+   if (!detach_mapped_vfs_data(f,0,0)) {
+      SyncReleaseMutex(vfs->mutex);
+      free(h);
+      return NULL;
+   }
+   f->size=0;
+}
+f->nb_open++;
+SyncReleaseMutex(vfs->mutex);
+h->file=f;
+h->pos=0;
+return (ABSTRACTFILE_PTR)h;
+}
+
+
+static size_t ABSTRACT_CALLBACK_UNITEX vfs_write(ABSTRACTFILE_PTR llFile,void const* Buf,size_t size,void* privateSpacePtr) {
+struct virtual_file_space* vfs=(struct virtual_file_space*)privateSpacePtr;
+struct vfs_handle* h=(struct vfs_handle*)llFile;
+struct vfs_file* f=h->file;
+SyncGetMutex(vfs->mutex);
+if (!detach_mapped_vfs_data(f,f->size,f->capacity) || !reserve_vfs_file(f,h->pos+size)) {
+   SyncReleaseMutex(vfs->mutex);
+   return 0;
+}
+if (h->pos>f->size) {
+   /* As with a real file, a write after a seek beyond the end fills the gap with zeros */
+   memset(f->data+f->size,0,h->pos-f->size);
+}
+memcpy(f->data+h->pos,Buf,size);
+h->pos+=size;
+if (h->pos>f->size) {
+   f->size=h->pos;
+}
+SyncReleaseMutex(vfs->mutex);
+return size;
+}
+
+
+static size_t ABSTRACT_CALLBACK_UNITEX vfs_read(ABSTRACTFILE_PTR llFile,void* Buf,size_t size,void* privateSpacePtr) {
+struct virtual_file_space* vfs=(struct virtual_file_space*)privateSpacePtr;
+struct vfs_handle* h=(struct vfs_handle*)llFile;
+struct vfs_file* f=h->file;
+SyncGetMutex(vfs->mutex);
+size_t available=(h->pos<f->size)?(f->size-h->pos):0;
+if (size>available) {
+   size=available;
+}
+if (size>0) {
+   memcpy(Buf,f->data+h->pos,size);
+   h->pos+=size;
+}
+SyncReleaseMutex(vfs->mutex);
+return size;
+}
+
+
+static int ABSTRACT_CALLBACK_UNITEX vfs_seek(ABSTRACTFILE_PTR llFile,afs_size_type Pos,int TypeSeek,void* privateSpacePtr) {
+struct virtual_file_space* vfs=(struct virtual_file_space*)privateSpacePtr;
+struct vfs_handle* h=(struct vfs_handle*)llFile;
+/* af_fseek gives us a signed long offset through an unsigned type */
+long offset=(long)Pos;
+long origin;
+SyncGetMutex(vfs->mutex);
+switch (TypeSeek) {
+   case SEEK_SET: origin=0; break;
+   case SEEK_CUR: origin=(long)h->pos; break;
+   case SEEK_END: origin=(long)h->file->size; break;
+   default: SyncReleaseMutex(vfs->mutex); return -1;
+}
+SyncReleaseMutex(vfs->mutex);
+if (origin+offset<0) {
+   return -1;
+}
+h->pos=(size_t)(origin+offset);
+return 0;
+}
+
+
+static void ABSTRACT_CALLBACK_UNITEX vfs_get_size(ABSTRACTFILE_PTR llFile,afs_size_type* pPos,void* privateSpacePtr) {
+struct virtual_file_space* vfs=(struct virtual_file_space*)privateSpacePtr;
+struct vfs_handle* h=(struct vfs_handle*)llFile;
+SyncGetMutex(vfs->mutex);
+*pPos=h->file->size;
+SyncReleaseMutex(vfs->mutex);
+}
+
+
+static void ABSTRACT_CALLBACK_UNITEX vfs_tell(ABSTRACTFILE_PTR llFile,afs_size_type* pPos,void*) {
+struct vfs_handle* h=(struct vfs_handle*)llFile;
+*pPos=h->pos;
+}
+
+
+static int ABSTRACT_CALLBACK_UNITEX vfs_close(ABSTRACTFILE_PTR llFile,void* privateSpacePtr) {
+struct virtual_file_space* vfs=(struct virtual_file_space*)privateSpacePtr;
+struct vfs_handle* h=(struct vfs_handle*)llFile;
+SyncGetMutex(vfs->mutex);
+struct vfs_file* f=h->file;
+f->nb_open--;
+if (f->nb_open==0 && f->unlinked) {
+   free_vfs_file(f);
+}
+SyncReleaseMutex(vfs->mutex);
+free(h);
+return 0;
+}
+
+
+static int ABSTRACT_CALLBACK_UNITEX vfs_set_size_reservation(ABSTRACTFILE_PTR llFile,afs_size_type size_reserv,void* privateSpacePtr) {
+struct virtual_file_space* vfs=(struct virtual_file_space*)privateSpacePtr;
+struct vfs_handle* h=(struct vfs_handle*)llFile;
+SyncGetMutex(vfs->mutex);
+int ret=reserve_vfs_file(h->file,size_reserv);
+SyncReleaseMutex(vfs->mutex);
+return ret;
+}
+
+
+static int ABSTRACT_CALLBACK_UNITEX vfs_remove(const char* name,void* privateSpacePtr) {
+struct virtual_file_space* vfs=(struct virtual_file_space*)privateSpacePtr;
+SyncGetMutex(vfs->mutex);
+struct vfs_file* f=find_vfs_file(vfs,name);
+if (f!=NULL) {
+   unlink_vfs_file(vfs,f);
+}
+SyncReleaseMutex(vfs->mutex);
+return (f==NULL)?-1:0;
+}
+
+
+static int ABSTRACT_CALLBACK_UNITEX vfs_rename(const char* old_name,const char* new_name,void* privateSpacePtr) {
+struct virtual_file_space* vfs=(struct virtual_file_space*)privateSpacePtr;
+char* name=strdup(new_name);
+if (name==NULL) {
+   fatal_alloc_error("vfs_rename");
+}
+SyncGetMutex(vfs->mutex);
+struct vfs_file* f=find_vfs_file(vfs,old_name);
+if (f==NULL) {
+   SyncReleaseMutex(vfs->mutex);
+   free(name);
+   return -1;
+}
+struct vfs_file* existing=find_vfs_file(vfs,new_name);
+if (existing!=NULL && existing!=f) {
+   unlink_vfs_file(vfs,existing);
+}
+free(f->name);
+f->name=name;
+SyncReleaseMutex(vfs->mutex);
+return 0;
+}
+
+
+/**
+ * Mapping a RAM file costs nothing: we just return a pointer to its content.
+ * The pointer stays valid until it is released, even if the file is written
+ * meanwhile, since the file then gets a copy of its content (see
+ * detach_mapped_vfs_data).
+ */
+static const void* ABSTRACT_CALLBACK_UNITEX vfs_get_map_pointer(ABSTRACTFILE_PTR llFile,afs_size_type pos,afs_size_type len,
+                                            int,afs_size_type,void* privateSpacePtr) {
+struct virtual_file_space* vfs=(struct virtual_file_space*)privateSpacePtr;
+struct vfs_handle* h=(struct vfs_handle*)llFile;
+const void* ptr=NULL;
+SyncGetMutex(vfs->mutex);
+if (pos+len<=h->file->size && h->file->data!=NULL) {
+   ptr=h->file->data+pos;
+   (h->file->nb_mapped)++;
+}
+SyncReleaseMutex(vfs->mutex);
+return ptr;
+}
+
+
+static void ABSTRACT_CALLBACK_UNITEX vfs_release_map_pointer(ABSTRACTFILE_PTR llFile,const void* ptr,afs_size_type,void* privateSpacePtr) {
+struct virtual_file_space* vfs=(struct virtual_file_space*)privateSpacePtr;
+struct vfs_handle* h=(struct vfs_handle*)llFile;
+struct vfs_file* f=h->file;
+const unsigned char* p=(const unsigned char*)ptr;
+SyncGetMutex(vfs->mutex);
+if (f->nb_mapped!=0 && p>=f->data && p<=f->data+f->size) {
+   (f->nb_mapped)--;
+} else {
+   /* The pointer was given on a former content of the file */
+   for (struct vfs_buffer** previous=&(f->detached);*previous!=NULL;previous=&((*previous)->next)) {
+      struct vfs_buffer* b=*previous;
+      if (p>=b->data && p<=b->data+b->size) {
+         (b->nb_mapped)--;
+         if (b->nb_mapped==0) {
+            *previous=b->next;
+            free(b->data);
+            free(b);
+         }
+         break;
+      }
+   }
+}
+SyncReleaseMutex(vfs->mutex);
+}
+
+
+static const t_fileio_func_array_ex vfs_func_array={
+   vfs_is_filename_object,
+   vfs_init,
+   vfs_uninit,
+   vfs_open,
+   vfs_write,
+   vfs_read,
+   vfs_seek,
+   vfs_get_size,
+   vfs_tell,
+   vfs_close,
+   vfs_set_size_reservation,
+   vfs_remove,
+   vfs_rename,
+   vfs_get_map_pointer,
+   vfs_release_map_pointer
+};
+
+
+UNITEX_FUNC int UNITEX_CALL InstallVirtualFileSpace() {
+if (installed_vfs!=NULL) return 1;
+struct virtual_file_space* vfs=(struct virtual_file_space*)malloc(sizeof(struct virtual_file_space));
+if (vfs==NULL) {
+   fatal_alloc_error("InstallVirtualFileSpace");
+   return 0;
+}
+if (!AddAbstractFileSpaceEx(&vfs_func_array,vfs)) {
+   free(vfs);
+   return 0;
+}
+installed_vfs=vfs;
+return 1;
+}
+
+
+UNITEX_FUNC int UNITEX_CALL UninstallVirtualFileSpace() {
+if (installed_vfs==NULL) return 0;
+int ret=RemoveAbstractFileSpaceEx(&vfs_func_array,installed_vfs);
+free(installed_vfs);
+installed_vfs=NULL;
+return ret;
+}
+
+
+UNITEX_FUNC int UNITEX_CALL IsVirtualFileSpaceInstalled() {
+return (installed_vfs!=NULL);
+}
+
+
+UNITEX_FUNC char** UNITEX_CALL GetVirtualFileList(const char* filter) {
+if (installed_vfs==NULL) return NULL;
+SyncGetMutex(installed_vfs->mutex);
+int n=0;
+struct vfs_file* f;
+for (f=installed_vfs->files;f!=NULL;f=f->next) {
+   if (has_filter_prefix(f->name,filter)) n++;
+}
+char** list=(char**)malloc((n+1)*sizeof(char*));
+if (list==NULL) {
+   fatal_alloc_error("GetVirtualFileList");
+}
+n=0;
+for (f=installed_vfs->files;f!=NULL;f=f->next) {
+   if (has_filter_prefix(f->name,filter)) {
+      list[n]=strdup(f->name);
+      if (list[n]==NULL) {
+         fatal_alloc_error("GetVirtualFileList");
+      }
+      n++;
+   }
+}
+list[n]=NULL;
+SyncReleaseMutex(installed_vfs->mutex);
+return list;
+}
+
+
+UNITEX_FUNC void UNITEX_CALL ReleaseVirtualFileList(char** list) {
+if (list==NULL) return;
+for (int i=0;list[i]!=NULL;i++) {
+   free(list[i]);
+}
+free(list);
+}
+
+
+UNITEX_FUNC int UNITEX_CALL ExportVirtualFile(const char* name,const char* disk_name) {
+if (!vfs_is_filename_object(name,NULL) || vfs_is_filename_object(disk_name,NULL)) {
+   return -1;
+}
+return af_copy_unlogged(name,disk_name);
+}
+
+
+UNITEX_FUNC int UNITEX_CALL PurgeVirtualFiles(const char* filter) {
+if (installed_vfs==NULL) return 0;
+int n=0;
+SyncGetMutex(installed_vfs->mutex);
+struct vfs_file* f=installed_vfs->files;
+while (f!=NULL) {
+   struct vfs_file* next=f->next;
+   if (has_filter_prefix(f->name,filter)) {
+      unlink_vfs_file(installed_vfs,f);
+      n++;
+   }
+   f=next;
+}
+SyncReleaseMutex(installed_vfs->mutex);
+return n;
+}
+
+
+UNITEX_FUNC size_t UNITEX_CALL GetVirtualFileSpaceSize() {
+if (installed_vfs==NULL) return 0;
+size_t total=0;
+SyncGetMutex(installed_vfs->mutex);
+for (struct vfs_file* f=installed_vfs->files;f!=NULL;f=f->next) {
+   total=total+f->size;
+}
+SyncReleaseMutex(installed_vfs->mutex);
+return total;
+}
+
+
+#ifndef NO_UNITEX_VIRTUAL_FILE_SPACE_AUTOINSTALL
+
+/**
+ * This object installs the RAM file space when the program starts,
+ * and removes it when the program ends.
+ */
+class AutoInstallVirtualFileSpace {
+public:
+   AutoInstallVirtualFileSpace() {
+      InstallVirtualFileSpace();
+   }
+   ~AutoInstallVirtualFileSpace() {
+      UninstallVirtualFileSpace();
+   }
+};
+
+static AutoInstallVirtualFileSpace auto_install_virtual_file_space;
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ * Unitex
+ *
+ * Copyright (C) 2001-2011 Université Paris-Est Marne-la-Vallée <unitex@univ-mlv.fr>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA.
+ *
+ */
+
+#ifndef VirtualFileSystemH
+#define VirtualFileSystemH
+
+#include <stddef.h>
+#include "AbstractCallbackFuncModifier.h"
+
+/**
+ * This library provides an abstract file space (see AbstractFilePlugCallback.h)
+ * that keeps files in RAM. Every file whose name starts with VIRTUAL_FILE_SPACE_PREFIX
+ * belongs to this file space, so that a caller can run a whole chain of tools
+ * (for instance UnitexTool { Normalize $:t.txt } { Tokenize $:t.snt ... } ...)
+ * without any disk access for the intermediate files. The files can be imported
+ * and exported with af_copy or the DuplicateFile tool, since af_copy works
+ * across file spaces.
+ *
+ * The file space is thread-safe, and af_open_mapfile returns pointers
+ * to the RAM content without any copy. A file that is written while it is
+ * mapped gets a copy of its content, so that the mappings keep seeing
+ * the content they were given until they are released.
+ *
+ * When VirtualFileSystem.cpp is linked, the file space is installed
+ * at startup, unless NO_UNITEX_VIRTUAL_FILE_SPACE_AUTOINSTALL is defined.
+ */
+
+#define VIRTUAL_FILE_SPACE_PREFIX "$:"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* installs and removes the RAM file space. They return 1 if successful and 0 otherwise.
+   Removing the file space frees all its files */
+UNITEX_FUNC int UNITEX_CALL InstallVirtualFileSpace();
+UNITEX_FUNC int UNITEX_CALL UninstallVirtualFileSpace();
+UNITEX_FUNC int UNITEX_CALL IsVirtualFileSpaceInstalled();
+
+/* returns a NULL terminated array with the names of the files whose name starts
+   with filter (all the files if filter is NULL). This array must be freed
+   with ReleaseVirtualFileList */
+UNITEX_FUNC char** UNITEX_CALL GetVirtualFileList(const char* filter);
+UNITEX_FUNC void UNITEX_CALL ReleaseVirtualFileList(char** list);
+
+/* copies a file of the RAM file space to the disk. Returns 0 if successful */
+UNITEX_FUNC int UNITEX_CALL ExportVirtualFile(const char* name,const char* disk_name);
+
+/* removes all files whose name starts with filter (all the files if filter is NULL),
+   and returns the number of removed files */
+UNITEX_FUNC int UNITEX_CALL PurgeVirtualFiles(const char* filter);
+
+/* returns the total number of bytes stored in the RAM file space */
+UNITEX_FUNC size_t UNITEX_CALL GetVirtualFileSpaceSize();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -52,6 +52,8 @@ UNITEX_FUNC unsigned int UNITEX_CALL SyncGetMSecElapsedNotDestructive(hTimeElasp
 typedef void (SYNC_CALLBACK_UNITEX* t_thread_func)(void* privateDataPtr,unsigned int iNbThread);
 
 UNITEX_FUNC int UNITEX_CALL IsSeveralThreadsPossible();
+/* returns the number of processors available, or 1 if unknown */
+UNITEX_FUNC unsigned int UNITEX_CALL SyncGetNumberOfProcessors();
 UNITEX_FUNC void UNITEX_CALL SyncDoRunThreads(unsigned int iNbThread,t_thread_func thread_func,void** privateDataPtrArray);
 
 
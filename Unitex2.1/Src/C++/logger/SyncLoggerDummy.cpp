@@ -41,6 +41,11 @@ UNITEX_FUNC int UNITEX_CALL IsSeveralThreadsPossible()
     return 0;
 }
 
+UNITEX_FUNC unsigned int UNITEX_CALL SyncGetNumberOfProcessors()
+{
+    return 1;
+}
+
 UNITEX_FUNC void UNITEX_CALL SyncDoRunThreads(unsigned int iNbThread,t_thread_func thread_func,void** privateDataPtrArray)
 {
     if (iNbThread>0)
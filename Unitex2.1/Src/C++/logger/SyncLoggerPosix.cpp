@@ -37,6 +37,7 @@
 
 #include <sys/time.h>
 #include <pthread.h>
+#include <unistd.h>
 #include <stdlib.h>
 
 
@@ -65,6 +66,12 @@ UNITEX_FUNC int UNITEX_CALL IsSeveralThreadsPossible()
     return 1;
 }
 
+UNITEX_FUNC unsigned int UNITEX_CALL SyncGetNumberOfProcessors()
+{
+    long nb=sysconf(_SC_NPROCESSORS_ONLN);
+    return (nb>0) ? (unsigned int)nb : 1;
+}
+
 UNITEX_FUNC void UNITEX_CALL SyncDoRunThreads(unsigned int iNbThread,t_thread_func thread_func,void** privateDataPtrArray)
 {
     unsigned int i;
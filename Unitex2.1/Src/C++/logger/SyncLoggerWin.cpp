@@ -97,6 +97,13 @@ UNITEX_FUNC int UNITEX_CALL IsSeveralThreadsPossible()
     return 1;
 }
 
+UNITEX_FUNC unsigned int UNITEX_CALL SyncGetNumberOfProcessors()
+{
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return (si.dwNumberOfProcessors>0) ? (unsigned int)si.dwNumberOfProcessors : 1;
+}
+
 UNITEX_FUNC void UNITEX_CALL SyncDoRunThreads(unsigned int iNbThread,t_thread_func thread_func,void** privateDataPtrArray)
 {
     unsigned int i;
@@ -256,6 +263,7 @@ UNITEX_FUNC void UNITEX_CALL SyncDeleteTls(SYNC_TLS_OBJECT pTls)
 
 #include <sys/time.h>
 #include <pthread.h>
+#include <unistd.h>
 #include <stdlib.h>
 
 
@@ -303,6 +311,12 @@ UNITEX_FUNC int UNITEX_CALL IsSeveralThreadsPossible()
     return 1;
 }
 
+UNITEX_FUNC unsigned int UNITEX_CALL SyncGetNumberOfProcessors()
+{
+    long nb=sysconf(_SC_NPROCESSORS_ONLN);
+    return (nb>0) ? (unsigned int)nb : 1;
+}
+
 UNITEX_FUNC void UNITEX_CALL SyncDoRunThreads(unsigned int iNbThread,t_thread_func thread_func,void** privateDataPtrArray)
 {
     unsigned int i;